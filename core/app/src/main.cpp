@@ -6,6 +6,7 @@
 #include "assembler/preprocessor.h"
 #include "emulator32bit/emulator32bit.h"
 #include "emulator32bit/disk.h"
+#include "emulator32bit/kernel/file_io.h"
 #include "util/file.h"
 #include "util/logger.h"
 
@@ -141,6 +142,7 @@ int main(int argc, char* argv[])
         Disk *disk = new Disk(File("../tests/disk.bin", true), 32, 32);
 
         Emulator32bit emulator(ram, rom, disk);
+        emulator.file_manager->set_root(".");           /* guest programs open files in the working directory */
         long long pid = emulator.system_bus.mmu.begin_process();
         LoadExecutable loader(emulator, process.get_exe_file());
         CLOCK_END
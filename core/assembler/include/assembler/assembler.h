@@ -53,13 +53,22 @@ class Assembler
         word parse_format_o1(size_t& tok_i, byte opcode);
         word parse_format_o2(size_t& tok_i, byte opcode);
         word parse_format_o3(size_t& tok_i, byte opcode);
+        word parse_format_o4(size_t& tok_i, byte opcode);
+
+        word parse_format_f(size_t& tok_i, byte opcode);
+        word parse_format_f1(size_t& tok_i, byte opcode);
+        word parse_format_f2(size_t& tok_i, byte opcode);
 
         word parse_format_m(size_t& tok_i, byte opcode);
         word parse_format_m1(size_t& tok_i, byte opcode);
         word parse_format_m2(size_t& tok_i, byte opcode);
+        word parse_format_m3(size_t& tok_i, byte opcode);
+        word parse_format_m4(size_t& tok_i, byte opcode);
+        word parse_format_m5(size_t& tok_i, byte opcode);
 
         word parse_format_b1(size_t& tok_i, byte opcode);
         word parse_format_b2(size_t& tok_i, byte opcode);
+        word parse_format_b3(size_t& tok_i, byte opcode);
 
         void fill_local();
 
@@ -97,60 +106,9 @@ class Assembler
         void _ascii(size_t& tok_i);
         void _asciz(size_t& tok_i);
 
-        void _hlt(size_t& tok_i);
-        void _add(size_t& tok_i);
-        void _sub(size_t& tok_i);
-        void _rsb(size_t& tok_i);
-        void _adc(size_t& tok_i);
-        void _sbc(size_t& tok_i);
-        void _rsc(size_t& tok_i);
-        void _mul(size_t& tok_i);
-        void _umull(size_t& tok_i);
-        void _smull(size_t& tok_i);
-        void _vabs(size_t& tok_i);
-        void _vneg(size_t& tok_i);
-        void _vsqrt(size_t& tok_i);
-        void _vadd(size_t& tok_i);
-        void _vsub(size_t& tok_i);
-        void _vdiv(size_t& tok_i);
-        void _vmul(size_t& tok_i);
-        void _vcmp(size_t& tok_i);
-        void _vsel(size_t& tok_i);
-        void _vcint(size_t& tok_i);
-        void _vcflo(size_t& tok_i);
-        void _vmov(size_t& tok_i);
-        void _and(size_t& tok_i);
-        void _orr(size_t& tok_i);
-        void _eor(size_t& tok_i);
-        void _bic(size_t& tok_i);
-        void _lsl(size_t& tok_i);
-        void _lsr(size_t& tok_i);
-        void _asr(size_t& tok_i);
-        void _ror(size_t& tok_i);
-        void _cmp(size_t& tok_i);
-        void _cmn(size_t& tok_i);
-        void _tst(size_t& tok_i);
-        void _teq(size_t& tok_i);
-        void _mov(size_t& tok_i);
-        void _mvn(size_t& tok_i);
-        void _ldr(size_t& tok_i);
-        void _str(size_t& tok_i);
-        void _swp(size_t& tok_i);
-        void _ldrb(size_t& tok_i);
-        void _strb(size_t& tok_i);
-        void _swpb(size_t& tok_i);
-        void _ldrh(size_t& tok_i);
-        void _strh(size_t& tok_i);
-        void _swph(size_t& tok_i);
-        void _b(size_t& tok_i);
-        void _bl(size_t& tok_i);
-        void _bx(size_t& tok_i);
-        void _blx(size_t& tok_i);
-        void _swi(size_t& tok_i);
-
-        void _adrp(size_t& tok_i);
-
-        void _ret(size_t& tok_i);
+        #define _INSTRUCTION_HANDLER(name, handler, mnemonic) void _##handler(size_t& tok_i);
+        ASSEMBLER_INSTRUCTIONS(_INSTRUCTION_HANDLER)
+        #undef _INSTRUCTION_HANDLER
 
         typedef void (Assembler::*DirectiveFunction)(size_t& tok_i);
         std::unordered_map<Tokenizer::Type,DirectiveFunction> directives = {
@@ -179,60 +137,7 @@ class Assembler
             {Tokenizer::ASSEMBLER_ASCIZ, &Assembler::_asciz},
         };
         typedef void (Assembler::*InstructionFunction)(size_t& tok_i);
-        std::unordered_map<Tokenizer::Type,InstructionFunction> instructions = {
-            {Tokenizer::INSTRUCTION_HLT, & Assembler::_hlt},
-            {Tokenizer::INSTRUCTION_ADD, &Assembler::_add},
-            {Tokenizer::INSTRUCTION_SUB, &Assembler::_sub},
-            {Tokenizer::INSTRUCTION_RSB, &Assembler::_rsb},
-            {Tokenizer::INSTRUCTION_ADC, &Assembler::_adc},
-            {Tokenizer::INSTRUCTION_SBC, &Assembler::_sbc},
-            {Tokenizer::INSTRUCTION_RSC, &Assembler::_rsc},
-            {Tokenizer::INSTRUCTION_MUL, &Assembler::_mul},
-            {Tokenizer::INSTRUCTION_UMULL, &Assembler::_umull},
-            {Tokenizer::INSTRUCTION_SMULL, &Assembler::_smull},
-            {Tokenizer::INSTRUCTION_VABS, &Assembler::_vabs},
-            {Tokenizer::INSTRUCTION_VNEG, &Assembler::_vneg},
-            {Tokenizer::INSTRUCTION_VSQRT, &Assembler::_vsqrt},
-            {Tokenizer::INSTRUCTION_VADD, &Assembler::_vadd},
-            {Tokenizer::INSTRUCTION_VSUB, &Assembler::_vsub},
-            {Tokenizer::INSTRUCTION_VDIV, &Assembler::_vdiv},
-            {Tokenizer::INSTRUCTION_VMUL, &Assembler::_vmul},
-            {Tokenizer::INSTRUCTION_VCMP, &Assembler::_vcmp},
-            {Tokenizer::INSTRUCTION_VSEL, &Assembler::_vsel},
-            {Tokenizer::INSTRUCTION_VCINT, &Assembler::_vcint},
-            {Tokenizer::INSTRUCTION_VCFLO, &Assembler::_vcflo},
-            {Tokenizer::INSTRUCTION_VMOV, &Assembler::_vmov},
-            {Tokenizer::INSTRUCTION_AND, &Assembler::_and},
-            {Tokenizer::INSTRUCTION_ORR, &Assembler::_orr},
-            {Tokenizer::INSTRUCTION_EOR, &Assembler::_eor},
-            {Tokenizer::INSTRUCTION_BIC, &Assembler::_bic},
-            {Tokenizer::INSTRUCTION_LSL, &Assembler::_lsl},
-            {Tokenizer::INSTRUCTION_LSR, &Assembler::_lsr},
-            {Tokenizer::INSTRUCTION_ASR, &Assembler::_asr},
-            {Tokenizer::INSTRUCTION_ROR, &Assembler::_ror},
-            {Tokenizer::INSTRUCTION_CMP, &Assembler::_cmp},
-            {Tokenizer::INSTRUCTION_CMN, &Assembler::_cmn},
-            {Tokenizer::INSTRUCTION_TST, &Assembler::_tst},
-            {Tokenizer::INSTRUCTION_TEQ, &Assembler::_teq},
-            {Tokenizer::INSTRUCTION_MOV, &Assembler::_mov},
-            {Tokenizer::INSTRUCTION_MVN, &Assembler::_mvn},
-            {Tokenizer::INSTRUCTION_LDR, &Assembler::_ldr},
-            {Tokenizer::INSTRUCTION_STR, &Assembler::_str},
-            {Tokenizer::INSTRUCTION_SWP, &Assembler::_swp},
-            {Tokenizer::INSTRUCTION_LDRB, &Assembler::_ldrb},
-            {Tokenizer::INSTRUCTION_STRB, &Assembler::_strb},
-            {Tokenizer::INSTRUCTION_SWPB, &Assembler::_swpb},
-            {Tokenizer::INSTRUCTION_LDRH, &Assembler::_ldrh},
-            {Tokenizer::INSTRUCTION_STRH, &Assembler::_strh},
-            {Tokenizer::INSTRUCTION_SWPH, &Assembler::_swph},
-            {Tokenizer::INSTRUCTION_B, &Assembler::_b},
-            {Tokenizer::INSTRUCTION_BL, &Assembler::_bl},
-            {Tokenizer::INSTRUCTION_BX, &Assembler::_bx},
-            {Tokenizer::INSTRUCTION_BLX, &Assembler::_blx},
-            {Tokenizer::INSTRUCTION_SWI, &Assembler::_swi},
-            {Tokenizer::INSTRUCTION_ADRP, &Assembler::_adrp},
-            {Tokenizer::INSTRUCTION_RET, &Assembler::_ret},
-        };
+        static const InstructionFunction instructions[Tokenizer::NUM_INSTRUCTIONS];     /* Indexed by Tokenizer::instruction_index() */
 };
 
 #endif
\ No newline at end of file
@@ -15,6 +15,16 @@
         - specify whether it is physical or virtual memory addresses
     allow entry point symbol to be defined
 
+    LAYOUT(PAGE_ALIGNED) writes a page aligned executable with a program
+    header table. Relocations are resolved at link time so .text and .data
+    can be mapped straight out of the file. LAYOUT(PACKED) is the default.
+
+    Tags inside SECTIONS apply to every section that follows them
+        @P; @V;         load at physical or virtual addresses
+        @HUGE; @SMALL;  map virtual sections with huge pages, one TLB entry
+                        per 4 MiB instead of one per 4 KiB page. Meant for
+                        large sections, each huge page pins 4 MiB of RAM
+
 */
 
 class Linker
@@ -34,7 +44,7 @@ class Linker
             enum class Type
             {
                 WHITESPACE,
-                ENTRY, SECTIONS,
+                ENTRY, LAYOUT, SECTIONS,
                 TEXT, DATA, BSS,
                 SECTION_COUNTER,
                 LITERAL_NUMBER_BINARY, LITERAL_NUMBER_DECIMAL, LITERAL_NUMBER_HEXADECIMAL,
@@ -54,6 +64,7 @@ class Linker
         std::vector<Token> m_tokens;
 
         std::string entry_symbol = "_start";
+        bool page_aligned = false;
         struct SectionAddress
         {
             enum class Type
@@ -65,15 +76,18 @@ class Linker
             bool set_address = false;
             word address = 0;
             bool physical = false;
+            bool huge = false;
         };
 
         bool physical = false;
+        bool huge = false;
         std::vector<SectionAddress> sections;
 
         void link();
         void tokenize_ld();
         void parse_ld();
         void _entry(size_t& tok_i);
+        void _layout(size_t& tok_i);
         void _sections(size_t& tok_i);
 
         word parse_value(size_t& tok_i);
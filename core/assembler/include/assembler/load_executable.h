@@ -2,9 +2,13 @@
 #ifndef LOAD_EXECUTABLE_H
 #define LOAD_EXECUTABLE_H
 
+#include "assembler/object_file.h"
 #include "emulator32bit/emulator32bit.h"
 #include "util/file.h"
 
+#include <memory>
+#include <vector>
+
 class LoadExecutable
 {
     public:
@@ -15,6 +19,19 @@ class LoadExecutable
         File m_exe_file;
 
         void load();
+
+        /**
+         * @brief           Maps every 4 MiB region covered by a section linked with @HUGE
+         *                  using a single huge page.
+         */
+        void map_huge_pages(const std::vector<ObjectFile::ProgramHeader>& segments);
+
+        /**
+         * @brief           Loads each segment from image, which file offsets index into, and
+         *                  starts the program at entry_point.
+         */
+        void load_segments(const std::vector<ObjectFile::ProgramHeader>& segments,
+                           std::shared_ptr<const byte> image, word entry_point);
 };
 
 
@@ -13,6 +13,18 @@
 // todo #define SHARED_OBJECT_FILE_TYPE 3
 #define EMU_32BIT_MACHINE_ID 1
 
+/*
+    Page aligned executable layout. A program header table follows the BELF
+    header and .text and .data start at PAGE_SIZE aligned file offsets, so
+    a loader can map them straight out of the file. .text is stored little
+    endian, the byte order of words in emulator memory.
+
+        24-31   entry point address
+        32-39   number of program headers
+        40-     program headers
+*/
+#define BELF_FLAG_PAGE_ALIGNED 1
+
 class ObjectFile
 {
     friend class Linker;
@@ -47,9 +59,20 @@ class ObjectFile
             word entry_size;                                        /* size of entry in section, todo this has not use imo, figure out why ELF has it listed */
 
             bool load_at_physical_address = false;
+            bool huge_pages = false;                                /* map with huge pages when loaded */
             word address = 0;
         };
 
+        struct ProgramHeader {
+            SectionHeader::Type type;                                /* TEXT, DATA or BSS */
+            word file_offset;                                        /* page aligned offset of the segment in the file */
+            word file_size;                                            /* bytes of the segment stored in the file */
+            word address;                                            /* address to load the segment at */
+            word mem_size;                                            /* bytes of memory, past file_size is zero filled */
+            bool load_at_physical_address = false;
+            bool huge_pages = false;
+        };
+
         struct RelocationEntry {
             word offset;                                            /* offset from beginning of section to the symbol */
             int symbol;                                                /* index into symbol table */
@@ -58,6 +81,7 @@ class ObjectFile
                 R_EMU32_O_LO12, R_EMU32_ADRP_HI20,                    /* Format O instructions and ADRP */
                 R_EMU32_MOV_LO19, R_EMU32_MOV_HI13,                    /* MOV/MVN instructions */
                 R_EMU32_B_OFFSET22,                                    /* Branch offset, +/- 24 bit value (last 2 bits are 0) */
+                R_EMU32_CB_OFFSET20,                                /* cbz/cbnz offset, +/- 22 bit value (last 2 bits are 0) */
             } type;                                                    /* type of relocation */
             word shift;                                                /* constant to be added to the value of the symbol */
             size_t token;                                            /* token index that the relocation entry is used on. Used to fill local symbols */
@@ -68,12 +92,16 @@ class ObjectFile
         static const int BSS_SECTION_SIZE = 8;
         static const int RELOCATION_ENTRY_SIZE = 28;
         static const int SYMBOL_TABLE_ENTRY_SIZE = 26;
+        static const int PROGRAM_HEADER_SIZE = 37;
 
         hword file_type;
         hword target_machine;
-        hword flags;
+        hword flags = 0;
         hword n_sections;
 
+        word entry_point = 0;                                        /* address of the entry symbol, page aligned layout only */
+        std::vector<ProgramHeader> program_headers;                    /* loadable segments, page aligned layout only */
+
         std::vector<word> text_section;                                /* instructions stored in .text section */
         std::vector<byte> data_section;                                /* data stored in .data section */
         word bss_section = 0;                                        /* size of .bss section */
@@ -94,6 +122,12 @@ class ObjectFile
 
         std::string get_symbol_name(int symbol);
 
+        /**
+         * @brief                     Resolves the absolute relocations of .text against the symbol
+         *                             table and clears them, once every symbol has its final address.
+         */
+        void relocate_text();
+
     private:
         enum class State {
             NO_STATE,
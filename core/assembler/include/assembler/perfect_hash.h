@@ -0,0 +1,160 @@
+#pragma once
+#ifndef PERFECT_HASH_H
+#define PERFECT_HASH_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+template <typename Value>
+struct PerfectHashEntry
+{
+    std::string_view key;
+    Value value;
+};
+
+/**
+ * @brief           Read only string map whose hash function is chosen at compile time so no two
+ *                  keys collide.
+ *
+ * Hash and displace: the keys are split into buckets by one hash, then each bucket, largest first,
+ * is given the seed of a second hash that sends all its keys to slots nobody else took. A lookup
+ * is two hashes, one slot and one key compare, with nothing built at run time. Declaring the map
+ * constexpr fails to compile when no seed is found, or a key is listed twice.
+ *
+ * @tparam          Value: type of the values
+ * @tparam          N: number of keys
+ */
+template <typename Value, size_t N>
+class PerfectHashMap
+{
+    public:
+        constexpr PerfectHashMap(const PerfectHashEntry<Value> (&list)[N])
+        {
+            size_t bucket_of[N] = {};
+            size_t bucket_size[BUCKETS] = {};
+            for (size_t i = 0; i < N; i++)
+            {
+                entries[i] = list[i];
+                bucket_of[i] = hash(list[i].key, 0) & (BUCKETS - 1);
+                bucket_size[bucket_of[i]]++;
+            }
+
+            /* largest buckets first, while most slots are still free */
+            size_t order[BUCKETS] = {};
+            for (size_t i = 0; i < BUCKETS; i++)
+            {
+                size_t j = i;
+                for (; j > 0 && bucket_size[order[j - 1]] < bucket_size[i]; j--)
+                {
+                    order[j] = order[j - 1];
+                }
+                order[j] = i;
+            }
+
+            for (size_t b : order)
+            {
+                size_t members[N] = {};
+                size_t nmembers = 0;
+                for (size_t i = 0; i < N; i++)
+                {
+                    if (bucket_of[i] == b)
+                    {
+                        members[nmembers++] = i;
+                    }
+                }
+
+                if (nmembers > 0)
+                {
+                    place(b, members, nmembers);
+                }
+            }
+        }
+
+        /**
+         * @brief       Value of key, nullptr if key is not in the map
+         */
+        constexpr const Value* find(std::string_view key) const
+        {
+            const uint32_t seed = seeds[hash(key, 0) & (BUCKETS - 1)];
+            const size_t slot = slots[hash(key, seed) & (SLOTS - 1)];
+            if (slot == 0 || entries[slot - 1].key != key)
+            {
+                return nullptr;
+            }
+            return &entries[slot - 1].value;
+        }
+
+    private:
+        static constexpr size_t round_up_pow2(size_t n)
+        {
+            size_t pow2 = 1;
+            while (pow2 < n)
+            {
+                pow2 <<= 1;
+            }
+            return pow2;
+        }
+
+        /* At most half the slots are used, so a bucket's seed is found in a few tries */
+        static constexpr size_t SLOTS = round_up_pow2(2 * N);
+        static constexpr size_t BUCKETS = SLOTS / 8 > 0 ? SLOTS / 8 : 1;
+        static constexpr uint32_t MAX_SEED = 1 << 16;
+
+        PerfectHashEntry<Value> entries[N] = {};
+        uint32_t seeds[BUCKETS] = {};
+        size_t slots[SLOTS] = {};                   /* Index of the entry in the slot plus one, 0 if free */
+
+        /* FNV-1a, seeded through the offset basis and finished with murmur3's mixer so the low bits
+           used for the slot depend on every bit of the seed */
+        static constexpr uint32_t hash(std::string_view key, uint32_t seed)
+        {
+            uint32_t h = 2166136261u ^ (seed * 0x9E3779B9u);
+            for (char c : key)
+            {
+                h ^= (unsigned char) c;
+                h *= 16777619u;
+            }
+            h ^= h >> 16;
+            h *= 0x85EBCA6Bu;
+            h ^= h >> 13;
+            h *= 0xC2B2AE35u;
+            h ^= h >> 16;
+            return h;
+        }
+
+        constexpr void place(size_t bucket, const size_t (&members)[N], size_t nmembers)
+        {
+            for (uint32_t seed = 1; seed < MAX_SEED; seed++)
+            {
+                size_t chosen[N] = {};
+                bool fits = true;
+                for (size_t m = 0; m < nmembers && fits; m++)
+                {
+                    chosen[m] = hash(entries[members[m]].key, seed) & (SLOTS - 1);
+                    fits = slots[chosen[m]] == 0;
+                    for (size_t other = 0; other < m && fits; other++)
+                    {
+                        if (entries[members[m]].key == entries[members[other]].key)
+                        {
+                            throw "PerfectHashMap - duplicate key";
+                        }
+                        fits = chosen[other] != chosen[m];
+                    }
+                }
+
+                if (fits)
+                {
+                    seeds[bucket] = seed;
+                    for (size_t m = 0; m < nmembers; m++)
+                    {
+                        slots[chosen[m]] = members[m] + 1;
+                    }
+                    return;
+                }
+            }
+            throw "PerfectHashMap - no seed places the bucket";
+        }
+};
+
+#endif /* PERFECT_HASH_H */
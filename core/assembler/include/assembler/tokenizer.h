@@ -2,6 +2,7 @@
 #ifndef TOKENIZER_H
 #define TOKENIZER_H
 
+#include "emulator32bit/isa.h"
 #include "util/file.h"
 
 #include <vector>
@@ -10,7 +11,15 @@
 #include <set>
 
 
-// TODO create a macro that will generate the token spec
+/**
+ * @brief           Every instruction the assembler parses, in the order of EMU32_ISA, as
+ *                  X(NAME, handler, mnemonic).
+ *
+ * Generates the INSTRUCTION_NAME token types, their names, their keywords and
+ * @ref Tokenizer::INSTRUCTIONS, and Assembler's table of Assembler::_handler parsers.
+ */
+#define ASSEMBLER_INSTRUCTIONS(X) EMU32_ISA(EMU32_ISA_SKIP, X, EMU32_ISA_SKIP)
+
 class Tokenizer
 {
     public:
@@ -78,28 +87,10 @@ class Tokenizer
             REGISTER_X28, REGISTER_X29,
             REGISTER_SP, REGISTER_XZR,
 
-            // instructions
-            INSTRUCTION_HLT,
-            INSTRUCTION_ADD, INSTRUCTION_SUB, INSTRUCTION_RSB,
-            INSTRUCTION_ADC, INSTRUCTION_SBC, INSTRUCTION_RSC,
-            INSTRUCTION_MUL, INSTRUCTION_UMULL, INSTRUCTION_SMULL,
-            INSTRUCTION_VABS, INSTRUCTION_VNEG, INSTRUCTION_VSQRT,
-            INSTRUCTION_VADD, INSTRUCTION_VSUB, INSTRUCTION_VDIV,
-            INSTRUCTION_VMUL, INSTRUCTION_VCMP, INSTRUCTION_VSEL,
-            INSTRUCTION_VCINT, INSTRUCTION_VCFLO,
-            INSTRUCTION_VMOV,
-            INSTRUCTION_AND, INSTRUCTION_ORR, INSTRUCTION_EOR, INSTRUCTION_BIC,
-            INSTRUCTION_LSL, INSTRUCTION_LSR, INSTRUCTION_ASR, INSTRUCTION_ROR,
-            INSTRUCTION_CMP, INSTRUCTION_CMN, INSTRUCTION_TST, INSTRUCTION_TEQ,
-            INSTRUCTION_MOV, INSTRUCTION_MVN,
-            INSTRUCTION_LDR, INSTRUCTION_STR, INSTRUCTION_SWP,
-            INSTRUCTION_LDRB, INSTRUCTION_STRB, INSTRUCTION_SWPB,
-            INSTRUCTION_LDRH, INSTRUCTION_STRH, INSTRUCTION_SWPH,
-            INSTRUCTION_B, INSTRUCTION_BL, INSTRUCTION_BX, INSTRUCTION_BLX, INSTRUCTION_SWI,
-            INSTRUCTION_ADRP,
-
-            // PSEUDO INSTRUCTION
-            INSTRUCTION_RET,
+            // instructions, contiguous and in the order of ASSEMBLER_INSTRUCTIONS
+            #define _INSTRUCTION_TYPE(name, handler, mnemonic) INSTRUCTION_##name,
+            ASSEMBLER_INSTRUCTIONS(_INSTRUCTION_TYPE)
+            #undef _INSTRUCTION_TYPE
 
             // conditions for branch instructions
             CONDITION_EQ, CONDITION_NE,
@@ -130,6 +121,17 @@ class Tokenizer
             OPERATOR_LOGICAL_OR, OPERATOR_LOGICAL_AND,
         };
 
+        #define _INSTRUCTION_COUNT(name, handler, mnemonic) + 1
+        static constexpr int NUM_INSTRUCTIONS = 0 ASSEMBLER_INSTRUCTIONS(_INSTRUCTION_COUNT);
+        #undef _INSTRUCTION_COUNT
+
+        /* Position of an instruction token in ASSEMBLER_INSTRUCTIONS, -1 for other tokens */
+        static constexpr int instruction_index(Type type)
+        {
+            return type >= INSTRUCTION_HLT && type < INSTRUCTION_HLT + NUM_INSTRUCTIONS ?
+                    type - INSTRUCTION_HLT : -1;
+        }
+
         static const std::unordered_map<Type, std::string> TYPE_TO_NAME_MAP;
 
         static const std::set<Type> WHITESPACES;
@@ -6,6 +6,13 @@
 #include <fstream>
 #include <regex>
 
+#define _INSTRUCTION_HANDLER(name, handler, mnemonic) &Assembler::_##handler,
+const Assembler::InstructionFunction Assembler::instructions[Tokenizer::NUM_INSTRUCTIONS] =
+{
+    ASSEMBLER_INSTRUCTIONS(_INSTRUCTION_HANDLER)
+};
+#undef _INSTRUCTION_HANDLER
+
 Assembler::Assembler(Process *process, File processed_file, const std::string& output_path) : m_process(process), m_inputFile(processed_file)
 {
     if (output_path.empty()) {
@@ -139,13 +146,13 @@ File Assembler::assemble()
                 m_obj.add_symbol(symbol, m_obj.bss_section, ObjectFile::SymbolTableEntry::BindingInfo::LOCAL, 2);
             }
             i++;
-        } else if (instructions.find(token.type) != instructions.end()) {
+        } else if (Tokenizer::instruction_index(token.type) >= 0) {
             if (current_section != Section::TEXT) {
                 ERROR("Assembler::assemble() - Code must be located in .text section.");
                 m_state = State::ASSEMBLER_ERROR;
                 break;
             }
-            (this->*instructions[token.type])(i);
+            (this->*instructions[Tokenizer::instruction_index(token.type)])(i);
         } else if (directives.find(token.type) != directives.end()) {
             (this->*directives[token.type])(i);
         } else {
@@ -241,6 +248,13 @@ void Assembler::fill_local()
                 m_obj.text_section[rel.offset/4] = mask_0(m_obj.text_section[rel.offset/4], 0, 22) +
                         bitfield_u32(bitfield_s32(symbol_entry.symbol_value, 2, 22) - rel.offset/4, 0, 22);
                 break;
+            case ObjectFile::RelocationEntry::Type::R_EMU32_CB_OFFSET20:
+                EXPECT_TRUE_SS((symbol_entry.symbol_value & 0b11) == 0, std::stringstream()
+                        << "Assembler::fill_local() - Expected relocation value for R_EMU32_CB_OFFSET20 to be 4 byte aligned. Got "
+                        << symbol_entry.symbol_value);
+                m_obj.text_section[rel.offset/4] = mask_0(m_obj.text_section[rel.offset/4], 0, 20) +
+                        bitfield_u32(bitfield_s32(symbol_entry.symbol_value, 2, 20) - rel.offset/4, 0, 20);
+                break;
             case ObjectFile::RelocationEntry::Type::UNDEFINED:
             default:
                 ERROR("Assembler::fill_local() - Unknown relocation entry type.");
@@ -91,6 +91,8 @@ Process::Process(const std::string& assembler_args)
         {"-D", &Process::_preprocessor_flag},                            /* Passes preprocessor flags into the program */
 
         {"-kp", &Process::_keep_processed_files},                        /* Don't delete intermediate files */
+
+        {"-ld", &Process::_ld},                                            /* Links with the given linker script */
     };
 
     // split command args by whitespace unless surrounded by quotes
@@ -631,6 +633,7 @@ void Process::_ld(std::vector<std::string>& args, size_t& index)
     EXPECT_TRUE_SS(File::valid_path(fpath), std::stringstream()
             << "Process::_ld() - Invalid linker script file path: " << fpath << ".");
     m_ld_file = File(fpath);
+    m_has_ld_file = true;
 }
 
 
@@ -2,6 +2,7 @@
 
 #include <util/logger.h>
 
+#include <cstring>
 #include <string>
 
 #define UNUSED(x) (void)(x)
@@ -141,6 +142,184 @@ word Assembler::parse_format_b2(size_t& tok_i, byte opcode)
     return Emulator32bit::asm_format_b2(opcode, condition, reg);
 }
 
+word Assembler::parse_format_b3(size_t& tok_i, byte opcode)
+{
+    bool nonzero = consume(tok_i).value == "cbnz";
+    skip_tokens(tok_i, "[ \t]");
+
+    byte reg = parse_register(tok_i);
+    skip_tokens(tok_i, "[ \t]");
+    expect_token(tok_i, (std::set<Tokenizer::Type>) {Tokenizer::COMMA},
+            "Assembler::parse_format_b3() - Expected branch target.");
+    consume(tok_i);
+
+    sword value = 0;
+    skip_tokens(tok_i, "[ \t]");
+    if (is_token(tok_i, {Tokenizer::SYMBOL})) {
+        std::string symbol = consume(tok_i).value;
+        m_obj.add_symbol(symbol, 0, ObjectFile::SymbolTableEntry::BindingInfo::WEAK, -1);
+
+        m_obj.rel_text.push_back((ObjectFile::RelocationEntry) {
+            .offset = (word) (m_obj.text_section.size() * 4),
+            .symbol = m_obj.string_table[symbol],
+            .type = ObjectFile::RelocationEntry::Type::R_EMU32_CB_OFFSET20,
+            .shift = 0,
+            .token = tok_i
+        });
+    } else {
+        word imm = parse_expression(tok_i);
+        EXPECT_TRUE(imm < (1 << 22), "Assembler::parse_format_b3() - Expected immediate to be 22 bits. "
+                "Error at %s in line %llu.", disassemble_instr(((word) opcode) << 26).c_str(), line_at(tok_i));
+        EXPECT_TRUE((imm & 0b11) == 0, "Assembler::parse_format_b3() - Expected immediate to be 4 byte aligned. "
+                "Error at %s in line %llu.", disassemble_instr(((word) opcode) << 26).c_str(), line_at(tok_i));
+        value = bitfield_s32(imm, 0, 22) >> 2;
+    }
+
+    return Emulator32bit::asm_format_b3(opcode, nonzero, reg, value);
+}
+
+word Assembler::parse_format_m4(size_t& tok_i, byte opcode)
+{
+    std::string op = consume(tok_i).value;
+
+    /* ldm/stm and the ia suffix increment after, the db suffix decrements before */
+    bool load = op.front() == 'l';
+    bool decrement = op.size() > 3 && op.substr(3) == "db";
+    skip_tokens(tok_i, "[ \t]");
+
+    byte reg_a = parse_register(tok_i);
+    bool writeback = false;
+    if (is_token(tok_i, {Tokenizer::OPERATOR_LOGICAL_NOT})) {
+        consume(tok_i);
+        writeback = true;
+    }
+    skip_tokens(tok_i, "[ \t]");
+
+    expect_token(tok_i, (std::set<Tokenizer::Type>) {Tokenizer::COMMA},
+            "Assembler::parse_format_m4() - Expected register list.");
+    consume(tok_i);
+    skip_tokens(tok_i, "[ \t]");
+
+    expect_token(tok_i, {Tokenizer::OPEN_BRACE}, "Assembler::parse_format_m4() - Expected open brace.");
+    consume(tok_i);
+    skip_tokens(tok_i, "[ \t]");
+
+    /* registers and ranges of registers, ex: {x19-x28, x29} */
+    word reglist = 0;
+    while (!is_token(tok_i, {Tokenizer::CLOSE_BRACE})) {
+        byte reg_lo = parse_register(tok_i);
+        byte reg_hi = reg_lo;
+        skip_tokens(tok_i, "[ \t]");
+
+        if (is_token(tok_i, {Tokenizer::OPERATOR_SUBTRACTION})) {
+            consume(tok_i);
+            skip_tokens(tok_i, "[ \t]");
+            reg_hi = parse_register(tok_i);
+            skip_tokens(tok_i, "[ \t]");
+        }
+
+        EXPECT_TRUE(reg_lo <= reg_hi, "Assembler::parse_format_m4() - Register range must be ascending. "
+                "Error in line %llu.", line_at(tok_i));
+        for (byte reg = reg_lo; reg <= reg_hi; reg++) {
+            reglist |= 1U << reg;
+        }
+
+        if (!is_token(tok_i, {Tokenizer::COMMA})) {
+            break;
+        }
+        consume(tok_i);
+        skip_tokens(tok_i, "[ \t]");
+    }
+
+    expect_token(tok_i, {Tokenizer::CLOSE_BRACE}, "Assembler::parse_format_m4() - Expected close brace.");
+    consume(tok_i);
+
+    EXPECT_TRUE((reglist & 0xFFFF) == 0 || (reglist >> 16) == 0, "Assembler::parse_format_m4() - Register "
+            "list must lie within x0-x15 or x16-xzr. Error in line %llu.", line_at(tok_i));
+
+    return Emulator32bit::asm_format_m4(opcode, load, reg_a, writeback, decrement, reglist);
+}
+
+word Assembler::parse_format_m3(size_t& tok_i, byte opcode)
+{
+    bool load = consume(tok_i).value.front() == 'l';
+    skip_tokens(tok_i, "[ \t]");
+
+    byte reg_t1 = parse_register(tok_i);
+    skip_tokens(tok_i, "[ \t]");
+
+    expect_token(tok_i, (std::set<Tokenizer::Type>) {Tokenizer::COMMA},
+            "Assembler::parse_format_m3() - Expected second argument.");
+    consume(tok_i);
+    skip_tokens(tok_i, "[ \t]");
+
+    byte reg_t2 = parse_register(tok_i);
+    skip_tokens(tok_i, "[ \t]");
+
+    expect_token(tok_i, (std::set<Tokenizer::Type>) {Tokenizer::COMMA},
+            "Assembler::parse_format_m3() - Expected third argument.");
+    consume(tok_i);
+    skip_tokens(tok_i, "[ \t]");
+
+    expect_token(tok_i, {Tokenizer::OPEN_BRACKET}, "Assembler::parse_format_m3() - Expected open bracket");
+    consume(tok_i);
+    skip_tokens(tok_i, "[ \t]");
+
+    byte reg_a = parse_register(tok_i);
+    skip_tokens(tok_i, "[ \t]");
+
+    /* offsets are word aligned and may be negative, ex: stp x28, x29, [sp, #-8]! */
+    auto parse_offset = [this](size_t& tok_i) -> sword {
+        expect_token(tok_i, {Tokenizer::NUMBER_SIGN}, "Assembler::parse_format_m3() - Expected offset.");
+        consume(tok_i);
+        skip_tokens(tok_i, "[ \t]");
+
+        bool negative = is_token(tok_i, {Tokenizer::OPERATOR_SUBTRACTION});
+        if (negative) {
+            consume(tok_i);
+        }
+        sword offset = parse_expression(tok_i);
+        return negative ? -offset : offset;
+    };
+
+    Emulator32bit::AddrType addressing_mode = Emulator32bit::ADDR_OFFSET;
+    sword offset = 0;
+    if (is_token(tok_i, {Tokenizer::CLOSE_BRACKET})) {
+        consume(tok_i);
+        skip_tokens(tok_i, "[ \t]");
+
+        /* post indexed, offset is applied to value at register after accessing */
+        if (is_token(tok_i, {Tokenizer::COMMA})) {
+            consume(tok_i);
+            skip_tokens(tok_i, "[ \t]");
+            offset = parse_offset(tok_i);
+            addressing_mode = Emulator32bit::ADDR_POST_INC;
+        }
+    } else {
+        expect_token(tok_i, (std::set<Tokenizer::Type>) {Tokenizer::COMMA},
+                "Assembler::parse_format_m3() - Expected offset or close bracket.");
+        consume(tok_i);
+        skip_tokens(tok_i, "[ \t]");
+        offset = parse_offset(tok_i);
+        skip_tokens(tok_i, "[ \t]");
+
+        expect_token(tok_i, (std::set<Tokenizer::Type>) {Tokenizer::CLOSE_BRACKET},
+                "Assembler::parse_format_m3() - Expected close bracket.");
+        consume(tok_i);
+
+        /* preindexed, offset is applied to value at register before accessing */
+        if (is_token(tok_i, {Tokenizer::OPERATOR_LOGICAL_NOT})) {
+            consume(tok_i);
+            addressing_mode = Emulator32bit::ADDR_PRE_INC;
+        }
+    }
+
+    EXPECT_TRUE(offset % 4 == 0 && offset >= -256 && offset < 256, "Assembler::parse_format_m3() - Offset "
+            "must be a multiple of 4 within [-256, 252]. Got: %d. Error in line %llu.", offset, line_at(tok_i));
+
+    return Emulator32bit::asm_format_m3(opcode, load, reg_t1, reg_t2, reg_a, offset, addressing_mode);
+}
+
 word Assembler::parse_format_m2(size_t& tok_i, byte opcode)
 {
     consume(tok_i);
@@ -179,6 +358,35 @@ word Assembler::parse_format_m2(size_t& tok_i, byte opcode)
     return Emulator32bit::asm_format_m2(opcode, reg, 0);
 }
 
+word Assembler::parse_format_m5(size_t& tok_i, byte opcode)
+{
+    /* cpy xd, xs, xn and set xd, xn, xs, the length always comes after the destination for set */
+    bool set = consume(tok_i).value == "set";
+    skip_tokens(tok_i, "[ \t]");
+
+    byte reg_d = parse_register(tok_i);
+    skip_tokens(tok_i, "[ \t]");
+
+    expect_token(tok_i, (std::set<Tokenizer::Type>) {Tokenizer::COMMA},
+            "Assembler::parse_format_m5() - Expected second argument.");
+    consume(tok_i);
+    skip_tokens(tok_i, "[ \t]");
+    byte reg_b = parse_register(tok_i);
+    skip_tokens(tok_i, "[ \t]");
+
+    expect_token(tok_i, (std::set<Tokenizer::Type>) {Tokenizer::COMMA},
+            "Assembler::parse_format_m5() - Expected third argument.");
+    consume(tok_i);
+    skip_tokens(tok_i, "[ \t]");
+    byte reg_c = parse_register(tok_i);
+
+    byte reg_s = set ? reg_c : reg_b;
+    byte reg_n = set ? reg_b : reg_c;
+    EXPECT_TRUE(reg_d != reg_n && (set || (reg_s != reg_d && reg_s != reg_n)),
+            "Assembler::parse_format_m5() - Registers must be distinct. Error in line %llu.", line_at(tok_i));
+    return Emulator32bit::asm_format_m5(opcode, set, reg_d, reg_s, reg_n);
+}
+
 word Assembler::parse_format_m1(size_t& tok_i, byte opcode)
 {
     consume(tok_i);
@@ -380,6 +588,164 @@ word Assembler::parse_format_o3(size_t& tok_i, byte opcode)
     return 0;
 }
 
+/*
+ * csel xd, xn, xm, cond and csinc xd, xn, xm, cond, with the aliases cset xd, cond for
+ * csinc xd, xzr, xzr, !cond and cinc xd, xn, cond for csinc xd, xn, xn, !cond
+ */
+word Assembler::parse_format_o4(size_t& tok_i, byte opcode)
+{
+    std::string op = consume(tok_i).value;
+    skip_tokens(tok_i, "[ \t]");
+
+    std::vector<byte> regs = {parse_register(tok_i)};
+    size_t n_regs = op == "cset" ? 1 : op == "cinc" ? 2 : 3;
+    while (regs.size() < n_regs) {
+        skip_tokens(tok_i, "[ \t]");
+        expect_token(tok_i, (std::set<Tokenizer::Type>) {Tokenizer::COMMA},
+                "Assembler::parse_format_o4() - Expected another register.");
+        consume(tok_i);
+        skip_tokens(tok_i, "[ \t]");
+        regs.push_back(parse_register(tok_i));
+    }
+
+    skip_tokens(tok_i, "[ \t]");
+    expect_token(tok_i, (std::set<Tokenizer::Type>) {Tokenizer::COMMA},
+            "Assembler::parse_format_o4() - Expected condition code.");
+    consume(tok_i);
+    skip_tokens(tok_i, "[ \t]");
+    expect_token(tok_i, Tokenizer::CONDITIONS, "Assembler::parse_format_o4() - Expected condition code.");
+    Emulator32bit::ConditionCode condition = get_cond_code(consume(tok_i).type);
+
+    if (n_regs == 3) {
+        return Emulator32bit::asm_format_o4(opcode, op == "csinc", condition, regs[0], regs[1], regs[2]);
+    }
+
+    /* conditions come in pairs that differ in the lowest bit */
+    Emulator32bit::ConditionCode inverse = (Emulator32bit::ConditionCode) ((int) condition ^ 1);
+    byte reg_n = n_regs == 1 ? XZR : regs[1];
+    return Emulator32bit::asm_format_o4(opcode, true, inverse, regs[0], reg_n, reg_n);
+}
+
+/* Data type suffix of a floating point mnemonic, ex: the '.f32' of 'vadd.f32' */
+static bool parse_type_suffix(std::vector<Tokenizer::Token>& tokens, size_t& tok_i, const std::string& type)
+{
+    if (tok_i + 1 >= tokens.size() || tokens[tok_i].type != Tokenizer::PERIOD
+            || tokens[tok_i + 1].value != type) {
+        return false;
+    }
+    tok_i += 2;
+    return true;
+}
+
+word Assembler::parse_format_f(size_t& tok_i, byte opcode)
+{
+    consume(tok_i);
+
+    /* conversions name the integer type first, ex: vcint.s32.f32 */
+    bool sign = false;
+    if (opcode == Emulator32bit::_op_vcint || opcode == Emulator32bit::_op_vcflo) {
+        sign = parse_type_suffix(m_tokens, tok_i, "s32");
+        EXPECT_TRUE(sign || parse_type_suffix(m_tokens, tok_i, "u32"),
+                "Assembler::parse_format_f() - Expected integer type .u32 or .s32. Error at line %llu.", line_at(tok_i));
+    }
+    EXPECT_TRUE(parse_type_suffix(m_tokens, tok_i, "f32"),
+            "Assembler::parse_format_f() - Expected type .f32. Error at line %llu.", line_at(tok_i));
+    skip_tokens(tok_i, "[ \t]");
+
+    byte reg_d = parse_register(tok_i);
+    skip_tokens(tok_i, "[ \t]");
+
+    expect_token(tok_i, {Tokenizer::COMMA}, "Assembler::parse_format_f() - Expected comma.");
+    consume(tok_i);
+    skip_tokens(tok_i, "[ \t]");
+
+    byte reg_n = parse_register(tok_i);
+    return Emulator32bit::asm_format_f(opcode, sign, reg_d, reg_n);
+}
+
+word Assembler::parse_format_f1(size_t& tok_i, byte opcode)
+{
+    consume(tok_i);
+
+    Emulator32bit::ConditionCode condition = Emulator32bit::ConditionCode::AL;
+    if (opcode == Emulator32bit::_op_vsel) {
+        expect_token(tok_i, {Tokenizer::PERIOD}, "Assembler::parse_format_f1() - Expected condition code.");
+        consume(tok_i);
+        expect_token(tok_i, Tokenizer::CONDITIONS, "Assembler::parse_format_f1() - Expected condition code to follow period.");
+        condition = get_cond_code(consume(tok_i).type);
+    }
+    EXPECT_TRUE(parse_type_suffix(m_tokens, tok_i, "f32"),
+            "Assembler::parse_format_f1() - Expected type .f32. Error at line %llu.", line_at(tok_i));
+    skip_tokens(tok_i, "[ \t]");
+
+    /* vcmp has no destination, ex: vcmp.f32 xn, {xm|#0} */
+    byte reg_d = 0;
+    if (opcode != Emulator32bit::_op_vcmp) {
+        reg_d = parse_register(tok_i);
+        skip_tokens(tok_i, "[ \t]");
+
+        expect_token(tok_i, {Tokenizer::COMMA}, "Assembler::parse_format_f1() - Expected comma.");
+        consume(tok_i);
+        skip_tokens(tok_i, "[ \t]");
+    }
+
+    byte reg_n = parse_register(tok_i);
+    skip_tokens(tok_i, "[ \t]");
+
+    expect_token(tok_i, {Tokenizer::COMMA}, "Assembler::parse_format_f1() - Expected comma.");
+    consume(tok_i);
+    skip_tokens(tok_i, "[ \t]");
+
+    if (opcode == Emulator32bit::_op_vcmp && is_token(tok_i, {Tokenizer::NUMBER_SIGN})) {
+        consume(tok_i);
+        EXPECT_TRUE(parse_expression(tok_i) == 0, "Assembler::parse_format_f1() - vcmp can only compare "
+                "against #0. Error at line %llu.", line_at(tok_i));
+        return Emulator32bit::asm_format_f1(opcode, condition, reg_d, reg_n, true, 0);
+    }
+
+    byte reg_m = parse_register(tok_i);
+    return Emulator32bit::asm_format_f1(opcode, condition, reg_d, reg_n, false, reg_m);
+}
+
+word Assembler::parse_format_f2(size_t& tok_i, byte opcode)
+{
+    consume(tok_i);
+    EXPECT_TRUE(parse_type_suffix(m_tokens, tok_i, "f32"),
+            "Assembler::parse_format_f2() - Expected type .f32. Error at line %llu.", line_at(tok_i));
+    skip_tokens(tok_i, "[ \t]");
+
+    byte reg_d = parse_register(tok_i);
+    skip_tokens(tok_i, "[ \t]");
+
+    expect_token(tok_i, {Tokenizer::COMMA}, "Assembler::parse_format_f2() - Expected comma.");
+    consume(tok_i);
+    skip_tokens(tok_i, "[ \t]");
+
+    if (is_token(tok_i, Tokenizer::REGISTERS)) {
+        return Emulator32bit::asm_format_f2(opcode, Emulator32bit::VMOV_REGISTER, reg_d, parse_register(tok_i));
+    }
+
+    expect_token(tok_i, {Tokenizer::NUMBER_SIGN}, "Assembler::parse_format_f2() - Expected register or immediate.");
+    consume(tok_i);
+    skip_tokens(tok_i, "[ \t]");
+
+    bool negative = is_token(tok_i, {Tokenizer::OPERATOR_SUBTRACTION});
+    if (negative) {
+        consume(tok_i);
+    }
+    expect_token(tok_i, {Tokenizer::LITERAL_FLOAT_32, Tokenizer::LITERAL_NUMBER_DECIMAL},
+            "Assembler::parse_format_f2() - Expected floating point immediate.");
+    float value = std::stof(consume(tok_i).value);
+    value = negative ? -value : value;
+
+    /* only the top 20 bits of the binary32 value are encoded */
+    word bits;
+    memcpy(&bits, &value, sizeof(bits));
+    EXPECT_TRUE((bits & 0xFFF) == 0, "Assembler::parse_format_f2() - Floating point immediate %f does not fit "
+            "in 11 significand bits. Error at line %llu.", value, line_at(tok_i));
+    return Emulator32bit::asm_format_f2(opcode, reg_d, bits >> 12);
+}
+
 word Assembler::parse_format_o2(size_t& tok_i, byte opcode)
 {
     bool s = consume(tok_i).value.back() == 's';
@@ -604,86 +970,125 @@ void Assembler::_smull(size_t& tok_i)
 
 void Assembler::_vabs(size_t& tok_i)
 {
-    UNUSED(tok_i);
-
-    EXPECT_TRUE(false, "Assembler::_vabs() - Instruction not implemented yet.");
+    word instruction = parse_format_f(tok_i, Emulator32bit::_op_vabs);
+    m_obj.text_section.push_back(instruction);
 }
 
 void Assembler::_vneg(size_t& tok_i)
 {
-    UNUSED(tok_i);
-
-    EXPECT_TRUE(false, "Assembler::_vneg() - Instruction not implemented yet.");
+    word instruction = parse_format_f(tok_i, Emulator32bit::_op_vneg);
+    m_obj.text_section.push_back(instruction);
 }
 
 void Assembler::_vsqrt(size_t& tok_i)
 {
-    UNUSED(tok_i);
-
-    EXPECT_TRUE(false, "Assembler::_vsqrt() - Instruction not implemented yet.");
+    word instruction = parse_format_f(tok_i, Emulator32bit::_op_vsqrt);
+    m_obj.text_section.push_back(instruction);
 }
 
 void Assembler::_vadd(size_t& tok_i)
 {
-    UNUSED(tok_i);
-
-    EXPECT_TRUE(false, "Assembler::_vadd() - Instruction not implemented yet.");
+    word instruction = parse_format_f1(tok_i, Emulator32bit::_op_vadd);
+    m_obj.text_section.push_back(instruction);
 }
 
 void Assembler::_vsub(size_t& tok_i)
 {
-    UNUSED(tok_i);
-
-    EXPECT_TRUE(false, "Assembler::_vsub() - Instruction not implemented yet.");
+    word instruction = parse_format_f1(tok_i, Emulator32bit::_op_vsub);
+    m_obj.text_section.push_back(instruction);
 }
 
 void Assembler::_vdiv(size_t& tok_i)
 {
-    UNUSED(tok_i);
-
-    EXPECT_TRUE(false, "Assembler::_vdiv() - Instruction not implemented yet.");
+    word instruction = parse_format_f1(tok_i, Emulator32bit::_op_vdiv);
+    m_obj.text_section.push_back(instruction);
 }
 
 void Assembler::_vmul(size_t& tok_i)
 {
-    UNUSED(tok_i);
-
-    EXPECT_TRUE(false, "Assembler::_vmul() - Instruction not implemented yet.");
+    word instruction = parse_format_f1(tok_i, Emulator32bit::_op_vmul);
+    m_obj.text_section.push_back(instruction);
 }
 
 void Assembler::_vcmp(size_t& tok_i)
 {
-    UNUSED(tok_i);
-
-    EXPECT_TRUE(false, "Assembler::_vcmp() - Instruction not implemented yet.");
+    word instruction = parse_format_f1(tok_i, Emulator32bit::_op_vcmp);
+    m_obj.text_section.push_back(instruction);
 }
 
 void Assembler::_vsel(size_t& tok_i)
 {
-    UNUSED(tok_i);
-
-    EXPECT_TRUE(false, "Assembler::_vsel() - Instruction not implemented yet.");
+    word instruction = parse_format_f1(tok_i, Emulator32bit::_op_vsel);
+    m_obj.text_section.push_back(instruction);
 }
 
 void Assembler::_vcint(size_t& tok_i)
 {
-    UNUSED(tok_i);
-
-    EXPECT_TRUE(false, "Assembler::_vcint() - Instruction not implemented yet.");
+    word instruction = parse_format_f(tok_i, Emulator32bit::_op_vcint);
+    m_obj.text_section.push_back(instruction);
 }
 
 void Assembler::_vcflo(size_t& tok_i)
 {
-    UNUSED(tok_i);
-
-    EXPECT_TRUE(false, "Assembler::_vcflo() - Instruction not implemented yet.");
+    word instruction = parse_format_f(tok_i, Emulator32bit::_op_vcflo);
+    m_obj.text_section.push_back(instruction);
 }
 
 void Assembler::_vmov(size_t& tok_i)
 {
-    UNUSED(tok_i);
+    word instruction = parse_format_f2(tok_i, Emulator32bit::_op_vmov);
+    m_obj.text_section.push_back(instruction);
+}
 
-    EXPECT_TRUE(false, "Assembler::_vmov() - Instruction not implemented yet.");
+/* Floating point system register operand of vmrs and vmsr */
+static bool parse_fp_sysreg(std::vector<Tokenizer::Token>& tokens, size_t tok_i, bool& fpsr)
+{
+    if (tok_i >= tokens.size() || (tokens[tok_i].value != "fpcr" && tokens[tok_i].value != "fpsr")) {
+        return false;
+    }
+    fpsr = tokens[tok_i].value == "fpsr";
+    return true;
+}
+
+void Assembler::_vmrs(size_t& tok_i)
+{
+    consume(tok_i);
+    skip_tokens(tok_i, "[ \t]");
+
+    byte reg_d = parse_register(tok_i);
+    skip_tokens(tok_i, "[ \t]");
+
+    expect_token(tok_i, {Tokenizer::COMMA}, "Assembler::_vmrs() - Expected comma.");
+    consume(tok_i);
+    skip_tokens(tok_i, "[ \t]");
+
+    bool fpsr = false;
+    EXPECT_TRUE(parse_fp_sysreg(m_tokens, tok_i, fpsr), "Assembler::_vmrs() - Expected fpcr or fpsr. "
+            "Error at line %llu.", line_at(tok_i));
+    consume(tok_i);
+
+    m_obj.text_section.push_back(Emulator32bit::asm_format_f2(Emulator32bit::_op_vmov,
+            fpsr ? Emulator32bit::VMRS_FPSR : Emulator32bit::VMRS_FPCR, reg_d, 0));
+}
+
+void Assembler::_vmsr(size_t& tok_i)
+{
+    consume(tok_i);
+    skip_tokens(tok_i, "[ \t]");
+
+    bool fpsr = false;
+    EXPECT_TRUE(parse_fp_sysreg(m_tokens, tok_i, fpsr), "Assembler::_vmsr() - Expected fpcr or fpsr. "
+            "Error at line %llu.", line_at(tok_i));
+    consume(tok_i);
+    skip_tokens(tok_i, "[ \t]");
+
+    expect_token(tok_i, {Tokenizer::COMMA}, "Assembler::_vmsr() - Expected comma.");
+    consume(tok_i);
+    skip_tokens(tok_i, "[ \t]");
+
+    byte reg_n = parse_register(tok_i);
+    m_obj.text_section.push_back(Emulator32bit::asm_format_f2(Emulator32bit::_op_vmov,
+            fpsr ? Emulator32bit::VMSR_FPSR : Emulator32bit::VMSR_FPCR, 0, reg_n));
 }
 
 void Assembler::_and(size_t& tok_i)
@@ -892,6 +1297,148 @@ void Assembler::_adrp(size_t& tok_i)
     m_obj.text_section.push_back(instruction);
 }
 
+void Assembler::_wfi(size_t& tok_i)
+{
+    consume(tok_i);
+    word instruction = Emulator32bit::asm_wfi();
+    m_obj.text_section.push_back(instruction);
+}
+
+void Assembler::_ldp(size_t& tok_i)
+{
+    word instruction = parse_format_m3(tok_i, Emulator32bit::_op_ldstp);
+    m_obj.text_section.push_back(instruction);
+}
+
+void Assembler::_stp(size_t& tok_i)
+{
+    word instruction = parse_format_m3(tok_i, Emulator32bit::_op_ldstp);
+    m_obj.text_section.push_back(instruction);
+}
+
+void Assembler::_ldm(size_t& tok_i)
+{
+    word instruction = parse_format_m4(tok_i, Emulator32bit::_op_ldstm);
+    m_obj.text_section.push_back(instruction);
+}
+
+void Assembler::_stm(size_t& tok_i)
+{
+    word instruction = parse_format_m4(tok_i, Emulator32bit::_op_ldstm);
+    m_obj.text_section.push_back(instruction);
+}
+
+void Assembler::_packed(size_t& tok_i)
+{
+    std::string op_name = consume(tok_i).value;
+    int op = 0;
+    while (op < Emulator32bit::PACKED_NUM_OPS
+            && op_name != Emulator32bit::packed_op_name((Emulator32bit::PackedOp) op)) {
+        op++;
+    }
+    EXPECT_TRUE(op < Emulator32bit::PACKED_NUM_OPS, "Assembler::_packed() - Unknown packed instruction %s. "
+            "Error in line %llu.", op_name.c_str(), line_at(tok_i));
+    skip_tokens(tok_i, "[ \t]");
+
+    byte reg_d = parse_register(tok_i);
+    skip_tokens(tok_i, "[ \t]");
+
+    expect_token(tok_i, (std::set<Tokenizer::Type>) {Tokenizer::COMMA},
+            "Assembler::_packed() - Expected second argument.");
+    consume(tok_i);
+    skip_tokens(tok_i, "[ \t]");
+    byte reg_n = parse_register(tok_i);
+    skip_tokens(tok_i, "[ \t]");
+
+    expect_token(tok_i, (std::set<Tokenizer::Type>) {Tokenizer::COMMA},
+            "Assembler::_packed() - Expected third argument.");
+    consume(tok_i);
+    skip_tokens(tok_i, "[ \t]");
+    byte reg_m = parse_register(tok_i);
+
+    word instruction = Emulator32bit::asm_format_p(Emulator32bit::_op_packed,
+            (Emulator32bit::PackedOp) op, reg_d, reg_n, reg_m);
+    m_obj.text_section.push_back(instruction);
+}
+
+void Assembler::_cpy(size_t& tok_i)
+{
+    word instruction = parse_format_m5(tok_i, Emulator32bit::_op_mops);
+    m_obj.text_section.push_back(instruction);
+}
+
+void Assembler::_set(size_t& tok_i)
+{
+    word instruction = parse_format_m5(tok_i, Emulator32bit::_op_mops);
+    m_obj.text_section.push_back(instruction);
+}
+
+void Assembler::_cbz(size_t& tok_i)
+{
+    word instruction = parse_format_b3(tok_i, Emulator32bit::_op_cbz);
+    m_obj.text_section.push_back(instruction);
+}
+
+void Assembler::_cbnz(size_t& tok_i)
+{
+    word instruction = parse_format_b3(tok_i, Emulator32bit::_op_cbz);
+    m_obj.text_section.push_back(instruction);
+}
+
+void Assembler::_csel(size_t& tok_i)
+{
+    word instruction = parse_format_o4(tok_i, Emulator32bit::_op_csel);
+    m_obj.text_section.push_back(instruction);
+}
+
+void Assembler::_csinc(size_t& tok_i)
+{
+    word instruction = parse_format_o4(tok_i, Emulator32bit::_op_csel);
+    m_obj.text_section.push_back(instruction);
+}
+
+void Assembler::_cset(size_t& tok_i)
+{
+    word instruction = parse_format_o4(tok_i, Emulator32bit::_op_csel);
+    m_obj.text_section.push_back(instruction);
+}
+
+void Assembler::_cinc(size_t& tok_i)
+{
+    word instruction = parse_format_o4(tok_i, Emulator32bit::_op_csel);
+    m_obj.text_section.push_back(instruction);
+}
+
+void Assembler::_udiv(size_t& tok_i)
+{
+    word instruction = parse_format_o(tok_i, Emulator32bit::_op_udiv);
+    m_obj.text_section.push_back(instruction);
+}
+
+void Assembler::_sdiv(size_t& tok_i)
+{
+    word instruction = parse_format_o(tok_i, Emulator32bit::_op_sdiv);
+    m_obj.text_section.push_back(instruction);
+}
+
+void Assembler::_clz(size_t& tok_i)
+{
+    word instruction = parse_format_o3(tok_i, Emulator32bit::_op_clz);
+    m_obj.text_section.push_back(instruction);
+}
+
+void Assembler::_rbit(size_t& tok_i)
+{
+    word instruction = parse_format_o3(tok_i, Emulator32bit::_op_rbit);
+    m_obj.text_section.push_back(instruction);
+}
+
+void Assembler::_rev(size_t& tok_i)
+{
+    word instruction = parse_format_o3(tok_i, Emulator32bit::_op_rev);
+    m_obj.text_section.push_back(instruction);
+}
+
 void Assembler::_hlt(size_t& tok_i)
 {
     consume(tok_i);
@@ -33,6 +33,30 @@ void Linker::_entry(size_t& tok_i)
     consume(tok_i, {Token::Type::CLOSE_PARENTHESIS}, "Expected close parenthesis after ENTRY command. Got " + m_tokens[tok_i].val);
 }
 
+void Linker::_layout(size_t& tok_i)
+{
+    consume(tok_i);
+    skip_tokens(tok_i, {Token::Type::WHITESPACE});
+    consume(tok_i, {Token::Type::OPEN_PARENTHESIS}, "Expected open parenthesis after LAYOUT command. Got " + m_tokens[tok_i].val);
+    skip_tokens(tok_i, {Token::Type::WHITESPACE});
+    std::string layout = consume(tok_i, {Token::Type::SYMBOL}, "Expected layout to follow LAYOUT command. Got " + m_tokens[tok_i].val).val;
+    if (layout == "PAGE_ALIGNED")
+    {
+        page_aligned = true;
+    }
+    else if (layout == "PACKED")
+    {
+        page_aligned = false;
+    }
+    else
+    {
+        ERROR("Linker::_layout() - Unknown layout %s", layout.c_str());
+    }
+
+    skip_tokens(tok_i, {Token::Type::WHITESPACE});
+    consume(tok_i, {Token::Type::CLOSE_PARENTHESIS}, "Expected close parenthesis after LAYOUT command. Got " + m_tokens[tok_i].val);
+}
+
 void Linker::_sections(size_t& tok_i)
 {
     consume(tok_i);
@@ -55,6 +79,18 @@ void Linker::_sections(size_t& tok_i)
             {
                 physical = false;
             }
+            else if (tag == "HUGE")
+            {
+                huge = true;
+            }
+            else if (tag == "SMALL")
+            {
+                huge = false;
+            }
+            else
+            {
+                ERROR("Unknown section tag @%s in SECTIONS command.", tag.c_str());
+            }
 
             skip_tokens(tok_i, {Token::Type::WHITESPACE});
             consume(tok_i, {Token::Token::Type::SEMI_COLON}, "Expected semicolon to end statement. Got " + m_tokens[tok_i].val);
@@ -69,21 +105,24 @@ void Linker::_sections(size_t& tok_i)
                 consume(tok_i);
                 sections.push_back((SectionAddress) {
                     .type = SectionAddress::Type::TEXT,
-                    .physical = physical
+                    .physical = physical,
+                    .huge = huge
                 });
                 break;
             case Token::Type::DATA:
                 consume(tok_i);
                 sections.push_back((SectionAddress) {
                     .type = SectionAddress::Type::DATA,
-                    .physical = physical
+                    .physical = physical,
+                    .huge = huge
                 });
                 break;
             case Token::Type::BSS:
                 consume(tok_i);
                 sections.push_back((SectionAddress) {
                     .type = SectionAddress::Type::BSS,
-                    .physical = physical
+                    .physical = physical,
+                    .huge = huge
                 });
                 break;
             default:
@@ -119,6 +158,9 @@ void Linker::parse_ld()
             case Token::Type::ENTRY:
                 _entry(i);
                 break;
+            case Token::Type::LAYOUT:
+                _layout(i);
+                break;
             case Token::Type::SECTIONS:
                 _sections(i);
                 break;
@@ -259,6 +301,7 @@ void Linker::link()
         }
 
         section_header->load_at_physical_address = section.physical;
+        section_header->huge_pages = section.huge;
         section_header->address = section.set_address ? section.address : address;
         address = section_header->address + section_size;
     }
@@ -344,6 +387,12 @@ void Linker::link()
                             << symbol_entry.symbol_value);
                     exe_obj_file.text_section[instr_i] = mask_0(obj_file.text_section[rel.offset/4], 0, 22) + bitfield_u32(bitfield_s32(symbol_entry.symbol_value, 2, 22) - instr_i, 0, 22);
                     continue;
+                case ObjectFile::RelocationEntry::Type::R_EMU32_CB_OFFSET20:
+                    EXPECT_TRUE_SS((symbol_entry.symbol_value & 0b11) == 0, std::stringstream()
+                            << "Linker::fill_local() - Expected relocation value for R_EMU32_CB_OFFSET20 to be 4 byte aligned. Got "
+                            << symbol_entry.symbol_value);
+                    exe_obj_file.text_section[instr_i] = mask_0(obj_file.text_section[rel.offset/4], 0, 20) + bitfield_u32(bitfield_s32(symbol_entry.symbol_value, 2, 20) - instr_i, 0, 20);
+                    continue;
                 case ObjectFile::RelocationEntry::Type::UNDEFINED:
                 default:
                     ERROR("Linker::fill_local() - Unknown relocation entry type.");
@@ -371,6 +420,19 @@ void Linker::link()
     // offset_data += obj_file.data_section.size();
     // offset_bss += obj_file.bss_section;
 
+    /* Symbols already have their final addresses, so the loader has nothing left to patch */
+    if (page_aligned)
+    {
+        if (exe_obj_file.string_table.find(entry_symbol) == exe_obj_file.string_table.end())
+        {
+            ERROR("Linker::link() - Missing entry point %s.", entry_symbol.c_str());
+        }
+
+        exe_obj_file.flags |= BELF_FLAG_PAGE_ALIGNED;
+        exe_obj_file.entry_point = exe_obj_file.symbol_table.at(exe_obj_file.string_table.at(entry_symbol)).symbol_value;
+        exe_obj_file.relocate_text();
+    }
+
     exe_obj_file.write_object_file(m_exe_file);
 }
 
@@ -421,6 +483,7 @@ const std::vector<std::pair<std::string, Linker::Token::Type>> Linker::TOKEN_SPE
     {"^[^\\S]+", Linker::Token::Type::WHITESPACE},
     {"^/\\*[\\s\\S]*?\\*/", Linker::Token::Type::WHITESPACE}, {"^//.*", Linker::Token::Type::WHITESPACE},
     {"^ENTRY\\b", Linker::Token::Type::ENTRY},
+    {"^LAYOUT\\b", Linker::Token::Type::LAYOUT},
     {"^SECTIONS\\b", Linker::Token::Type::SECTIONS},
     {"^\\.text\\b", Linker::Token::Type::TEXT}, {"^\\.data\\b", Linker::Token::Type::DATA}, {"^\\.bss\\b", Linker::Token::Type::BSS},
 
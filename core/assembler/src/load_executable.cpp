@@ -1,123 +1,204 @@
 #include "assembler/load_executable.h"
 #include "assembler/object_file.h"
+#include "emulator32bit/kernel/malloc.h"
 #include "util/logger.h"
 
+#include <algorithm>
+#include <cstring>
+#include <map>
+
 LoadExecutable::LoadExecutable(Emulator32bit& emu, File exe_file) : m_emu(emu), m_exe_file(exe_file)
 {
     load();
 }
 
-void LoadExecutable::load()
-{                                            /* For now load starting at address 0 */
-    ObjectFile obj(m_exe_file);
+/* Fields in the executable are little endian. */
+static word read_field(const byte *field, int nbytes)
+{
+    word value = 0;
+    for (int i = 0; i < nbytes && i < (int) sizeof(word); i++)
+    {
+        value |= (word) field[i] << (i * 8);
+    }
+    return value;
+}
 
-    for (ObjectFile::RelocationEntry& rel : obj.rel_text) {
-        ObjectFile::SymbolTableEntry symbol_entry = obj.symbol_table.at(rel.symbol);
+void LoadExecutable::map_huge_pages(const std::vector<ObjectFile::ProgramHeader>& segments)
+{
+    /* Sections can share a huge page, so its permissions are the union of theirs. */
+    struct HugeSlot
+    {
+        bool write = false;
+        bool execute = false;
+    };
+    std::map<word, HugeSlot> slots;
 
-        /* all symbols should have a corresponding definition */
-        if (symbol_entry.binding_info == ObjectFile::SymbolTableEntry::BindingInfo::WEAK) {
-            ERROR("Linker::link() - Undefined symbol %s", obj.strings.at(symbol_entry.symbol_name).c_str());
+    for (const ObjectFile::ProgramHeader& segment : segments)
+    {
+        if (segment.load_at_physical_address || !segment.huge_pages || segment.mem_size == 0)
+        {
             continue;
         }
 
-        word instr_i = rel.offset/4;
-        word new_abs_value = symbol_entry.symbol_value;
-        switch (rel.type) {
-            case ObjectFile::RelocationEntry::Type::R_EMU32_O_LO12:
-                obj.text_section.at(instr_i) = mask_0(obj.text_section.at(rel.offset/4), 0, 14) + bitfield_u32(new_abs_value, 0, 12);
-                break;
-            case ObjectFile::RelocationEntry::Type::R_EMU32_ADRP_HI20:
-                obj.text_section.at(instr_i) = mask_0(obj.text_section.at(rel.offset/4), 0, 20) + bitfield_u32(new_abs_value, 12, 20);
-                break;
-            case ObjectFile::RelocationEntry::Type::R_EMU32_MOV_LO19:
-                obj.text_section.at(instr_i) = mask_0(obj.text_section.at(rel.offset/4), 0, 19) + bitfield_u32(new_abs_value, 0, 19);
-                break;
-            case ObjectFile::RelocationEntry::Type::R_EMU32_MOV_HI13:
-                obj.text_section.at(instr_i) = mask_0(obj.text_section.at(rel.offset/4), 0, 19) + bitfield_u32(new_abs_value, 19, 13);
-                break;
-            case ObjectFile::RelocationEntry::Type::UNDEFINED:
-            default:
-                ERROR("Assembler::fill_local() - Unknown relocation entry type (%d)", (int)rel.type);
+        bool text = segment.type == ObjectFile::SectionHeader::Type::TEXT;
+        word start = segment.address >> HUGE_PAGE_PSIZE;
+        word end = (segment.address + segment.mem_size - 1) >> HUGE_PAGE_PSIZE;
+        for (word slot = start; slot <= end; slot++)
+        {
+            slots[slot].write |= !text;
+            slots[slot].execute |= text;
         }
     }
 
-    // text -> data -> bss
-    word cur_addr = obj.sections[obj.section_table.at(".text")].address;
-    bool physical = obj.sections[obj.section_table.at(".text")].load_at_physical_address;
-
-
-    if (!physical && obj.text_section.size() > 0)
+    for (const std::pair<const word, HugeSlot>& slot : slots)
     {
-        // we are assuming that there is no overlap between pages of text, data, and bss sections
-        word start = cur_addr >> PAGE_PSIZE;
-        word end = (cur_addr + 4 * obj.text_section.size() - 1) >> PAGE_PSIZE;
-        m_emu.mmu->add_vpage(m_emu.mmu->current_process(), start, end - start + 1, false, true);
+        m_emu.mmu->add_huge_vpage(m_emu.mmu->current_process(), slot.first << PTABLE_L2_PSIZE,
+                                  slot.second.write, slot.second.execute);
     }
+}
 
-    for (word instr : obj.text_section) {
-        if (!physical)
+void LoadExecutable::load()
+{
+    /*
+        Page aligned executables are loaded straight out of a read only
+        mapping of the file, only the headers are parsed. The host shares
+        the mapped pages between every emulator running the executable.
+    */
+    std::shared_ptr<MappedFile> mapping = std::make_shared<MappedFile>(m_exe_file);
+    const word program_headers_start = ObjectFile::BELF_HEADER_SIZE + 16;
+    if (mapping->size() >= program_headers_start &&
+        (read_field(mapping->data() + 20, 2) & BELF_FLAG_PAGE_ALIGNED))
+    {
+        const byte *data = mapping->data();
+        word entry_point = read_field(data + ObjectFile::BELF_HEADER_SIZE, 8);
+        word n_program_headers = read_field(data + ObjectFile::BELF_HEADER_SIZE + 8, 8);
+        if (mapping->size() < program_headers_start + (size_t) n_program_headers * ObjectFile::PROGRAM_HEADER_SIZE)
         {
-            m_emu.system_bus.write_word(cur_addr, instr);
+            ERROR("LoadExecutable::load() - Truncated program header table in %s.", m_exe_file.get_path().c_str());
         }
-        else
+
+        std::vector<ObjectFile::ProgramHeader> segments;
+        for (word i = 0; i < n_program_headers; i++)
         {
-            m_emu.system_bus.write_unmapped_word(cur_addr, instr);
+            const byte *header = data + program_headers_start + i * ObjectFile::PROGRAM_HEADER_SIZE;
+            ObjectFile::ProgramHeader segment = {
+                .type = (ObjectFile::SectionHeader::Type) read_field(header, 4),
+                .file_offset = read_field(header + 4, 8),
+                .file_size = read_field(header + 12, 8),
+                .address = read_field(header + 20, 8),
+                .mem_size = read_field(header + 28, 8),
+                .load_at_physical_address = (bool) test_bit(header[36], 0),
+                .huge_pages = (bool) test_bit(header[36], 1),
+            };
+
+            if ((size_t) segment.file_offset + segment.file_size > mapping->size() ||
+                segment.file_size > segment.mem_size)
+            {
+                ERROR("LoadExecutable::load() - Segment %u lies outside of %s.", i, m_exe_file.get_path().c_str());
+            }
+            segments.push_back(segment);
         }
 
-        cur_addr += 4;
+        load_segments(segments, std::shared_ptr<const byte>(mapping, data), entry_point);
+        return;
     }
+    mapping.reset();
 
-    cur_addr = obj.sections[obj.section_table.at(".data")].address;
-    physical = obj.sections[obj.section_table.at(".data")].load_at_physical_address;
-
-    if (!physical && obj.data_section.size() > 0)
+    ObjectFile obj(m_exe_file);
+    obj.relocate_text();
+
+    /* Lay .text then .data out in one image so both paths load segments the same way */
+    word text_size = obj.text_section.size() * 4;
+    word data_size = obj.data_section.size();
+    std::shared_ptr<std::vector<byte>> image = std::make_shared<std::vector<byte>>(text_size + data_size);
+    memcpy(image->data(), obj.text_section.data(), text_size);
+    memcpy(image->data() + text_size, obj.data_section.data(), data_size);
+
+    std::vector<ObjectFile::ProgramHeader> segments;
+    const std::pair<std::string, ObjectFile::ProgramHeader> section_segments[] = {
+        {".text", {ObjectFile::SectionHeader::Type::TEXT, 0, text_size, 0, text_size}},
+        {".data", {ObjectFile::SectionHeader::Type::DATA, text_size, data_size, 0, data_size}},
+        {".bss", {ObjectFile::SectionHeader::Type::BSS, 0, 0, 0, obj.bss_section}},
+    };
+    for (const std::pair<std::string, ObjectFile::ProgramHeader>& section_segment : section_segments)
     {
-        word start = cur_addr >> PAGE_PSIZE;
-        word end = (cur_addr + obj.data_section.size() - 1) >> PAGE_PSIZE;
-        m_emu.mmu->add_vpage(m_emu.mmu->current_process(), start, end - start + 1, true, false);
+        ObjectFile::SectionHeader& section = obj.sections[obj.section_table.at(section_segment.first)];
+        ObjectFile::ProgramHeader segment = section_segment.second;
+        segment.address = section.address;
+        segment.load_at_physical_address = section.load_at_physical_address;
+        segment.huge_pages = section.huge_pages;
+        segments.push_back(segment);
     }
 
-    for (byte data : obj.data_section) {
-        if (!physical)
+    /* start program at _start label */
+    if (obj.string_table.find("_start") == obj.string_table.end()) {
+        ERROR("LoadExecutable::load() - Missing required _start entry point of program.");
+    }
+
+    word entry_point = obj.symbol_table.at(obj.string_table.at("_start")).symbol_value;
+    load_segments(segments, std::shared_ptr<const byte>(image, image->data()), entry_point);
+}
+
+void LoadExecutable::load_segments(const std::vector<ObjectFile::ProgramHeader>& segments,
+                                   std::shared_ptr<const byte> image, word entry_point)
+{
+    map_huge_pages(segments);
+
+    /*
+        Virtual segments on small pages are demand paged, a page is only
+        filled from the image (or zeroed past it) on its first touch.
+        We are assuming that there is no overlap between pages of text, data,
+        and bss sections.
+    */
+    for (const ObjectFile::ProgramHeader& segment : segments)
+    {
+        bool text = segment.type == ObjectFile::SectionHeader::Type::TEXT;
+        if (!segment.load_at_physical_address && !segment.huge_pages)
         {
-            m_emu.system_bus.write_byte(cur_addr, data);
+            std::shared_ptr<const byte> segment_image;
+            if (segment.file_size > 0)
+            {
+                segment_image = std::shared_ptr<const byte>(image, image.get() + segment.file_offset);
+            }
+
+            m_emu.mmu->add_segment(m_emu.mmu->current_process(), segment.address, segment.mem_size,
+                                   segment_image, segment.file_size, !text, text);
+            continue;
         }
-        else
+
+        for (word i = 0; i < segment.mem_size; i++)
         {
-            m_emu.system_bus.write_unmapped_byte(cur_addr, data);
+            byte data = i < segment.file_size ? image.get()[segment.file_offset + i] : 0;
+            if (!segment.load_at_physical_address)
+            {
+                m_emu.system_bus.write_byte(segment.address + i, data);
+            }
+            else
+            {
+                m_emu.system_bus.write_unmapped_byte(segment.address + i, data);
+            }
         }
-        cur_addr++;
     }
 
-    cur_addr = obj.sections[obj.section_table.at(".bss")].address;
-    physical = obj.sections[obj.section_table.at(".bss")].load_at_physical_address;
-    if (!physical && obj.bss_section > 0)
+    /* The heap grown by brk starts on the page after the program */
+    word program_end = 0;
+    for (const ObjectFile::ProgramHeader& segment : segments)
     {
-        word start = cur_addr >> PAGE_PSIZE;
-        word end = (cur_addr + obj.bss_section - 1) >> PAGE_PSIZE;
-        m_emu.mmu->add_vpage(m_emu.mmu->current_process(), start, end - start + 1, true, false);
-    }
-
-    for (word i = 0; i < obj.bss_section; i++) {
-        if (!physical)
-        {
-            m_emu.system_bus.write_byte(cur_addr, 0);
-        }
-        else
+        if (!segment.load_at_physical_address)
         {
-            m_emu.system_bus.write_unmapped_byte(cur_addr, 0);
+            program_end = std::max(program_end, segment.address + segment.mem_size);
         }
-        cur_addr++;
     }
-
-    /* start program at _start label */
-    if (obj.string_table.find("_start") == obj.string_table.end()) {
-        ERROR("LoadExecutable::load() - Missing required _start entry point of program.");
+    if (m_emu.mmu->current_process() >= 0)
+    {
+        m_emu.memory_manager->set_break(m_emu.mmu->current_process(), program_end);
     }
 
     VirtualMemory::Exception vm_exception;
-    word entry_point = obj.symbol_table.at(obj.string_table.at("_start")).symbol_value;
+
+    /* Fault the entry page in through the system bus, which fills it, before using its physical address. */
+    m_emu.system_bus.read_word(entry_point);
     m_emu.set_pc(m_emu.mmu->translate_address(entry_point, vm_exception));
 
-    INFO("Starting emulator at entry point _start at virtual address %x mapped to physical address %x", entry_point, m_emu.get_pc());
-};
\ No newline at end of file
+    INFO("Starting emulator at entry point at virtual address %x mapped to physical address %x", entry_point, m_emu.get_pc());
+}
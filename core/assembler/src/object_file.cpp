@@ -4,6 +4,7 @@
 #include "util/logger.h"
 #include "util/types.h"
 
+#include <bit>
 #include <fstream>
 
 ObjectFile::ObjectFile()
@@ -71,6 +72,28 @@ void ObjectFile::disassemble(std::vector<byte>& bytes)
     DEBUG("ObjectFile::disassemble() - Belf Header = (filetype=%hu, target_machine=%hu, flags=%hu, n_sections=%hu)",
         file_type, target_machine, flags, n_sections);
 
+    /* Program headers, sections start at their offsets instead of right after each other */
+    word cur_byte = BELF_HEADER_SIZE;
+    if (flags & BELF_FLAG_PAGE_ALIGNED) {
+        entry_point = reader.read_dword();
+        word n_program_headers = reader.read_dword();
+        for (word i = 0; i < n_program_headers; i++) {
+            ProgramHeader program_header = {
+                .type = (SectionHeader::Type) reader.read_word(),
+                .file_offset = (word) reader.read_dword(),
+                .file_size = (word) reader.read_dword(),
+                .address = (word) reader.read_dword(),
+                .mem_size = (word) reader.read_dword(),
+            };
+
+            byte load_flags = reader.read_byte();
+            program_header.load_at_physical_address = test_bit(load_flags, 0);
+            program_header.huge_pages = test_bit(load_flags, 1);
+            program_headers.push_back(program_header);
+        }
+        cur_byte += 16 + n_program_headers * PROGRAM_HEADER_SIZE;
+    }
+
     /* Section headers */
     DEBUG("ObjectFile::disassemble() - Reading section headers");
     ByteReader section_headers_reader(bytes);
@@ -86,11 +109,14 @@ void ObjectFile::disassemble(std::vector<byte>& bytes)
             .section_start = (word) section_headers_reader.read_dword(),
             .section_size = (word) section_headers_reader.read_dword(),
             .entry_size = (word) section_headers_reader.read_dword(),
-
-            .load_at_physical_address = (bool) section_headers_reader.read_byte(),
-            .address = (word) section_headers_reader.read_dword(),
         };
 
+        /* load flags, bit 0 is load at physical address and bit 1 is map with huge pages */
+        byte load_flags = section_headers_reader.read_byte();
+        section_header.load_at_physical_address = test_bit(load_flags, 0);
+        section_header.huge_pages = test_bit(load_flags, 1);
+        section_header.address = (word) section_headers_reader.read_dword();
+
         sections.push_back(section_header);
 
         DEBUG("ObjectFile::disassemble() - Reading section %d (name = %d, type=%d, section_start=%u, section_size=%u, entry_size=%u)",
@@ -105,12 +131,20 @@ void ObjectFile::disassemble(std::vector<byte>& bytes)
         switch(section_header.type) {
             case SectionHeader::Type::TEXT:
                 DEBUG("ObjectFile::disassemble() - Disassembling Text Section");
+                if (flags & BELF_FLAG_PAGE_ALIGNED) {
+                    reader.skip_bytes(section_header.section_start - cur_byte);
+                    cur_byte = section_header.section_start + section_header.section_size;
+                }
                 for (word i = 0; i < section_header.section_size; i+=4) {
-                    text_section.push_back(reader.read_word(false));
+                    text_section.push_back(reader.read_word(flags & BELF_FLAG_PAGE_ALIGNED));
                 }
                 break;
             case SectionHeader::Type::DATA:
                 DEBUG("ObjectFile::disassemble() - Disassembling Data Section");
+                if (flags & BELF_FLAG_PAGE_ALIGNED) {
+                    reader.skip_bytes(section_header.section_start - cur_byte);
+                    cur_byte = section_header.section_start + section_header.section_size;
+                }
                 for (word i = 0; i < section_header.section_size; i++) {
                     data_section.push_back(reader.read_byte());
                 }
@@ -231,6 +265,41 @@ std::string ObjectFile::get_symbol_name(int symbol)
     return strings[symbol_table[symbol].symbol_name];
 }
 
+void ObjectFile::relocate_text()
+{
+    for (RelocationEntry& rel : rel_text) {
+        SymbolTableEntry symbol_entry = symbol_table.at(rel.symbol);
+
+        /* all symbols should have a corresponding definition */
+        if (symbol_entry.binding_info == SymbolTableEntry::BindingInfo::WEAK) {
+            ERROR("ObjectFile::relocate_text() - Undefined symbol %s", strings.at(symbol_entry.symbol_name).c_str());
+            continue;
+        }
+
+        word instr_i = rel.offset/4;
+        word new_abs_value = symbol_entry.symbol_value;
+        switch (rel.type) {
+            case RelocationEntry::Type::R_EMU32_O_LO12:
+                text_section.at(instr_i) = mask_0(text_section.at(instr_i), 0, 14) + bitfield_u32(new_abs_value, 0, 12);
+                break;
+            case RelocationEntry::Type::R_EMU32_ADRP_HI20:
+                text_section.at(instr_i) = mask_0(text_section.at(instr_i), 0, 20) + bitfield_u32(new_abs_value, 12, 20);
+                break;
+            case RelocationEntry::Type::R_EMU32_MOV_LO19:
+                text_section.at(instr_i) = mask_0(text_section.at(instr_i), 0, 19) + bitfield_u32(new_abs_value, 0, 19);
+                break;
+            case RelocationEntry::Type::R_EMU32_MOV_HI13:
+                text_section.at(instr_i) = mask_0(text_section.at(instr_i), 0, 19) + bitfield_u32(new_abs_value, 19, 13);
+                break;
+            case RelocationEntry::Type::UNDEFINED:
+            default:
+                ERROR("ObjectFile::relocate_text() - Unknown relocation entry type (%d)", (int)rel.type);
+        }
+    }
+
+    rel_text.clear();
+}
+
 /**
  * @brief                     Adds a symbol to the symbol table
  *
@@ -293,14 +362,51 @@ void ObjectFile::write_object_file(File obj_file)
     byte_writer << ByteWriter::Data(0, 12);                                /* Unused padding */
     byte_writer << ByteWriter::Data(file_type, 2);                        /* Object file type */
     byte_writer << ByteWriter::Data(target_machine, 2);                    /* Target machine */
-    byte_writer << ByteWriter::Data(0, 2);                                /* Flags */
+    byte_writer << ByteWriter::Data(flags, 2);                            /* Flags */
     byte_writer << ByteWriter::Data(sections.size(), 2);                /* Number of sections */
     current_byte += BELF_HEADER_SIZE;
 
+    /* Program Headers */
+    word data_start = 0;
+    if (flags & BELF_FLAG_PAGE_ALIGNED) {
+        DEBUG("ObjectFile::write_object_file() - Writing program headers.");
+        const SectionHeader& text = sections[section_table[".text"]];
+        const SectionHeader& data = sections[section_table[".data"]];
+        const SectionHeader& bss = sections[section_table[".bss"]];
+
+        word text_start = (BELF_HEADER_SIZE + 16 + 3 * PROGRAM_HEADER_SIZE + PAGE_SIZE - 1) & ~(PAGE_SIZE - 1);
+        data_start = (text_start + text_section.size() * 4 + PAGE_SIZE - 1) & ~(PAGE_SIZE - 1);
+        program_headers = {
+            {SectionHeader::Type::TEXT, text_start, (word) text_section.size() * 4, text.address,
+             (word) text_section.size() * 4, text.load_at_physical_address, text.huge_pages},
+            {SectionHeader::Type::DATA, data_start, (word) data_section.size(), data.address,
+             (word) data_section.size(), data.load_at_physical_address, data.huge_pages},
+            {SectionHeader::Type::BSS, 0, 0, bss.address, bss_section, bss.load_at_physical_address,
+             bss.huge_pages},
+        };
+
+        byte_writer << ByteWriter::Data(entry_point, 8);
+        byte_writer << ByteWriter::Data(program_headers.size(), 8);
+        for (ProgramHeader& program_header : program_headers) {
+            byte_writer << ByteWriter::Data((int) program_header.type, 4);
+            byte_writer << ByteWriter::Data(program_header.file_offset, 8);
+            byte_writer << ByteWriter::Data(program_header.file_size, 8);
+            byte_writer << ByteWriter::Data(program_header.address, 8);
+            byte_writer << ByteWriter::Data(program_header.mem_size, 8);
+            byte_writer << ByteWriter::Data(program_header.load_at_physical_address |
+                                            (program_header.huge_pages << 1), 1);
+        }
+        current_byte += 16 + program_headers.size() * PROGRAM_HEADER_SIZE;
+
+        for (; current_byte < (int) text_start; current_byte++) {
+            byte_writer << ByteWriter::Data(0, 1);
+        }
+    }
+
     /* Text Section */
     DEBUG("ObjectFile::write_object_file() - Writing .text section.");
     for (size_t i = 0; i < text_section.size(); i++) {
-        byte_writer << ByteWriter::Data(text_section.at(i), 4, false);
+        byte_writer << ByteWriter::Data(text_section.at(i), 4, flags & BELF_FLAG_PAGE_ALIGNED);
     }
     sections[section_table[".text"]].section_size = text_section.size() * 4;
     sections[section_table[".text"]].section_start = current_byte;
@@ -308,6 +414,9 @@ void ObjectFile::write_object_file(File obj_file)
 
     /* Data Section */
     DEBUG("ObjectFile::write_object_file() - Writing .data section.");
+    for (; current_byte < (int) data_start; current_byte++) {
+        byte_writer << ByteWriter::Data(0, 1);
+    }
     for (size_t i = 0; i < data_section.size(); i++) {
         byte_writer << ByteWriter::Data(data_section.at(i), 1);
     }
@@ -395,7 +504,8 @@ void ObjectFile::write_object_file(File obj_file)
         byte_writer << ByteWriter::Data(sections[i].section_size, 8);
         byte_writer << ByteWriter::Data(sections[i].entry_size, 8);
 
-        byte_writer << ByteWriter::Data(sections[i].load_at_physical_address, 1);
+        byte_writer << ByteWriter::Data(sections[i].load_at_physical_address |
+                                        (sections[i].huge_pages << 1), 1);
         byte_writer << ByteWriter::Data(sections[i].address, 8);
     }
     /* For easy access */
@@ -539,6 +649,9 @@ void ObjectFile::print()
                 case RelocationEntry::Type::R_EMU32_B_OFFSET22:
                     print_str = "R_EMU32_B_OFFSET22";
                     break;
+                case RelocationEntry::Type::R_EMU32_CB_OFFSET20:
+                    print_str = "R_EMU32_CB_OFFSET20";
+                    break;
                 case RelocationEntry::Type::UNDEFINED:
                     print_str = "<ERROR>";
                     break;
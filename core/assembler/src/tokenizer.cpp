@@ -1,7 +1,10 @@
 #include "assembler/tokenizer.h"
+#include "assembler/perfect_hash.h"
 #include "util/logger.h"
 
+#include <iterator>
 #include <regex>
+#include <string_view>
 #include <utility>
 
 Tokenizer::Tokenizer(File src, bool keep_comments) :
@@ -326,7 +329,8 @@ std::vector<Tokenizer::Token> Tokenizer::tokenize(std::string source_code, bool
                 (c == '.' && index == 0) || (c == '_') || (c == '#' && index == 0);
     };
 
-    std::unordered_map<std::string, Type> simple_map =
+    /* Words that are always the same token, hashed at compile time */
+    static constexpr PerfectHashEntry<Type> KEYWORD_LIST[] =
     {
         {"x0", REGISTER_X0}, {"x1", REGISTER_X1},
         {"x2", REGISTER_X2}, {"x3", REGISTER_X3},
@@ -392,59 +396,11 @@ std::vector<Tokenizer::Token> Tokenizer::tokenize(std::string source_code, bool
         {".ascii", ASSEMBLER_ASCII},
         {".asciz", ASSEMBLER_ASCIZ},
 
-        {"hlt", INSTRUCTION_HLT},
-        {"add", INSTRUCTION_ADD}, {"adds", INSTRUCTION_ADD},
-        {"sub", INSTRUCTION_SUB}, {"subs", INSTRUCTION_SUB},
-        {"rsb", INSTRUCTION_RSB}, {"rsbs", INSTRUCTION_RSB},
-        {"adc", INSTRUCTION_ADC}, {"adcs", INSTRUCTION_ADC},
-        {"sbc", INSTRUCTION_SBC}, {"sbcs", INSTRUCTION_SBC},
-        {"rsc", INSTRUCTION_RSC}, {"rscs", INSTRUCTION_RSC},
-        {"mul", INSTRUCTION_MUL}, {"muls", INSTRUCTION_MUL},
-        {"umull", INSTRUCTION_UMULL}, {"umulls", INSTRUCTION_UMULL},
-        {"smull", INSTRUCTION_SMULL}, {"smulls", INSTRUCTION_SMULL},
-        {"vabs.f32", INSTRUCTION_VABS},
-        {"vneg.f32", INSTRUCTION_VNEG},
-        {"vsqrt.f32", INSTRUCTION_VSQRT},
-        {"vadd.f32", INSTRUCTION_VADD},
-        {"vsub.f32", INSTRUCTION_VSUB},
-        {"vdiv.f32", INSTRUCTION_VDIV},
-        {"vmul.f32", INSTRUCTION_VMUL},
-        {"vcmp.f32", INSTRUCTION_VCMP},
-        {"vsel.f32", INSTRUCTION_VSEL},
-        {"vcint.u32.f32", INSTRUCTION_VCINT}, {"vcint.s32.f32", INSTRUCTION_VCINT},
-        {"vcflo.u32.f32", INSTRUCTION_VCFLO}, {"vcflo.s32.f32", INSTRUCTION_VCFLO},
-        {"vmov.f32", INSTRUCTION_VMOV},
-        {"and", INSTRUCTION_AND}, {"ands", INSTRUCTION_AND},
-        {"orr", INSTRUCTION_ORR}, {"orrs", INSTRUCTION_ORR},
-        {"eor", INSTRUCTION_EOR}, {"eors", INSTRUCTION_EOR},
-        {"bic", INSTRUCTION_BIC}, {"bics", INSTRUCTION_BIC},
-        {"lsl", INSTRUCTION_LSL}, {"lsls", INSTRUCTION_LSL},
-        {"lsr", INSTRUCTION_LSR}, {"lsrs", INSTRUCTION_LSR},
-        {"asr", INSTRUCTION_ASR}, {"asrs", INSTRUCTION_ASR},
-        {"ror", INSTRUCTION_ROR}, {"rors", INSTRUCTION_ROR},
-        {"cmp", INSTRUCTION_CMP},
-        {"cmn", INSTRUCTION_CMN},
-        {"tst", INSTRUCTION_TST},
-        {"teq", INSTRUCTION_TEQ},
-        {"mov", INSTRUCTION_MOV}, {"movs", INSTRUCTION_MOV},
-        {"mvn", INSTRUCTION_MVN}, {"mvns", INSTRUCTION_MVN},
-        {"ldr", INSTRUCTION_LDR}, {"ldrs", INSTRUCTION_LDR},
-        {"str", INSTRUCTION_STR}, {"strs", INSTRUCTION_STR},
-        {"swp", INSTRUCTION_SWP}, {"swps", INSTRUCTION_SWP},
-        {"ldrb", INSTRUCTION_LDRB}, {"ldrsb", INSTRUCTION_LDRB},
-        {"strb", INSTRUCTION_STRB}, {"strsb", INSTRUCTION_STRB},
-        {"swpb", INSTRUCTION_SWPB}, {"swpsb", INSTRUCTION_SWPB},
-        {"ldrh", INSTRUCTION_LDRH}, {"ldrsh", INSTRUCTION_LDRH},
-        {"strh", INSTRUCTION_STRH}, {"strsh", INSTRUCTION_STRH},
-        {"swph", INSTRUCTION_SWPH}, {"swpsh", INSTRUCTION_SWPH},
-        {"b", INSTRUCTION_B},
-        {"bl", INSTRUCTION_BL},
-        {"bx", INSTRUCTION_BX},
-        {"blx", INSTRUCTION_BLX},
-        {"swi", INSTRUCTION_SWI},
-        {"adrp", INSTRUCTION_ADRP},
-
-        {"ret", INSTRUCTION_RET},
+        #define _INSTRUCTION_KEYWORD(name, handler, mnemonic) {mnemonic, INSTRUCTION_##name},
+        #define _INSTRUCTION_ALIAS(name, mnemonic) {mnemonic, INSTRUCTION_##name},
+        EMU32_ISA(EMU32_ISA_SKIP, _INSTRUCTION_KEYWORD, _INSTRUCTION_ALIAS)
+        #undef _INSTRUCTION_KEYWORD
+        #undef _INSTRUCTION_ALIAS
 
         {"eq", CONDITION_EQ}, {"ne", CONDITION_NE},
         {"cs", CONDITION_CS}, {"hs", CONDITION_HS},
@@ -455,6 +411,7 @@ std::vector<Tokenizer::Token> Tokenizer::tokenize(std::string source_code, bool
         {"ge", CONDITION_GE}, {"lt", CONDITION_LT}, {"gt", CONDITION_GT}, {"le", CONDITION_LE},
         {"al", CONDITION_AL}, {"nv", CONDITION_NV},
     };
+    static constexpr PerfectHashMap<Type, std::size(KEYWORD_LIST)> KEYWORDS(KEYWORD_LIST);
 
     while (source_code.size() > 0)
     {
@@ -465,10 +422,10 @@ std::vector<Tokenizer::Token> Tokenizer::tokenize(std::string source_code, bool
             substring_length++;
         }
 
-        std::string sub = source_code.substr(0, substring_length);
-        if (simple_map.find(sub) != simple_map.end())
+        const std::string_view word(source_code.data(), substring_length);
+        if (const Type *keyword = KEYWORDS.find(word))
         {
-            tokens.emplace_back(simple_map.at(sub), sub, cur_line, tokenize_id);
+            tokens.emplace_back(*keyword, std::string(word), cur_line, tokenize_id);
             source_code = source_code.substr(substring_length);
             continue;
         }
@@ -671,26 +628,9 @@ const std::unordered_map<Tokenizer::Type, std::string> Tokenizer::TYPE_TO_NAME_M
     {REGISTER_X28, "REGISTER_X28"}, {REGISTER_X29, "REGISTER_X29"},
     {REGISTER_XZR, "REGISTER_XZR"}, {REGISTER_SP, "REGISTER_SP"},
 
-    {INSTRUCTION_HLT, "INSTRUCTION_HLT"},
-    {INSTRUCTION_ADD, "INSTRUCTION_ADD"}, {INSTRUCTION_SUB,"INSTRUCTION_SUB"}, {INSTRUCTION_RSB, "INSTRUCTION_RSB"},
-    {INSTRUCTION_ADC, "INSTRUCTION_ADC"}, {INSTRUCTION_SBC, "INSTRUCTION_SBC"}, {INSTRUCTION_RSC, "INSTRUCTION_RSC"},
-    {INSTRUCTION_MUL, "INSTRUCTION_MUL"}, {INSTRUCTION_UMULL, "INSTRUCTION_UMULL"}, {INSTRUCTION_SMULL, "INSTRUCTION_SMULL"},
-    {INSTRUCTION_VABS, "INSTRUCTION_VABS"}, {INSTRUCTION_VNEG, "INSTRUCTION_VNEG"}, {INSTRUCTION_VSQRT, "INSTRUCTION_VSQRT"},
-    {INSTRUCTION_VADD, "INSTRUCTION_VADD"}, {INSTRUCTION_VSUB, "INSTRUCTION_VSUB"}, {INSTRUCTION_VDIV, "INSTRUCTION_VDIV"},
-    {INSTRUCTION_VMUL, "INSTRUCTION_VMUL"}, {INSTRUCTION_VCMP, "INSTRUCTION_VCMP"}, {INSTRUCTION_VSEL, "INSTRUCTION_VSEL"},
-    {INSTRUCTION_VCINT, "INSTRUCTION_VCINT"}, {INSTRUCTION_VCFLO, "INSTRUCTION_VCFLO"},
-    {INSTRUCTION_VMOV, "INSTRUCTION_VMOV"},
-    {INSTRUCTION_AND, "INSTRUCTION_AND"}, {INSTRUCTION_ORR, "INSTRUCTION_ORR"}, {INSTRUCTION_EOR, "INSTRUCTION_EOR"}, {INSTRUCTION_BIC, "INSTRUCTION_BIC"},
-    {INSTRUCTION_LSL, "INSTRUCTION_LSL"}, {INSTRUCTION_LSR, "INSTRUCTION_LSR"}, {INSTRUCTION_ASR, "INSTRUCTION_ASR"}, {INSTRUCTION_ROR, "INSTRUCTION_ROR"},
-    {INSTRUCTION_CMP, "INSTRUCTION_CMP"}, {INSTRUCTION_CMN, "INSTRUCTION_CMN"}, {INSTRUCTION_TST, "INSTRUCTION_TST"}, {INSTRUCTION_TEQ, "INSTRUCTION_TEQ"},
-    {INSTRUCTION_MOV, "INSTRUCTION_MOV"}, {INSTRUCTION_MVN, "INSTRUCTION_MVN"},
-    {INSTRUCTION_LDR, "INSTRUCTION_LDR"}, {INSTRUCTION_STR, "INSTRUCTION_STR"}, {INSTRUCTION_SWP, "INSTRUCTION_SWP"},
-    {INSTRUCTION_LDRB, "INSTRUCTION_LDRB"}, {INSTRUCTION_STRB, "INSTRUCTION_STRB"}, {INSTRUCTION_SWPB, "INSTRUCTION_SWPB"},
-    {INSTRUCTION_LDRH, "INSTRUCTION_LDRH"}, {INSTRUCTION_STRH, "INSTRUCTION_STRH"}, {INSTRUCTION_SWPH, "INSTRUCTION_SWPH"},
-    {INSTRUCTION_B, "INSTRUCTION_B"}, {INSTRUCTION_BL, "INSTRUCTION_B"}, {INSTRUCTION_BX, "INSTRUCTION_BX"}, {INSTRUCTION_BLX, "INSTRUCTION_BLX"}, {INSTRUCTION_SWI, "INSTRUCTION_SWI"},
-    {INSTRUCTION_ADRP, "INSTRUCTION_ADRP"},
-
-    {INSTRUCTION_RET, "INSTRUCTION_RET"},
+    #define _INSTRUCTION_NAME(name, handler, mnemonic) {INSTRUCTION_##name, "INSTRUCTION_" #name},
+    ASSEMBLER_INSTRUCTIONS(_INSTRUCTION_NAME)
+    #undef _INSTRUCTION_NAME
 
     {CONDITION_EQ, "CONDITION_EQ"}, {CONDITION_NE, "CONDITION_NE"},
     {CONDITION_CS, "CONDITION_CS"}, {CONDITION_HS, "CONDITION_HS"},
@@ -787,29 +727,13 @@ const std::set<Tokenizer::Type> Tokenizer::REGISTERS =
     REGISTER_XZR, REGISTER_SP,
 };
 
-const std::set<Tokenizer::Type> Tokenizer::INSTRUCTIONS =
-{
-    INSTRUCTION_HLT,
-    INSTRUCTION_ADD, INSTRUCTION_SUB, INSTRUCTION_RSB,
-    INSTRUCTION_ADC, INSTRUCTION_SBC, INSTRUCTION_RSC,
-    INSTRUCTION_MUL, INSTRUCTION_UMULL, INSTRUCTION_SMULL,
-    INSTRUCTION_VABS, INSTRUCTION_VNEG, INSTRUCTION_VSQRT,
-    INSTRUCTION_VADD, INSTRUCTION_VSUB, INSTRUCTION_VDIV,
-    INSTRUCTION_VMUL, INSTRUCTION_VCMP, INSTRUCTION_VSEL,
-    INSTRUCTION_VCINT, INSTRUCTION_VCFLO,
-    INSTRUCTION_VMOV,
-    INSTRUCTION_AND, INSTRUCTION_ORR, INSTRUCTION_EOR, INSTRUCTION_BIC,
-    INSTRUCTION_LSL, INSTRUCTION_LSR, INSTRUCTION_ASR, INSTRUCTION_ROR,
-    INSTRUCTION_CMP, INSTRUCTION_CMN, INSTRUCTION_TST, INSTRUCTION_TEQ,
-    INSTRUCTION_MOV, INSTRUCTION_MVN,
-    INSTRUCTION_LDR, INSTRUCTION_STR, INSTRUCTION_SWP,
-    INSTRUCTION_LDRB, INSTRUCTION_STRB, INSTRUCTION_SWPB,
-    INSTRUCTION_LDRH, INSTRUCTION_STRH, INSTRUCTION_SWPH,
-    INSTRUCTION_B, INSTRUCTION_BL, INSTRUCTION_BX, INSTRUCTION_BLX, INSTRUCTION_SWI,
-    INSTRUCTION_ADRP,
-
-    INSTRUCTION_RET,
-};
+#define _INSTRUCTION_TYPE(name, handler, mnemonic) Tokenizer::INSTRUCTION_##name,
+static constexpr Tokenizer::Type INSTRUCTION_TYPES[] = {ASSEMBLER_INSTRUCTIONS(_INSTRUCTION_TYPE)};
+#undef _INSTRUCTION_TYPE
+static_assert(INSTRUCTION_TYPES[0] == Tokenizer::INSTRUCTION_HLT,
+        "Tokenizer::instruction_index() counts from INSTRUCTION_HLT");
+
+const std::set<Tokenizer::Type> Tokenizer::INSTRUCTIONS(std::begin(INSTRUCTION_TYPES), std::end(INSTRUCTION_TYPES));
 
 const std::set<Tokenizer::Type> Tokenizer::CONDITIONS =
 {
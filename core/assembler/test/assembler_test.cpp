@@ -8,7 +8,9 @@
  */
 
 #include <iostream>
+#ifdef _MSC_VER
 #include <crtdbg.h>
+#endif
 #include <gtest/gtest.h>
 
 using namespace std;
@@ -18,7 +20,7 @@ namespace testing
 {
     class MemoryLeakDetector : public EmptyTestEventListener
     {
-    #ifdef _DEBUG
+    #if defined(_DEBUG) && defined(_MSC_VER)
     public:
         virtual void OnTestStart(const TestInfo&) {
             _CrtMemCheckpoint(&memState_);
@@ -37,7 +39,7 @@ namespace testing
 
     private:
         _CrtMemState memState_;
-    #endif // _DEBUG
+    #endif // _DEBUG && _MSC_VER
     };
 }
 
@@ -0,0 +1,21 @@
+#include "assembler_test/assembler_test.h"
+
+TEST_F (EmulatorFixture, conditional)
+{
+    Process p ("-kp " + AEMU_PROJECT_ROOT_DIR +
+            "core/assembler/test/instruction_test/src/conditional.basm " +
+            "-outdir " + AEMU_PROJECT_ROOT_DIR +
+            "core/assembler/test/instruction_test/build");
+    ASSERT_TRUE (p.does_create_exe ());
+
+    LoadExecutable loader(*machine, p.get_exe_file());
+    machine->run(MAX_INSTRUCTIONS);
+
+    EXPECT_EQ (machine->read_reg(0), 0) << "cbnz loops back over every value";
+    EXPECT_EQ (machine->read_reg(20), 9) << "csel keeps the largest value";
+    EXPECT_EQ (machine->read_reg(21), 4) << "cinc counts the odd values";
+    EXPECT_EQ (machine->read_reg(22), 1);
+    EXPECT_EQ (machine->read_reg(23), 0);
+    EXPECT_EQ (machine->read_reg(24), 5) << "csinc increments the second register when false";
+    EXPECT_EQ (machine->read_reg(25), 1) << "cbz falls through on a nonzero register";
+}
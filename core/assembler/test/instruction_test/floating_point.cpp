@@ -0,0 +1,30 @@
+#include "assembler_test/assembler_test.h"
+
+#include <cstring>
+
+static float reg_float(Emulator32bit *machine, int reg)
+{
+    word bits = machine->read_reg(reg);
+    float f;
+    memcpy(&f, &bits, sizeof(f));
+    return f;
+}
+
+TEST_F (EmulatorFixture, floating_point)
+{
+    Process p ("-kp " + AEMU_PROJECT_ROOT_DIR +
+            "core/assembler/test/instruction_test/src/floating_point.basm " +
+            "-outdir " + AEMU_PROJECT_ROOT_DIR +
+            "core/assembler/test/instruction_test/build");
+    ASSERT_TRUE (p.does_create_exe ());
+
+    LoadExecutable loader(*machine, p.get_exe_file());
+    machine->run(MAX_INSTRUCTIONS);
+
+    EXPECT_NEAR (reg_float(machine, 10), 1.41421356f, 1e-6f) << "newton's method converges on sqrt(2)";
+    EXPECT_EQ (machine->read_reg(11), 1414) << "vcflo and vcint convert through integers";
+    EXPECT_EQ (machine->read_reg(12), machine->read_reg(10)) << "vcmp and vsel pick the absolute value";
+    EXPECT_NEAR (reg_float(machine, 14), 0.0f, 1e-6f) << "vsqrt agrees with newton's method";
+    EXPECT_NE (machine->read_reg(15) & (1 << FPSR_IXC), 0) << "rounding raised inexact";
+    EXPECT_EQ (machine->read_reg(16), 0) << "vmsr clears the flags";
+}
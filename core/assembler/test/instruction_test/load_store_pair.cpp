@@ -0,0 +1,19 @@
+#include "assembler_test/assembler_test.h"
+
+TEST_F (EmulatorFixture, load_store_pair)
+{
+    Process p ("-kp " + AEMU_PROJECT_ROOT_DIR +
+            "core/assembler/test/instruction_test/src/load_store_pair.basm " +
+            "-outdir " + AEMU_PROJECT_ROOT_DIR +
+            "core/assembler/test/instruction_test/build");
+    ASSERT_TRUE (p.does_create_exe ());
+
+    LoadExecutable loader(*machine, p.get_exe_file());
+    machine->run(MAX_INSTRUCTIONS);
+
+    EXPECT_EQ (machine->read_reg(21), 55) << "recursion through stp/stmdb prologues";
+    EXPECT_EQ (machine->read_reg(19), 7) << "ldm restores the callee saved registers";
+    EXPECT_EQ (machine->read_reg(20), 9);
+    EXPECT_EQ (machine->read_reg(22), 7);
+    EXPECT_EQ (machine->read_reg(23), 9);
+}
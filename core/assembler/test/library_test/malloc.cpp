@@ -0,0 +1,30 @@
+#include "assembler_test/assembler_test.h"
+
+#include <emulator32bit/kernel/malloc.h>
+
+TEST_F (EmulatorFixture, malloc_size_classes)
+{
+    Process p ("-kp " + AEMU_PROJECT_ROOT_DIR +
+            "core/assembler/test/library_test/src/malloc.basm " +
+            "-I " + AEMU_PROJECT_ROOT_DIR + "core/app/programs/include " +
+            "-outdir " + AEMU_PROJECT_ROOT_DIR +
+            "core/assembler/test/library_test/build");
+    ASSERT_TRUE (p.does_create_exe ());
+
+    LoadExecutable loader(*machine, p.get_exe_file());
+    machine->run(MAX_INSTRUCTIONS);
+
+    word heap = machine->read_reg(20);
+    EXPECT_EQ (heap % PAGE_SIZE, 4) << "the heap starts on the page after the program";
+    EXPECT_EQ (machine->read_reg(21), heap + 16);
+    EXPECT_EQ (machine->read_reg(22), heap) << "freed blocks are reused by their size class";
+    EXPECT_GE (machine->read_reg(23), MMAP_START);
+    EXPECT_EQ (machine->read_reg(24), 0x77);
+    EXPECT_EQ (machine->read_reg(25), heap + 16 + 128);
+    EXPECT_EQ (machine->read_reg(26), 0x55);
+    EXPECT_EQ (machine->read_reg(27), 0);
+
+    long long pid = machine->mmu->current_process();
+    EXPECT_EQ (machine->mmu->has_vpage(pid, machine->read_reg(23) >> PAGE_PSIZE), false)
+            << "free unmaps large blocks";
+}
@@ -0,0 +1,24 @@
+#include "assembler_test/assembler_test.h"
+
+TEST_F (EmulatorFixture, string_functions)
+{
+    Process p ("-kp " + AEMU_PROJECT_ROOT_DIR +
+            "core/assembler/test/library_test/src/string.basm " +
+            "-I " + AEMU_PROJECT_ROOT_DIR + "core/app/programs/include " +
+            "-outdir " + AEMU_PROJECT_ROOT_DIR +
+            "core/assembler/test/library_test/build");
+    ASSERT_TRUE (p.does_create_exe ());
+
+    LoadExecutable loader(*machine, p.get_exe_file());
+    machine->run(MAX_INSTRUCTIONS);
+
+    word src = machine->read_reg(20);
+    word dst = machine->read_reg(21);
+    EXPECT_EQ (machine->read_reg(22), src + 1) << "memset returns the destination";
+    EXPECT_EQ (machine->read_reg(23), 301);
+    EXPECT_EQ (machine->read_reg(24), dst) << "strcpy returns the destination";
+    EXPECT_EQ (machine->read_reg(25), 301);
+    EXPECT_EQ (machine->read_reg(26), 0);
+    EXPECT_EQ (machine->read_reg(27), 0x62) << "memmove copies overlapping ranges";
+    EXPECT_EQ (machine->read_reg(28), 0x61);
+}
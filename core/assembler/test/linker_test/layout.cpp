@@ -0,0 +1,25 @@
+#include "assembler_test/assembler_test.h"
+
+TEST_F (EmulatorFixture, layout_page_aligned)
+{
+    Process p ("-kp " + AEMU_PROJECT_ROOT_DIR +
+            "core/assembler/test/linker_test/src/page_aligned.basm "
+            "-ld " + AEMU_PROJECT_ROOT_DIR +
+            "core/assembler/test/linker_test/src/page_aligned.ld "
+            "-outdir " + AEMU_PROJECT_ROOT_DIR +
+            "core/assembler/test/linker_test/build");
+    ASSERT_TRUE (p.does_create_exe ());
+
+    ObjectFile exe (p.get_exe_file ());
+    ASSERT_EQ (exe.flags & BELF_FLAG_PAGE_ALIGNED, BELF_FLAG_PAGE_ALIGNED);
+    ASSERT_EQ (exe.rel_text.size (), 0);
+    for (ObjectFile::ProgramHeader& segment : exe.program_headers)
+    {
+        ASSERT_EQ (segment.file_offset % PAGE_SIZE, 0);
+    }
+
+    LoadExecutable loader(*machine, p.get_exe_file());
+    machine->run(MAX_INSTRUCTIONS);
+
+    ASSERT_EQ(machine->read_reg(0), 13);
+}
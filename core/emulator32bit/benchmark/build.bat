@@ -0,0 +1,19 @@
+@echo off
+REM This script configures and builds the emulator benchmarks and their dependencies
+
+REM Configure and install the util library
+cmake -S ../../util -B ../../util/build -G Ninja -DCMAKE_INSTALL_PREFIX="../../util/install"
+cmake --build ../../util/build --target install
+
+REM Configure and install the emulator32bit library
+cmake -S ../ ../build -G Ninja -DCMAKE_BUILD_TYPE=Release -DCMAKE_INSTALL_PREFIX="../install"
+cmake --build ../build --target install
+
+REM Configure and build the benchmarks
+cmake -S . -B build/benchmark -G Ninja -DCMAKE_BUILD_TYPE=Release -DCMAKE_PREFIX_PATH="../../util/install;../install"
+
+cmake --build build/benchmark
+
+if errorlevel 1 exit /B
+
+build\benchmark\emulator32bit_benchmarks.exe
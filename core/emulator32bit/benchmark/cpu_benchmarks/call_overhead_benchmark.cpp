@@ -0,0 +1,83 @@
+#include <emulator32bit_benchmark/emulator32bit_benchmark.h>
+
+#include <cstdio>
+#include <string>
+
+#define N_CALLS 1000000ULL
+#define FUNCTION 0x100
+#define N_SAVED 6                   /* x19 to x24, besides the frame pointer and link register */
+
+/*
+ * Calls a function that saves and restores fp, lr and six callee saved registers, once with a
+ * str/ldr per register and once with stp/stmdb and ldm/ldp.
+ */
+static void run_call_overhead(bool paired)
+{
+    Emulator32bit *emulator = new Emulator32bit(16, 0, {}, 0, 16);
+    SystemBus& bus = emulator->system_bus;
+
+    /* bl function; subs x0, x0, #1; b.ne loop; hlt */
+    bus.write_word(0, Emulator32bit::asm_format_b1(Emulator32bit::_op_bl, Emulator32bit::ConditionCode::AL,
+            FUNCTION / 4));
+    bus.write_word(4, Emulator32bit::asm_format_o(Emulator32bit::_op_sub, true, 0, 0, 1));
+    bus.write_word(8, Emulator32bit::asm_format_b1(Emulator32bit::_op_b, Emulator32bit::ConditionCode::NE, -2));
+    bus.write_word(12, Emulator32bit::asm_hlt());
+
+    const word saved_regs = ((1 << N_SAVED) - 1) << 19;
+    word address = FUNCTION;
+    int instructions = 0;
+    auto emit = [&](word instruction)
+    {
+        bus.write_word(address, instruction);
+        address += 4;
+        instructions++;
+    };
+
+    if (paired)
+    {
+        emit(Emulator32bit::asm_format_m3(Emulator32bit::_op_ldstp, false, FP, LINKR, SP, -8,
+                Emulator32bit::ADDR_PRE_INC));
+        emit(Emulator32bit::asm_format_m4(Emulator32bit::_op_ldstm, false, SP, true, true, saved_regs));
+        emit(Emulator32bit::asm_format_m4(Emulator32bit::_op_ldstm, true, SP, true, false, saved_regs));
+        emit(Emulator32bit::asm_format_m3(Emulator32bit::_op_ldstp, true, FP, LINKR, SP, 8,
+                Emulator32bit::ADDR_POST_INC));
+    }
+    else
+    {
+        static const int regs[] = {19, 20, 21, 22, 23, 24, FP, LINKR};
+        for (int i = N_SAVED + 1; i >= 0; i--)
+        {
+            emit(Emulator32bit::asm_format_m(Emulator32bit::_op_str, false, regs[i], SP, -4,
+                    Emulator32bit::ADDR_PRE_INC));
+        }
+        for (int i = 0; i < N_SAVED + 2; i++)
+        {
+            emit(Emulator32bit::asm_format_m(Emulator32bit::_op_ldr, false, regs[i], SP, 4,
+                    Emulator32bit::ADDR_POST_INC));
+        }
+    }
+    emit(Emulator32bit::asm_format_b2(Emulator32bit::_op_bx, Emulator32bit::ConditionCode::AL, LINKR));
+
+    emulator->write_reg(0, N_CALLS);
+    emulator->write_reg(SP, 16 * PAGE_SIZE);
+    emulator->set_pc(0);
+
+    double start = benchmark::now();
+    emulator->run(N_CALLS * (instructions + 3) + 1);
+    double elapsed = benchmark::now() - start;
+
+    std::string config = paired ? "stp/stm" : "str/ldr";
+    benchmark::report("call_overhead", config, elapsed / N_CALLS * 1e9, "ns/call");
+    if (emulator->read_reg(0) != 0 || emulator->read_reg(SP) != 16 * PAGE_SIZE)
+    {
+        printf("call_overhead: %s did not finish, x0 %u sp %u\n", config.c_str(), emulator->read_reg(0),
+                emulator->read_reg(SP));
+    }
+    delete emulator;
+}
+
+BENCHMARK(call_overhead)
+{
+    run_call_overhead(false);
+    run_call_overhead(true);
+}
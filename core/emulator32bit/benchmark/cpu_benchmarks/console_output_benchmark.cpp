@@ -0,0 +1,55 @@
+#include <emulator32bit_benchmark/emulator32bit_benchmark.h>
+
+#include <emulator32bit/uart.h>
+
+#include <cstdio>
+
+#define N_BYTES 4000000ULL
+#define LOOP_LENGTH 256
+
+/*
+ * A guest printing one byte per strb to the UART data register, against the host cost of
+ * writing the same bytes to an unbuffered stream one call at a time, which is what printing
+ * each message straight to stdio amounts to for a chatty program.
+ */
+BENCHMARK(console_output)
+{
+    Emulator32bit *emulator = new Emulator32bit(1, 0, {}, 0, 1);
+    for (word i = 0; i < LOOP_LENGTH; i++)
+    {
+        emulator->system_bus.write_word(4 * i, Emulator32bit::asm_format_m(Emulator32bit::_op_strb, false, 0, 1, 0,
+                Emulator32bit::ADDR_OFFSET));
+    }
+    emulator->system_bus.write_word(4 * LOOP_LENGTH, Emulator32bit::asm_format_b1(Emulator32bit::_op_b,
+            Emulator32bit::ConditionCode::AL, -LOOP_LENGTH));
+    emulator->write_reg(0, 'x');
+    emulator->write_reg(1, UART_BASE + UART_DATA);
+    emulator->set_pc(0);
+
+    FILE *output = tmpfile();
+    emulator->uart->set_output(output);
+    unsigned long long instructions = N_BYTES / LOOP_LENGTH * (LOOP_LENGTH + 1);
+    double start = benchmark::now();
+    emulator->run(instructions);
+    double uart = benchmark::now() - start;
+    long written = ftell(output);
+    delete emulator;
+    fclose(output);
+
+    output = tmpfile();
+    setvbuf(output, nullptr, _IONBF, 0);
+    start = benchmark::now();
+    for (unsigned long long i = 0; i < N_BYTES; i++)
+    {
+        fputc('x', output);
+    }
+    double unbuffered = benchmark::now() - start;
+    fclose(output);
+
+    benchmark::report("console_output", "uart", uart / N_BYTES * 1e9, "ns/byte");
+    benchmark::report("console_output", "unbuffered host writes", unbuffered / N_BYTES * 1e9, "ns/byte");
+    if ((unsigned long long) written != N_BYTES)
+    {
+        printf("console_output: wrote %ld bytes\n", written);
+    }
+}
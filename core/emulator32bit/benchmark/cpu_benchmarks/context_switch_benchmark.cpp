@@ -0,0 +1,59 @@
+#include <emulator32bit_benchmark/emulator32bit_benchmark.h>
+
+#include <emulator32bit/kernel/process.h>
+#include <emulator32bit/virtual_memory.h>
+
+#include <string>
+
+#define N_INSTRUCTIONS 20000000ULL
+#define N_PROCESSES 4
+
+/*
+ * Round robins processes that each loop at virtual address 0 of their own address space.
+ * A single process with the quantum as long as the run is the cost without switching.
+ */
+static void run_context_switch(int nprocesses, unsigned long long quantum)
+{
+    Emulator32bit *emulator = new Emulator32bit(16, 0, {}, 0, 16);
+    double elapsed;
+    unsigned long long switches;
+    unsigned long long tlb_misses;
+    {
+        ProcessScheduler scheduler(emulator, quantum);
+        for (int i = 0; i < nprocesses; i++)
+        {
+            Process *process = scheduler.spawn(0, PAGE_SIZE);
+            emulator->mmu->add_vpage(process->pid, 0, 1, true, true);
+            emulator->mmu->set_process(process->pid);
+            emulator->system_bus.write_word(0, Emulator32bit::asm_format_o(Emulator32bit::_op_add, false, 0, 0, 1));
+            emulator->system_bus.write_word(4, Emulator32bit::asm_format_b1(Emulator32bit::_op_b,
+                    Emulator32bit::ConditionCode::AL, -1));
+        }
+
+        scheduler.start();
+        emulator->mmu->reset_tlb_stats();
+        unsigned long long start_switches = scheduler.switches();
+        double start = benchmark::now();
+        emulator->run(N_INSTRUCTIONS);
+        elapsed = benchmark::now() - start;
+        switches = scheduler.switches() - start_switches;
+        tlb_misses = emulator->mmu->get_tlb_stats().misses;
+    }
+    delete emulator;
+
+    std::string config = std::to_string(nprocesses) + " processes, quantum " + std::to_string(quantum);
+    benchmark::report("context_switch", config, elapsed / N_INSTRUCTIONS * 1e9, "ns/instr");
+    if (nprocesses > 1)
+    {
+        benchmark::report("context_switch", config + " rate", switches / elapsed, "switches/s");
+        benchmark::report("context_switch", config + " tlb misses", (double) tlb_misses, "");
+    }
+}
+
+BENCHMARK(context_switch)
+{
+    run_context_switch(1, N_INSTRUCTIONS);
+    run_context_switch(N_PROCESSES, 10000);
+    run_context_switch(N_PROCESSES, 100);
+    run_context_switch(N_PROCESSES, 10);
+}
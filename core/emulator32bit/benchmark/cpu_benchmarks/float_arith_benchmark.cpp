@@ -0,0 +1,65 @@
+#include <emulator32bit_benchmark/emulator32bit_benchmark.h>
+
+#include <cstdio>
+#include <cstring>
+#include <string>
+
+#define N_ITERATIONS (1 << 22)
+
+static word float_bits(float f)
+{
+    word bits;
+    memcpy(&bits, &f, sizeof(bits));
+    return bits;
+}
+
+/*
+ * Guest multiply add loop x = x * a + b, with vmul/vadd on the host FPU against the same loop
+ * with integer mul/add, the cost floats had to be measured against before v* did anything.
+ */
+static void run_loop(bool vfp)
+{
+    Emulator32bit *emulator = new Emulator32bit(1, 0, {}, 0, 1);
+    SystemBus& bus = emulator->system_bus;
+
+    if (vfp)
+    {
+        bus.write_word(0, Emulator32bit::asm_format_f1(Emulator32bit::_op_vmul, 1, 1, 2));
+        bus.write_word(4, Emulator32bit::asm_format_f1(Emulator32bit::_op_vadd, 1, 1, 3));
+        emulator->write_reg(1, float_bits(0.0f));
+        emulator->write_reg(2, float_bits(0.9f));
+        emulator->write_reg(3, float_bits(0.1f));
+    }
+    else
+    {
+        bus.write_word(0, Emulator32bit::asm_format_o(Emulator32bit::_op_mul, false, 1, 1, 2, Emulator32bit::SHIFT_LSL, 0));
+        bus.write_word(4, Emulator32bit::asm_format_o(Emulator32bit::_op_add, false, 1, 1, 3, Emulator32bit::SHIFT_LSL, 0));
+        emulator->write_reg(1, 0);
+        emulator->write_reg(2, 9);
+        emulator->write_reg(3, 1);
+    }
+    bus.write_word(8, Emulator32bit::asm_format_o(Emulator32bit::_op_sub, true, 0, 0, 1));
+    bus.write_word(12, Emulator32bit::asm_format_b1(Emulator32bit::_op_b, Emulator32bit::ConditionCode::NE, -3));
+    bus.write_word(16, Emulator32bit::asm_hlt());
+    emulator->write_reg(0, N_ITERATIONS);
+    emulator->set_pc(0);
+
+    double start = benchmark::now();
+    emulator->run(4ULL * N_ITERATIONS);
+    double elapsed = benchmark::now() - start;
+
+    std::string config = vfp ? "vmul/vadd" : "mul/add";
+    benchmark::report("float_arith", config, 2.0 * N_ITERATIONS / elapsed / 1e6, "Mop/s");
+    if (emulator->read_reg(0) != 0 || (vfp && emulator->read_reg(1) < float_bits(0.99f)))
+    {
+        printf("float_arith: %s stopped at %u, x1 %08x\n", config.c_str(), emulator->read_reg(0),
+                emulator->read_reg(1));
+    }
+    delete emulator;
+}
+
+BENCHMARK(float_arith)
+{
+    run_loop(false);
+    run_loop(true);
+}
@@ -0,0 +1,74 @@
+#include <emulator32bit_benchmark/emulator32bit_benchmark.h>
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#define STRING_LENGTH (1 << 20)
+#define STRING_START PAGE_SIZE
+#define RAM_NPAGES ((STRING_LENGTH >> PAGE_PSIZE) + 4)
+#define N_RUNS 5
+
+/*
+ * Guest strlen over a 1 MiB string, a byte at a time with ldrb against a word at a time with
+ * cmeq8 finding the terminator and rbit/clz locating it in the word.
+ */
+static void run_strlen(bool packed)
+{
+    Emulator32bit *emulator = new Emulator32bit(RAM_NPAGES, 0, {}, 0, RAM_NPAGES);
+    SystemBus& bus = emulator->system_bus;
+
+    std::vector<byte> string(STRING_LENGTH + 4, 'a');
+    string[STRING_LENGTH] = '\0';
+    bus.write_buffer(STRING_START, string.data(), string.size());
+
+    if (packed)
+    {
+        bus.write_word(0, Emulator32bit::asm_format_m(Emulator32bit::_op_ldr, false, 2, 0, 4,
+                Emulator32bit::ADDR_POST_INC));
+        bus.write_word(4, Emulator32bit::asm_format_p(Emulator32bit::_op_packed, Emulator32bit::PACKED_CMEQ8,
+                3, 2, XZR));
+        bus.write_word(8, Emulator32bit::asm_format_o(Emulator32bit::_op_add, true, XZR, 3, 0));
+        bus.write_word(12, Emulator32bit::asm_format_b1(Emulator32bit::_op_b, Emulator32bit::ConditionCode::EQ, -3));
+        bus.write_word(16, Emulator32bit::asm_format_o3(Emulator32bit::_op_rbit, false, 3, 3, 0));
+        bus.write_word(20, Emulator32bit::asm_format_o3(Emulator32bit::_op_clz, false, 3, 3, 0));
+        bus.write_word(24, Emulator32bit::asm_hlt());
+    }
+    else
+    {
+        bus.write_word(0, Emulator32bit::asm_format_m(Emulator32bit::_op_ldrb, false, 2, 0, 1,
+                Emulator32bit::ADDR_POST_INC));
+        bus.write_word(4, Emulator32bit::asm_format_o(Emulator32bit::_op_add, true, XZR, 2, 0));
+        bus.write_word(8, Emulator32bit::asm_format_b1(Emulator32bit::_op_b, Emulator32bit::ConditionCode::NE, -2));
+        bus.write_word(12, Emulator32bit::asm_hlt());
+    }
+
+    word length = 0;
+    double elapsed = 0;
+    for (int run = 0; run < N_RUNS; run++)
+    {
+        emulator->write_reg(0, STRING_START);
+        emulator->set_pc(0);
+
+        double start = benchmark::now();
+        emulator->run(4ULL * STRING_LENGTH);
+        elapsed += benchmark::now() - start;
+
+        length = packed ? emulator->read_reg(0) - STRING_START - 4 + emulator->read_reg(3) / 8
+                        : emulator->read_reg(0) - STRING_START - 1;
+    }
+
+    std::string config = packed ? "cmeq8" : "ldrb";
+    benchmark::report("packed_strlen", config, (double) STRING_LENGTH * N_RUNS / elapsed / (1 << 20), "MiB/s");
+    if (length != STRING_LENGTH)
+    {
+        printf("packed_strlen: %s measured %u bytes\n", config.c_str(), length);
+    }
+    delete emulator;
+}
+
+BENCHMARK(packed_strlen)
+{
+    run_strlen(false);
+    run_strlen(true);
+}
@@ -0,0 +1,55 @@
+#include <emulator32bit_benchmark/emulator32bit_benchmark.h>
+
+#include <emulator32bit/timer.h>
+
+#include <string>
+
+#define N_INSTRUCTIONS 50000000ULL
+#define VECTOR_TABLE 0x100
+#define TIMER_HANDLER 0x200
+
+/*
+ * Runs a two instruction loop with the timer off and at a few periods. The run loop only stops
+ * at scheduled deadlines, so the cost per instruction should not move with the timer off.
+ */
+static void run_timer_interrupt(unsigned long long period)
+{
+    Emulator32bit *emulator = new Emulator32bit(1, 0, {}, 0, 1);
+    emulator->system_bus.write_word(0, Emulator32bit::asm_format_o(Emulator32bit::_op_add, false, 0, 0, 1));
+    emulator->system_bus.write_word(4, Emulator32bit::asm_format_b1(Emulator32bit::_op_b,
+            Emulator32bit::ConditionCode::AL, -1));
+
+    word timer_vector = VECTOR_TABLE + Emulator32bit::TIMER * 4;
+    emulator->system_bus.write_word(timer_vector, Emulator32bit::asm_format_b1(Emulator32bit::_op_b,
+            Emulator32bit::ConditionCode::AL, (TIMER_HANDLER - timer_vector) / 4));
+    emulator->system_bus.write_word(TIMER_HANDLER, Emulator32bit::asm_format_o(Emulator32bit::_op_add, false, NR, XZR, 139));
+    emulator->system_bus.write_word(TIMER_HANDLER + 4, Emulator32bit::asm_format_b1(Emulator32bit::_op_swi,
+            Emulator32bit::ConditionCode::AL, 0));
+    emulator->set_vector_table(VECTOR_TABLE);
+    emulator->set_pc(0);
+
+    if (period > 0)
+    {
+        emulator->timer->start(period);
+    }
+
+    double start = benchmark::now();
+    emulator->run(N_INSTRUCTIONS);
+    double elapsed = benchmark::now() - start;
+
+    std::string config = period > 0 ? "timer every " + std::to_string(period) : "timer off";
+    benchmark::report("timer_interrupt", config, elapsed / N_INSTRUCTIONS * 1e9, "ns/instr");
+    if (period > 0)
+    {
+        benchmark::report("timer_interrupt", config + " interrupts", (double) emulator->timer->time(), "");
+    }
+
+    delete emulator;
+}
+
+BENCHMARK(timer_interrupt)
+{
+    run_timer_interrupt(0);
+    run_timer_interrupt(100000);
+    run_timer_interrupt(1000);
+}
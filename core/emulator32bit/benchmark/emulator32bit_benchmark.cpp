@@ -0,0 +1,126 @@
+/**
+ * @file
+ *
+ * Runs the registered emulator benchmarks. Pass benchmark names as arguments to only run those,
+ * otherwise every benchmark is ran.
+ *
+ * Global operator new/delete are replaced to count host heap usage so benchmarks can report the
+ * memory overhead of the emulator alongside timings.
+ */
+
+#include <emulator32bit_benchmark/emulator32bit_benchmark.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <utility>
+#include <vector>
+
+static size_t heap_in_use = 0;
+static size_t heap_peak = 0;
+
+/* Allocations are prefixed with their size so frees can be accounted for. */
+static constexpr size_t HEAP_HEADER_SIZE = alignof(std::max_align_t);
+
+void* operator new(size_t size)
+{
+    byte *block = (byte*) std::malloc(size + HEAP_HEADER_SIZE);
+    if (block == nullptr)
+    {
+        throw std::bad_alloc();
+    }
+
+    *((size_t*) block) = size;
+    heap_in_use += size;
+    if (heap_in_use > heap_peak)
+    {
+        heap_peak = heap_in_use;
+    }
+    return block + HEAP_HEADER_SIZE;
+}
+
+void operator delete(void *ptr) noexcept
+{
+    if (ptr == nullptr)
+    {
+        return;
+    }
+
+    byte *block = ((byte*) ptr) - HEAP_HEADER_SIZE;
+    heap_in_use -= *((size_t*) block);
+    std::free(block);
+}
+
+void* operator new[](size_t size)
+{
+    return operator new(size);
+}
+
+void operator delete[](void *ptr) noexcept
+{
+    operator delete(ptr);
+}
+
+void operator delete(void *ptr, size_t size) noexcept
+{
+    (void) size;
+    operator delete(ptr);
+}
+
+void operator delete[](void *ptr, size_t size) noexcept
+{
+    (void) size;
+    operator delete(ptr);
+}
+
+static std::vector<std::pair<std::string, benchmark::BenchmarkFunction>>& benchmarks()
+{
+    static std::vector<std::pair<std::string, benchmark::BenchmarkFunction>> registered;
+    return registered;
+}
+
+bool benchmark::register_benchmark(const std::string& name, BenchmarkFunction function)
+{
+    benchmarks().push_back(std::make_pair(name, function));
+    return true;
+}
+
+size_t benchmark::heap_bytes_in_use()
+{
+    return heap_in_use;
+}
+
+size_t benchmark::heap_bytes_peak()
+{
+    return heap_peak;
+}
+
+void benchmark::reset_heap_peak()
+{
+    heap_peak = heap_in_use;
+}
+
+void benchmark::report(const std::string& benchmark, const std::string& metric, double value,
+                       const std::string& unit)
+{
+    printf("%-32s %-40s %16.2f %s\n", benchmark.c_str(), metric.c_str(), value, unit.c_str());
+}
+
+int main(int argc, char **argv)
+{
+    for (std::pair<std::string, benchmark::BenchmarkFunction>& registered : benchmarks())
+    {
+        bool selected = argc <= 1;
+        for (int i = 1; i < argc; i++)
+        {
+            selected |= registered.first == argv[i];
+        }
+
+        if (selected)
+        {
+            registered.second();
+        }
+    }
+
+    return 0;
+}
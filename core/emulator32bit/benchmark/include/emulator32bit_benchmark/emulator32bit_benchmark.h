@@ -0,0 +1,67 @@
+#pragma once
+#ifndef EMULATOR32BITBENCHMARK_H
+#define EMULATOR32BITBENCHMARK_H
+
+#include <emulator32bit/emulator32bit.h>
+#include <emulator32bit/emulator32bit_util.h>
+
+#include <chrono>
+#include <cstddef>
+#include <string>
+
+namespace benchmark
+{
+    typedef void (*BenchmarkFunction)();
+
+    /**
+     * @brief             Registers a benchmark to be ran by the benchmark main.
+     *
+     * @param             name: Name the benchmark is reported and selected by.
+     * @param             function: Benchmark body.
+     * @return            Always true, so registration can happen during static initialization.
+     */
+    bool register_benchmark(const std::string& name, BenchmarkFunction function);
+
+    /**
+     * @brief             Host heap bytes currently allocated through operator new.
+     */
+    size_t heap_bytes_in_use();
+
+    /**
+     * @brief             Highest value @ref heap_bytes_in_use reached since the last call to
+     *                     @ref reset_heap_peak.
+     */
+    size_t heap_bytes_peak();
+
+    /**
+     * @brief             Resets the peak heap usage to the current heap usage.
+     */
+    void reset_heap_peak();
+
+    /**
+     * @brief             Prints a single result line of a benchmark.
+     *
+     * @param             benchmark: Name of the benchmark.
+     * @param             metric: What was measured.
+     * @param             value: Measured value.
+     * @param             unit: Unit of the measured value.
+     */
+    void report(const std::string& benchmark, const std::string& metric, double value,
+                const std::string& unit);
+
+    /**
+     * @brief             Wall clock time in seconds since an arbitrary point.
+     */
+    inline double now()
+    {
+        return std::chrono::duration<double>(
+                std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+}
+
+#define BENCHMARK(name) \
+    static void benchmark_##name(); \
+    static const bool benchmark_registered_##name = benchmark::register_benchmark(#name, benchmark_##name); \
+    static void benchmark_##name()
+
+#endif /* EMULATOR32BITBENCHMARK_H */
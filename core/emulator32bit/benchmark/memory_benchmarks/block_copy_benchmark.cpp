@@ -0,0 +1,79 @@
+#include <emulator32bit_benchmark/emulator32bit_benchmark.h>
+
+#include <cstdio>
+#include <string>
+
+#define BLOCK_LENGTH (1 << 20)
+#define SRC_START PAGE_SIZE
+#define DST_START (SRC_START + BLOCK_LENGTH)
+#define RAM_NPAGES ((2 * BLOCK_LENGTH >> PAGE_PSIZE) + 4)
+#define N_RUNS 5
+
+/*
+ * Guest memcpy and memset of 1 MiB, a word at a time with ldr/str against the cpy and set block
+ * instructions, which move a page per host memcpy or memset.
+ */
+static void run_block(bool fill, bool block)
+{
+    Emulator32bit *emulator = new Emulator32bit(RAM_NPAGES, 0, {}, 0, RAM_NPAGES);
+    SystemBus& bus = emulator->system_bus;
+    for (word offset = 0; offset < BLOCK_LENGTH; offset += 4)
+    {
+        bus.write_word(SRC_START + offset, offset);
+    }
+
+    if (block)
+    {
+        bus.write_word(0, Emulator32bit::asm_format_m5(Emulator32bit::_op_mops, fill, 0, fill ? 3 : 1, 2));
+        bus.write_word(4, Emulator32bit::asm_hlt());
+    }
+    else if (fill)
+    {
+        bus.write_word(0, Emulator32bit::asm_format_m(Emulator32bit::_op_str, false, 3, 0, 4,
+                Emulator32bit::ADDR_POST_INC));
+        bus.write_word(4, Emulator32bit::asm_format_o(Emulator32bit::_op_sub, true, 2, 2, 4));
+        bus.write_word(8, Emulator32bit::asm_format_b1(Emulator32bit::_op_b, Emulator32bit::ConditionCode::NE, -2));
+        bus.write_word(12, Emulator32bit::asm_hlt());
+    }
+    else
+    {
+        bus.write_word(0, Emulator32bit::asm_format_m(Emulator32bit::_op_ldr, false, 3, 1, 4,
+                Emulator32bit::ADDR_POST_INC));
+        bus.write_word(4, Emulator32bit::asm_format_m(Emulator32bit::_op_str, false, 3, 0, 4,
+                Emulator32bit::ADDR_POST_INC));
+        bus.write_word(8, Emulator32bit::asm_format_o(Emulator32bit::_op_sub, true, 2, 2, 4));
+        bus.write_word(12, Emulator32bit::asm_format_b1(Emulator32bit::_op_b, Emulator32bit::ConditionCode::NE, -3));
+        bus.write_word(16, Emulator32bit::asm_hlt());
+    }
+
+    double elapsed = 0;
+    for (int run = 0; run < N_RUNS; run++)
+    {
+        emulator->write_reg(0, DST_START);
+        emulator->write_reg(1, SRC_START);
+        emulator->write_reg(2, BLOCK_LENGTH);
+        emulator->write_reg(3, 0x5A5A5A5A);
+        emulator->set_pc(0);
+
+        double start = benchmark::now();
+        emulator->run(BLOCK_LENGTH);
+        elapsed += benchmark::now() - start;
+    }
+
+    std::string config = std::string(fill ? "memset " : "memcpy ") + (block ? (fill ? "set" : "cpy") : "ldr/str loop");
+    benchmark::report("block_copy", config, (double) BLOCK_LENGTH * N_RUNS / elapsed / (1 << 20), "MiB/s");
+    word last = bus.read_word(DST_START + BLOCK_LENGTH - 4);
+    if (last != (fill ? 0x5A5A5A5A : BLOCK_LENGTH - 4) || emulator->read_reg(2) != 0)
+    {
+        printf("block_copy: %s left %u bytes, last word %u\n", config.c_str(), emulator->read_reg(2), last);
+    }
+    delete emulator;
+}
+
+BENCHMARK(block_copy)
+{
+    run_block(false, false);
+    run_block(false, true);
+    run_block(true, false);
+    run_block(true, true);
+}
@@ -0,0 +1,61 @@
+#include <emulator32bit_benchmark/emulator32bit_benchmark.h>
+
+#include <emulator32bit/dma.h>
+
+#include <cstdio>
+
+#define DISK_NAME "dma_transfer_benchmark_disk"
+#define DISK_FILE DISK_NAME ".bin"
+#define TRANSFER_PAGES 256
+#define RAM_NPAGES (TRANSFER_PAGES + 16)
+#define DISK_START (RAM_NPAGES << PAGE_PSIZE)
+#define N_TRANSFERS 20
+
+/*
+ * Copies a run of disk pages into RAM with the DMA controller, against the word at a time
+ * ldr/str loop a guest used before, where every load goes through the disk's cache lookup.
+ */
+BENCHMARK(dma_transfer)
+{
+    static const byte rom_data[1] = {0};
+    const word length = TRANSFER_PAGES * PAGE_SIZE;
+    RAM *ram = new RAM(RAM_NPAGES, 0);
+    ROM *rom = new ROM(rom_data, 0, RAM_NPAGES);
+    Disk *disk = new Disk(File(DISK_NAME, "bin", "", true), TRANSFER_PAGES, RAM_NPAGES);
+    Emulator32bit *emulator = new Emulator32bit(ram, rom, disk);
+    SystemBus& bus = emulator->system_bus;
+
+    bus.write_word(DMA_BASE + DMA_SRC, DISK_START);
+    bus.write_word(DMA_BASE + DMA_DST, 0);
+    bus.write_word(DMA_BASE + DMA_LEN, length);
+
+    double start = benchmark::now();
+    for (int i = 0; i < N_TRANSFERS; i++)
+    {
+        bus.write_word(DMA_BASE + DMA_CTRL, DMA_CTRL_START);
+    }
+    double dma = benchmark::now() - start;
+
+    word checksum = 0;
+    start = benchmark::now();
+    for (int i = 0; i < N_TRANSFERS; i++)
+    {
+        for (word offset = 0; offset < length; offset += 4)
+        {
+            bus.write_word(offset, bus.read_word(DISK_START + offset));
+        }
+        checksum += bus.read_word(length - 4);
+    }
+    double loop = benchmark::now() - start;
+
+    benchmark::report("dma_transfer", "dma", (double) length * N_TRANSFERS / dma / (1 << 20), "MiB/s");
+    benchmark::report("dma_transfer", "ldr/str loop", (double) length * N_TRANSFERS / loop / (1 << 20), "MiB/s");
+    if (bus.read_word(DMA_BASE + DMA_STATUS) != DMA_STATUS_DONE || checksum != 0)
+    {
+        printf("dma_transfer: status %u checksum %u\n", bus.read_word(DMA_BASE + DMA_STATUS), checksum);
+    }
+
+    delete emulator;
+    std::remove(DISK_FILE);
+    std::remove(DISK_FILE ".info");
+}
@@ -0,0 +1,73 @@
+#include <emulator32bit_benchmark/emulator32bit_benchmark.h>
+
+#include <emulator32bit/kernel/file_io.h>
+
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+/* Host files are POSIX only, see @ref FileManager */
+#ifndef _WIN32
+#include <fcntl.h>
+
+#define SANDBOX "file_read_benchmark_sandbox"
+#define FILE_PAGES 1024
+#define BUFFER_ADDRESS 0x100000
+#define N_READS 20
+
+/*
+ * Reads a file into guest memory with the read syscall, straight into the pinned guest pages,
+ * against reading it into a host buffer and copying that in a byte at a time, which is all a
+ * guest could do before.
+ */
+BENCHMARK(file_read)
+{
+    const word length = FILE_PAGES * PAGE_SIZE;
+    std::filesystem::create_directory(SANDBOX);
+    std::ofstream(SANDBOX "/input.bin", std::ios::binary) << std::string(length, 'x');
+
+    Emulator32bit *emulator = new Emulator32bit(FILE_PAGES + 512, 0, {}, 0, FILE_PAGES + 512);
+    long long pid = emulator->mmu->begin_process();
+    emulator->mmu->add_vpage(pid, 1, 1, true, false);
+    emulator->mmu->add_vpage(pid, BUFFER_ADDRESS >> PAGE_PSIZE, FILE_PAGES, true, false);
+    emulator->file_manager->set_root(SANDBOX);
+    emulator->system_bus.write_buffer(PAGE_SIZE, (const byte*) "input.bin", 10);
+    word fd = emulator->file_manager->openat(GUEST_AT_FDCWD, PAGE_SIZE, O_RDONLY, 0);
+
+    double start = benchmark::now();
+    word read = 0;
+    for (int i = 0; i < N_READS; i++)
+    {
+        emulator->file_manager->lseek(fd, 0, SEEK_SET);
+        read += emulator->file_manager->read(fd, BUFFER_ADDRESS, length);
+    }
+    double direct = benchmark::now() - start;
+
+    std::vector<byte> staging(length);
+    start = benchmark::now();
+    for (int i = 0; i < N_READS; i++)
+    {
+        FILE *file = fopen(SANDBOX "/input.bin", "rb");
+        read += fread(staging.data(), 1, length, file);
+        fclose(file);
+        for (word j = 0; j < length; j++)
+        {
+            emulator->system_bus.write_byte(BUFFER_ADDRESS + j, staging[j]);
+        }
+    }
+    double staged = benchmark::now() - start;
+
+    benchmark::report("file_read", "read syscall", (double) length * N_READS / direct / (1 << 20), "MiB/s");
+    benchmark::report("file_read", "staged byte copy", (double) length * N_READS / staged / (1 << 20), "MiB/s");
+    if (read != 2ULL * N_READS * length)
+    {
+        printf("file_read: read %u bytes\n", read);
+    }
+
+    emulator->mmu->end_process(pid);
+    delete emulator;
+    std::filesystem::remove_all(SANDBOX);
+}
+#endif
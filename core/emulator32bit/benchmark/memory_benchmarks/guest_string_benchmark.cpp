@@ -0,0 +1,53 @@
+#include <emulator32bit_benchmark/emulator32bit_benchmark.h>
+
+#include <string>
+
+#define STRING_LENGTH 4000
+#define N_READS 2000
+
+/*
+ * Reads a guest string spanning two pages the way emu_log used to, two translated byte
+ * reads per character, and with the bulk read_cstring that translates once per page.
+ */
+BENCHMARK(guest_string)
+{
+    Emulator32bit *emulator = new Emulator32bit(16, 0, {}, 0, 16);
+    long long pid = emulator->mmu->begin_process();
+    emulator->mmu->add_vpage(pid, 1, 2, true, false);
+
+    std::string msg(STRING_LENGTH, 'a');
+    const word address = 2 * PAGE_SIZE - STRING_LENGTH / 2;
+    emulator->system_bus.write_buffer(address, (const byte*) msg.c_str(), msg.size() + 1);
+
+    size_t total = 0;
+    double start = benchmark::now();
+    for (int i = 0; i < N_READS; i++)
+    {
+        std::string str;
+        word c = address;
+        while (emulator->system_bus.read_byte(c) != '\0')
+        {
+            str += (char) emulator->system_bus.read_byte(c);
+            c++;
+        }
+        total += str.size();
+    }
+    double bytewise = benchmark::now() - start;
+
+    start = benchmark::now();
+    for (int i = 0; i < N_READS; i++)
+    {
+        total += emulator->system_bus.read_cstring(address).size();
+    }
+    double bulk = benchmark::now() - start;
+
+    benchmark::report("guest_string", "byte reads", bytewise / N_READS / STRING_LENGTH * 1e9, "ns/char");
+    benchmark::report("guest_string", "read_cstring", bulk / N_READS / STRING_LENGTH * 1e9, "ns/char");
+    if (total != 2ULL * N_READS * STRING_LENGTH)
+    {
+        printf("guest_string: read %zu characters\n", total);
+    }
+
+    emulator->mmu->end_process(pid);
+    delete emulator;
+}
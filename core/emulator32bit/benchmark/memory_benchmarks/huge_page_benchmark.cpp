@@ -0,0 +1,69 @@
+#include <emulator32bit_benchmark/emulator32bit_benchmark.h>
+
+#include <cstdio>
+#include <string>
+
+#define HEAP_NPAGES HUGE_PAGE_NPAGES
+#define HEAP_VPAGE HUGE_PAGE_NPAGES
+#define N_SWEEPS 50
+#define TLB_NENTRIES 64
+#define TLB_NWAYS 4
+
+/*
+ * Sweeps a 4 MiB heap one word per page with a TLB the size of a hardware L1 TLB. With 4 KiB
+ * pages every access misses and walks the page table, a huge page covers the heap with one entry.
+ */
+static void run_heap_sweep(bool huge)
+{
+    Emulator32bit *emulator = new Emulator32bit(HEAP_NPAGES + 16, 0, {}, 0, HEAP_NPAGES + 16);
+    VirtualMemory *mmu = emulator->mmu;
+    mmu->configure_tlb(TLB_NENTRIES, TLB_NWAYS);
+    long long pid = mmu->begin_process();
+
+    if (huge)
+    {
+        mmu->add_huge_vpage(pid, HEAP_VPAGE, true, false);
+    }
+    else
+    {
+        mmu->add_vpage(pid, HEAP_VPAGE, HEAP_NPAGES, true, false);
+    }
+
+    for (word vpage = 0; vpage < HEAP_NPAGES; vpage++)
+    {
+        emulator->system_bus.write_word((HEAP_VPAGE + vpage) << PAGE_PSIZE, vpage);
+    }
+
+    mmu->reset_tlb_stats();
+    word checksum = 0;
+    double start = benchmark::now();
+    for (int sweep = 0; sweep < N_SWEEPS; sweep++)
+    {
+        for (word vpage = 0; vpage < HEAP_NPAGES; vpage++)
+        {
+            checksum += emulator->system_bus.read_word((HEAP_VPAGE + vpage) << PAGE_PSIZE);
+        }
+    }
+    double elapsed = benchmark::now() - start;
+
+    const VirtualMemory::TLB_Stats& stats = mmu->get_tlb_stats();
+    std::string config = huge ? "huge page " : "4 KiB pages ";
+    benchmark::report("huge_page", config + "miss rate",
+            100.0 * stats.misses / (stats.hits + stats.misses), "%");
+    benchmark::report("huge_page", config + "translation",
+            elapsed / ((double) N_SWEEPS * HEAP_NPAGES) * 1e9, "ns");
+
+    if (checksum != N_SWEEPS * (HEAP_NPAGES * (HEAP_NPAGES - 1) / 2))
+    {
+        printf("huge_page: bad checksum %u\n", checksum);
+    }
+
+    mmu->end_process(pid);
+    delete emulator;
+}
+
+BENCHMARK(huge_page)
+{
+    run_heap_sweep(false);
+    run_heap_sweep(true);
+}
@@ -0,0 +1,69 @@
+#include <emulator32bit_benchmark/emulator32bit_benchmark.h>
+
+#include <vector>
+
+#define N_INSTANCES 64
+
+/*
+ * Host memory and construction time of an emulator instance with a small amount of installed
+ * memory. Virtual memory bookkeeping should scale with the installed pages, not the full 32 bit
+ * physical address space.
+ */
+BENCHMARK(instance_overhead)
+{
+    const word ram_npages = 16;
+    const word rom_npages = 16;
+    std::vector<byte> rom_data(rom_npages << PAGE_PSIZE);
+
+    /* memory backing the emulated RAM/ROM itself, which is not overhead */
+    const double installed = (double) ((ram_npages + rom_npages) << PAGE_PSIZE);
+
+    std::vector<Emulator32bit*> emulators;
+    emulators.reserve(N_INSTANCES);
+
+    size_t heap_before = benchmark::heap_bytes_in_use();
+    benchmark::reset_heap_peak();
+    double start = benchmark::now();
+    for (int i = 0; i < N_INSTANCES; i++)
+    {
+        emulators.push_back(new Emulator32bit(ram_npages, 0, rom_data.data(), rom_npages, ram_npages));
+    }
+    double elapsed = benchmark::now() - start;
+    size_t heap_after = benchmark::heap_bytes_in_use();
+
+    double per_instance = (double) (heap_after - heap_before) / N_INSTANCES;
+    benchmark::report("instance_overhead", "heap per instance", per_instance, "bytes");
+    benchmark::report("instance_overhead", "heap per instance excluding RAM/ROM",
+            per_instance - installed, "bytes");
+    benchmark::report("instance_overhead", "construction time per instance",
+            elapsed / N_INSTANCES * 1e6, "us");
+
+    /* includes the virtual memory bookkeeping of a running process */
+    start = benchmark::now();
+    for (Emulator32bit *emulator : emulators)
+    {
+        emulator->mmu->begin_process();
+        emulator->mmu->add_vpage(emulator->mmu->current_process(), 0, ram_npages, true, true);
+        for (word vpage = 0; vpage < ram_npages; vpage++)
+        {
+            emulator->system_bus.write_word(vpage << PAGE_PSIZE, vpage);
+        }
+    }
+    elapsed = benchmark::now() - start;
+    benchmark::report("instance_overhead", "heap per instance with mapped process",
+            (double) (benchmark::heap_bytes_in_use() - heap_before) / N_INSTANCES, "bytes");
+    benchmark::report("instance_overhead", "process setup time per instance",
+            elapsed / N_INSTANCES * 1e6, "us");
+
+    start = benchmark::now();
+    for (Emulator32bit *emulator : emulators)
+    {
+        emulator->mmu->end_process(emulator->mmu->current_process());
+        delete emulator;
+    }
+    elapsed = benchmark::now() - start;
+    benchmark::report("instance_overhead", "destruction time per instance",
+            elapsed / N_INSTANCES * 1e6, "us");
+    benchmark::report("instance_overhead", "heap leaked per instance",
+            (double) (benchmark::heap_bytes_in_use() - heap_before) / N_INSTANCES, "bytes");
+}
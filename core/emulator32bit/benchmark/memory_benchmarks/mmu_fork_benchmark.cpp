@@ -0,0 +1,74 @@
+#include <emulator32bit_benchmark/emulator32bit_benchmark.h>
+
+#include <emulator32bit/kernel/better_virtual_memory.h>
+
+#include <cstdio>
+
+/* Physical page 0 is left out so it is never the null page directory. */
+#define KERNEL_NPAGES 64
+#define USER_LOW_PAGE (KERNEL_NPAGES + 1)
+#define USER_NPAGES 512
+#define PROCESS_NPAGES 256
+#define VPAGE_BASE 0x10000
+#define N_FORKS 2000
+
+/*
+ * Shell like spawning, a process forks and the child writes to a few pages before exiting.
+ * With copy on write only the written pages are copied, eagerly copying the address space
+ * would copy every resident page.
+ */
+static void run_mmu_fork(word child_writes)
+{
+    static const byte rom_data[1] = {0};
+    RAM *ram = new RAM(USER_LOW_PAGE + USER_NPAGES, 0);
+    ROM *rom = new ROM(rom_data, 0, USER_LOW_PAGE + USER_NPAGES);
+    Emulator32bit *emulator = new Emulator32bit(ram, rom, new MockDisk());
+
+    MMU *mmu = new MMU(emulator, USER_LOW_PAGE, USER_LOW_PAGE + USER_NPAGES - 1,
+            1, KERNEL_NPAGES);
+    mmu->create_pagedir();
+    word parent = emulator->_pagedir;
+
+    for (word i = 0; i < PROCESS_NPAGES; i++)
+    {
+        mmu->add_vpage(VPAGE_BASE + i, false, true, false, false);
+        ram->write_word(mmu->map_address((VPAGE_BASE + i) << PAGE_PSIZE, MMU::WRITE_ACCESSMODE), i);
+    }
+
+    unsigned long long copies = mmu->get_stats().cow_copies;
+    double start = benchmark::now();
+    for (int fork = 0; fork < N_FORKS; fork++)
+    {
+        emulator->_pagedir = parent;
+        emulator->_pagedir = mmu->fork_pagedir();
+        for (word i = 0; i < child_writes; i++)
+        {
+            ram->write_word(mmu->map_address((VPAGE_BASE + i) << PAGE_PSIZE, MMU::WRITE_ACCESSMODE), fork);
+        }
+        mmu->remove_pagedir();
+    }
+    double elapsed = benchmark::now() - start;
+
+    std::string config = std::to_string(child_writes) + " of " + std::to_string(PROCESS_NPAGES) +
+            " pages written ";
+    benchmark::report("mmu_fork", config + "fork and exit", elapsed / N_FORKS * 1e6, "us");
+    benchmark::report("mmu_fork", config + "pages copied per fork",
+            (double) (mmu->get_stats().cow_copies - copies) / N_FORKS, "");
+
+    emulator->_pagedir = parent;
+    if (ram->read_word(mmu->map_address(VPAGE_BASE << PAGE_PSIZE, MMU::READ_ACCESSMODE)) != 0)
+    {
+        printf("mmu_fork: child write leaked into the parent\n");
+    }
+
+    mmu->remove_pagedir();
+    delete mmu;
+    delete emulator;
+}
+
+BENCHMARK(mmu_fork)
+{
+    run_mmu_fork(0);
+    run_mmu_fork(8);
+    run_mmu_fork(PROCESS_NPAGES);
+}
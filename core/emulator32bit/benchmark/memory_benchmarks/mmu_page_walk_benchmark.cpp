@@ -0,0 +1,83 @@
+#include <emulator32bit_benchmark/emulator32bit_benchmark.h>
+
+#include <emulator32bit/kernel/better_virtual_memory.h>
+
+#include <cstdio>
+
+/* Physical page 0 is left out so it is never the null page directory. */
+#define KERNEL_NPAGES 64
+#define USER_LOW_PAGE (KERNEL_NPAGES + 1)
+#define USER_NPAGES 256
+#define VPAGE_BASE 0x10000
+#define N_ROUNDS 20000
+
+/*
+ * Translates resident pages spread over a number of 4 MiB regions, like a process with code,
+ * heap and stack far apart. Every region costs one page table, so the page walk cache hit
+ * rate drops once the regions outnumber its entries.
+ */
+static void run_mmu_page_walk(word nregions)
+{
+    static const byte rom_data[1] = {0};
+    RAM *ram = new RAM(USER_LOW_PAGE + USER_NPAGES, 0);
+    ROM *rom = new ROM(rom_data, 0, USER_LOW_PAGE + USER_NPAGES);
+    Emulator32bit *emulator = new Emulator32bit(ram, rom, new MockDisk());
+
+    MMU *mmu = new MMU(emulator, USER_LOW_PAGE, USER_LOW_PAGE + USER_NPAGES - 1,
+            1, KERNEL_NPAGES);
+    mmu->create_pagedir();
+
+    const word pages_per_region = USER_NPAGES / nregions;
+    for (word region = 0; region < nregions; region++)
+    {
+        for (word i = 0; i < pages_per_region; i++)
+        {
+            word vpage = VPAGE_BASE + (region << 10) + i;
+            mmu->add_vpage(vpage, false, true, false, false);
+            ram->write_word(mmu->map_address(vpage << PAGE_PSIZE, MMU::WRITE_ACCESSMODE), vpage);
+        }
+    }
+
+    MMU::Stats before = mmu->get_stats();
+    word checksum = 0;
+    double start = benchmark::now();
+    for (int round = 0; round < N_ROUNDS; round++)
+    {
+        for (word i = 0; i < pages_per_region; i++)
+        {
+            for (word region = 0; region < nregions; region++)
+            {
+                word vpage = VPAGE_BASE + (region << 10) + i;
+                checksum += ram->read_word(mmu->map_address(vpage << PAGE_PSIZE, MMU::READ_ACCESSMODE));
+            }
+        }
+    }
+    double elapsed = benchmark::now() - start;
+
+    const MMU::Stats& stats = mmu->get_stats();
+    unsigned long long hits = stats.pwc_hits - before.pwc_hits;
+    unsigned long long misses = stats.pwc_misses - before.pwc_misses;
+    std::string config = std::to_string(nregions) + " regions ";
+    benchmark::report("mmu_page_walk", config + "translation",
+            elapsed / ((double) N_ROUNDS * pages_per_region * nregions) * 1e9, "ns");
+    benchmark::report("mmu_page_walk", config + "walk cache hit rate",
+            100.0 * hits / (hits + misses), "%");
+    benchmark::report("mmu_page_walk", config + "page table memory",
+            (double) (nregions + 1) * PAGE_SIZE, "bytes");
+
+    if (checksum == 0)
+    {
+        printf("mmu_page_walk: unexpected checksum\n");
+    }
+
+    mmu->remove_pagedir();
+    delete mmu;
+    delete emulator;
+}
+
+BENCHMARK(mmu_page_walk)
+{
+    run_mmu_page_walk(1);
+    run_mmu_page_walk(16);
+    run_mmu_page_walk(32);
+}
@@ -0,0 +1,92 @@
+#include <emulator32bit_benchmark/emulator32bit_benchmark.h>
+
+#include <emulator32bit/kernel/better_virtual_memory.h>
+
+#include <cstdio>
+#include <vector>
+
+/* Physical page 0 is left out so it is never the null page directory. */
+#define KERNEL_NPAGES 16
+#define USER_LOW_PAGE (KERNEL_NPAGES + 1)
+#define USER_NPAGES 256
+#define DISK_NPAGES 4096
+#define VPAGE_BASE 0x10000
+#define N_ACCESSES 1000000
+#define DISK_NAME "mmu_swap_benchmark_disk"
+#define DISK_FILE DISK_NAME ".bin"
+
+/*
+ * Runs a working set larger than the user physical pages through the MMU. Most accesses go
+ * to a hot fifth of the working set and a quarter of them are writes, so the CLOCK hand has
+ * both referenced pages to keep and clean pages to drop.
+ */
+static void run_mmu_swap(word working_set)
+{
+    static const byte rom_data[1] = {0};
+    RAM *ram = new RAM(USER_LOW_PAGE + USER_NPAGES, 0);
+    ROM *rom = new ROM(rom_data, 0, USER_LOW_PAGE + USER_NPAGES);
+    Disk *disk = new Disk(File(DISK_NAME, "bin", "", true), DISK_NPAGES, USER_LOW_PAGE + USER_NPAGES);
+    Emulator32bit *emulator = new Emulator32bit(ram, rom, disk);
+
+    MMU *mmu = new MMU(emulator, USER_LOW_PAGE, USER_LOW_PAGE + USER_NPAGES - 1,
+            1, KERNEL_NPAGES);
+    mmu->create_pagedir();
+
+    std::vector<word> expected(working_set);
+    for (word i = 0; i < working_set; i++)
+    {
+        mmu->add_vpage(VPAGE_BASE + i, false, true, false, false);
+        ram->write_word(mmu->map_address((VPAGE_BASE + i) << PAGE_PSIZE, MMU::WRITE_ACCESSMODE), i);
+        expected[i] = i;
+    }
+
+    MMU::Stats before = mmu->get_stats();
+    word seed = 12345;
+    word hot = working_set / 5;
+    word mismatches = 0;
+    double start = benchmark::now();
+    for (int access = 0; access < N_ACCESSES; access++)
+    {
+        seed = seed * 1103515245 + 12345;
+        word r = seed >> 8;
+        word vpage = (r & 0xF) < 13 ? (r >> 4) % hot : (r >> 4) % working_set;
+        word address = (VPAGE_BASE + vpage) << PAGE_PSIZE;
+
+        if ((r >> 20) < 4)
+        {
+            ram->write_word(mmu->map_address(address, MMU::WRITE_ACCESSMODE), ++expected[vpage]);
+        }
+        else if (ram->read_word(mmu->map_address(address, MMU::READ_ACCESSMODE)) != expected[vpage])
+        {
+            mismatches++;
+        }
+    }
+    double elapsed = benchmark::now() - start;
+
+    const MMU::Stats& stats = mmu->get_stats();
+    std::string config = std::to_string(working_set) + " pages over " +
+            std::to_string(USER_NPAGES) + " ";
+    benchmark::report("mmu_swap", config + "access", elapsed / N_ACCESSES * 1e9, "ns");
+    benchmark::report("mmu_swap", config + "fault rate",
+            100.0 * (stats.page_ins - before.page_ins) / N_ACCESSES, "%");
+    benchmark::report("mmu_swap", config + "evictions", (double) (stats.evictions - before.evictions), "");
+    benchmark::report("mmu_swap", config + "write backs",
+            (double) (stats.write_backs - before.write_backs), "");
+
+    if (mismatches != 0)
+    {
+        printf("mmu_swap: %u mismatched reads\n", mismatches);
+    }
+
+    mmu->remove_pagedir();
+    delete mmu;
+    delete emulator;
+    std::remove(DISK_FILE);
+    std::remove(DISK_FILE ".info");
+}
+
+BENCHMARK(mmu_swap)
+{
+    run_mmu_swap(USER_NPAGES * 3 / 2);
+    run_mmu_swap(USER_NPAGES * 4);
+}
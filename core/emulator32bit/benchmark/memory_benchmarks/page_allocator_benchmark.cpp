@@ -0,0 +1,66 @@
+#include <emulator32bit_benchmark/emulator32bit_benchmark.h>
+
+#include <emulator32bit/fbl.h>
+#include <emulator32bit/page_allocator.h>
+
+#include <string>
+#include <vector>
+
+#define N_OPERATIONS 200000
+
+/*
+ * Frees and allocates random single pages with every 8th page free, so the free pages are
+ * scattered. The free block list walks its holes on every free, the bitmap does not.
+ */
+template <typename Alloc, typename Free>
+static double run_churn(word npages, Alloc alloc, Free free)
+{
+    std::vector<word> pages;
+    for (word i = 0; i < npages; i++)
+    {
+        pages.push_back(alloc());
+    }
+
+    std::vector<word> used;
+    for (word i = 0; i < npages; i++)
+    {
+        if (i % 8 == 0)
+        {
+            free(pages[i]);
+        }
+        else
+        {
+            used.push_back(pages[i]);
+        }
+    }
+    pages = used;
+
+    word seed = 12345;
+    double start = benchmark::now();
+    for (int op = 0; op < N_OPERATIONS; op++)
+    {
+        seed = seed * 1103515245 + 12345;
+        word &page = pages[(seed >> 8) % pages.size()];
+        free(page);
+        page = alloc();
+    }
+    return (benchmark::now() - start) / N_OPERATIONS * 1e9;
+}
+
+BENCHMARK(page_allocator)
+{
+    for (word npages : {1024U, 16384U})
+    {
+        std::string config = std::to_string(npages) + " pages ";
+
+        FreeBlockList fbl(0, npages);
+        benchmark::report("page_allocator", config + "free block list", run_churn(npages,
+                [&]() { return fbl.get_free_block(1); },
+                [&](word page) { fbl.return_block(page, 1); }), "ns/op");
+
+        PageAllocator bitmap(0, npages);
+        benchmark::report("page_allocator", config + "bitmap", run_churn(npages,
+                [&]() { return bitmap.alloc(); },
+                [&](word page) { bitmap.free(page); }), "ns/op");
+    }
+}
@@ -0,0 +1,81 @@
+#include <emulator32bit_benchmark/emulator32bit_benchmark.h>
+
+#define RAM_NPAGES 1024
+#define N_ROUNDS 2000
+
+/*
+ * Page table lookups that miss the TLB. Virtual pages are spaced so they all collide in the TLB,
+ * forcing every translation to walk the page table.
+ */
+BENCHMARK(page_table_walk)
+{
+    Emulator32bit *emulator = new Emulator32bit(RAM_NPAGES, 0, {}, 0, RAM_NPAGES);
+    VirtualMemory *mmu = emulator->mmu;
+    long long pid = mmu->begin_process();
+
+    /* one virtual page per TLB index collision, spread over the whole address space */
+    const word stride = 1 << 12;
+    const word nvpages = NUM_VPAGES / stride;
+    for (word i = 0; i < nvpages; i++)
+    {
+        mmu->add_vpage(pid, i * stride, 1, true, true);
+        emulator->system_bus.write_word((i * stride) << PAGE_PSIZE, i);
+    }
+
+    word checksum = 0;
+    double start = benchmark::now();
+    for (int round = 0; round < N_ROUNDS; round++)
+    {
+        for (word i = 0; i < nvpages; i++)
+        {
+            checksum += emulator->system_bus.read_word((i * stride) << PAGE_PSIZE);
+        }
+    }
+    double elapsed = benchmark::now() - start;
+    benchmark::report("page_table_walk", "translation with TLB miss",
+            elapsed / ((double) N_ROUNDS * nvpages) * 1e9, "ns");
+
+    mmu->end_process(pid);
+    delete emulator;
+
+    if (checksum != (word) N_ROUNDS * (nvpages * (nvpages - 1) / 2))
+    {
+        printf("page_table_walk: unexpected checksum %u\n", checksum);
+    }
+}
+
+/*
+ * Adding and tearing down a large, mostly unmapped address space.
+ */
+BENCHMARK(page_table_large_process)
+{
+    Emulator32bit *emulator = new Emulator32bit(RAM_NPAGES, 0, {}, 0, RAM_NPAGES);
+    VirtualMemory *mmu = emulator->mmu;
+    const word nvpages = 1 << 16;
+
+    size_t heap_before = benchmark::heap_bytes_in_use();
+    double start = benchmark::now();
+    long long pid = mmu->begin_process();
+    mmu->add_vpage(pid, 0, nvpages, true, false);
+    double elapsed = benchmark::now() - start;
+    benchmark::report("page_table_large_process", "add virtual page",
+            elapsed / nvpages * 1e9, "ns");
+    benchmark::report("page_table_large_process", "heap per virtual page",
+            (double) (benchmark::heap_bytes_in_use() - heap_before) / nvpages, "bytes");
+
+    start = benchmark::now();
+    for (word vpage = 0; vpage < nvpages; vpage++)
+    {
+        mmu->can_write_vpage(pid, vpage);
+    }
+    elapsed = benchmark::now() - start;
+    benchmark::report("page_table_large_process", "permission lookup",
+            elapsed / nvpages * 1e9, "ns");
+
+    start = benchmark::now();
+    mmu->end_process(pid);
+    elapsed = benchmark::now() - start;
+    benchmark::report("page_table_large_process", "end process", elapsed * 1e6, "us");
+
+    delete emulator;
+}
@@ -0,0 +1,85 @@
+#include <emulator32bit_benchmark/emulator32bit_benchmark.h>
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#define ROM_NPAGES 1024
+#define ROM_START_PAGE 16
+#define ROM_NAME "rom_image_benchmark"
+#define ROM_FILE ROM_NAME ".bin"
+
+/*
+ * Boots and shuts down a 4 MiB ROM image. The copied ROM reads and writes the file one byte
+ * at a time the way ROM used to, the mapped ROMs only fault in the pages the boot touches.
+ */
+static void run_rom_image(const std::string& config, bool copy, ROM::Mode mode, bool write)
+{
+    std::vector<byte> image(ROM_NPAGES * PAGE_SIZE);
+    for (size_t i = 0; i < image.size(); i++)
+    {
+        image[i] = (byte) (i * 13);
+    }
+    FILE *file = fopen(ROM_FILE, "wb");
+    fwrite(image.data(), 1, image.size(), file);
+    fclose(file);
+
+    const word base = ROM_START_PAGE << PAGE_PSIZE;
+    double start = benchmark::now();
+    ROM *rom = nullptr;
+    if (copy)
+    {
+        std::vector<byte> bytes;
+        FileReader fr(File(ROM_FILE), std::ios::binary | std::ios::in);
+        while (fr.has_next_byte())
+        {
+            bytes.push_back(fr.read_byte());
+        }
+        rom = new ROM(bytes.data(), ROM_NPAGES, ROM_START_PAGE);
+    }
+    else
+    {
+        rom = new ROM(File(ROM_FILE), ROM_NPAGES, ROM_START_PAGE, mode);
+    }
+    double booted = benchmark::now();
+
+    word checksum = 0;
+    for (word page = 0; page < ROM_NPAGES; page += 64)
+    {
+        checksum += rom->read_byte(base + (page << PAGE_PSIZE) + 1);
+    }
+    if (write)
+    {
+        rom->write_word(base, checksum);
+    }
+
+    double touched = benchmark::now();
+    if (copy)
+    {
+        FileWriter fw(File(ROM_FILE), std::ios::out | std::ios::binary);
+        for (word i = 0; i < ROM_NPAGES << PAGE_PSIZE; i++)
+        {
+            fw.write(rom->data[i]);
+        }
+        fw.close();
+    }
+    delete rom;
+    double shutdown = benchmark::now();
+
+    benchmark::report("rom_image", config + " boot", (booted - start) * 1e3, "ms");
+    benchmark::report("rom_image", config + " shutdown", (shutdown - touched) * 1e3, "ms");
+
+    if (checksum != (ROM_NPAGES / 64) * 13)
+    {
+        printf("rom_image: bad checksum %u\n", checksum);
+    }
+    std::remove(ROM_FILE);
+}
+
+BENCHMARK(rom_image)
+{
+    run_rom_image("byte copied", true, ROM::Mode::READ_ONLY, false);
+    run_rom_image("mapped read only", false, ROM::Mode::READ_ONLY, false);
+    run_rom_image("mapped flash, clean", false, ROM::Mode::FLASH, false);
+    run_rom_image("mapped flash, one write", false, ROM::Mode::FLASH, true);
+}
@@ -0,0 +1,69 @@
+#include <emulator32bit_benchmark/emulator32bit_benchmark.h>
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#define SEGMENT_NPAGES 512
+#define SEGMENT_VPAGE 16
+#define TOUCHED_NPAGES 16
+
+/*
+ * Loads a 2 MiB segment the way LoadExecutable used to, one translated byte store at a time,
+ * and as demand pages that are only filled when touched. A program usually touches a small
+ * part of its image before doing real work, so startup then runs a few page faults.
+ */
+static void run_segment_load(bool demand)
+{
+    Emulator32bit *emulator = new Emulator32bit(SEGMENT_NPAGES + 16, 0, {}, 0, SEGMENT_NPAGES + 16);
+    VirtualMemory *mmu = emulator->mmu;
+    long long pid = mmu->begin_process();
+
+    std::vector<byte> image(SEGMENT_NPAGES * PAGE_SIZE);
+    for (size_t i = 0; i < image.size(); i++)
+    {
+        image[i] = (byte) (i * 31);
+    }
+
+    const word address = SEGMENT_VPAGE << PAGE_PSIZE;
+    double start = benchmark::now();
+    if (demand)
+    {
+        mmu->add_segment(pid, address, image.size(), image, true, false);
+    }
+    else
+    {
+        mmu->add_vpage(pid, SEGMENT_VPAGE, SEGMENT_NPAGES, true, false);
+        for (size_t i = 0; i < image.size(); i++)
+        {
+            emulator->system_bus.write_byte(address + i, image[i]);
+        }
+    }
+    double loaded = benchmark::now();
+
+    word checksum = 0;
+    for (word vpage = 0; vpage < TOUCHED_NPAGES; vpage++)
+    {
+        checksum += emulator->system_bus.read_byte(address + (vpage << PAGE_PSIZE) + 1);
+    }
+    double touched = benchmark::now();
+
+    std::string config = demand ? "demand paged " : "eager ";
+    benchmark::report("segment_load", config + "load", (loaded - start) * 1e6, "us");
+    benchmark::report("segment_load", config + "first touch of " + std::to_string(TOUCHED_NPAGES) + " pages",
+            (touched - loaded) * 1e6, "us");
+
+    if (checksum != TOUCHED_NPAGES * 31)
+    {
+        printf("segment_load: bad checksum %u\n", checksum);
+    }
+
+    mmu->end_process(pid);
+    delete emulator;
+}
+
+BENCHMARK(segment_load)
+{
+    run_segment_load(false);
+    run_segment_load(true);
+}
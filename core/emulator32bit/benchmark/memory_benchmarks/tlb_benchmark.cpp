@@ -0,0 +1,73 @@
+#include <emulator32bit_benchmark/emulator32bit_benchmark.h>
+
+#include <vector>
+
+#define N_PROCESSES 8
+#define PROCESS_NPAGES 16
+#define N_ROUNDS 20000
+
+/*
+ * Round robin between processes that all use the same virtual pages, like freshly loaded
+ * programs do. Reports the TLB hit rate and translation time for a few TLB geometries.
+ */
+static void run_tlb_context_switch(word nentries, word nways)
+{
+    Emulator32bit *emulator = new Emulator32bit(N_PROCESSES * PROCESS_NPAGES, 0, {}, 0,
+            N_PROCESSES * PROCESS_NPAGES);
+    VirtualMemory *mmu = emulator->mmu;
+    mmu->configure_tlb(nentries, nways);
+
+    std::vector<long long> pids;
+    for (int i = 0; i < N_PROCESSES; i++)
+    {
+        long long pid = mmu->begin_process();
+        mmu->add_vpage(pid, 0, PROCESS_NPAGES, true, true);
+        for (word vpage = 0; vpage < PROCESS_NPAGES; vpage++)
+        {
+            emulator->system_bus.write_word(vpage << PAGE_PSIZE, (word) pid);
+        }
+        pids.push_back(pid);
+    }
+
+    mmu->reset_tlb_stats();
+    word checksum = 0;
+    double start = benchmark::now();
+    for (int round = 0; round < N_ROUNDS; round++)
+    {
+        for (long long pid : pids)
+        {
+            mmu->set_process(pid);
+            for (word vpage = 0; vpage < PROCESS_NPAGES; vpage++)
+            {
+                checksum += emulator->system_bus.read_word(vpage << PAGE_PSIZE);
+            }
+        }
+    }
+    double elapsed = benchmark::now() - start;
+
+    const VirtualMemory::TLB_Stats& stats = mmu->get_tlb_stats();
+    std::string config = std::to_string(nentries) + " entries " + std::to_string(nways) + "-way ";
+    benchmark::report("tlb_context_switch", config + "hit rate",
+            100.0 * stats.hits / (stats.hits + stats.misses), "%");
+    benchmark::report("tlb_context_switch", config + "translation",
+            elapsed / ((double) N_ROUNDS * N_PROCESSES * PROCESS_NPAGES) * 1e9, "ns");
+
+    for (long long pid : pids)
+    {
+        mmu->end_process(pid);
+    }
+    delete emulator;
+
+    if (checksum == 0)
+    {
+        printf("tlb_context_switch: unexpected checksum\n");
+    }
+}
+
+BENCHMARK(tlb_context_switch)
+{
+    run_tlb_context_switch(256, 1);
+    run_tlb_context_switch(256, 2);
+    run_tlb_context_switch(256, 4);
+    run_tlb_context_switch(256, 8);
+}
@@ -8,6 +8,7 @@
 #include "util/file.h"
 
 #include <fstream>
+#include <mutex>
 
 /**
  * @def             AEMU_DISK_CACHE_PSIZE
@@ -169,6 +170,30 @@ class Disk : public BaseMemory
          */
         word read_word(word address) override;
 
+        /**
+         * @brief             Reads a run of bytes from disk.
+         *
+         *                     Whole pages that are not cached are read straight from the disk file
+         *                     in one go, without going through (and evicting) the cache.
+         *
+         * @param address     Full address of the first byte to read.
+         * @param dst         Buffer of at least length bytes.
+         * @param length     Number of bytes to read.
+         */
+        virtual void read_bytes(word address, byte *dst, word length);
+
+        /**
+         * @brief             Writes a run of bytes to disk.
+         *
+         *                     Whole pages that are not cached are written straight to the disk
+         *                     file, partial pages go through the cache.
+         *
+         * @param address     Full address of the first byte to write.
+         * @param src         Buffer of at least length bytes.
+         * @param length     Number of bytes to write.
+         */
+        virtual void write_bytes(word address, const byte *src, word length);
+
         /**
          * @brief             Write a page to disk.
          *
@@ -247,14 +272,14 @@ class Disk : public BaseMemory
 
         FreeBlockList m_free_list;                ///< Disk manager, which pages are free to use
 
+        std::mutex m_mutex;                        ///< Guards the cache, DMA transfers use it off the emulator thread
+
         /**
          * @brief             Reads a specified size little endian value from disk.
          *
          *                     Interfaced with by the read byte/hword/word public functions. Note,
-         *                     reading anything more than 8 bytes will not produce useful results.
-         *
-         * @todo             TODO: Have a separate method that reads a stream of bytes so we are not
-         *                     limited by primitive data types.
+         *                     reading anything more than 8 bytes will not produce useful results,
+         *                     use @ref read_bytes for longer runs.
          *
          * @param address     Address to read from.
          * @param n_bytes     Number of bytes to read.
@@ -268,10 +293,8 @@ class Disk : public BaseMemory
          * @brief             Writes a little endian value of specified size to disk.
          *
          *                     Interfaced with by the write byte/hword/word public functions. Note,
-         *                     writing anything more than 8 bytes will not be useful.
-         *
-         * @todo             TODO: Have a separate method that writes a stream of bytes so we are no
-         *                     limited by primitive data types.
+         *                     writing anything more than 8 bytes will not be useful, use
+         *                     @ref write_bytes for longer runs.
          *
          * @param address     Address to write to.
          * @param val         Value to write.
@@ -301,6 +324,12 @@ class Disk : public BaseMemory
          */
         void write_cpage(CachePage& cpage);
 
+        /**
+         * @brief             Counts the pages from page on, up to length of them, that are not in
+         *                     the cache.
+         */
+        word uncached_pages(word page, word length);
+
         /**
          * @brief            Reads a cache page from disk.
          *
@@ -337,11 +366,13 @@ class MockDisk : public Disk
         byte read_byte(word address) override;
         hword read_hword(word addressn) override;
         word read_word(word address) override;
+        void read_bytes(word address, byte *dst, word length) override;
 
         void write_page(word page, std::vector<byte>) override;
         void write_byte(word address, byte data) override;
         void write_hword(word address, hword data) override;
         void write_word(word address, word data) override;
+        void write_bytes(word address, const byte *src, word length) override;
 
         void save() override;
 };
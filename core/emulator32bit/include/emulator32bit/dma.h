@@ -0,0 +1,118 @@
+#pragma once
+#ifndef DMA_H
+#define DMA_H
+
+#include "emulator32bit/emulator32bit.h"
+
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#define DMA_BASE (MMIO_START + PAGE_SIZE)
+
+/* Register offsets from @ref DMA_BASE, all registers are words */
+#define DMA_SRC 0x00                /* Physical address copied from, in RAM, ROM or disk */
+#define DMA_DST 0x04                /* Physical address copied to, in RAM or disk */
+#define DMA_LEN 0x08                /* Bytes to copy */
+#define DMA_CTRL 0x0C               /* See DMA_CTRL_*, writing DMA_CTRL_START starts a transfer */
+#define DMA_STATUS 0x10             /* See DMA_STATUS_*, writing 1s clears DONE and ERROR */
+#define DMA_COUNT 0x14              /* Read only, bytes copied by the last transfer */
+
+#define DMA_CTRL_START 0x1          /* Not stored, reads back as 0 */
+#define DMA_CTRL_INTERRUPT 0x2      /* Raise @ref Emulator32bit::DMA_DONE when a transfer ends */
+#define DMA_CTRL_ASYNC 0x4          /* Copy on a host thread while the guest keeps running */
+
+#define DMA_STATUS_BUSY 0x1
+#define DMA_STATUS_DONE 0x2
+#define DMA_STATUS_ERROR 0x4        /* Bad range, a start while busy, or the disk failed */
+
+/**
+ * @brief           Memory mapped DMA controller for bulk copies between disk and RAM.
+ *
+ * The guest programs @ref DMA_SRC, @ref DMA_DST and @ref DMA_LEN, then starts the transfer by
+ * writing @ref DMA_CTRL_START to @ref DMA_CTRL. Addresses are physical, like a real DMA engine
+ * the controller sits behind the MMU. Each side of the transfer has to lie within one memory,
+ * ROM can only be read from. Copies are done a page or more at a time, with memmove for RAM and
+ * whole page file reads and writes for the disk, never a byte at a time.
+ *
+ * A transfer finishes during the write that starts it, unless @ref DMA_CTRL_ASYNC is set. Then
+ * it runs on a host thread and the guest keeps executing, @ref DMA_STATUS_BUSY stays set until
+ * the processor picks the completion up between instructions. The RAM pages of the transfer are
+ * pinned meanwhile so the MMU does not swap them out. There is one channel, starting a transfer
+ * while one is in flight fails with @ref DMA_STATUS_ERROR.
+ */
+class DMAController : public BaseMemory
+{
+    public:
+        DMAController(Emulator32bit *processor);
+        ~DMAController() override;
+
+        byte read_byte(word address) override;
+        hword read_hword(word address) override;
+        word read_word(word address) override;
+        void write_byte(word address, byte value) override;
+        void write_hword(word address, hword value) override;
+        void write_word(word address, word value) override;
+
+        /**
+         * @brief           Blocks until an asynchronous transfer in flight is copied, then
+         *                  completes it. Must be called on the emulator thread.
+         */
+        void wait();
+
+        /**
+         * @brief           Waits out a transfer in flight, without completing it, and clears
+         *                  the registers.
+         */
+        void reset();
+
+        inline bool busy()
+        {
+            return status & DMA_STATUS_BUSY;
+        }
+
+    private:
+        Emulator32bit *processor;
+
+        word src = 0;
+        word dst = 0;
+        word length = 0;
+        word ctrl = 0;
+        word status = 0;
+        word count = 0;
+
+        bool in_flight = false;                     /* An asynchronous transfer is not completed */
+        word in_flight_length = 0;
+        std::vector<word> pinned;                   /* Physical pages of the transfer in flight */
+
+        /* Guarded by mutex, shared with the worker */
+        std::mutex mutex;
+        std::condition_variable job_ready;
+        std::condition_variable copied;
+        std::function<void()> job;
+        bool copying = false;
+        bool failed = false;
+        bool stopping = false;
+
+        std::thread worker;                         /* Started on the first asynchronous transfer */
+
+        word read_register(word offset);
+        void write_register(word offset, word value);
+        void start();
+        void finish(bool error, word copied_bytes);
+        void complete();
+        void wait_copied();
+        void work();
+
+        /**
+         * @brief           The memory [address, address + length) lies in, nullptr if it is not
+         *                  all in one memory the controller can use.
+         */
+        BaseMemory* target(word address, word length, bool write);
+        void copy(BaseMemory *from, word from_address, BaseMemory *to, word to_address,
+                word length);
+};
+
+#endif /* DMA_H */
@@ -4,13 +4,27 @@
 
 #include "emulator32bit/disk.h"
 #include "emulator32bit/emulator32bit_util.h"
+#include "emulator32bit/isa.h"
 #include "emulator32bit/memory.h"
+#include "emulator32bit/scheduler.h"
 #include "emulator32bit/system_bus.h"
 
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <cstring>
+#include <functional>
+#include <mutex>
 #include <string>
+#include <unordered_map>
+#include <vector>
 
 class MMU;  /* Forward declare from 'better_virtual_memory.h' */
+class MemoryManager; /* Forward declare from 'kernel/malloc.h' */
 class Timer; /* Forward declare from 'timer.h' */
+class UART; /* Forward declare from 'uart.h' */
+class DMAController; /* Forward declare from 'dma.h' */
+class FileManager; /* Forward declare from 'kernel/file_io.h' */
 
 /**
  * @brief                    IDs for special registers
@@ -32,6 +46,7 @@ class Timer; /* Forward declare from 'timer.h' */
  */
 #define NUM_REG 32          /* Number of general purpose stack registers */
 #define NR 8                /* Number register for syscalls */
+#define MAX_SYSCALL 1023    /* Highest built in syscall number */
 #define FP 28               /* Frame Pointer - points to saved (FP,LR) in stack */
 #define LINKR 29            /* Link Register */
 #define SP 30               /* Stack Pointer */
@@ -47,6 +62,24 @@ class Timer; /* Forward declare from 'timer.h' */
 #define V_FLAG 3            /* Overflow Flag */
 #define USER_FLAG 8         /* User mode flag */
 #define REAL_FLAG 9         /* Real memory mode flag */
+#define IRQ_MASK_FLAG 10    /* Interrupts are held pending while set */
+
+/**
+ * @brief                     Bit locations in the _fpcr and _fpsr registers, laid out as in AArch64
+ *
+ */
+#define FPCR_RMODE 22       /* Rounding mode, 2 bits, see FPRounding */
+#define FPCR_FZ 24          /* Flush denormal operands and results to zero */
+#define FPCR_DN 25          /* NaN results are the default NaN instead of a propagated operand */
+#define FPCR_MASK ((0b11 << FPCR_RMODE) | (1 << FPCR_FZ) | (1 << FPCR_DN))
+
+#define FPSR_IOC 0          /* Invalid operation */
+#define FPSR_DZC 1          /* Division by zero */
+#define FPSR_OFC 2          /* Overflow */
+#define FPSR_UFC 3          /* Underflow */
+#define FPSR_IXC 4          /* Inexact */
+#define FPSR_IDC 7          /* Denormal operand flushed to zero */
+#define FPSR_MASK (0b11111 | (1 << FPSR_IDC))
 
 /**
  * @brief                    Which bit of the instruction determines whether flags will be updated
@@ -79,16 +112,46 @@ class Emulator32bit
             FAILED_ASSERT,
             BAD_PAGEDIR,
             PAGEFAULT,
+            TIMER,
+            UART_RX,
+            DMA_DONE,
         };
 
+        /**
+         * @brief            State saved when an interrupt is delivered, restored by the
+         *                     rt_sigreturn syscall.
+         */
         struct InterruptFrame
         {
             word saved_reg[NUM_REG];
             word saved_px;
             word saved_pstate;
             word saved_pagedir;
+        };
 
+        /**
+         * @brief            Processor state of a process that is switched out. Registers are kept in
+         *                     the raw value and mask form of @ref _x so a context switch copies the
+         *                     register file as one block.
+         */
+        struct ProcessContext
+        {
+            dword x[NUM_REG];
+            word pc;
+            word pstate;
+            word pagedir;
+            word fpcr;
+            word fpsr;
+
+            inline word read_reg(byte reg) const
+            {
+                return ((word) x[reg]) & ((word) (x[reg] >> 32));
+            }
 
+            inline void write_reg(byte reg, word val)
+            {
+                x[reg] = (((word) x[reg]) ^ ((dword) val << 32));
+            }
         };
 
         class Exception : public std::exception
@@ -130,6 +193,28 @@ class Emulator32bit
             ADDR_OFFSET, ADDR_PRE_INC, ADDR_POST_INC
         };
 
+        /* Lane operations of the packed instruction, over 4 byte or 2 half word lanes of a register */
+        enum PackedOp {
+            PACKED_ADD8, PACKED_SUB8,                   /* Wrap around */
+            PACKED_UMIN8, PACKED_UMAX8, PACKED_SMIN8, PACKED_SMAX8,
+            PACKED_CMEQ8, PACKED_CMGT8,                 /* All ones lane when true, cmgt is signed */
+            PACKED_ADD16, PACKED_SUB16,
+            PACKED_UMIN16, PACKED_UMAX16, PACKED_SMIN16, PACKED_SMAX16,
+            PACKED_CMEQ16, PACKED_CMGT16,
+            PACKED_TBL,                                 /* Byte i = byte xm[i] of xn, 0 if xm[i] > 3 */
+            PACKED_NUM_OPS
+        };
+
+        /* Rounding modes of the FPCR_RMODE field */
+        enum FPRounding {
+            FP_ROUND_NEAREST, FP_ROUND_PLUS_INF, FP_ROUND_MINUS_INF, FP_ROUND_ZERO
+        };
+
+        /* Register forms of the vmov instruction, vmrs and vmsr move the floating point system registers */
+        enum VmovType {
+            VMOV_REGISTER, VMRS_FPCR, VMRS_FPSR, VMSR_FPCR, VMSR_FPSR
+        };
+
         static const word RAM_NPAGES;     /* Default size of RAM memory in bytes */
         static const word RAM_START_PAGE;    /* Default 32 bit start address of RAM memory */
         static const word ROM_NPAGES;     /* Default size of ROM memory in bytes */
@@ -140,9 +225,14 @@ class Emulator32bit
         ROM *rom;
         Disk *disk;
         VirtualMemory *mmu;
+        MMU *kernel_mmu = nullptr;                      /* In guest page table MMU managing _pagedir, attached by the kernel. */
+        MemoryManager *memory_manager;                  /* Heap and anonymous mappings of the processes of mmu. */
         SystemBus system_bus;
 
         Timer *timer;
+        UART *uart;                                     /* Console, mapped at UART_BASE. */
+        DMAController *dma;                             /* Bulk disk and RAM copies, mapped at DMA_BASE. */
+        FileManager *file_manager;                      /* Host files opened by the guest. */
 
         word _pagedir;                                  /* Pointer to Page directory for virtual address space. */
 
@@ -160,6 +250,131 @@ class Emulator32bit
          */
         void reset();
 
+        /**
+         * @brief            Schedules handler to run between instructions, delay instructions from now.
+         * @details            @ref run only stops at the next deadline, so nothing is checked per instruction.
+         *                     An event scheduled while an instruction executes ends the current run of
+         *                     instructions early if it is due sooner.
+         *
+         * @param             delay: Instructions to run before the handler.
+         * @param             handler: Called between instructions, may raise interrupts.
+         * @return             ID to cancel the event with.
+         */
+        EventScheduler::EventID schedule_event(unsigned long long delay, EventScheduler::Handler handler);
+
+        inline bool cancel_event(EventScheduler::EventID id)
+        {
+            return _scheduler.cancel(id);
+        }
+
+        /**
+         * @brief            Runs handler on the emulator thread between instructions, as soon as
+         *                     possible. Safe to call from any thread, wakes a processor waiting in WFI.
+         * @details            A running processor picks external events up between bursts, which
+         *                     are at most @ref MAX_BURST_LENGTH instructions long.
+         *
+         * @param             handler: Called between instructions, may raise interrupts.
+         */
+        void post_event(EventScheduler::Handler handler);
+
+        /**
+         * @brief            Declares a host thread that may post events, like one reading input
+         *                     for the @ref UART. A processor waiting in WFI with nothing scheduled
+         *                     or in flight only sleeps while one is attached, otherwise nothing
+         *                     could ever wake it and the run stops like it does on hlt.
+         */
+        void attach_event_source();
+        void detach_event_source();
+
+        /**
+         * @brief            Whether the processor is idle in a WFI instruction.
+         */
+        inline bool is_waiting()
+        {
+            return _waiting;
+        }
+
+        /**
+         * @brief            Delivers an interrupt, saving an @ref InterruptFrame and jumping to the
+         *                     type's entry in the vector table. Held pending while @ref IRQ_MASK_FLAG
+         *                     is set. Must be called between instructions, from a scheduled event.
+         *
+         * @param             type: Interrupt to deliver, selects the 4 byte vector table entry.
+         */
+        void raise_interrupt(InterruptType type);
+
+        /**
+         * @brief            Handles one syscall. Reads its arguments from x0-x5 and writes any
+         *                     result back to the registers itself.
+         */
+        typedef std::function<void(Emulator32bit& processor)> SyscallHandler;
+
+        /**
+         * @brief            Registers handler for the syscall number id, replacing the handler
+         *                     already registered for it. Lets the host add syscalls at runtime.
+         *
+         * @param             id: Syscall number, passed in x8 to swi.
+         * @param             handler: Called by swi when x8 is id.
+         */
+        void register_syscall(word id, SyscallHandler handler);
+
+        /**
+         * @brief            Removes the handler for id, swi then raises BAD_INSTR for it.
+         *
+         * @return             Whether a handler was registered.
+         */
+        bool unregister_syscall(word id);
+
+        /**
+         * @brief            Physical address of the vector table, one instruction per @ref InterruptType.
+         *                     Entries are usually branches to the handlers.
+         */
+        inline void set_vector_table(word address)
+        {
+            _vector_table = address;
+        }
+
+        inline word get_vector_table()
+        {
+            return _vector_table;
+        }
+
+        /**
+         * @brief            Number of instructions retired since the processor was created.
+         */
+        inline unsigned long long cycles()
+        {
+            return _cycles + _burst_len - _burst;
+        }
+
+        /**
+         * @brief            Saves the register file, @ref _pc, @ref _pstate and @ref _pagedir.
+         *                     Between instructions _pc is the next instruction to run.
+         */
+        inline void save_context(ProcessContext& context)
+        {
+            memcpy(context.x, _x, sizeof(_x));
+            context.pc = _pc;
+            context.pstate = _pstate;
+            context.pagedir = _pagedir;
+            context.fpcr = _fpcr;
+            context.fpsr = _fpsr;
+        }
+
+        /**
+         * @brief            Restores a context saved by @ref save_context. Does not switch the
+         *                     address space of @ref mmu.
+         */
+        inline void restore_context(const ProcessContext& context)
+        {
+            memcpy(_x, context.x, sizeof(_x));
+            _pc = context.pc;
+            _pstate = context.pstate;
+            _pagedir = context.pagedir;
+            _fpcr = context.fpcr;
+            _fpsr = context.fpsr;
+        }
+
         inline void set_pc(word pc)
         {
             _pc = pc;
@@ -212,9 +427,33 @@ class Emulator32bit
             return test_bit(_pstate, flag);
         }
 
-        /* @todo determine if fp registers are needed */
-        // word fpcr;
-        // word fpsr;
+        /**
+         * @brief           Floating point control register, see FPCR_*. Bits the processor does not
+         *                  implement are dropped.
+         */
+        inline word get_fpcr()
+        {
+            return _fpcr;
+        }
+
+        inline void set_fpcr(word fpcr)
+        {
+            _fpcr = fpcr & FPCR_MASK;
+        }
+
+        /**
+         * @brief           Floating point status register, see FPSR_*. The exception flags are
+         *                  cumulative, only a write clears them.
+         */
+        inline word get_fpsr()
+        {
+            return _fpsr;
+        }
+
+        inline void set_fpsr(word fpsr)
+        {
+            _fpsr = fpsr & FPSR_MASK;
+        }
 
     private:
         /**
@@ -225,22 +464,64 @@ class Emulator32bit
         dword _x[NUM_REG];
         word _pc;                                        /* Program counter */
         word _pstate;                                    /* Program state. Bits 0-3 are NZCV flags. Rest are TODO */
-
-        static constexpr int _num_instructions = 64;
+        word _fpcr = 0;                                  /* Floating point control */
+        word _fpsr = 0;                                  /* Floating point status */
+
+        EventScheduler _scheduler;
+        unsigned long long _cycles = 0;                    /* Instructions retired before the current burst */
+        unsigned long long _burst = 0;                    /* Instructions left in the current burst */
+        unsigned long long _burst_len = 0;                /* Length of the current burst */
+        static constexpr unsigned long long MAX_BURST_LENGTH = 1ULL << 16;
+
+        word _vector_table = 0;
+        word _pending_interrupts = 0;                    /* Interrupts raised while masked, one bit per type */
+        std::vector<InterruptFrame> _interrupt_frames;
+
+        bool _waiting = false;                            /* Idle in WFI until an event runs */
+        std::mutex _external_mutex;
+        std::condition_variable _external_signal;
+        std::vector<EventScheduler::Handler> _external_events;    /* Posted by other threads, guarded by _external_mutex */
+        std::atomic<bool> _has_external_events{false};
+        std::atomic<int> _event_sources{0};               /* Host threads attached with attach_event_source */
+
+        void deliver_pending_interrupts();
+        bool run_events();
+        bool run_external_events();
+        void wait_for_event(unsigned long long end_cycles);
+
+        static constexpr int _num_instructions = EMU32_NUM_OPCODES;
         typedef void (Emulator32bit::*InstructionFunction)(word);
-        InstructionFunction _instructions[_num_instructions];
+        static const InstructionFunction _instructions[_num_instructions];     /* Generated from EMU32_INSTRUCTIONS */
+
+        /*
+            Built in syscalls live in one dense table shared by every emulator. Host registrations
+            are rare, so they go in a sparse map that overrides the table, an empty handler there
+            unregisters the syscall.
+        */
+        typedef void (*BuiltinSyscall)(Emulator32bit& processor);
+        typedef std::array<BuiltinSyscall, MAX_SYSCALL + 1> SyscallTable;
+        static const SyscallTable& builtin_syscalls();
+        static SyscallTable fill_out_syscalls();
+        std::unordered_map<word, SyscallHandler> _syscalls;
 
         // note, stringstreams cannot use the static const for some reason
-        #define _INSTR(func_name, opcode) \
+        #define _INSTR(func_name, opcode, disassembly) \
         private: void _##func_name(word instr); \
         public: static const byte _op_##func_name = opcode;
-        void fill_out_instructions();
 
         word calc_mem_addr(word xn, sword offset, byte addr_mode);
 
+        /* IEEE-754 binary32 arithmetic on register bit patterns under _fpcr, see float.cpp */
+        word float_arith(byte opcode, word a, word b);
+        word float_to_int(word a, bool sign);
+        word int_to_float(word a, bool sign);
+        void float_compare(word a, word b);
+        word float_operand(word a);
+        word float_nan(word a, word b);
+
         inline void execute(word instr)
         {
-            (this->*_instructions[bitfield_u32(instr, 26, 6)])(instr);
+            (this->*_instructions[isa_opcode(instr)])(instr);
         }
 
         inline bool check_cond(word pstate, byte cond)
@@ -293,79 +574,8 @@ class Emulator32bit
             return false;
         }
 
-        // instruction handling
-        _INSTR(hlt, 0b000000)
-
-        _INSTR(add, 0b000001)
-        _INSTR(sub, 0b000010)
-        _INSTR(rsb, 0b000011)
-        _INSTR(adc, 0b000100)
-        _INSTR(sbc, 0b000101)
-        _INSTR(rsc, 0b000110)
-        _INSTR(mul, 0b000111)
-        _INSTR(umull, 0b001000)
-        _INSTR(smull, 0b001001)
-
-        _INSTR(vabs, 0b001010)
-        _INSTR(vneg, 0b001011)
-        _INSTR(vsqrt, 0b001100)
-        _INSTR(vadd, 0b001101)
-        _INSTR(vsub, 0b001110)
-        _INSTR(vdiv, 0b001111)
-        _INSTR(vmul, 0b010000)
-        _INSTR(vcmp, 0b010001)
-        _INSTR(vsel, 0b010010)
-        _INSTR(vcint, 0b010011)
-        _INSTR(vcflo, 0b010100)
-        _INSTR(vmov, 0b010101)
-
-        _INSTR(and, 0b010110)
-        _INSTR(orr, 0b010111)
-        _INSTR(eor, 0b011000)
-        _INSTR(bic, 0b011001)
-        _INSTR(lsl, 0b011010)
-        _INSTR(lsr, 0b011011)
-        _INSTR(asr, 0b011100)
-        _INSTR(ror, 0b011101)
-
-        _INSTR(cmp, 0b011110)
-        _INSTR(cmn, 0b011111)
-        _INSTR(tst, 0b100000)
-        _INSTR(teq, 0b100001)
-
-        _INSTR(mov, 0b100010)
-        _INSTR(mvn, 0b100011)
-
-        _INSTR(ldr, 0b100100)
-        _INSTR(ldrb, 0b100101)
-        _INSTR(ldrh, 0b100110)
-        _INSTR(str, 0b100111)
-        _INSTR(strb, 0b101000)
-        _INSTR(strh, 0b101001)
-        _INSTR(swp, 0b101010)
-        _INSTR(swpb, 0b101011)
-        _INSTR(swph, 0b101100)
-        _INSTR(b, 0b101101)
-        _INSTR(bl, 0b101110)
-        _INSTR(bx, 0b101111)
-        _INSTR(blx, 0b110000)
-        _INSTR(swi, 0b110001)
-
-        _INSTR(adrp, 0b110010)
-
-        // _INSTR(nop_, 0b110100)
-        // _INSTR(nop_, 0b110101)
-        // _INSTR(nop_, 0b110110)
-        // _INSTR(nop_, 0b110111)
-        // _INSTR(nop_, 0b111000)
-        // _INSTR(nop_, 0b111001)
-        // _INSTR(nop_, 0b111010)
-        // _INSTR(nop_, 0b111011)
-        // _INSTR(nop_, 0b111100)
-        // _INSTR(nop_, 0b111101)
-        // _INSTR(nop_, 0b111110)
-
-        _INSTR(nop, 0b111111)
+        // instruction handling, one handler and opcode constant for each entry of the ISA table
+        EMU32_INSTRUCTIONS(_INSTR)
 
         #undef _INSTR
 
@@ -380,24 +590,242 @@ class Emulator32bit
         void _emu_log(word str);
         void _emu_err(word err);
 
+        word _sys_fork();
+        void _sys_rt_sigreturn();
+        word _sys_brk(word address);
+        word _sys_mmap(word address, word length, word prot, word flags, word fd, word offset);
+        word _sys_munmap(word address, word length);
+
 
     public:
+        /**
+         * @brief           Applies a packed lane operation, with host SSE2 (SSSE3 for tbl) when
+         *                  the build targets it and @ref packed_op_scalar otherwise.
+         */
+        static word packed_op(PackedOp op, word a, word b);
+
+        /* Portable reference of @ref packed_op. */
+        static word packed_op_scalar(PackedOp op, word a, word b);
+
+        /* Assembler mnemonic of op, nullptr past the last op. */
+        static const char* packed_op_name(PackedOp op);
+
         // help assemble instructions
-        static word asm_hlt();
-        static word asm_format_o(byte opcode, bool s, int xd, int xn, int imm14);
-        static word asm_format_o(byte opcode, bool s, int xd, int xn, int xm, ShiftType shift, int imm5);
-        static word asm_format_o1(byte opcode, int xd, int xn, bool imm, int xm, int imm5);
-        static word asm_format_o2(byte opcode, bool s, int xlo, int xhi, int xn, int xm);
-        static word asm_format_o3(byte opcode, bool s, int xd, int imm19);
-        static word asm_format_o3(byte opcode, bool s, int xd, int xn, int imm14);
-        static word asm_format_m(byte opcode, bool sign, int xt, int xn, int xm, ShiftType shift, int imm5, AddrType adr);
-        static word asm_format_m(byte opcode, bool sign, int xt, int xn, int simm12, AddrType adr);
-        static word asm_format_m1(byte opcode, int xd, int xn, int xm);
-        static word asm_format_m2(byte opcode, int xd, int imm20);
-        static word asm_format_b1(byte opcode, ConditionCode cond, sword simm22);
-        static word asm_format_b2(byte opcode, ConditionCode cond, int xd);
-
-        static word asm_nop();
+        static constexpr word asm_hlt();
+        static constexpr word asm_format_o(byte opcode, bool s, int xd, int xn, int imm14);
+        static constexpr word asm_format_o(byte opcode, bool s, int xd, int xn, int xm, ShiftType shift, int imm5);
+        static constexpr word asm_format_o1(byte opcode, int xd, int xn, bool imm, int xm, int imm5);
+        static constexpr word asm_format_o2(byte opcode, bool s, int xlo, int xhi, int xn, int xm);
+        static constexpr word asm_format_o3(byte opcode, bool s, int xd, int imm19);
+        static constexpr word asm_format_o3(byte opcode, bool s, int xd, int xn, int imm14);
+        static constexpr word asm_format_o4(byte opcode, bool inc, ConditionCode cond, int xd, int xn, int xm);
+        static constexpr word asm_format_m(byte opcode, bool sign, int xt, int xn, int xm, ShiftType shift, int imm5, AddrType adr);
+        static constexpr word asm_format_m(byte opcode, bool sign, int xt, int xn, int simm12, AddrType adr);
+        static constexpr word asm_format_m1(byte opcode, int xd, int xn, int xm);
+        static constexpr word asm_format_m2(byte opcode, int xd, int imm20);
+        static constexpr word asm_format_m3(byte opcode, bool load, int xt1, int xt2, int xn, int offset, AddrType adr);
+        static constexpr word asm_format_m4(byte opcode, bool load, int xn, bool writeback, bool decrement, word reglist);
+        static constexpr word asm_format_m5(byte opcode, bool set, int xd, int xs, int xn);
+        static constexpr word asm_format_b1(byte opcode, ConditionCode cond, sword simm22);
+        static constexpr word asm_format_b2(byte opcode, ConditionCode cond, int xd);
+        static constexpr word asm_format_b3(byte opcode, bool nonzero, int xt, sword simm20);
+
+        static constexpr word asm_format_f(byte opcode, bool sign, int xd, int xn);
+        static constexpr word asm_format_f1(byte opcode, int xd, int xn, int xm);
+        static constexpr word asm_format_f1(byte opcode, ConditionCode cond, int xd, int xn, bool zero, int xm);
+        static constexpr word asm_format_f2(byte opcode, int xd, word fimm20);
+        static constexpr word asm_format_f2(byte opcode, VmovType type, int xd, int xn);
+        static constexpr word asm_format_p(byte opcode, PackedOp op, int xd, int xn, int xm);
+
+        static constexpr word asm_wfi();
+        static constexpr word asm_nop();
 };
 
+/* The encoders are defined in the header so that calls with constant operands fold. */
+
+/**
+ * @brief                    Constructs instructions of format O with an imm14 operand
+ *
+ * @param                     opcode: 6 bit identifier of a format O instruction
+ * @param                     s: whether condition flags are set
+ * @param                     xd: 5 bit destination register identifier
+ * @param                     xn: 5 bit operand register identifier
+ * @param                     imm14: 14 bit immediate value
+ * @return                     instruction word
+ */
+constexpr word Emulator32bit::asm_format_o(const byte opcode, const bool s, const int xd, const int xn,
+                                           const int imm14)
+{
+    return Joiner() << JPart(6, opcode) << JPart(1, s) << JPart(5, xd) << JPart(5, xn)
+                    << JPart(1, 1) << JPart(14, imm14);
+}
+
+/**
+ * @brief                     Constructs instructions of format O with an arg operand
+ *
+ * @param                     opcode: 6 bit identifier of a format O instruction
+ * @param                     s: whether condition flags are set
+ * @param                     xd: 5 bit destination register identifier
+ * @param                     xn: 5 bit operand register identifier
+ * @param                     xm: 5 bit operand register identifier
+ * @param                     shift: shift type to be applied on the value in the xm register
+ * @param                     imm5: shift amount
+ * @return                     instruction word
+ */
+constexpr word Emulator32bit::asm_format_o(const byte opcode, const bool s, const int xd, const int xn,
+                                           const int xm, const ShiftType shift, const int imm5)
+{
+    return Joiner() << JPart(6, opcode) << JPart(1, s) << JPart(5, xd) << JPart(5, xn) << 1
+                    << JPart(5, xm) << JPart(2, shift) << JPart(5, imm5) << 2;
+}
+
+constexpr word Emulator32bit::asm_format_o1(const byte opcode, const int xd, const int xn, const bool imm,
+                                            const int xm, const int imm5)
+{
+    return Joiner() << JPart(6, opcode) << 1 << JPart(5, xd) << JPart(5, xn) << JPart(1, imm)
+                    << JPart(5, xm) << 2 << JPart(5, imm5) << 2;
+}
+
+constexpr word Emulator32bit::asm_format_o2(const byte opcode, const bool s, const int xlo, const int xhi,
+                                            const int xn, const int xm)
+{
+    return Joiner() << JPart(6, opcode) << JPart(1, s) << JPart(5, xlo) << JPart(5, xhi)
+                    << 1 << JPart(5, xn) << JPart(5, xm) << 4;
+}
+
+constexpr word Emulator32bit::asm_format_o3(const byte opcode, const bool s, const int xd, const int imm19)
+{
+    return Joiner() << JPart(6, opcode) << JPart(1, s) << JPart(5, xd) << JPart(1, 1)
+                    << JPart(19, imm19);
+}
+
+constexpr word Emulator32bit::asm_format_o3(const byte opcode, const bool s, const int xd, const int xn,
+                                            const int imm14)
+{
+    return Joiner() << JPart(6, opcode) << JPart(1, s) << JPart(5, xd) << 1 << JPart(5, xn)
+                    << JPart(14, imm14);
+}
+
+constexpr word Emulator32bit::asm_format_o4(const byte opcode, const bool inc, const ConditionCode cond, const int xd,
+                                            const int xn, const int xm)
+{
+    return Joiner() << JPart(6, opcode) << JPart(1, inc) << JPart(5, xd) << JPart(5, xn) << 1
+                    << JPart(5, xm) << 5 << JPart(4, (word) cond);
+}
+
+constexpr word Emulator32bit::asm_format_m(const byte opcode, const bool sign, const int xt, const int xn,
+                                           const int xm, const ShiftType shift, const int imm5,
+                                           const AddrType adr)
+{
+    return Joiner() << JPart(6, opcode) << JPart(1, sign) << JPart(5, xt) << JPart(5, xn)
+                    << 1 << JPart(5, xm) << JPart(2, shift) << JPart(5, imm5) << JPart(2, adr);
+}
+
+constexpr word Emulator32bit::asm_format_m(const byte opcode, const bool sign, const int xt, const int xn,
+                                           const int simm12, const AddrType adr)
+{
+    return Joiner() << JPart(6, opcode) << JPart(1, sign) << JPart(5, xt) << JPart(5, xn)
+                    << JPart(1, 1) << JPart(12, bitfield_u32(simm12, 0, 12)) << JPart(2, adr);
+}
+
+constexpr word Emulator32bit::asm_format_m1(const byte opcode, const int xt, const int xn, const int xm)
+{
+    return Joiner() << JPart(6, opcode) << 1 << JPart(5, xt) << JPart(5, xn) << 1 << JPart(5, xm)
+                    << 9;
+}
+
+constexpr word Emulator32bit::asm_format_m2(const byte opcode, const int xd, const int imm20)
+{
+    return Joiner() << JPart(6, opcode) << 1 << JPart(5, xd) << JPart(20, imm20);
+}
+
+constexpr word Emulator32bit::asm_format_m3(const byte opcode, const bool load, const int xt1, const int xt2,
+                                            const int xn, const int offset, const AddrType adr)
+{
+    return Joiner() << JPart(6, opcode) << JPart(1, load) << JPart(5, xt1) << JPart(5, xt2) << 1
+                    << JPart(5, xn) << JPart(7, bitfield_u32(offset >> 2, 0, 7)) << JPart(2, adr);
+}
+
+constexpr word Emulator32bit::asm_format_m4(const byte opcode, const bool load, const int xn,
+                                            const bool writeback, const bool decrement, const word reglist)
+{
+    const bool high = (reglist >> 16) != 0;
+    return Joiner() << JPart(6, opcode) << JPart(1, load) << JPart(5, xn) << JPart(1, writeback)
+                    << JPart(1, decrement) << JPart(1, high) << 1
+                    << JPart(16, high ? reglist >> 16 : reglist & 0xFFFF);
+}
+
+constexpr word Emulator32bit::asm_format_m5(const byte opcode, const bool set, const int xd, const int xs,
+                                            const int xn)
+{
+    return Joiner() << JPart(6, opcode) << JPart(1, set) << JPart(5, xd) << JPart(5, xs) << 1
+                    << JPart(5, xn) << 9;
+}
+
+constexpr word Emulator32bit::asm_format_b3(const byte opcode, const bool nonzero, const int xt, const sword simm20)
+{
+    return Joiner() << JPart(6, opcode) << JPart(1, nonzero) << JPart(5, xt)
+                    << JPart(20, bitfield_u32(simm20, 0, 20));
+}
+
+constexpr word Emulator32bit::asm_format_f(const byte opcode, const bool sign, const int xd, const int xn)
+{
+    return Joiner() << JPart(6, opcode) << JPart(1, sign) << JPart(5, xd) << JPart(5, xn) << 15;
+}
+
+constexpr word Emulator32bit::asm_format_f1(const byte opcode, const int xd, const int xn, const int xm)
+{
+    return asm_format_f1(opcode, ConditionCode::AL, xd, xn, false, xm);
+}
+
+constexpr word Emulator32bit::asm_format_f1(const byte opcode, const ConditionCode cond, const int xd, const int xn,
+                                            const bool zero, const int xm)
+{
+    return Joiner() << JPart(6, opcode) << 1 << JPart(5, xd) << JPart(5, xn) << JPart(1, zero)
+                    << JPart(5, xm) << 5 << JPart(4, (word) cond);
+}
+
+constexpr word Emulator32bit::asm_format_f2(const byte opcode, const int xd, const word fimm20)
+{
+    return Joiner() << JPart(6, opcode) << JPart(1, 1) << JPart(5, xd) << JPart(20, fimm20);
+}
+
+constexpr word Emulator32bit::asm_format_f2(const byte opcode, const VmovType type, const int xd, const int xn)
+{
+    return Joiner() << JPart(6, opcode) << 1 << JPart(5, xd) << JPart(5, xn) << 12 << JPart(3, type);
+}
+
+constexpr word Emulator32bit::asm_format_p(const byte opcode, const PackedOp op, const int xd, const int xn,
+                                           const int xm)
+{
+    return Joiner() << JPart(6, opcode) << 1 << JPart(5, xd) << JPart(5, xn) << 1 << JPart(5, xm)
+                    << 4 << JPart(5, op);
+}
+
+constexpr word Emulator32bit::asm_format_b1(const byte opcode, const ConditionCode cond, const sword simm22)
+{
+    return Joiner() << JPart(6, opcode) << JPart(4, (word) cond)
+                    << JPart(22, bitfield_u32(simm22, 0, 22));
+}
+
+constexpr word Emulator32bit::asm_format_b2(const byte opcode, const ConditionCode cond, const int xd)
+{
+    return Joiner() << JPart(6, opcode) << JPart(4, (word) cond) << JPart(5, xd) << 17;
+}
+
+constexpr word Emulator32bit::asm_hlt()
+{
+    return Joiner() << JPart(6, _op_hlt) << 26;
+}
+
+constexpr word Emulator32bit::asm_wfi()
+{
+    return Joiner() << JPart(6, _op_wfi) << 26;
+}
+
+constexpr word Emulator32bit::asm_nop()
+{
+    return Joiner() << JPart(6, _op_nop) << 26;
+}
+
 #endif /* EMULATOR32BIT_H */
\ No newline at end of file
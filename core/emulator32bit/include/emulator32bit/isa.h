@@ -0,0 +1,224 @@
+#pragma once
+#ifndef ISA_H
+#define ISA_H
+
+#include "emulator32bit/emulator32bit_util.h"
+
+/**
+ * @brief           The instruction set, one row per opcode in opcode order.
+ *
+ * A row is OP(name, opcode, disassembly) followed by the assembler's spellings of it:
+ * ASM(TOKEN, handler, mnemonic) for each token the assembler parses into the opcode, and
+ * ALIAS(TOKEN, mnemonic) for each further mnemonic of a token, like adds for add.
+ *
+ * disassembly is the disassemble_format_ the generated disassemble_name prints the instruction
+ * with, the f formats adding .f32, bare for the name alone, and custom when disassemble_name is
+ * written by hand.
+ *
+ * Everything listing instructions is generated from here, through @ref EMU32_INSTRUCTIONS and the
+ * assembler's ASSEMBLER_INSTRUCTIONS. A new instruction is added here, then given an
+ * Emulator32bit::_name handler and an Assembler::_handler parser, leaving one out fails to build.
+ */
+#define EMU32_ISA(OP, ASM, ALIAS) \
+    OP(hlt, 0b000000, bare) ASM(HLT, hlt, "hlt") \
+    OP(add, 0b000001, o) ASM(ADD, add, "add") ALIAS(ADD, "adds") \
+    OP(sub, 0b000010, o) ASM(SUB, sub, "sub") ALIAS(SUB, "subs") \
+    OP(rsb, 0b000011, o) ASM(RSB, rsb, "rsb") ALIAS(RSB, "rsbs") \
+    OP(adc, 0b000100, o) ASM(ADC, adc, "adc") ALIAS(ADC, "adcs") \
+    OP(sbc, 0b000101, o) ASM(SBC, sbc, "sbc") ALIAS(SBC, "sbcs") \
+    OP(rsc, 0b000110, o) ASM(RSC, rsc, "rsc") ALIAS(RSC, "rscs") \
+    OP(mul, 0b000111, o) ASM(MUL, mul, "mul") ALIAS(MUL, "muls") \
+    OP(umull, 0b001000, o2) ASM(UMULL, umull, "umull") ALIAS(UMULL, "umulls") \
+    OP(smull, 0b001001, o2) ASM(SMULL, smull, "smull") ALIAS(SMULL, "smulls") \
+    OP(vabs, 0b001010, f) ASM(VABS, vabs, "vabs") \
+    OP(vneg, 0b001011, f) ASM(VNEG, vneg, "vneg") \
+    OP(vsqrt, 0b001100, f) ASM(VSQRT, vsqrt, "vsqrt") \
+    OP(vadd, 0b001101, f1) ASM(VADD, vadd, "vadd") \
+    OP(vsub, 0b001110, f1) ASM(VSUB, vsub, "vsub") \
+    OP(vdiv, 0b001111, f1) ASM(VDIV, vdiv, "vdiv") \
+    OP(vmul, 0b010000, f1) ASM(VMUL, vmul, "vmul") \
+    OP(vcmp, 0b010001, custom) ASM(VCMP, vcmp, "vcmp") \
+    OP(vsel, 0b010010, custom) ASM(VSEL, vsel, "vsel") \
+    OP(vcint, 0b010011, custom) ASM(VCINT, vcint, "vcint") \
+    OP(vcflo, 0b010100, custom) ASM(VCFLO, vcflo, "vcflo") \
+    OP(vmov, 0b010101, custom)          /* vmov, and vmrs and vmsr moving to and from fpcr and fpsr */ \
+        ASM(VMOV, vmov, "vmov") ASM(VMRS, vmrs, "vmrs") ASM(VMSR, vmsr, "vmsr") \
+    OP(and, 0b010110, o) ASM(AND, and, "and") ALIAS(AND, "ands") \
+    OP(orr, 0b010111, o) ASM(ORR, orr, "orr") ALIAS(ORR, "orrs") \
+    OP(eor, 0b011000, o) ASM(EOR, eor, "eor") ALIAS(EOR, "eors") \
+    OP(bic, 0b011001, o) ASM(BIC, bic, "bic") ALIAS(BIC, "bics") \
+    OP(lsl, 0b011010, o1) ASM(LSL, lsl, "lsl") ALIAS(LSL, "lsls") \
+    OP(lsr, 0b011011, o1) ASM(LSR, lsr, "lsr") ALIAS(LSR, "lsrs") \
+    OP(asr, 0b011100, o1) ASM(ASR, asr, "asr") ALIAS(ASR, "asrs") \
+    OP(ror, 0b011101, o1) ASM(ROR, ror, "ror") ALIAS(ROR, "rors") \
+    OP(cmp, 0b011110, compare) ASM(CMP, cmp, "cmp") \
+    OP(cmn, 0b011111, compare) ASM(CMN, cmn, "cmn") \
+    OP(tst, 0b100000, compare) ASM(TST, tst, "tst") \
+    OP(teq, 0b100001, compare) ASM(TEQ, teq, "teq") \
+    OP(mov, 0b100010, o3) ASM(MOV, mov, "mov") ALIAS(MOV, "movs") \
+    OP(mvn, 0b100011, o3) ASM(MVN, mvn, "mvn") ALIAS(MVN, "mvns") \
+    OP(ldr, 0b100100, m) ASM(LDR, ldr, "ldr") ALIAS(LDR, "ldrs") \
+    OP(ldrb, 0b100101, m) ASM(LDRB, ldrb, "ldrb") ALIAS(LDRB, "ldrsb") \
+    OP(ldrh, 0b100110, m) ASM(LDRH, ldrh, "ldrh") ALIAS(LDRH, "ldrsh") \
+    OP(str, 0b100111, m) ASM(STR, str, "str") ALIAS(STR, "strs") \
+    OP(strb, 0b101000, m) ASM(STRB, strb, "strb") ALIAS(STRB, "strsb") \
+    OP(strh, 0b101001, m) ASM(STRH, strh, "strh") ALIAS(STRH, "strsh") \
+    OP(swp, 0b101010, m1) ASM(SWP, swp, "swp") ALIAS(SWP, "swps") \
+    OP(swpb, 0b101011, m1) ASM(SWPB, swpb, "swpb") ALIAS(SWPB, "swpsb") \
+    OP(swph, 0b101100, m1) ASM(SWPH, swph, "swph") ALIAS(SWPH, "swpsh") \
+    OP(b, 0b101101, b1) ASM(B, b, "b") \
+    OP(bl, 0b101110, b1) ASM(BL, bl, "bl") \
+    OP(bx, 0b101111, b2) ASM(BX, bx, "bx") \
+        ASM(RET, ret, "ret")            /* pseudo instruction, bx x29 */ \
+    OP(blx, 0b110000, b2) ASM(BLX, blx, "blx") \
+    OP(swi, 0b110001, b1) ASM(SWI, swi, "swi") \
+    OP(adrp, 0b110010, m2) ASM(ADRP, adrp, "adrp") \
+    OP(udiv, 0b110011, o) ASM(UDIV, udiv, "udiv") ALIAS(UDIV, "udivs") \
+    OP(wfi, 0b110100, bare) ASM(WFI, wfi, "wfi") \
+    OP(sdiv, 0b110101, o) ASM(SDIV, sdiv, "sdiv") ALIAS(SDIV, "sdivs") \
+    OP(clz, 0b110110, o3) ASM(CLZ, clz, "clz") ALIAS(CLZ, "clzs") \
+    OP(rbit, 0b110111, o3) ASM(RBIT, rbit, "rbit") ALIAS(RBIT, "rbits") \
+    OP(rev, 0b111000, o3) ASM(REV, rev, "rev") ALIAS(REV, "revs") \
+    OP(ldstp, 0b111001, custom)         /* ldp and stp, told apart by the load bit */ \
+        ASM(LDP, ldp, "ldp") ASM(STP, stp, "stp") \
+    OP(ldstm, 0b111010, custom)         /* ldm and stm, told apart by the load bit */ \
+        ASM(LDM, ldm, "ldm") ALIAS(LDM, "ldmia") ALIAS(LDM, "ldmdb") \
+        ASM(STM, stm, "stm") ALIAS(STM, "stmia") ALIAS(STM, "stmdb") \
+    OP(packed, 0b111011, custom)        /* 4x8 and 2x16 bit SIMD, one mnemonic per PackedOp */ \
+        ASM(PACKED, packed, "add8") ALIAS(PACKED, "sub8") \
+        ALIAS(PACKED, "umin8") ALIAS(PACKED, "umax8") ALIAS(PACKED, "smin8") ALIAS(PACKED, "smax8") \
+        ALIAS(PACKED, "cmeq8") ALIAS(PACKED, "cmgt8") ALIAS(PACKED, "add16") ALIAS(PACKED, "sub16") \
+        ALIAS(PACKED, "umin16") ALIAS(PACKED, "umax16") ALIAS(PACKED, "smin16") ALIAS(PACKED, "smax16") \
+        ALIAS(PACKED, "cmeq16") ALIAS(PACKED, "cmgt16") ALIAS(PACKED, "tbl") \
+    OP(mops, 0b111100, custom)          /* cpy and set block memory operations, told apart by the set bit */ \
+        ASM(CPY, cpy, "cpy") ASM(SET, set, "set") \
+    OP(cbz, 0b111101, custom)           /* cbz and cbnz, told apart by the nonzero bit */ \
+        ASM(CBZ, cbz, "cbz") ASM(CBNZ, cbnz, "cbnz") \
+    OP(csel, 0b111110, custom)          /* csel and csinc, cset and cinc being aliases of csinc */ \
+        ASM(CSEL, csel, "csel") ASM(CSINC, csinc, "csinc") ASM(CSET, cset, "cset") ASM(CINC, cinc, "cinc") \
+    OP(nop, 0b111111, bare)
+
+/* Expands to nothing, for the columns of EMU32_ISA a list leaves out */
+#define EMU32_ISA_SKIP(...)
+
+/**
+ * @brief           Every opcode of the instruction set, in opcode order, as X(name, opcode, disassembly).
+ *
+ * Generates the emulator's handlers and dispatch table, and the disassembler's table.
+ */
+#define EMU32_INSTRUCTIONS(X) EMU32_ISA(X, EMU32_ISA_SKIP, EMU32_ISA_SKIP)
+
+#define EMU32_NUM_OPCODES 64
+
+/* Fields every format keeps at the same bits */
+constexpr byte isa_opcode(word instr)
+{
+    return instr >> 26;
+}
+
+constexpr byte isa_x1(word instr)            /* bits 20 to 24 */
+{
+    return (instr >> 20) & 0x1F;
+}
+
+constexpr byte isa_x2(word instr)            /* bits 15 to 19 */
+{
+    return (instr >> 15) & 0x1F;
+}
+
+constexpr byte isa_x3(word instr)            /* bits 9 to 13 */
+{
+    return (instr >> 9) & 0x1F;
+}
+
+constexpr byte isa_x4(word instr)            /* bits 4 to 8 */
+{
+    return (instr >> 4) & 0x1F;
+}
+
+/* The tables are indexed by opcode, so the list has to hold every opcode once and in order */
+#define _ISA_OPCODE(name, opcode, disassembly) opcode,
+constexpr byte ISA_OPCODES[] = {EMU32_INSTRUCTIONS(_ISA_OPCODE)};
+#undef _ISA_OPCODE
+
+constexpr bool isa_opcodes_in_order()
+{
+    for (int i = 0; i < EMU32_NUM_OPCODES; i++)
+    {
+        if (ISA_OPCODES[i] != i)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+static_assert(sizeof(ISA_OPCODES) == EMU32_NUM_OPCODES && isa_opcodes_in_order(),
+        "EMU32_ISA must list every opcode once, in opcode order");
+
+/**
+ * @internal
+ * @brief                    A sequence of bits to add to a @ref Joiner
+ *
+ */
+struct JPart
+{
+    constexpr JPart(const int bits, const word val = 0) :
+        bits(bits), val(val)
+    {
+
+    }
+    const int bits;                                            /* Number of bits stored in this part */
+    const word val;                                            /* Contents of the bits stored in this part, stored with the first bit in the most significant bit */
+};
+
+/**
+ * @internal
+ * @brief                    A value that is formed by joining @ref JPart
+ *
+ */
+class Joiner
+{
+    public:
+        word val = 0;                                        /* Content stored so far */
+
+        /**
+         * @internal
+         * @brief            Add a new @ref JPart
+         *
+         * @param            p: @ref JPart to add
+         * @return             Reference to this object
+         */
+        constexpr Joiner& operator<<(const JPart& p)
+        {
+            val <<= p.bits;
+            val += p.val;
+            return *this;
+        }
+
+        /**
+         * @internal
+         * @brief            Add filler bits all set to 0
+         *
+         * @param             bits: Number of bits to add
+         * @return             Reference to this object
+         */
+        constexpr Joiner& operator<<(const int bits)
+        {
+            val <<= bits;
+            return *this;
+        }
+
+        /**
+         * @internal
+         * @brief             Extract the value of this object
+         *
+         * @return             word
+         */
+        constexpr operator word() const
+        {
+            return val;
+        }
+};
+
+#endif /* ISA_H */
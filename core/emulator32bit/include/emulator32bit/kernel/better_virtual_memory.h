@@ -6,13 +6,13 @@
 #include "emulator32bit/emulator32bit_util.h"
 #include "emulator32bit/kernel/fbl_inmemory.h"
 
+#include <cstring>
 #include <string>
+#include <unordered_map>
+#include <vector>
 
 #define N_VPAGES (1<<20)
 
-// todo, figure out how to implement shared pages. might have to use
-// dynamically allocated memory on kernel heap to do so.
-
 class MMU
 {
     public:
@@ -26,13 +26,96 @@ class MMU
             EXECUTE_ACCESSMODE,
         };
 
+        class Exception : public std::exception
+        {
+            protected:
+                std::string message;
+
+            public:
+                Exception(const std::string& msg);
+
+                const char* what() const noexcept override;
+        };
+
+        /**
+         * @brief           Page replacement counters.
+         */
+        struct Stats
+        {
+            unsigned long long page_ins = 0;        /* Pages read back from disk. */
+            unsigned long long zero_fills = 0;      /* Pages allocated zero filled on first touch. */
+            unsigned long long evictions = 0;       /* Resident pages reclaimed by the CLOCK hand. */
+            unsigned long long write_backs = 0;     /* Dirty victims written to disk. */
+            unsigned long long cow_copies = 0;      /* Shared pages copied on their first write. */
+            unsigned long long pwc_hits = 0;        /* Page walks that skipped the page directory. */
+            unsigned long long pwc_misses = 0;      /* Page walks that read the page directory. */
+        };
+
+        /**
+         * @brief           Allocates an empty page directory from a kernel page and makes it the
+         *                  current page directory of the processor.
+         *
+         * @throws          Exception if there are no free kernel pages.
+         */
         void create_pagedir();
+
+        /**
+         * @brief           Adds a virtual page to the current page directory. Physical memory is
+         *                  only allocated, zero filled, on the first access.
+         *
+         * @throws          Exception if the virtual page is already mapped or a page table could
+         *                  not be allocated.
+         */
         void add_vpage(word vpage, bool kernel, bool write,
                        bool execute, bool copy_on_write);
 
+        /**
+         * @brief           Removes a virtual page of the current page directory, releasing its
+         *                  physical and disk pages.
+         *
+         * @throws          Exception if the virtual page is not mapped.
+         */
         void remove_vpage(word vpage);
+
+        /**
+         * @brief           Maps a huge page in the current page directory. A single directory
+         *                  entry maps PTABLE_NENTRIES virtual pages onto as many contiguous user
+         *                  physical pages, taken up front and zero filled. Huge pages are pinned,
+         *                  the CLOCK hand never evicts them.
+         *
+         * @throws          Exception if the virtual page is not the first of a directory entry,
+         *                  any page in its range is mapped, or there is no run of free user
+         *                  physical pages long enough.
+         */
+        void add_huge_vpage(word vpage, bool kernel, bool write, bool execute);
+
+        /**
+         * @brief           Removes a huge page of the current page directory, releasing its
+         *                  physical pages.
+         *
+         * @throws          Exception if no huge page starts at the virtual page.
+         */
+        void remove_huge_vpage(word vpage);
+
+        /**
+         * @brief           Releases every page of the current page directory, its page tables
+         *                  and the page directory itself.
+         */
         void remove_pagedir();
 
+        /**
+         * @brief           Duplicates the current page directory for a forked process. Resident
+         *                  user pages are shared, writable ones copy on write, and are only
+         *                  copied when one of the processes first writes to them. Swapped out
+         *                  pages are read back in first so they can be shared.
+         *
+         * @throws          Exception if there are not enough kernel pages for the page tables.
+         * @return          Physical address of the new page directory.
+         */
+        word fork_pagedir();
+
+        const Stats& get_stats() const;
+
         inline word map_address(word address, AccessMode mode)
         {
             /*
@@ -45,10 +128,10 @@ class MMU
                 return address;
             }
 
-            /* Check for valid page directory. */
-            if (UNLIKELY(!processor->ram->in_bounds(processor->_pagedir)) ||
-                !processor->ram->in_bounds(processor->_pagedir +
-                (PAGE_SIZE * sizeof(struct PageTableEntry)) - 1))
+            /* Check for valid page directory, it takes exactly one page. */
+            if (UNLIKELY((processor->_pagedir & (PAGE_SIZE - 1)) ||
+                !processor->ram->in_bounds(processor->_pagedir) ||
+                !processor->ram->in_bounds(processor->_pagedir + PAGE_SIZE - 1)))
             {
                 throw Emulator32bit::Exception(Emulator32bit::BAD_PAGEDIR,
                     "Page directory is not in RAM.");
@@ -70,74 +153,116 @@ class MMU
                 return address;
             }
 
-            struct PageTableEntry *pagetable = (struct PageTableEntry *)
-                &processor->ram->data[processor->_pagedir];
-            struct PageTableEntry *entry = &pagetable[vpage];
+            /* For huge pages this is the directory entry itself. */
+            word *entry = find_entry(vpage);
 
             /* Check for access permissions. */
-            if (UNLIKELY(!entry->valid))
+            if (UNLIKELY(!entry || !(*entry & PTE_VALID)))
             {
                 throw Emulator32bit::Exception(Emulator32bit::PAGEFAULT,
                     "Unmapped memory accessed.");
             }
-            else if (UNLIKELY(entry->kernel && processor->get_flag(USER_FLAG)))
+            else if (UNLIKELY((*entry & PTE_KERNEL) && processor->get_flag(USER_FLAG)))
             {
                 throw Emulator32bit::Exception(Emulator32bit::PAGEFAULT,
                     "User tried accessing kernel page.");
             }
-            else if (UNLIKELY(mode == WRITE_ACCESSMODE && !entry->write))
+            else if (UNLIKELY(mode == WRITE_ACCESSMODE && !(*entry & PTE_WRITE)))
             {
                 throw Emulator32bit::Exception(Emulator32bit::PAGEFAULT,
                     "Page has no write permissions.");
             }
-            else if (UNLIKELY(mode == EXECUTE_ACCESSMODE && !entry->execute))
+            else if (UNLIKELY(mode == EXECUTE_ACCESSMODE && !(*entry & PTE_EXECUTE)))
             {
                 throw Emulator32bit::Exception(Emulator32bit::PAGEFAULT,
                     "Page has no execute permissions.");
             }
 
-            entry->clock = 1;
-
-            /* Read from disk and write to memory. */
-            if (UNLIKELY(entry->disk))
+            /* Huge pages are always resident and never shared. */
+            if (UNLIKELY(*entry & PTE_HUGE))
             {
-                std::vector<byte> disk_page =
-                        processor->disk->read_page(entry->disk);
-                processor->disk->return_page(entry->disk);
-
-                EXPECT_TRUE(disk_page.size() == PAGE_SIZE,
-                    "Page size does not match.");
-
-                word free_ppage = get_free_ppage();
+                *entry |= mode == WRITE_ACCESSMODE ? PTE_ACCESSED | PTE_DIRTY : PTE_ACCESSED;
+                return (*entry & PTE_FRAME) + (address & (HUGE_PAGE_SIZE - 1));
+            }
 
-                entry->disk = false;
-                entry->ppage = free_ppage;
+            /* Bring the page back into memory from disk, or zero fill it. */
+            if (UNLIKELY(!(*entry & PTE_PRESENT)))
+            {
+                page_in(entry);
+            }
 
-                word mapped_address = (free_ppage << PAGE_PSIZE) +
-                    (address & (PAGE_SIZE - 1));
-                memcpy(&processor->ram->data[mapped_address], disk_page.data(),
-                    PAGE_SIZE);
-                return mapped_address;
+            if (UNLIKELY(mode == WRITE_ACCESSMODE && (*entry & PTE_COPY_ON_WRITE)))
+            {
+                copy_on_write(entry);
             }
 
-            return (entry->ppage << PAGE_PSIZE) + (address & (PAGE_SIZE - 1));
+            *entry |= mode == WRITE_ACCESSMODE ? PTE_ACCESSED | PTE_DIRTY : PTE_ACCESSED;
+
+            return (*entry & PTE_FRAME) + (address & (PAGE_SIZE - 1));
         }
 
     private:
-        struct PageTableEntry
+        /*
+            Virtual addresses are split 10/10/12 into a page directory index, a
+            page table index and a page offset. The page directory and each
+            page table are one kernel page of 1024 packed word entries, page
+            tables are only allocated for regions that have mapped pages.
+
+                31..12  frame. For a directory entry the physical page of the
+                        page table, or the first physical page of a huge page.
+                        For a table entry the physical page if present,
+                        otherwise the disk page if on disk.
+                9       huge, only in directory entries. The entry maps the
+                        whole region itself and carries its permission bits
+                8       copy on write
+                7       execute
+                6       write
+                5       kernel
+                4       accessed, for CLOCK replacement
+                3       dirty
+                2       disk, the page has a copy stored on disk
+                1       present, the page is resident in physical memory
+                0       valid
+
+            A valid table entry is in one of three states
+                - present: resident in the frame. If disk is also set, the disk
+                  page is kept in ppage_diskpage and is up to date unless dirty.
+                - swapped: not present but disk is set, the page lives in the
+                  disk page named by the frame.
+                - untouched: neither present nor on disk, the page is zero
+                  filled when first accessed.
+        */
+        static constexpr word PTE_VALID = 1 << 0;
+        static constexpr word PTE_PRESENT = 1 << 1;
+        static constexpr word PTE_DISK = 1 << 2;
+        static constexpr word PTE_DIRTY = 1 << 3;
+        static constexpr word PTE_ACCESSED = 1 << 4;
+        static constexpr word PTE_KERNEL = 1 << 5;
+        static constexpr word PTE_WRITE = 1 << 6;
+        static constexpr word PTE_EXECUTE = 1 << 7;
+        static constexpr word PTE_COPY_ON_WRITE = 1 << 8;
+        static constexpr word PTE_HUGE = 1 << 9;
+        static constexpr word PTE_FRAME = ~(word) (PAGE_SIZE - 1);
+
+        static constexpr word PTABLE_PSIZE = 10;
+        static constexpr word PTABLE_NENTRIES = 1 << PTABLE_PSIZE;
+
+        /* No page table entry maps the physical page. */
+        static constexpr word NO_OWNER = (word) -1;
+
+        /*
+            Software page walk cache, direct mapped by page directory index.
+            Caches the page table a directory entry points to, tagged by the
+            page directory so switching processes needs no flush.
+        */
+        static constexpr word PWC_NENTRIES = 16;
+
+        struct PageWalkCacheEntry
         {
-            word ppage;                 /* Physical page mapped to */
-            word reference_count;       /* How many virtual pages map to this */
-            word diskpage;              /* Disk page stored in */
-            bool valid;                 /* Valid entry in table */
-            bool disk;                  /* Page is stored on disk */
-            bool dirty;                 /* Page has been written to */
-            bool clock;                 /* Clock based LRU replacement */
-
-            bool kernel;                /* Kernel page */
-            bool write;                 /* Write access */
-            bool execute;               /* Execute access */
-            bool copy_on_write;         /* Copies and maps new page on write */
+            word pagedir;               /* Page directory the entry was walked from, 0 if empty */
+            word dir_index;             /* Page directory index */
+            word *table;                /* Page table in RAM, or the directory entry of a huge page */
+            bool huge;                  /* Whether the directory entry maps a huge page */
         };
 
         Emulator32bit *processor;
@@ -150,6 +275,81 @@ class MMU
         FBL_InMemory free_kernel_ppages;
         word clock_hand = 0;
 
+        /*
+            Reverse mapping of user physical pages (indexed from user_low_page)
+            to the physical address of the page table entry mapping it, used by
+            the CLOCK hand to find the entry of a victim page.
+        */
+        std::vector<word> ppage_owner;
+
+        /* Disk copy of a present page (indexed from user_low_page), the entry frame holds the ppage. */
+        std::vector<word> ppage_diskpage;
+
+        /*
+            Number of page table entries mapping each user physical page
+            (indexed from user_low_page). Shared pages are never evicted, only
+            one of their entries can be the owner.
+        */
+        std::vector<word> ppage_refcount;
+
+        /*
+            Physical addresses of every page table entry mapping a shared page,
+            by user physical page index. Only pages with more than one mapping
+            have a list, so the mapping left last can take ownership back.
+        */
+        std::unordered_map<word, std::vector<word>> ppage_mappers;
+
+        PageWalkCacheEntry pwc[PWC_NENTRIES] = {};
+
+        Stats stats;
+
+        inline byte *ppage_data(word ppage)
+        {
+            return &processor->ram->data[(ppage - processor->ram->get_lo_page()) << PAGE_PSIZE];
+        }
+
+        inline word *phys_word(word address)
+        {
+            return (word *) &processor->ram->data[address - (processor->ram->get_lo_page() << PAGE_PSIZE)];
+        }
+
+        inline word phys_address(word *ptr)
+        {
+            return (word) ((byte *) ptr - processor->ram->data) +
+                (processor->ram->get_lo_page() << PAGE_PSIZE);
+        }
+
+        /**
+         * @brief           Walks the current page directory for the page table entry of a
+         *                  virtual page, going through the page walk cache.
+         *
+         * @return          The entry, the directory entry if a huge page covers the virtual
+         *                  page, or nullptr if no page table covers it.
+         */
+        inline word *find_entry(word vpage)
+        {
+            word dir_index = vpage >> PTABLE_PSIZE;
+            PageWalkCacheEntry& cached = pwc[dir_index & (PWC_NENTRIES - 1)];
+            if (LIKELY(cached.pagedir == processor->_pagedir && cached.dir_index == dir_index))
+            {
+                stats.pwc_hits++;
+                return cached.huge ? cached.table : &cached.table[vpage & (PTABLE_NENTRIES - 1)];
+            }
+
+            stats.pwc_misses++;
+            word *pde = &phys_word(processor->_pagedir)[dir_index];
+            if (!(*pde & PTE_VALID))
+            {
+                return nullptr;
+            }
+
+            cached.pagedir = processor->_pagedir;
+            cached.dir_index = dir_index;
+            cached.huge = *pde & PTE_HUGE;
+            cached.table = cached.huge ? pde : phys_word(*pde & PTE_FRAME);
+            return cached.huge ? cached.table : &cached.table[vpage & (PTABLE_NENTRIES - 1)];
+        }
+
         inline word get_free_ppage()
         {
             if (UNLIKELY(free_user_ppages.empty()))
@@ -157,16 +357,78 @@ class MMU
                 return evict_ppage();
             }
 
-            return free_user_ppages.get_free_block() >> PAGE_PSIZE;
+            return (free_user_ppages.get_free_block() >> PAGE_PSIZE) +
+                processor->ram->get_lo_page();
+        }
+
+        inline void return_ppage(word ppage)
+        {
+            ppage_owner[ppage - user_low_page] = NO_OWNER;
+            free_user_ppages.return_block((ppage - processor->ram->get_lo_page()) << PAGE_PSIZE);
         }
 
-        inline word evict_ppage()
+        /**
+         * @brief           Takes PTABLE_NENTRIES contiguous user physical pages for a huge page.
+         *
+         * @throws          Exception if there is no run of free user pages long enough.
+         * @return          First physical page of the run.
+         */
+        word alloc_huge();
+
+        inline void return_huge(word ppage)
         {
-            return 0;
+            free_user_ppages.return_blocks((ppage - processor->ram->get_lo_page()) << PAGE_PSIZE,
+                                           PTABLE_NENTRIES);
         }
+
+        /**
+         * @brief           Allocates a zeroed kernel page for the page directory or a page table.
+         *
+         * @throws          Exception if there are no free kernel pages.
+         * @return          Physical address of the page.
+         */
+        word alloc_table();
+
+        /**
+         * @brief           Drops every page walk cache entry walked from the page directory.
+         */
+        void invalidate_pwc(word pagedir);
+
+        /**
+         * @brief           Makes the page of a valid entry resident, reading it from disk if it
+         *                  was swapped out and zero filling it otherwise.
+         */
+        void page_in(word *entry);
+
+        /**
+         * @brief           Handles the first write to a copy on write page, copying it if it is
+         *                  still shared and otherwise taking it over.
+         */
+        void copy_on_write(word *entry);
+
+        /**
+         * @brief           Reclaims a user physical page with the CLOCK (second chance)
+         *                  algorithm, preferring pages that are neither referenced nor dirty.
+         *                  Dirty victims are written to disk, clean victims are dropped.
+         *
+         * @throws          Emulator32bit::Exception if no user page can be reclaimed.
+         * @return          The reclaimed physical page.
+         */
+        word evict_ppage();
+
+        /**
+         * @brief           Releases the physical and disk pages held by an entry.
+         */
+        void release_entry(word *entry);
+
+        /**
+         * @brief           Removes a mapping of a shared page whose refcount was already dropped,
+         *                  handing ownership to a remaining mapping.
+         */
+        void unshare(word index, word entry_address);
 };
 
 
 
 
-#endif /* BETTER_VIRTUAL_MEMORY */
\ No newline at end of file
+#endif /* BETTER_VIRTUAL_MEMORY */
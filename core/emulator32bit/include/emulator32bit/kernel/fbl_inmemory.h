@@ -34,6 +34,19 @@ class FBL_InMemory
         word get_free_block();
         void return_block(word block_addr);
 
+        /**
+         * @brief           Takes the first run of nblocks contiguous free blocks.
+         *
+         * @throws          Exception if no run of free blocks is long enough.
+         * @return          Memory index of the first block of the run.
+         */
+        word get_free_blocks(word nblocks);
+
+        /**
+         * @brief           Returns a run of nblocks contiguous blocks taken by get_free_blocks.
+         */
+        void return_blocks(word block_addr, word nblocks);
+
         bool empty();
         int nfree();
         int nnodes();
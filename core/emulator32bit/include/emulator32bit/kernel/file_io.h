@@ -0,0 +1,142 @@
+#pragma once
+#ifndef FILE_IO_H
+#define FILE_IO_H
+
+#include "emulator32bit/emulator32bit.h"
+
+#include <condition_variable>
+#include <deque>
+#include <filesystem>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#define GUEST_AT_FDCWD ((word) -100)    /* openat dirfd for paths relative to the sandbox root */
+#define IO_THREADS 4                    /* Host threads servicing io_submit requests */
+#define IO_BATCH_PAGES 16               /* Guest pages per readv/writev of a synchronous transfer */
+
+/* Guest struct iocb, 6 words: data, opcode, fd, buf, nbytes, offset */
+#define IOCB_SIZE 24
+#define IOCB_CMD_PREAD 0
+#define IOCB_CMD_PWRITE 1
+
+/* Guest struct io_event, 4 words: data, obj (the iocb), res, res2 */
+#define IO_EVENT_SIZE 16
+
+/**
+ * @brief           Host files for the open, read, write, close and lseek syscalls, and the
+ *                  asynchronous io_setup, io_submit and io_getevents ones.
+ *
+ * Paths resolve inside a sandbox directory set by the host, nothing can be opened until one is
+ * set, and symlinks are never followed. Guest fds 0-2 are the console, writes to them go to the
+ * @ref UART. Transfers go straight between the host file and the guest's RAM pages with
+ * readv/writev, the pages are pinned so they are not swapped out from under the host.
+ * Asynchronous requests run on a pool of host threads, started on the first io_setup, and
+ * completions wake a processor waiting in WFI.
+ *
+ * Host files need POSIX, on Windows builds only the console works and everything else returns
+ * -ENOSYS. Like the Linux syscalls, errors are returned as negative errno values. Closing a file
+ * or unmapping a buffer with requests still in flight is undefined, like it is for real hardware.
+ */
+class FileManager
+{
+    public:
+        FileManager(Emulator32bit *processor);
+        ~FileManager();
+
+        /**
+         * @brief           Directory guest paths resolve in. Absolute guest paths are relative
+         *                  to it too, and paths that climb out of it are refused.
+         */
+        void set_root(const std::string& directory);
+
+        /**
+         * @param           dirfd: Only @ref GUEST_AT_FDCWD.
+         * @param           path: Guest address of the path.
+         * @param           flags: Linux O_* flags, the access mode, O_CREAT, O_EXCL, O_TRUNC
+         *                  and O_APPEND are honored.
+         * @return          The guest fd.
+         */
+        word openat(word dirfd, word path, word flags, word mode);
+        word close(word fd);
+        word read(word fd, word buf, word count);
+        word write(word fd, word buf, word count);
+        word lseek(word fd, word offset, word whence);
+
+        /**
+         * @brief           Creates a context for up to nr_events requests in flight and stores
+         *                  its id at ctxp.
+         */
+        word io_setup(word nr_events, word ctxp);
+
+        /**
+         * @brief           Waits for the requests in flight and destroys the context.
+         */
+        word io_destroy(word ctx);
+
+        /**
+         * @brief           Queues the nr iocbs pointed to by the array at iocbpp.
+         *
+         * @return          Number of requests queued, -EAGAIN if the context is full.
+         */
+        word io_submit(word ctx, word nr, word iocbpp);
+
+        /**
+         * @brief           Copies up to nr completions to events, first waiting for min_nr of
+         *                  them unless the timeout, a guest timespec of two words, runs out.
+         *                  A null timeout waits as long as it takes.
+         *
+         * @return          Number of completions copied.
+         */
+        word io_getevents(word ctx, word min_nr, word nr, word events, word timeout);
+
+        /**
+         * @brief           Whether a request is in flight, or finished without the processor
+         *                  having picked the completion up yet.
+         */
+        bool busy();
+
+    private:
+        struct Completion
+        {
+            word data;
+            word obj;
+            sword res;
+        };
+
+        struct IOContext
+        {
+            word max_events;
+            word in_flight = 0;
+            std::deque<Completion> done;
+        };
+
+        Emulator32bit *processor;
+        std::filesystem::path root;
+        std::vector<int> fds;                           /* Host fd of each guest fd, -1 when closed */
+
+        /* Guarded by mutex, shared with the io threads */
+        std::mutex mutex;
+        std::condition_variable job_ready;
+        std::condition_variable completed;
+        std::deque<std::function<void()>> jobs;
+        std::vector<std::vector<SystemBus::HostSpan>> finished_spans;  /* Waiting to be unpinned */
+        std::unordered_map<word, IOContext> contexts;
+        bool stopping = false;
+
+        std::vector<std::thread> workers;
+        word next_context = 1;
+
+        int host_fd(word fd);
+        word console_write(word fd, word buf, word count);
+        word transfer(int host, word buf, word count, bool to_guest);
+        void submit(word ctx, word iocb, word data, word opcode, int fd, word buf, word nbytes,
+                word offset);
+        void release_finished();
+        void work();
+};
+
+#endif /* FILE_IO_H */
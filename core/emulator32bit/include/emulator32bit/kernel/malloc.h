@@ -2,6 +2,85 @@
 #ifndef MALLOC_H
 #define MALLOC_H
 
+#include "emulator32bit/fbl.h"
+#include "emulator32bit/virtual_memory.h"
 
+#include <memory>
+#include <unordered_map>
 
-#endif /* MALLOC_H */
\ No newline at end of file
+#define HEAP_START 0x10000000       /* Program break of a process the loader has not set one for. */
+#define MMAP_START 0x40000000       /* Anonymous mappings are placed in [MMAP_START, MMAP_END). */
+#define MMAP_END 0x80000000         /* Mappings stay below the sign bit so errors are negative. */
+
+#define MMAP_PROT_WRITE 0x2
+#define MMAP_PROT_EXEC 0x4
+#define MMAP_ANONYMOUS 0x20
+
+/**
+ * @brief           Runtime memory of the processes of a @ref VirtualMemory, grown with the brk,
+ *                  mmap and munmap syscalls.
+ *
+ * New pages are demand zero segments, nothing is allocated until they are first touched and
+ * unmapped pages go straight back to the physical page allocator. Errors are returned as
+ * negative errno values like the Linux syscalls.
+ */
+class MemoryManager
+{
+    public:
+        MemoryManager(VirtualMemory *mmu);
+
+        /**
+         * @brief           Sets where the heap of a process starts, rounded up to a page. Called by
+         *                  the loader with the end of the program's segments.
+         */
+        void set_break(long long pid, word address);
+
+        /**
+         * @brief           Moves the program break, mapping or unmapping heap pages.
+         *
+         * @param           address: New break, 0 to query it.
+         * @return          The program break, unchanged if address is invalid or out of memory.
+         */
+        word brk(long long pid, word address);
+
+        /**
+         * @brief           Maps zeroed anonymous pages. Only MMAP_ANONYMOUS mappings are supported,
+         *                  placement is always chosen by the kernel.
+         *
+         * @param           length: Bytes to map, rounded up to whole pages.
+         * @param           prot: Linux PROT_* bits, pages are always readable.
+         * @param           flags: Linux MAP_* bits.
+         * @return          Address of the mapping, -EINVAL or -ENOMEM.
+         */
+        word mmap(long long pid, word length, word prot, word flags);
+
+        /**
+         * @brief           Unmaps pages previously mapped by @ref mmap, possibly part of a mapping.
+         *
+         * @param           address: Page aligned start of the range.
+         * @param           length: Bytes to unmap, rounded up to whole pages.
+         * @return          0 on success, -EINVAL if part of the range is not mapped.
+         */
+        word munmap(long long pid, word address, word length);
+
+        /**
+         * @brief           Drops the bookkeeping of an ended process. Its pages are freed by
+         *                  @ref VirtualMemory::end_process.
+         */
+        void release(long long pid);
+
+    private:
+        struct Heap
+        {
+            word start;                             /* First page aligned address of the heap. */
+            word brk;                               /* Current program break. */
+            FreeBlockList free_vpages;              /* Unmapped virtual pages of the mmap region. */
+        };
+
+        VirtualMemory *mmu;
+        std::unordered_map<long long, std::unique_ptr<Heap>> heaps;
+
+        Heap& get_heap(long long pid);
+};
+
+#endif /* MALLOC_H */
@@ -2,7 +2,89 @@
 #ifndef PROCESS_H
 #define PROCESS_H
 
+#include "emulator32bit/emulator32bit.h"
 
+#include <deque>
 
+/**
+ * @brief           Process control block of a guest process.
+ */
+struct Process
+{
+    long long pid;                              /* Address space in the MMU, also the ASID of its TLB entries. */
+    Emulator32bit::ProcessContext context;      /* Saved while the process is switched out. */
+};
 
-#endif /* PROCESS_H */
\ No newline at end of file
+/**
+ * @brief           Round robin scheduler switching guest processes every quantum instructions.
+ *
+ * Preemption is a scheduled event, so switches happen between instructions without the
+ * processor checking anything per instruction. A switch copies the register file in and out
+ * of the process control blocks and swaps the address space of the @ref VirtualMemory. The
+ * TLB is tagged by ASID, so translations of switched out processes stay warm.
+ */
+class ProcessScheduler
+{
+    public:
+        ProcessScheduler(Emulator32bit *processor, unsigned long long quantum);
+        ~ProcessScheduler();
+
+        /**
+         * @brief           Creates a process with its own address space and adds it to the back
+         *                  of the run queue. The running address space is left unchanged.
+         *
+         * @throws          VirtualMemoryException when the MAX_PROCESSES limit is reached.
+         * @param           entry: Address of the first instruction.
+         * @param           stack: Initial stack pointer.
+         * @param           kernel_privilege: Whether the process has kernel level access privilege.
+         * @return          The new process, owned by the scheduler.
+         */
+        Process* spawn(word entry, word stack, bool kernel_privilege = false);
+
+        /**
+         * @brief           Removes a process and its address space. Switches to the next process
+         *                  if it was running.
+         */
+        void exit(Process *process);
+
+        /**
+         * @brief           Switches to the front of the run queue if nothing is running and starts
+         *                  preempting every quantum instructions.
+         */
+        void start();
+
+        /**
+         * @brief           Stops preempting, the running process keeps the processor.
+         */
+        void stop();
+
+        /**
+         * @brief           Moves the running process to the back of the run queue and switches to
+         *                  the front. Must be called between instructions.
+         */
+        void yield();
+
+        inline Process* current()
+        {
+            return running;
+        }
+
+        inline unsigned long long switches()
+        {
+            return nswitches;
+        }
+
+    private:
+        Emulator32bit *processor;
+        unsigned long long quantum;
+        std::deque<Process*> run_queue;            /* Ready processes, not including the running one. */
+        Process *running = nullptr;
+        unsigned long long nswitches = 0;
+        bool preempting = false;
+        EventScheduler::EventID next_preempt = 0;
+
+        void switch_to(Process *next);
+        void schedule_preempt();
+};
+
+#endif /* PROCESS_H */
@@ -5,7 +5,9 @@
 #include "emulator32bit/emulator32bit_util.h"
 #include "util/file.h"
 
+#include <memory>
 #include <string>
+#include <vector>
 
 class BaseMemory
 {
@@ -98,6 +100,10 @@ class Memory : public BaseMemory
         void reset();
 
         byte* data;
+
+    protected:
+        /* Takes over data, which the subclass owns when it did not come from new[]. */
+        Memory(word npages, word start_page, byte* data);
 };
 
 class RAM : public Memory
@@ -106,13 +112,55 @@ class RAM : public Memory
         RAM(word npages, word start_pages);
 };
 
+/*
+    A ROM built from a file maps the file instead of reading it in. READ_ONLY
+    ROMs keep writes in memory and never touch the file. FLASH ROMs write
+    through to the file, and only the pages written to are flushed when the
+    ROM is destroyed.
+*/
 class ROM : public Memory
 {
     public:
+        enum class Mode
+        {
+            READ_ONLY, FLASH,
+        };
+
         ROM(const byte* data, word npages, word start_page);
-        ROM(File file, word npages, word start_page);
+        ROM(File file, word npages, word start_page, Mode mode = Mode::READ_ONLY);
         ~ROM() override;
 
+        inline void write_byte(word address, byte value) override
+        {
+            mark_dirty(address);
+            Memory::write_byte(address, value);
+        }
+
+        inline void write_hword(word address, hword value) override
+        {
+            mark_dirty(address, sizeof(hword));
+            Memory::write_hword(address, value);
+        }
+
+        inline void write_word(word address, word value) override
+        {
+            mark_dirty(address, sizeof(word));
+            Memory::write_word(address, value);
+        }
+
+        /**
+         * @brief           The contents of a ROM survive a reset.
+         */
+        void reset();
+
+        /**
+         * @brief           Whether anything was written to the ROM since it was created.
+         */
+        inline bool is_dirty() const
+        {
+            return ndirty_pages > 0;
+        }
+
         class ROM_Exception : public std::exception
         {
             private:
@@ -123,12 +171,29 @@ class ROM : public Memory
                 const char* what() const noexcept override;
         };
 
-        /* todo, prevent writes, have special way to flash memory */
+    private:
+        Mode mode = Mode::READ_ONLY;
+        std::unique_ptr<MappedFile> mapping;
+        std::vector<bool> dirty_pages;
+        word ndirty_pages = 0;
 
+        inline void mark_dirty(word address)
+        {
+            word page = (address - start_addr) >> PAGE_PSIZE;
+            if (UNLIKELY(!dirty_pages[page]))
+            {
+                dirty_pages[page] = true;
+                ndirty_pages++;
+            }
+        }
 
-    private:
-        bool save_file = false;
-        File file;
+        /* A write running past the end of the ROM only dirties the pages it has. */
+        inline void mark_dirty(word address, word size)
+        {
+            const word hi_addr = ((get_hi_page() + 1) << PAGE_PSIZE) - 1;
+            mark_dirty(address);
+            mark_dirty(address > hi_addr - (size - 1) ? hi_addr : address + size - 1);
+        }
 };
 
 #endif /* MEMORY_H */
\ No newline at end of file
@@ -0,0 +1,108 @@
+#pragma once
+#ifndef PAGE_ALLOCATOR_H
+#define PAGE_ALLOCATOR_H
+
+#include "emulator32bit/emulator32bit_util.h"
+
+#include <string>
+#include <vector>
+
+/**
+ * @brief            Allocator of physical pages.
+ *
+ * @details            One bit per page marks whether it is free, and a summary bit per word of
+ *                     that bitmap marks whether the word has a free page. Allocating and freeing
+ *                     single pages never walks a list, however fragmented memory gets. Pages are
+ *                     handed out lowest first, like a first fit @ref FreeBlockList.
+ */
+class PageAllocator
+{
+    public:
+        /**
+         * @brief             Construct an allocator with every page free.
+         *
+         * @param begin        First page managed by the allocator.
+         * @param npages    Number of pages managed.
+         */
+        PageAllocator(word begin, word npages);
+
+        class PageAllocatorException : public std::exception
+        {
+            private:
+                std::string message;
+
+            public:
+                PageAllocatorException(const std::string& msg);
+
+                const char* what() const noexcept override;
+        };
+
+        /**
+         * @brief             Takes the lowest free page.
+         *
+         * @throws            PageAllocatorException if no page is free.
+         * @return             The allocated page.
+         */
+        word alloc();
+
+        /**
+         * @brief             Takes the lowest run of npages free pages.
+         *
+         * @throws            PageAllocatorException if no run of free pages is long enough.
+         * @param npages    Length of the run.
+         * @return             First page of the run.
+         */
+        word alloc_contiguous(word npages);
+
+        /**
+         * @brief             Takes a specific free page.
+         *
+         * @throws            PageAllocatorException if the page is not free.
+         */
+        void reserve(word page);
+
+        /**
+         * @brief             Returns allocated pages.
+         *
+         * @throws            PageAllocatorException if a page is out of range or already free.
+         * @param page        First page to return.
+         * @param npages    Number of pages to return.
+         */
+        void free(word page, word npages = 1);
+
+        /**
+         * @brief             Whether a run of npages free pages exists.
+         */
+        bool can_fit(word npages);
+
+        bool is_free(word page);
+
+        /**
+         * @brief             Number of free pages.
+         */
+        inline word available()
+        {
+            return m_nfree;
+        }
+
+    private:
+        static constexpr word WORD_PAGES = 8 * sizeof(dword);
+
+        word m_begin;
+        word m_npages;
+        word m_nfree;
+        std::vector<dword> m_free;            /* Bit per page, set when free. */
+        std::vector<dword> m_summary;        /* Bit per word of m_free, set when it has a free page. */
+        word m_first_summary = 0;            /* No summary word before this has a bit set. */
+
+        /**
+         * @brief             Finds the lowest run of npages free pages.
+         *
+         * @return             Offset of the run from m_begin, m_npages if there is none.
+         */
+        word find_run(word npages);
+
+        void set_free(word offset, bool free);
+};
+
+#endif /* PAGE_ALLOCATOR_H */
@@ -0,0 +1,74 @@
+#pragma once
+#ifndef SCHEDULER_H
+#define SCHEDULER_H
+
+#include <functional>
+#include <queue>
+#include <unordered_map>
+#include <vector>
+
+#define NO_DEADLINE (~0ULL)
+
+/**
+ * @brief            Queue of events ordered by the instruction count they are due at.
+ *
+ * @details            The processor runs uninterrupted up to the earliest deadline and only then
+ *                     calls @ref run_due, so scheduled events cost nothing per instruction. Timers
+ *                     and other devices share the one queue. Events due at the same time run in
+ *                     the order they were scheduled.
+ */
+class EventScheduler
+{
+    public:
+        typedef std::function<void()> Handler;
+        typedef unsigned long long EventID;
+
+        /**
+         * @brief             Schedules handler to run once the instruction count reaches deadline.
+         *
+         * @param deadline    Instruction count the event is due at.
+         * @param handler    Called when the event is due, may schedule more events.
+         * @return             ID to cancel the event with.
+         */
+        EventID schedule(unsigned long long deadline, Handler handler);
+
+        /**
+         * @brief             Cancels an event that has not run yet.
+         *
+         * @param id        ID returned by @ref schedule.
+         * @return             Whether the event was still pending.
+         */
+        bool cancel(EventID id);
+
+        /**
+         * @brief             Deadline of the earliest pending event, @ref NO_DEADLINE if there is none.
+         */
+        unsigned long long next_deadline();
+
+        /**
+         * @brief             Runs every event due at or before now, including events scheduled
+         *                     by the handlers that are already due.
+         *
+         * @param now        Current instruction count.
+         * @return             Number of events that ran.
+         */
+        size_t run_due(unsigned long long now);
+
+    private:
+        struct Event
+        {
+            unsigned long long deadline;
+            EventID id;
+
+            inline bool operator>(const Event& other) const
+            {
+                return deadline > other.deadline || (deadline == other.deadline && id > other.id);
+            }
+        };
+
+        std::priority_queue<Event, std::vector<Event>, std::greater<Event>> m_events;
+        std::unordered_map<EventID, Handler> m_handlers;                /* cancelled events have no handler */
+        EventID m_next_id = 0;
+};
+
+#endif /* SCHEDULER_H */
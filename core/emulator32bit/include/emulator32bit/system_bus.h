@@ -10,7 +10,12 @@
 #define AEMU_ONLY_CRITICAL_LOG
 #include "util/logger.h"
 
+#include <string>
 #include <vector>
+
+/* Addresses from here up go to attached devices in every address space, untranslated */
+#define MMIO_START 0xFFFF0000
+
 class SystemBus
 {
     public:
@@ -49,6 +54,11 @@ class SystemBus
 
         inline void ensure_unmapped_mapping(word address)
         {
+            if (UNLIKELY(address >= MMIO_START))
+            {
+                return;
+            }
+
             VirtualMemory::Exception exception;
             word ppage = address >> PAGE_PSIZE;
             mmu.ensure_physical_page_mapping(mmu.current_process(), ppage, ppage, exception);
@@ -190,9 +200,118 @@ class SystemBus
             }
         }
 
+        /**
+         * @brief           Reads the null terminated string at address. Translates once per page
+         *                  and scans each page with memchr instead of reading byte by byte.
+         *
+         * @param address   Virtual address of the first character.
+         * @return          The string, without the terminator.
+         */
+        std::string read_cstring(word address);
+
+        /**
+         * @brief           Copies length bytes starting at address into dst, translating once
+         *                  per page.
+         *
+         * @param address   Virtual address to read from.
+         * @param dst       Host buffer of at least length bytes.
+         * @param length    Number of bytes to copy.
+         */
+        void read_buffer(word address, byte* dst, word length);
+
+        /**
+         * @brief           Copies length bytes from src to address, translating once per page.
+         *                  Writes to ROM pages still mark them dirty.
+         *
+         * @param address   Virtual address to write to.
+         * @param src       Host buffer of at least length bytes.
+         * @param length    Number of bytes to copy.
+         */
+        void write_buffer(word address, const byte* src, word length);
+
+        /**
+         * @brief           Copies up to length bytes from src to dst, stopping at the end of the
+         *                  page either lies in, so a block copy can be done a page at a time.
+         *                  Overlapping ranges are copied as by memmove.
+         *
+         * @param dst       Virtual address to copy to.
+         * @param src       Virtual address to copy from.
+         * @param length    Most bytes to copy.
+         * @return          Bytes copied, at least 1 unless length is 0.
+         */
+        word copy_chunk(word dst, word src, word length);
+
+        /**
+         * @brief           Sets up to length bytes at address to value, stopping at the end of
+         *                  its page.
+         *
+         * @param address   Virtual address to fill.
+         * @param value     Byte to fill with.
+         * @param length    Most bytes to fill.
+         * @return          Bytes filled, at least 1 unless length is 0.
+         */
+        word fill_chunk(word address, byte value, word length);
+
+        /**
+         * @brief           Host memory backing part of a guest buffer, within one page.
+         */
+        struct HostSpan
+        {
+            byte *data;
+            word length;
+            word ppage;                             /* Pinned physical page */
+        };
+
+        /**
+         * @brief           Pins the pages of a guest buffer and returns host pointers to them, so
+         *                  the host can do I/O straight into guest memory. Stops early at a page
+         *                  that faults, that is not RAM (or ROM when the host only reads from it),
+         *                  or after max_spans pages. Must be undone with @ref unpin_host_spans.
+         *
+         * @param address   Virtual address of the buffer.
+         * @param length    Length of the buffer.
+         * @param write     Whether the host writes into the buffer.
+         * @param spans     Filled with one span per page, in order.
+         * @param max_spans Most pages to pin.
+         * @return          Bytes of the buffer the spans cover.
+         */
+        word pin_host_spans(word address, word length, bool write, std::vector<HostSpan>& spans,
+                word max_spans);
+
+        void unpin_host_spans(const std::vector<HostSpan>& spans);
+
+        /**
+         * @brief           Routes accesses to the device's pages. Devices live in the MMIO
+         *                  window from @ref MMIO_START, which bypasses the MMU.
+         */
+        void attach_device(BaseMemory *device);
+
         void reset();
 
+        /* Host pointer to a physical address in RAM or ROM, nullptr for memory without one. */
+        inline byte* host_pointer(word paddr)
+        {
+            if (ram.in_bounds(paddr))
+            {
+                return ram.data + (paddr - (ram.get_lo_page() << PAGE_PSIZE));
+            }
+            else if (rom.in_bounds(paddr))
+            {
+                return rom.data + (paddr - (rom.get_lo_page() << PAGE_PSIZE));
+            }
+
+            return nullptr;
+        }
+
     private:
+        std::vector<BaseMemory*> devices;
+
+        /* Bytes from address to the end of its page. */
+        static inline word page_remaining(word address)
+        {
+            return PAGE_SIZE - (address & (PAGE_SIZE - 1));
+        }
+
         inline void handle_mmu_exception(VirtualMemory::Exception& exception)
         {
             if (exception.type == VirtualMemory::Exception::Type::DISK_RETURN_AND_FETCH_SUCCESS)
@@ -235,6 +354,11 @@ class SystemBus
 
         inline word translate_address(word address)
         {
+            if (UNLIKELY(address >= MMIO_START))
+            {
+                return address;
+            }
+
             VirtualMemory::Exception exception;
             word addr = mmu.translate_address(address, exception);
 
@@ -260,10 +384,16 @@ class SystemBus
             {
                 return &disk;
             }
-            else
+
+            for (BaseMemory *device : devices)
             {
-                throw Exception("Could not route address " + std::to_string(address) + " to memory.");
+                if (device->in_bounds(address))
+                {
+                    return device;
+                }
             }
+
+            throw Exception("Could not route address " + std::to_string(address) + " to memory.");
         }
 };
 
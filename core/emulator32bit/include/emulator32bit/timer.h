@@ -6,21 +6,36 @@
 
 /**
  * @brief           Simulates a hardware timer
- * 
- * todo, goal of this is to generate timer interrupts every so often
- * in order to do this, we need a way of stopping processor execution to handle
- * this interrupt.
+ *
+ * Once started, the timer ticks every period instructions and raises a
+ * @ref Emulator32bit::TIMER interrupt on each tick. Ticks are scheduled
+ * events, the processor does not check the timer between instructions.
  */
 class Timer
 {
     public:
         Timer(Emulator32bit *processor);
+        ~Timer();
+
+        /**
+         * @brief           Starts ticking every period instructions, restarting the timer if it
+         *                  was already running.
+         *
+         * @param           period: Instructions between ticks, at least 1.
+         */
+        void start(unsigned long long period);
+
+        /**
+         * @brief           Stops the timer, no more ticks are raised.
+         */
+        void stop();
 
         inline void tick()
         {
             clock++;
+            processor->raise_interrupt(Emulator32bit::TIMER);
         }
-        
+
         inline unsigned long long time()
         {
             return clock;
@@ -29,6 +44,11 @@ class Timer
     private:
         Emulator32bit *processor;
         unsigned long long clock = 0;
+        unsigned long long period = 0;
+        bool running = false;
+        EventScheduler::EventID next_tick = 0;
+
+        void schedule_tick();
 };
 
-#endif
\ No newline at end of file
+#endif /* TIMER_H */
@@ -0,0 +1,127 @@
+#pragma once
+#ifndef UART_H
+#define UART_H
+
+#include "emulator32bit/emulator32bit.h"
+
+#include <cstdio>
+#include <string>
+
+#define UART_BASE MMIO_START
+#define UART_RING_SIZE 1024                        /* Bytes in each ring, a power of two */
+#define UART_FLUSH_THRESHOLD (64 * 1024)           /* Host output buffered before it is written out */
+
+/* Register offsets from @ref UART_BASE, all registers are words */
+#define UART_DATA 0x00              /* Write pushes a byte to the TX ring, read pops one from the RX ring (0 when empty) */
+#define UART_STATUS 0x04            /* Read only, see UART_STATUS_* */
+#define UART_CTRL 0x08              /* See UART_CTRL_* */
+#define UART_TX_HEAD 0x0C           /* Guest writes it after filling the TX ring */
+#define UART_TX_TAIL 0x10           /* Read only, advanced as the host drains the TX ring */
+#define UART_RX_HEAD 0x14           /* Read only, advanced as input arrives */
+#define UART_RX_TAIL 0x18           /* Guest writes it after consuming the RX ring */
+#define UART_TX_RING 0x800          /* TX ring bytes, indexed by head & (UART_RING_SIZE - 1) */
+#define UART_RX_RING 0xC00          /* RX ring bytes, indexed by tail & (UART_RING_SIZE - 1) */
+
+#define UART_STATUS_RX_READY 0x1
+#define UART_STATUS_TX_FULL 0x2
+#define UART_CTRL_RX_INTERRUPT 0x1  /* Raise @ref Emulator32bit::UART_RX when input arrives */
+#define UART_CTRL_TX_FLUSH 0x2      /* Write output out to the host whenever UART_TX_HEAD is written */
+
+/**
+ * @brief           Memory mapped console.
+ *
+ * The guest either writes bytes to @ref UART_DATA, or fills the TX ring itself and publishes
+ * them with @ref UART_TX_HEAD. Head and tail registers are free running byte counts. Nothing
+ * reaches the host per byte, the TX ring is drained into a host side buffer when it fills or
+ * the guest publishes with @ref UART_TX_HEAD, and the buffer is written out in one go at stop
+ * points, when the processor stops running or waits for an event, or once it grows past
+ * @ref UART_FLUSH_THRESHOLD. A guest that prompts for input without waiting in WFI sets
+ * @ref UART_CTRL_TX_FLUSH to have every publish written out.
+ *
+ * Register reads have side effects, so an access to the register window reads the register it
+ * starts in exactly once, whatever its size.
+ *
+ * Input is queued with @ref receive on the emulator thread or @ref post_input from any other,
+ * so a host thread can read stdin without ever blocking the processor. Input that does not fit
+ * in the RX ring waits on the host until the guest makes room.
+ */
+class UART : public BaseMemory
+{
+    public:
+        UART(Emulator32bit *processor);
+        ~UART() override;
+
+        byte read_byte(word address) override;
+        hword read_hword(word address) override;
+        word read_word(word address) override;
+        void write_byte(word address, byte value) override;
+        void write_hword(word address, hword value) override;
+        void write_word(word address, word value) override;
+
+        /**
+         * @brief           Sends host output, like the emu_log syscall, through the same buffer
+         *                  as the guest's so the two stay in order.
+         */
+        void print(const std::string& str);
+        void print(const byte *data, word length);
+
+        /**
+         * @brief           Drains the TX ring and writes everything buffered to the output.
+         */
+        void flush();
+
+        /**
+         * @brief           Where output is written, stdout by default. Any stream works, a file
+         *                  or a pipe from popen. The UART does not close it.
+         */
+        void set_output(FILE *output);
+
+        /**
+         * @brief           Queues input for the guest. Must be called on the emulator thread.
+         */
+        void receive(const byte *data, word length);
+
+        /**
+         * @brief           Queues input for the guest from any thread, wakes a processor
+         *                  waiting in WFI. The thread should be attached with
+         *                  @ref Emulator32bit::attach_event_source while it may post input.
+         */
+        void post_input(std::string data);
+
+        /**
+         * @brief           Drops buffered input and output and clears the registers.
+         */
+        void reset();
+
+        inline word tx_pending()
+        {
+            return tx_head - tx_tail;
+        }
+
+        inline word rx_pending()
+        {
+            return rx_head - rx_tail;
+        }
+
+    private:
+        Emulator32bit *processor;
+        FILE *output = stdout;
+        std::string out_buffer;                    /* Drained output not yet written */
+        std::string in_backlog;                    /* Input that did not fit in the RX ring */
+
+        word ctrl = 0;
+        word tx_head = 0;
+        word tx_tail = 0;
+        word rx_head = 0;
+        word rx_tail = 0;
+        byte tx_ring[UART_RING_SIZE] = {};
+        byte rx_ring[UART_RING_SIZE] = {};
+
+        word read_register(word offset);
+        void write_register(word offset, word value);
+        void drain();                              /* Moves the TX ring into out_buffer */
+        void write_out();
+        void refill();                             /* Moves in_backlog into the RX ring */
+};
+
+#endif /* UART_H */
@@ -5,14 +5,36 @@
 #include "emulator32bit/emulator32bit_util.h"
 #include "emulator32bit/disk.h"
 #include "emulator32bit/fbl.h"
+#include "emulator32bit/page_allocator.h"
 
+#include <memory>
 #include <unordered_map>
+#include <vector>
 
 #define VM_MAX_PAGES 1024
 #define TLB_PSIZE 12
 #define TLB_SIZE (1 << TLB_PSIZE)
+#define TLB_WAYS 4
+#define TLB_INVALID_TAG ((word) -1)
 #define MAX_PROCESSES 1024
 #define NUM_PPAGES (1 << (8 * sizeof(word) - PAGE_PSIZE))
+#define NUM_VPAGES (1 << (8 * sizeof(word) - PAGE_PSIZE))
+
+/* Page tables are two level radix trees, a virtual page is split into a directory index (upper
+   bits) and an index into the second level table (lower bits). */
+#define PTABLE_L2_PSIZE 10
+#define PTABLE_L2_SIZE (1 << PTABLE_L2_PSIZE)
+#define PTABLE_L1_SIZE (NUM_VPAGES >> PTABLE_L2_PSIZE)
+
+/* A huge page covers the whole range of one second level table, 4 MiB of contiguous physical
+   memory mapped by a single directory slot and a single TLB entry. */
+#define HUGE_PAGE_PSIZE (PAGE_PSIZE + PTABLE_L2_PSIZE)
+#define HUGE_PAGE_SIZE (1 << HUGE_PAGE_PSIZE)
+#define HUGE_PAGE_NPAGES PTABLE_L2_SIZE
+#define HUGE_TLB_SIZE 8
+
+/* Demand page with no segment, zero filled on first touch. */
+#define NO_SEGMENT ((word) -1)
 
 /*
     idea
@@ -37,7 +59,15 @@
 class VirtualMemory
 {
     public:
-        VirtualMemory(Disk *disk);
+        /**
+         * @brief             Construct a new Virtual Memory object.
+         *
+         * @param             disk: Disk that evicted virtual pages are written back to.
+         * @param             nppages: Number of installed physical pages. Physical pages
+         *                     [0, nppages) can be handed out to virtual pages, and bookkeeping is
+         *                     only ever kept for pages in that range.
+         */
+        VirtualMemory(Disk *disk, word nppages);
         ~VirtualMemory();
 
         Disk *m_disk;
@@ -173,6 +203,21 @@ class VirtualMemory
         void set_ppage_permissions(word ppage_begin, word ppage_end, word swappable,
                                    word kernel_locked);
 
+        /**
+         * @brief             Keeps a physical page from being evicted while the host does I/O
+         *                     straight into it. Pins nest, each needs its own @ref unpin_ppage.
+         *
+         * @param             ppage: Physical page to pin.
+         */
+        void pin_ppage(word ppage);
+
+        /**
+         * @brief             Undoes one @ref pin_ppage.
+         *
+         * @param             ppage: Physical page to unpin.
+         */
+        void unpin_ppage(word ppage);
+
         /**
          * @brief             Set the access permissions of virtual memory specific to a process.
          *
@@ -226,6 +271,88 @@ class VirtualMemory
          */
         void add_vpage(long long pid, word vpage, word length, bool write, bool execute);
 
+        /**
+         * @brief             Removes the virtual page from a process referenced by it's pid.
+         *
+         * @throws            InvalidPIDException if pid is invalid.
+         * @throws             InvalidVPageException if virtual page is not mapped to process.
+         * @param             pid: Process id.
+         * @param             vpage: Virtual page to remove.
+         */
+        void remove_vpage(long long pid, word vpage);
+
+        /**
+         * @brief            Whether a virtual page has been added to the process, on a small or
+         *                     huge page.
+         *
+         * @throws            InvalidPIDException when pid is invalid.
+         */
+        bool has_vpage(long long pid, word vpage);
+
+        /**
+         * @brief            Adds a huge page to the specified process, mapping HUGE_PAGE_NPAGES
+         *                     virtual pages to contiguous physical pages that are never evicted.
+         *                     Like pages fetched from a fresh disk page, the contents are not
+         *                     guaranteed to be zero initialized.
+         *
+         * @throws            InvalidPIDException when pid is invalid.
+         * @throws            InvalidVPageException when the virtual page is not aligned to
+         *                     HUGE_PAGE_NPAGES or a page in its range has already been added.
+         * @throws            VirtualMemoryException when there are not enough contiguous free
+         *                     physical pages.
+         * @param             pid: ID of the process to add the huge page to.
+         * @param             vpage: First virtual page of the huge page.
+         * @param             write: Whether the huge page can be written to.
+         * @param             execute: Whether code can be executed from the huge page.
+         */
+        void add_huge_vpage(long long pid, word vpage, bool write, bool execute);
+
+        /**
+         * @brief            Removes a huge page from the specified process.
+         *
+         * @throws            InvalidPIDException when pid is invalid.
+         * @throws            InvalidVPageException when no huge page starts at the virtual page.
+         * @param             pid: Process id.
+         * @param             vpage: First virtual page of the huge page.
+         */
+        void remove_huge_vpage(long long pid, word vpage);
+
+        /**
+         * @brief            Adds the virtual pages covering a program segment to the specified
+         *                     process as demand pages. Nothing is allocated or copied up front, each
+         *                     page is filled on its first touch from the segment image, and bytes past
+         *                     the end of the image are zero. An empty image gives demand zero pages.
+         *
+         * @throws            InvalidPIDException when pid is invalid.
+         * @throws            InvalidVPageException when a page of the segment has already been added.
+         * @param             pid: ID of the process to add the segment to.
+         * @param             address: Virtual address of the first byte of the segment.
+         * @param             size: Size of the segment in bytes.
+         * @param             image: Initial contents of the start of the segment.
+         * @param             write: Whether the pages can be written to.
+         * @param             execute: Whether code can be executed from the pages.
+         */
+        void add_segment(long long pid, word address, word size, std::vector<byte> image,
+                         bool write, bool execute);
+
+        /**
+         * @brief            Adds a program segment whose image is shared rather than copied, such
+         *                     as a page aligned segment of a memory mapped executable. The image is
+         *                     kept alive until every page of the segment has been filled or removed.
+         *
+         * @throws            InvalidPIDException when pid is invalid.
+         * @throws            InvalidVPageException when a page of the segment has already been added.
+         * @param             pid: ID of the process to add the segment to.
+         * @param             address: Virtual address of the first byte of the segment.
+         * @param             size: Size of the segment in bytes.
+         * @param             image: Initial contents of the start of the segment.
+         * @param             image_size: Size of the image in bytes, at most size.
+         * @param             write: Whether the pages can be written to.
+         * @param             execute: Whether code can be executed from the pages.
+         */
+        void add_segment(long long pid, word address, word size, std::shared_ptr<const byte> image,
+                         word image_size, bool write, bool execute);
+
         /**
          * @brief             Converts a virtual address into a physical address of the process
          *                     specified by the process id if virtual memory
@@ -244,12 +371,7 @@ class VirtualMemory
                 return address;
             }
 
-            if (UNLIKELY(m_process_ptable_map.find(pid) == m_process_ptable_map.end()))
-            {
-                throw VirtualMemoryException("Invalid Process ID: " + std::to_string(pid));
-            }
-
-            return translate_address(m_process_ptable_map.at(pid), address, exception);
+            return translate_address(get_ptable(pid), address, exception);
         }
 
         /**
@@ -284,6 +406,63 @@ class VirtualMemory
         void ensure_physical_page_mapping(long long pid, word vpage, word ppage,
                                           Exception& exception);
 
+        /**
+         * @brief             TLB event counters.
+         */
+        struct TLB_Stats
+        {
+            unsigned long long hits = 0;            /* Translations found in the TLB. */
+            unsigned long long huge_hits = 0;        /* Hits on a huge page translation, included in hits. */
+            unsigned long long misses = 0;            /* Translations that walked the page table. */
+            unsigned long long evictions = 0;        /* Valid translations replaced by a new one. */
+            unsigned long long invalidations = 0;    /* Translations dropped by invalidation. */
+        };
+
+        /**
+         * @brief             Resizes the TLB, flushing all translations.
+         *
+         * @throws            VirtualMemoryException if the sizes are not powers of 2 or there are
+         *                     more ways than entries.
+         * @param             nentries: Total number of translations the TLB can hold.
+         * @param             nways: Associativity, the number of translations in each set.
+         */
+        void configure_tlb(word nentries, word nways);
+
+        /**
+         * @brief             Drops the translation of a single virtual page of a process.
+         *
+         * @param             pid: Process identifier, which is also the ASID.
+         * @param             vpage: Virtual page.
+         */
+        void invalidate_tlb_page(long long pid, word vpage);
+
+        /**
+         * @brief             Drops every translation of a process.
+         *
+         * @param             pid: Process identifier, which is also the ASID.
+         */
+        void invalidate_tlb_process(long long pid);
+
+        /**
+         * @brief             Drops every translation.
+         */
+        void flush_tlb();
+
+        /**
+         * @brief             Gets the TLB event counters.
+         */
+        const TLB_Stats& get_tlb_stats() const;
+
+        /**
+         * @brief             Resets the TLB event counters to zero.
+         */
+        void reset_tlb_stats();
+
+        /**
+         * @brief             Prints the TLB event counters and hit rate.
+         */
+        void print_tlb_stats();
+
 
     private:
         /**
@@ -292,6 +471,12 @@ class VirtualMemory
          */
         struct PageTableEntry
         {
+            /**
+             * @brief         Construct an invalid Page Table Entry object, used for the unused
+             *                 slots of a page table.
+             */
+            PageTableEntry();
+
             /**
              * @brief         Construct a new Page Table Entry object.
              *
@@ -303,6 +488,7 @@ class VirtualMemory
              */
             PageTableEntry(long long pid, word vpage, word diskpage, bool write, bool execute);
 
+            bool valid;                        /* Whether the virtual page has been added to the process. */
             long long pid;                    /* Process that has this mapping. */
             word vpage;                        /* Virtual page. */
             word ppage;                        /* Mapped physical page if not on disk. */
@@ -313,11 +499,25 @@ class VirtualMemory
 
             bool write;                        /* Whether this virtual page can be written to. */
             bool execute;                    /* Whether this virtual page contains code to execute. */
+
+            bool demand;                    /* Not touched yet, filled from its segment instead of disk. */
+            word segment;                    /* Segment a demand page is filled from, NO_SEGMENT to zero fill. */
+        };
+
+        /**
+         * @brief            Image of a program segment shared by its demand pages.
+         */
+        struct Segment
+        {
+            std::shared_ptr<const byte> image;    /* Initial contents, starting at address. */
+            word image_size;                /* Size of the image in bytes. */
+            word address;                    /* Virtual address of the first byte of the image. */
+            word nrefs;                        /* Demand pages still to be filled from the image. */
         };
 
         struct PhysicalPage
         {
-            PhysicalPage();
+            PhysicalPage(word ppage);
 
             std::vector<PageTableEntry*> mapped_vpages;
             word ppage;
@@ -326,6 +526,27 @@ class VirtualMemory
 
             bool swappable;                    /* Whether this physical page can be evicted/swapped. */
             bool kernel_locked;                /* Whether this physical page requires kernel level permission to access. */
+            bool huge;                        /* Part of a huge page, never evicted or remapped. */
+        };
+
+        /**
+         * @brief            Second level of a page table. Holds the entries of PTABLE_L2_SIZE
+         *                     consecutive virtual pages inline.
+         */
+        struct PageTableLevel
+        {
+            PageTableEntry entries[PTABLE_L2_SIZE];
+            word nvalid = 0;                /* Number of valid entries, the level is freed at 0. */
+        };
+
+        /**
+         * @brief            Huge page mapping of a directory slot.
+         */
+        struct HugePage
+        {
+            word ppage;                        /* First of the HUGE_PAGE_NPAGES contiguous physical pages. */
+            bool write;                        /* Whether the huge page can be written to. */
+            bool execute;                    /* Whether code can be executed from the huge page. */
         };
 
         /**
@@ -334,11 +555,53 @@ class VirtualMemory
         struct PageTable
         {
             long long pid = 0;                /* Process ID. */
+            bool kernel_privilege = false;
+
+            /* Directory of second level tables, only allocated once a virtual page in their range is added. */
+            PageTableLevel *levels[PTABLE_L1_SIZE] = {};
+
+            /* Directory slots mapped by a huge page instead of a second level table. */
+            std::unordered_map<word, HugePage> huge_pages = {};
+
+            /**
+             * @brief        Looks up the huge page covering a virtual page.
+             *
+             * @param        vpage: Virtual page.
+             * @return        Huge page, nullptr if the virtual page is not part of one.
+             */
+            inline HugePage* find_huge(word vpage)
+            {
+                if (LIKELY(huge_pages.empty()))
+                {
+                    return nullptr;
+                }
 
-            /* Mapping of virtual page address to the corresponding PageTableEntry. */
-            std::unordered_map<word, PageTableEntry*> entries = std::unordered_map<word,PageTableEntry*>();
+                std::unordered_map<word, HugePage>::iterator it = huge_pages.find(vpage >> PTABLE_L2_PSIZE);
+                return it == huge_pages.end() ? nullptr : &it->second;
+            }
 
-            bool kernel_privilege;
+            /**
+             * @brief        Looks up the entry of a virtual page.
+             *
+             * @param        vpage: Virtual page.
+             * @return        Entry of the virtual page, nullptr if it has not been added.
+             */
+            inline PageTableEntry* find(word vpage)
+            {
+                if (UNLIKELY(vpage >= NUM_VPAGES))
+                {
+                    return nullptr;
+                }
+
+                PageTableLevel *level = levels[vpage >> PTABLE_L2_PSIZE];
+                if (UNLIKELY(level == nullptr))
+                {
+                    return nullptr;
+                }
+
+                PageTableEntry *entry = &level->entries[vpage & (PTABLE_L2_SIZE-1)];
+                return LIKELY(entry->valid) ? entry : nullptr;
+            }
         };
 
         /**
@@ -346,20 +609,87 @@ class VirtualMemory
          */
         struct TLB_Entry
         {
-            bool valid = false;            /* Whether the TLB_Entry is a valid translation. */
-            long long pid = -1;            /* Corresponding process of the translation. */
-            word vpage;                    /* Virtual page address of the translation. */
-            word ppage;                    /* Resulting physical page address of the translation. */
+            word tag = TLB_INVALID_TAG;    /* ASID and virtual page of the translation, see tlb_tag. */
+            word ppage = 0;                /* Resulting physical page address of the translation. */
         };
 
         /**
          * @brief             Translation Lookaside Buffer. Contains the recently translated virtual
          *                     page address to physical page address.
-         * @note            Keys are the hash of the virtual page address.
-         * @todo            Change so that the hash is of the virtual page address and the pid to
-         *                     avoid collisions between processes.
+         * @note            N-way set associative, the ways of a set are stored contiguously. Sets
+         *                     are indexed by the virtual page hashed with the ASID so processes
+         *                     using the same virtual pages do not contend for the same set.
+         */
+        std::vector<TLB_Entry> tlb;
+        std::vector<byte> m_tlb_next_victim;    /* Round robin replacement way of each set. */
+
+        /**
+         * @brief             Fully associative TLB of huge page translations, tagged by the ASID and
+         *                     directory slot. Only searched while some process has a huge page.
+         */
+        TLB_Entry m_huge_tlb[HUGE_TLB_SIZE];
+        word m_huge_tlb_next_victim = 0;
+        word m_nhuge_pages = 0;
+        word m_tlb_set_mask;
+        word m_tlb_ways_psize;
+        TLB_Stats m_tlb_stats;
+
+        /**
+         * @brief             Tag of a translation in the TLB.
+         *
+         * @note             The ASID of a process is its pid, which is bounded by MAX_PROCESSES
+         *                     and fits above the 20 bits of the virtual page.
+         * @param             asid: Address space identifier of the process.
+         * @param             vpage: Virtual page.
+         * @return            Tag.
+         */
+        static inline word tlb_tag(long long asid, word vpage)
+        {
+            return (((word) asid) << (8 * sizeof(word) - PAGE_PSIZE)) | vpage;
+        }
+
+        /**
+         * @brief             Set of the TLB a translation can be placed in.
+         *
+         * @param             asid: Address space identifier of the process.
+         * @param             vpage: Virtual page.
+         * @return            Index of the set.
+         */
+        inline word tlb_set(long long asid, word vpage)
+        {
+            return (vpage ^ ((word) asid * 0x9E5)) & m_tlb_set_mask;
+        }
+
+        /**
+         * @brief             Inserts a translation into the TLB, evicting a way of the set if it is
+         *                     full.
+         *
+         * @param             asid: Address space identifier of the process.
+         * @param             vpage: Virtual page.
+         * @param             ppage: Physical page the virtual page translates to.
          */
-        TLB_Entry tlb[TLB_SIZE];
+        inline void insert_tlb(long long asid, word vpage, word ppage)
+        {
+            word set = tlb_set(asid, vpage);
+            TLB_Entry *ways = &tlb[set << m_tlb_ways_psize];
+            word nways = 1 << m_tlb_ways_psize;
+
+            word way = 0;
+            while (way < nways && ways[way].tag != TLB_INVALID_TAG)
+            {
+                way++;
+            }
+
+            if (way == nways)
+            {
+                way = m_tlb_next_victim[set];
+                m_tlb_next_victim[set] = (way + 1) & (nways - 1);
+                m_tlb_stats.evictions++;
+            }
+
+            ways[way].tag = tlb_tag(asid, vpage);
+            ways[way].ppage = ppage;
+        }
 
         /**
          * @brief            Free PIDs not in use by any process.
@@ -367,20 +697,32 @@ class VirtualMemory
         FreeBlockList m_freepids;
 
         /**
-         * @brief            Map of PID to the corresponding page table of the process.
+         * @brief            Page table of each process indexed by PID, nullptr if the PID is not
+         *                     in use.
          */
-        std::unordered_map<long long, PageTable*> m_process_ptable_map;
+        std::vector<PageTable*> m_process_ptables = std::vector<PageTable*>(MAX_PROCESSES, nullptr);
+
+        /**
+         * @brief            Number of installed physical pages.
+         */
+        word m_nppages;
 
         /**
          * @brief              Map of physical pages to the corresponding PageTableEntry.
+         * @note            Sparse, entries are only created once a physical page is touched.
+         */
+        std::unordered_map<word, PhysicalPage> m_physical_memory_map;
+
+        /**
+         * @brief            Segments with demand pages still to be filled, by ID.
          */
-        // std::unordered_map<word, PhysicalPage*> m_physical_memory_map;
-        PhysicalPage* m_physical_memory_map = new PhysicalPage[NUM_PPAGES];
+        std::unordered_map<word, Segment> m_segments;
+        word m_next_segment = 0;
 
         /**
          * @brief            Free physical pages that new virtual pages can map to.
          */
-        FreeBlockList m_freelist;
+        PageAllocator m_freelist;
 
         /**
          * @brief             Current active process in which all calls to the virtual memory to
@@ -418,11 +760,50 @@ class VirtualMemory
          */
         std::unordered_map<word,LRU_Node*> m_lru_map;
 
+        /**
+         * @brief            Pin counts of the physical pages @ref remove_lru must skip.
+         */
+        std::unordered_map<word,word> m_pinned;
+
         /**
          * @brief             Ensures that the virtual memory page tables memory mappings are valid.
          */
         void check_vm();
 
+        /**
+         * @brief             Gets the page table of a process.
+         *
+         * @throws            InvalidPIDException if the pid is invalid.
+         * @param             pid: Process identifier.
+         * @return            Page table of the process.
+         */
+        inline PageTable* get_ptable(long long pid)
+        {
+            if (UNLIKELY(pid < 0 || pid >= MAX_PROCESSES || m_process_ptables[pid] == nullptr))
+            {
+                throw InvalidPIDException("Invalid Process ID: " + std::to_string(pid), pid);
+            }
+
+            return m_process_ptables[pid];
+        }
+
+        /**
+         * @brief             Releases the physical or disk page held by a virtual page and drops
+         *                     any translation of it from the TLB. Does not invalidate the entry.
+         *
+         * @param             entry: Page table entry of the virtual page.
+         */
+        void release_vpage(PageTableEntry *entry);
+
+        /**
+         * @brief             Gets the bookkeeping of a physical page, creating it on first access.
+         *
+         * @throws            VirtualMemoryException if the physical page is not installed.
+         * @param             ppage: Physical page.
+         * @return            Physical page bookkeeping.
+         */
+        PhysicalPage& get_ppage(word ppage);
+
         /**
          * @brief             Adds a physical page that was just used to the list.
          *
@@ -437,6 +818,13 @@ class VirtualMemory
          */
         word remove_lru();
 
+        /**
+         * @brief             Removes a physical page from the list, used when it is freed.
+         *
+         * @param             ppage: Physical page address.
+         */
+        void erase_lru(word ppage);
+
         /**
          * @brief            Ensures the LRU (least recently used) of the in use physical pages
          *                     are valid.
@@ -454,16 +842,31 @@ class VirtualMemory
         void evict_ppage(word ppage, Exception& exception);
 
         /**
-         * @brief             Maps a virtual page to a specific physical page of the process
-         *                     corresponding to the given pid.
+         * @brief             Maps a virtual page to a specific physical page, fetching its contents
+         *                     from disk.
          *
-         * @throw             InvalidPIDException is pid is invalid.
-         * @param             pid: ID of the process to map a virtual page.
-         * @param             vpage: Virtual page to map.
+         * @param             entry: Page table entry of the virtual page to map.
          * @param             ppage: Physical page to map to.
          * @param             exception: Exception is thrown whenever there is a page fault to handle.
          */
-        void map_vpage_to_ppage(long long pid, word vpage, word ppage, Exception& exception);
+        void map_vpage_to_ppage(PageTableEntry *entry, word ppage, Exception& exception);
+
+        /**
+         * @brief             Builds the first contents of a demand page and drops its reference to
+         *                     the segment.
+         *
+         * @param             entry: Page table entry of the demand page.
+         * @return             Contents of the page.
+         */
+        std::vector<byte> fill_demand_page(PageTableEntry *entry);
+
+        /**
+         * @brief             Drops a reference of a demand page to its segment, freeing the image
+         *                     with the last one.
+         *
+         * @param             segment: Segment ID, NO_SEGMENT is ignored.
+         */
+        void release_segment(word segment);
 
         /**
          * @brief             Maps a new virtual page to a physical page of the specified process.
@@ -478,16 +881,6 @@ class VirtualMemory
          */
         void map_ppage(long long pid, word vpage, word ppage, Exception& exception);
 
-        /**
-         * @brief             Removes the virtual page from a process referenced by it's pid.
-         *
-         * @throws            InvalidPIDException if pid is invalid.
-         * @throws             InvalidVPageException if virtual page is not mapped to process.
-         * @param             pid: Process id.
-         * @param             vpage: Virtual page to remove.
-         */
-        void remove_vpage(long long pid, word vpage);
-
         /**
          * @brief            Translates a virtual space address to a physical space address. Note these
          *                     are not page addresses, but full memory address in the 0 to 2^31 - 1
@@ -524,8 +917,6 @@ class VirtualMemory
         {
             // check_vm();
 
-            word tlb_addr = vpage & (TLB_SIZE-1);
-
             /*
              * Unlikely that the virtual page has not been accessed recently.
              *
@@ -533,39 +924,62 @@ class VirtualMemory
              * mapping. Recently accessed virtual pages will have the translation stored in the
              * buffer.
              */
-            if (UNLIKELY(!tlb[tlb_addr].valid || tlb[tlb_addr].pid != ptable->pid || tlb[tlb_addr].vpage != vpage))
+            word tag = tlb_tag(ptable->pid, vpage);
+            TLB_Entry *ways = &tlb[tlb_set(ptable->pid, vpage) << m_tlb_ways_psize];
+            for (word way = 0; way < ((word) 1 << m_tlb_ways_psize); way++)
             {
-                /*
-                 * Unlikely that the virtual page accesses is an unmapped virtual page.
-                 */
-                if (UNLIKELY(ptable->entries.find(vpage) == ptable->entries.end()))
+                if (LIKELY(ways[way].tag == tag))
                 {
-                    throw VirtualMemoryException("SIGSEGV");
+                    m_tlb_stats.hits++;
+                    return ways[way].ppage;            // translation exists in the buffer.
                 }
-                else if (!ptable->entries.at(vpage)->disk)
+            }
+
+            if (UNLIKELY(m_nhuge_pages > 0))
+            {
+                word huge_tag = tlb_tag(ptable->pid, vpage >> PTABLE_L2_PSIZE);
+                for (TLB_Entry& huge_entry : m_huge_tlb)
                 {
-                    /*
-                     * Update the TLB with the result of the translation of virtual page to
-                     * physical page.
-                     */
-                    tlb[tlb_addr].valid = true;
-                    tlb[tlb_addr].pid = ptable->pid;
-                    tlb[tlb_addr].vpage = vpage;
-                    tlb[tlb_addr].ppage = ptable->entries.at(vpage)->ppage;
+                    if (huge_entry.tag == huge_tag)
+                    {
+                        m_tlb_stats.hits++;
+                        m_tlb_stats.huge_hits++;
+                        return huge_entry.ppage + (vpage & (PTABLE_L2_SIZE - 1));
+                    }
                 }
             }
-            else
+            m_tlb_stats.misses++;
+
+            PageTableEntry *entry = ptable->find(vpage);
+
+            /*
+             * Unlikely that the virtual page accesses is an unmapped virtual page.
+             */
+            if (UNLIKELY(entry == nullptr))
             {
-                return tlb[tlb_addr].ppage;            // translation exists in the buffer.
-            }
+                HugePage *huge = ptable->find_huge(vpage);
+                if (huge == nullptr)
+                {
+                    throw VirtualMemoryException("SIGSEGV");
+                }
 
-            PageTableEntry *entry = ptable->entries.at(vpage);
+                m_huge_tlb[m_huge_tlb_next_victim].tag = tlb_tag(ptable->pid, vpage >> PTABLE_L2_PSIZE);
+                m_huge_tlb[m_huge_tlb_next_victim].ppage = huge->ppage;
+                m_huge_tlb_next_victim = (m_huge_tlb_next_victim + 1) & (HUGE_TLB_SIZE - 1);
+                return huge->ppage + (vpage & (PTABLE_L2_SIZE - 1));
+            }
 
             /*
              * Likely that the virtual page being accessed has not been evicted to the disk.
              */
             if (LIKELY(!entry->disk))
             {
+                /*
+                 * Update the TLB with the result of the translation of virtual page to
+                 * physical page.
+                 */
+                insert_tlb(ptable->pid, vpage, entry->ppage);
+
                 // DEBUG("accessing virtual page (NOT ON DISK) %u (maps to %u) of process %llu",
                         // vpage, entry->ppage, ptable->pid);
                 return entry->ppage;
@@ -585,25 +999,25 @@ class VirtualMemory
                  * Since the virtual page is mapped to a physical page on disk, we can assume it was
                  * evicted and some other page is in use at the spot.
                  */
-                if (LIKELY(m_physical_memory_map[entry->mapped_ppage].used))
+                if (LIKELY(get_ppage(entry->mapped_ppage).used))
                 {
                     evict_ppage(entry->mapped_ppage, exception);
                 }
 
-                map_vpage_to_ppage(ptable->pid, vpage, entry->mapped_ppage, exception);
+                map_vpage_to_ppage(entry, entry->mapped_ppage, exception);
             }
             else
             {
                 /*
                  * Unlikely that all physical pages are in use.
                  */
-                if (UNLIKELY(!m_freelist.can_fit(1)))
+                if (UNLIKELY(m_freelist.available() == 0))
                 {
                     evict_ppage(remove_lru(), exception);
                 }
 
-                word ppage = m_freelist.get_free_block(1);
-                map_vpage_to_ppage(ptable->pid, vpage, ppage, exception);
+                word ppage = m_freelist.alloc();
+                map_vpage_to_ppage(entry, ppage, exception);
             }
 
             // DEBUG("Accessing virtual page %u (maps to %u) of process %llu.",
@@ -622,12 +1036,7 @@ class VirtualMemory
          */
         inline word access_vpage(long long pid, word vpage, Exception& exception)
         {
-            if (UNLIKELY(m_process_ptable_map.find(pid) == m_process_ptable_map.end()))
-            {
-                throw VirtualMemoryException("Invalid Process ID: " + std::to_string(pid));
-            }
-
-            return access_vpage(m_process_ptable_map.at(pid), vpage, exception);
+            return access_vpage(get_ptable(pid), vpage, exception);
         }
 
         /**
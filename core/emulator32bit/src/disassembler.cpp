@@ -1,6 +1,8 @@
 #include "emulator32bit/emulator32bit.h"
 #include "util/logger.h"
 
+#include <sstream>
+
 #define UNUSED(x) (void)(x)
 
 std::string disassemble_register(int reg)
@@ -174,6 +176,58 @@ std::string disassemble_format_m(word instruction, std::string op)
     return disassemble;
 }
 
+std::string disassemble_format_m3(word instruction, std::string op)
+{
+    std::string disassemble = op + " ";
+    disassemble += disassemble_register(bitfield_u32(instruction, 20, 5));
+    disassemble += ", ";
+    disassemble += disassemble_register(bitfield_u32(instruction, 15, 5));
+    disassemble += ", [";
+    disassemble += disassemble_register(bitfield_u32(instruction, 9, 5));
+
+    int offset = bitfield_s32(instruction, 2, 7) * 4;
+    int adr_mode = bitfield_u32(instruction, 0, 2);
+    if (offset == 0) {
+        disassemble += "]";
+    } else if (adr_mode == Emulator32bit::ADDR_PRE_INC) {
+        disassemble += ", #" + std::to_string(offset) + "]!";
+    } else if (adr_mode == Emulator32bit::ADDR_OFFSET) {
+        disassemble += ", #" + std::to_string(offset) + "]";
+    } else if (adr_mode == Emulator32bit::ADDR_POST_INC) {
+        disassemble += "], #" + std::to_string(offset);
+    } else {
+        ERROR("disassemble_format_m3() - Invalid addressing mode "
+                "in the disassembly of instruction (%s) %u", op.c_str(), instruction);
+    }
+    return disassemble;
+}
+
+std::string disassemble_format_m4(word instruction, std::string op)
+{
+    std::string disassemble = op;
+    if (test_bit(instruction, 18)) {
+        disassemble += "db";
+    }
+    disassemble += " ";
+
+    disassemble += disassemble_register(bitfield_u32(instruction, 20, 5));
+    if (test_bit(instruction, 19)) {
+        disassemble += "!";
+    }
+    disassemble += ", {";
+
+    int first_reg = test_bit(instruction, 17) ? 16 : 0;
+    bool first = true;
+    for (int reg = 0; reg < 16; reg++) {
+        if (test_bit(instruction, reg)) {
+            disassemble += (first ? "" : ", ") + disassemble_register(first_reg + reg);
+            first = false;
+        }
+    }
+    disassemble += "}";
+    return disassemble;
+}
+
 std::string disassemble_format_o3(word instruction, std::string op)
 {
     std::string disassemble = op;
@@ -264,351 +318,191 @@ std::string disassemble_format_o(word instruction, std::string op)
     return disassemble;
 }
 
-std::string disassemble_add(word instruction)
-{
-    return disassemble_format_o(instruction, "add");
-}
-
-std::string disassemble_sub(word instruction)
-{
-    return disassemble_format_o(instruction, "sub");
-}
-
-std::string disassemble_rsb(word instruction)
-{
-    return disassemble_format_o(instruction, "rsb");
-}
-
-std::string disassemble_adc(word instruction)
-{
-    return disassemble_format_o(instruction, "adc");
-}
-
-std::string disassemble_sbc(word instruction)
-{
-    return disassemble_format_o(instruction, "sbc");
-}
-
-std::string disassemble_rsc(word instruction)
-{
-    return disassemble_format_o(instruction, "rsc");
-}
-
-std::string disassemble_mul(word instruction)
+/* Format o with the xzr destination of a flag only instruction left out */
+std::string disassemble_format_compare(word instruction, std::string op)
 {
-    return disassemble_format_o(instruction, "mul");
+    std::string disassemble = disassemble_format_o(instruction, op);
+    return op + disassemble.substr(disassemble.find_first_of("xzr")+4);
 }
 
-std::string disassemble_umull(word instruction)
+std::string disassemble_format_f(word instruction, std::string op)
 {
-    return disassemble_format_o2(instruction, "umull");
-}
-
-std::string disassemble_smull(word instruction)
-{
-    return disassemble_format_o2(instruction, "smull");
-}
-
-std::string disassemble_vabs_f32(word instruction)
-{
-    UNUSED(instruction);
-    return "UNIMPLEMENTED";
-}
-
-std::string disassemble_vneg_f32(word instruction)
-{
-    UNUSED(instruction);
-    return "UNIMPLEMENTED";
-}
-
-std::string disassemble_vsqrt_f32(word instruction)
-{
-    UNUSED(instruction);
-    return "UNIMPLEMENTED";
-}
-
-std::string disassemble_vadd_f32(word instruction)
-{
-    UNUSED(instruction);
-    return "UNIMPLEMENTED";
-}
-
-std::string disassemble_vsub_f32(word instruction)
-{
-    UNUSED(instruction);
-    return "UNIMPLEMENTED";
-}
-
-std::string disassemble_vdiv_f32(word instruction)
-{
-    UNUSED(instruction);
-    return "UNIMPLEMENTED";
-}
-
-std::string disassemble_vmul_f32(word instruction)
-{
-    UNUSED(instruction);
-    return "UNIMPLEMENTED";
-}
-
-std::string disassemble_vcmp_f32(word instruction)
-{
-    UNUSED(instruction);
-    return "UNIMPLEMENTED";
-}
-
-std::string disassemble_vsel_f32(word instruction)
-{
-    UNUSED(instruction);
-    return "UNIMPLEMENTED";
-}
-
-std::string disassemble_vcint_u32_f32(word instruction)
-{
-    UNUSED(instruction);
-    return "UNIMPLEMENTED";
-}
-
-std::string disassemble_vcint_s32_f32(word instruction)
-{
-    UNUSED(instruction);
-    return "UNIMPLEMENTED";
-}
-
-std::string disassemble_vcflo_u32_f32(word instruction)
-{
-    UNUSED(instruction);
-    return "UNIMPLEMENTED";
-}
-
-std::string disassemble_vcflo_s32_f32(word instruction)
-{
-    UNUSED(instruction);
-    return "UNIMPLEMENTED";
-}
-
-std::string disassemble_vmov_f32(word instruction)
-{
-    UNUSED(instruction);
-    return "UNIMPLEMENTED";
-}
-
-std::string disassemble_and(word instruction)
-{
-    return disassemble_format_o(instruction, "and");
-}
-
-std::string disassemble_orr(word instruction)
-{
-    return disassemble_format_o(instruction, "orr");
-}
-
-std::string disassemble_eor(word instruction)
-{
-    return disassemble_format_o(instruction, "eor");
-}
-
-std::string disassemble_bic(word instruction)
-{
-    return disassemble_format_o(instruction, "bic");
-}
-
-std::string disassemble_lsl(word instruction)
-{
-    return disassemble_format_o1(instruction, "lsl");
-}
-
-std::string disassemble_lsr(word instruction)
-{
-    return disassemble_format_o1(instruction, "lsr");
-}
-
-std::string disassemble_asr(word instruction)
-{
-    return disassemble_format_o1(instruction, "asr");
-}
-
-std::string disassemble_ror(word instruction)
-{
-    return disassemble_format_o1(instruction, "ror");
-}
-
-std::string disassemble_cmp(word instruction)
-{
-    std::string disassemble = disassemble_format_o(instruction, "cmp");
-    return "cmp" + disassemble.substr(disassemble.find_first_of("xzr")+4);
-}
-
-std::string disassemble_cmn(word instruction)
-{
-    std::string disassemble = disassemble_format_o(instruction, "cmn");
-    return "cmn" + disassemble.substr(disassemble.find_first_of("xzr")+4);
-}
-
-std::string disassemble_tst(word instruction)
-{
-    std::string disassemble = disassemble_format_o(instruction, "tst");
-    return "tst" + disassemble.substr(disassemble.find_first_of("xzr")+4);
-}
-
-std::string disassemble_teq(word instruction)
-{
-    std::string disassemble = disassemble_format_o(instruction, "teq");
-    return "teq" + disassemble.substr(disassemble.find_first_of("xzr")+4);
-}
-
-std::string disassemble_mov(word instruction)
-{
-    return disassemble_format_o3(instruction, "mov");
+    std::string disassemble = op + " ";
+    disassemble += disassemble_register(bitfield_u32(instruction, 20, 5));
+    disassemble += ", ";
+    disassemble += disassemble_register(bitfield_u32(instruction, 15, 5));
+    return disassemble;
 }
 
-std::string disassemble_mvn(word instruction)
+std::string disassemble_format_f1(word instruction, std::string op)
 {
-    return disassemble_format_o3(instruction, "mvn");
+    std::string disassemble = op + " ";
+    disassemble += disassemble_register(bitfield_u32(instruction, 20, 5));
+    disassemble += ", ";
+    disassemble += disassemble_register(bitfield_u32(instruction, 15, 5));
+    disassemble += ", ";
+    disassemble += disassemble_register(bitfield_u32(instruction, 9, 5));
+    return disassemble;
 }
 
-std::string disassemble_ldr(word instruction)
+std::string disassemble_vcmp(word instruction)
 {
-    return disassemble_format_m(instruction, "ldr");
+    std::string disassemble = "vcmp.f32 ";
+    disassemble += disassemble_register(bitfield_u32(instruction, 15, 5));
+    disassemble += ", ";
+    if (test_bit(instruction, 14)) {
+        disassemble += "#0";
+    } else {
+        disassemble += disassemble_register(bitfield_u32(instruction, 9, 5));
+    }
+    return disassemble;
 }
 
-std::string disassemble_str(word instruction)
+std::string disassemble_vsel(word instruction)
 {
-    return disassemble_format_m(instruction, "str");
+    Emulator32bit::ConditionCode condition = (Emulator32bit::ConditionCode) bitfield_u32(instruction, 0, 4);
+    return disassemble_format_f1(instruction, "vsel." + disassemble_condition(condition) + ".f32");
 }
 
-std::string disassemble_swp(word instruction)
+std::string disassemble_vcint(word instruction)
 {
-    return disassemble_format_m1(instruction, "swp");
+    return disassemble_format_f(instruction, test_bit(instruction, 25) ? "vcint.s32.f32" : "vcint.u32.f32");
 }
 
-std::string disassemble_ldrb(word instruction)
+std::string disassemble_vcflo(word instruction)
 {
-    return disassemble_format_m(instruction, "ldrb");
+    return disassemble_format_f(instruction, test_bit(instruction, 25) ? "vcflo.s32.f32" : "vcflo.u32.f32");
 }
 
-std::string disassemble_strb(word instruction)
+std::string disassemble_vmov(word instruction)
 {
-    return disassemble_format_m(instruction, "strb");
-}
+    std::string xd = disassemble_register(bitfield_u32(instruction, 20, 5));
+    std::string xn = disassemble_register(bitfield_u32(instruction, 15, 5));
+    if (test_bit(instruction, 25)) {
+        word bits = bitfield_u32(instruction, 0, 20) << 12;
+        float fimm;
+        memcpy(&fimm, &bits, sizeof(fimm));
 
-std::string disassemble_swpb(word instruction)
-{
-    return disassemble_format_m1(instruction, "swpb");
-}
+        std::stringstream stream;
+        stream << fimm;
+        return "vmov.f32 " + xd + ", #" + stream.str();
+    }
 
-std::string disassemble_ldrh(word instruction)
-{
-    return disassemble_format_m(instruction, "ldrh");
+    switch ((Emulator32bit::VmovType) bitfield_u32(instruction, 0, 3)) {
+        case Emulator32bit::VMOV_REGISTER:
+            return "vmov.f32 " + xd + ", " + xn;
+        case Emulator32bit::VMRS_FPCR:
+            return "vmrs " + xd + ", fpcr";
+        case Emulator32bit::VMRS_FPSR:
+            return "vmrs " + xd + ", fpsr";
+        case Emulator32bit::VMSR_FPCR:
+            return "vmsr fpcr, " + xn;
+        case Emulator32bit::VMSR_FPSR:
+            return "vmsr fpsr, " + xn;
+        default:
+            return "INVALID";
+    }
 }
 
-std::string disassemble_strh(word instruction)
+std::string disassemble_ldstp(word instruction)
 {
-    return disassemble_format_m(instruction, "strh");
+    return disassemble_format_m3(instruction, test_bit(instruction, 25) ? "ldp" : "stp");
 }
 
-std::string disassemble_swph(word instruction)
+std::string disassemble_ldstm(word instruction)
 {
-    return disassemble_format_m1(instruction, "swph");
+    return disassemble_format_m4(instruction, test_bit(instruction, 25) ? "ldm" : "stm");
 }
 
-std::string disassemble_b(word instruction)
+std::string disassemble_packed(word instruction)
 {
-    return disassemble_format_b1(instruction, "b");
-}
+    const char *op = Emulator32bit::packed_op_name((Emulator32bit::PackedOp) bitfield_u32(instruction, 0, 5));
+    if (op == nullptr) {
+        return "INVALID";
+    }
 
-std::string disassemble_bl(word instruction)
-{
-    return disassemble_format_b1(instruction, "bl");
+    std::string disassemble = std::string(op) + " ";
+    disassemble += disassemble_register(bitfield_u32(instruction, 20, 5));
+    disassemble += ", ";
+    disassemble += disassemble_register(bitfield_u32(instruction, 15, 5));
+    disassemble += ", ";
+    disassemble += disassemble_register(bitfield_u32(instruction, 9, 5));
+    return disassemble;
 }
 
-std::string disassemble_bx(word instruction)
+std::string disassemble_mops(word instruction)
 {
-    return disassemble_format_b2(instruction, "bx");
+    const bool set = test_bit(instruction, 25);
+    std::string disassemble = set ? "set " : "cpy ";
+    disassemble += disassemble_register(bitfield_u32(instruction, 20, 5));
+    disassemble += ", ";
+    disassemble += disassemble_register(bitfield_u32(instruction, set ? 9 : 15, 5));
+    disassemble += ", ";
+    disassemble += disassemble_register(bitfield_u32(instruction, set ? 15 : 9, 5));
+    return disassemble;
 }
 
-std::string disassemble_blx(word instruction)
+std::string disassemble_cbz(word instruction)
 {
-    return disassemble_format_b2(instruction, "blx");
+    std::string disassemble = test_bit(instruction, 25) ? "cbnz " : "cbz ";
+    disassemble += disassemble_register(bitfield_u32(instruction, 20, 5));
+    disassemble += ", #" + std::to_string(bitfield_s32(instruction, 0, 20));
+    return disassemble;
 }
 
-std::string disassemble_swi(word instruction)
+std::string disassemble_csel(word instruction)
 {
-    return disassemble_format_b1(instruction, "swi");
+    std::string disassemble = test_bit(instruction, 25) ? "csinc " : "csel ";
+    disassemble += disassemble_register(bitfield_u32(instruction, 20, 5));
+    disassemble += ", ";
+    disassemble += disassemble_register(bitfield_u32(instruction, 15, 5));
+    disassemble += ", ";
+    disassemble += disassemble_register(bitfield_u32(instruction, 9, 5));
+    disassemble += ", ";
+    disassemble += disassemble_condition((Emulator32bit::ConditionCode) bitfield_u32(instruction, 0, 4));
+    return disassemble;
 }
 
-std::string disassemble_adrp(word instruction)
-{
-    return disassemble_format_m2(instruction, "adrp");
-}
+/* disassemble_name of each opcode whose disassembly in the ISA table is not custom */
+#define _DISASSEMBLER_FORMAT(name, format, op) \
+    std::string disassemble_##name(word instruction) \
+    { \
+        return disassemble_format_##format(instruction, op); \
+    }
+#define _DISASSEMBLER_o(name) _DISASSEMBLER_FORMAT(name, o, #name)
+#define _DISASSEMBLER_o1(name) _DISASSEMBLER_FORMAT(name, o1, #name)
+#define _DISASSEMBLER_o2(name) _DISASSEMBLER_FORMAT(name, o2, #name)
+#define _DISASSEMBLER_o3(name) _DISASSEMBLER_FORMAT(name, o3, #name)
+#define _DISASSEMBLER_compare(name) _DISASSEMBLER_FORMAT(name, compare, #name)
+#define _DISASSEMBLER_m(name) _DISASSEMBLER_FORMAT(name, m, #name)
+#define _DISASSEMBLER_m1(name) _DISASSEMBLER_FORMAT(name, m1, #name)
+#define _DISASSEMBLER_m2(name) _DISASSEMBLER_FORMAT(name, m2, #name)
+#define _DISASSEMBLER_b1(name) _DISASSEMBLER_FORMAT(name, b1, #name)
+#define _DISASSEMBLER_b2(name) _DISASSEMBLER_FORMAT(name, b2, #name)
+#define _DISASSEMBLER_f(name) _DISASSEMBLER_FORMAT(name, f, #name ".f32")
+#define _DISASSEMBLER_f1(name) _DISASSEMBLER_FORMAT(name, f1, #name ".f32")
+#define _DISASSEMBLER_bare(name) \
+    std::string disassemble_##name(word instruction) \
+    { \
+        UNUSED(instruction); \
+        return #name; \
+    }
+#define _DISASSEMBLER_custom(name)
 
-std::string disassemble_hlt(word instruction)
-{
-    UNUSED(instruction);
-    return "hlt";
-}
+#define _INSTR(name, opcode, disassembly) _DISASSEMBLER_##disassembly(name)
+EMU32_INSTRUCTIONS(_INSTR)
+#undef _INSTR
 
 /* construct disassembler instruction mapping */
 typedef std::string (*DisassemblerFunction)(word);
-DisassemblerFunction _disassembler_instructions[64] =
+#define _INSTR(name, opcode, disassembly) disassemble_##name,
+static const DisassemblerFunction _disassembler_instructions[EMU32_NUM_OPCODES] =
 {
-    disassemble_hlt,
-    disassemble_add,
-    disassemble_sub,
-    disassemble_rsb,
-    disassemble_adc,
-    disassemble_sbc,
-    disassemble_rsc,
-    disassemble_mul,
-    disassemble_umull,
-    disassemble_smull,
-    disassemble_vabs_f32,
-    disassemble_vneg_f32,
-    disassemble_vsqrt_f32,
-    disassemble_vadd_f32,
-    disassemble_vsub_f32,
-    disassemble_vdiv_f32,
-    disassemble_vmul_f32,
-    disassemble_vcmp_f32,
-    disassemble_vsel_f32,
-    disassemble_vcint_u32_f32,                                /* slight discrepency with the emulator. check later */
-    // disassemble_vcint_s32_f32,                                /* slight discrepency with the emulator. check later */
-    disassemble_vcflo_u32_f32,                                /* slight discrepency with the emulator. check later */
-    // disassemble_vcflo_s32_f32,                                /* slight discrepency with the emulator. check later */
-    disassemble_vmov_f32,
-    disassemble_and,
-    disassemble_orr,
-    disassemble_eor,
-    disassemble_bic,
-    disassemble_lsl,
-    disassemble_lsr,
-    disassemble_asr,
-    disassemble_ror,
-    disassemble_cmp,
-    disassemble_cmn,
-    disassemble_tst,
-    disassemble_teq,
-    disassemble_mov,
-    disassemble_mvn,
-    disassemble_ldr,
-    disassemble_ldrb,
-    disassemble_ldrh,
-    disassemble_str,
-    disassemble_strb,
-    disassemble_strh,
-    disassemble_swp,
-    disassemble_swpb,
-    disassemble_swph,
-    disassemble_b,
-    disassemble_bl,
-    disassemble_bx,
-    disassemble_blx,
-    disassemble_swi,
-
-    disassemble_adrp,
+    EMU32_INSTRUCTIONS(_INSTR)
 };
+#undef _INSTR
 
 std::string disassemble_instr(word instr)
 {
-    return (*_disassembler_instructions[bitfield_u32(instr, 26, 6)])(instr);
+    return (*_disassembler_instructions[isa_opcode(instr)])(instr);
 }
\ No newline at end of file
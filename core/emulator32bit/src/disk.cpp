@@ -4,6 +4,9 @@
 #define AEMU_ONLY_CRITICAL_LOG
 #include "util/logger.h"
 
+#include <algorithm>
+#include <cstring>
+
 /*
  * Located at the beginning of disk and the disk page management files
  * to detect invlaid disk/disk management files.
@@ -29,7 +32,7 @@ Disk::Disk() :
     m_free_list(0, 0, false)
 {
     // maybe this isnt the best way to create support a mocked disk
-    this->m_cache = new CachePage[AEMU_DISK_CACHE_SIZE];    /* so destructor can work. */
+    this->m_cache = nullptr;    /* mocked disks never touch the cache, delete[] of nullptr is a no-op. */
 }
 
 void Disk::read_disk_files()
@@ -171,11 +174,12 @@ void Disk::return_pages(word page_lo, word page_hi)
 
 std::vector<byte> Disk::read_page(word page)
 {
+    std::lock_guard<std::mutex> lock(m_mutex);
     CachePage& cpage = get_cpage(page);
 
     std::vector<byte> data(PAGE_SIZE);
     for (int i = 0; i < PAGE_SIZE; i++) {
-        data.push_back(cpage.data[i]);
+        data[i] = cpage.data[i];
     }
 
     DEBUG("Reading disk page %u.", page);
@@ -198,12 +202,13 @@ word Disk::read_word(word address)
 dword Disk::read_val(word address, int n_bytes)
 {
     /* TODO: Add warning for when n_bytes is larger than 8. */
+    std::lock_guard<std::mutex> lock(m_mutex);
 
     /* Read from the end since the most significant byte will be located there in little endian. */
-    address += n_bytes - 1;
+    address += n_bytes - 1 - start_addr;
     word page = address >> PAGE_PSIZE;                /* Get the page address (upper bits). */
     word offset = address & (PAGE_SIZE - 1);        /* Offset into the page (lower bits). */
-    CachePage& cpage = get_cpage(page);
+    CachePage *cpage = &get_cpage(page);
 
     dword val = 0;
     for (int i = 0; i < n_bytes; i++) {
@@ -214,11 +219,11 @@ dword Disk::read_val(word address, int n_bytes)
              */
             offset = PAGE_SIZE - 1;
             page--;
-            cpage = get_cpage(page);
+            cpage = &get_cpage(page);
         }
 
         val <<= 8;
-        val += cpage.data[offset];
+        val += cpage->data[offset];
         offset--;
     }
     return val;
@@ -234,6 +239,7 @@ void Disk::write_page(word page, std::vector<byte> data)
         return;
     }
 
+    std::lock_guard<std::mutex> lock(m_mutex);
     CachePage& cpage = get_cpage(page);
     cpage.dirty = true;                             /* Mark as dirty since it is written to. */
     for (int i = 0; i < PAGE_SIZE; i++) {
@@ -259,11 +265,13 @@ void Disk::write_word(word address, word data)
 void Disk::write_val(word address, dword val, int n_bytes)
 {
     /* TODO: Warn when n_bytes is larger than 8. */
+    std::lock_guard<std::mutex> lock(m_mutex);
 
+    address -= start_addr;
     word page = address >> PAGE_PSIZE;                /* Get the page address (upper bits). */
     word offset = address & (PAGE_SIZE - 1);        /* Offset into the page (lower bits). */
-    CachePage& cpage = get_cpage(page);
-    cpage.dirty = true;
+    CachePage *cpage = &get_cpage(page);
+    cpage->dirty = true;
 
     /* Write the bytes in little endian. */
     for (int i = 0; i < n_bytes; i++) {
@@ -275,16 +283,119 @@ void Disk::write_val(word address, dword val, int n_bytes)
 
             offset = 0;
             page++;
-            cpage = get_cpage(page);
-            cpage.dirty = true;
+            cpage = &get_cpage(page);
+            cpage->dirty = true;
         }
 
-        cpage.data[offset] = val & 0xFF;            /* Get lower 8 bits. */
+        cpage->data[offset] = val & 0xFF;            /* Get lower 8 bits. */
         val >>= 8;
         offset++;
     }
 }
 
+word Disk::uncached_pages(word page, word length)
+{
+    word npages = 0;
+    while (npages < length)
+    {
+        const CachePage& cpage = m_cache[(page + npages) & (AEMU_DISK_CACHE_SIZE - 1)];
+        if (cpage.valid && cpage.page == page + npages)
+        {
+            break;
+        }
+        npages++;
+    }
+    return npages;
+}
+
+void Disk::read_bytes(word address, byte *dst, word length)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    address -= start_addr;
+
+    std::ifstream file;
+    while (length > 0)
+    {
+        word page = address >> PAGE_PSIZE;
+        word offset = address & (PAGE_SIZE - 1);
+        word npages = offset == 0 ? uncached_pages(page, length >> PAGE_PSIZE) : 0;
+
+        if (npages > 0)
+        {
+            /* Whole pages skip the cache, a long transfer would only thrash it. */
+            if (!file.is_open())
+            {
+                file.open(m_diskfile.get_path(), std::ios::binary | std::ios::in);
+            }
+
+            file.seekg((std::streamoff) page << PAGE_PSIZE);
+            file.read((char*) dst, (std::streamsize) npages << PAGE_PSIZE);
+            if (!file)
+            {
+                throw DiskReadException("Error reading pages " + std::to_string(page) + " to "
+                        + std::to_string(page + npages - 1) + " from disk file.");
+            }
+
+            word chunk = npages << PAGE_PSIZE;
+            address += chunk;
+            dst += chunk;
+            length -= chunk;
+            continue;
+        }
+
+        word chunk = std::min(length, PAGE_SIZE - offset);
+        memcpy(dst, get_cpage(page).data + offset, chunk);
+        address += chunk;
+        dst += chunk;
+        length -= chunk;
+    }
+}
+
+void Disk::write_bytes(word address, const byte *src, word length)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    address -= start_addr;
+
+    std::ofstream file;
+    while (length > 0)
+    {
+        word page = address >> PAGE_PSIZE;
+        word offset = address & (PAGE_SIZE - 1);
+        word npages = offset == 0 ? uncached_pages(page, length >> PAGE_PSIZE) : 0;
+
+        if (npages > 0)
+        {
+            if (!file.is_open())
+            {
+                /* std::ios::in so the rest of the file is not truncated, see write_cpage */
+                file.open(m_diskfile.get_path(), std::ios::binary | std::ios::out | std::ios::in);
+            }
+
+            file.seekp((std::streamoff) page << PAGE_PSIZE);
+            file.write((const char*) src, (std::streamsize) npages << PAGE_PSIZE);
+            if (!file)
+            {
+                throw DiskWriteException("Error writing pages " + std::to_string(page) + " to "
+                        + std::to_string(page + npages - 1) + " to disk file.");
+            }
+
+            word chunk = npages << PAGE_PSIZE;
+            address += chunk;
+            src += chunk;
+            length -= chunk;
+            continue;
+        }
+
+        word chunk = std::min(length, PAGE_SIZE - offset);
+        CachePage& cpage = get_cpage(page);
+        cpage.dirty = true;
+        memcpy(cpage.data + offset, src, chunk);
+        address += chunk;
+        src += chunk;
+        length -= chunk;
+    }
+}
+
 /* TODO: Perhaps the addr parameter should instead be the page address. It would make more sense. */
 Disk::CachePage& Disk::get_cpage(word addr)
 {
@@ -293,7 +404,7 @@ Disk::CachePage& Disk::get_cpage(word addr)
     }
 
     /* Bitwise AND does the same as modulus to index into table since cache size is a power of 2. */
-    CachePage& cpage = m_cache[(addr >> PAGE_PSIZE) & (AEMU_DISK_CACHE_SIZE - 1)];
+    CachePage& cpage = m_cache[addr & (AEMU_DISK_CACHE_SIZE - 1)];
 
     cpage.last_acc = n_acc++;                        /* LRU information, but unused for now. */
     if (cpage.valid && cpage.page == addr) {
@@ -376,6 +487,7 @@ void Disk::read_cpage(CachePage& cpage)
     creating many I/O streams, just create one and write all dirty and valid cache pages to disk. */
 void Disk::save()
 {
+    std::lock_guard<std::mutex> lock(m_mutex);
     std::ofstream file(m_diskfile.get_path(), std::ios::binary | std::ios::in | std::ios::out);
     if (!file.is_open()) {
         ERROR("Error opening disk file");
@@ -456,7 +568,7 @@ void MockDisk::return_pages(word page_lo, word page_hi)
 std::vector<byte> MockDisk::read_page(word page)
 {
     UNUSED(page);
-    return std::vector<byte>();
+    return std::vector<byte>(PAGE_SIZE);
 }
 
 byte MockDisk::read_byte(word address)
@@ -475,6 +587,12 @@ word MockDisk::read_word(word address)
     return 0;
 }
 
+void MockDisk::read_bytes(word address, byte *dst, word length)
+{
+    UNUSED(address);
+    memset(dst, 0, length);
+}
+
 void MockDisk::write_page(word page, std::vector<byte> data)
 {
     UNUSED(page);
@@ -497,6 +615,13 @@ void MockDisk::write_word(word address, word data)
     UNUSED(data);
 }
 
+void MockDisk::write_bytes(word address, const byte *src, word length)
+{
+    UNUSED(address);
+    UNUSED(src);
+    UNUSED(length);
+}
+
 void MockDisk::save()
 {
 
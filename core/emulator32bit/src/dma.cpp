@@ -0,0 +1,335 @@
+#include "emulator32bit/dma.h"
+
+#include <cstring>
+
+DMAController::DMAController(Emulator32bit *processor) :
+    BaseMemory(1, DMA_BASE >> PAGE_PSIZE),
+    processor(processor)
+{
+
+}
+
+DMAController::~DMAController()
+{
+    if (!worker.joinable())
+    {
+        return;
+    }
+
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        copied.wait(lock, [this]() { return !copying; });
+        stopping = true;
+    }
+    job_ready.notify_one();
+    worker.join();
+}
+
+byte DMAController::read_byte(word address)
+{
+    word offset = address - start_addr;
+    return read_register(offset & ~0b11) >> (8 * (offset & 0b11));
+}
+
+hword DMAController::read_hword(word address)
+{
+    return read_byte(address) | (read_byte(address + 1) << 8);
+}
+
+word DMAController::read_word(word address)
+{
+    word offset = address - start_addr;
+    if ((offset & 0b11) == 0)
+    {
+        return read_register(offset);
+    }
+    return read_hword(address) | (read_hword(address + 2) << 16);
+}
+
+void DMAController::write_byte(word address, byte value)
+{
+    write_word(address, value);
+}
+
+void DMAController::write_hword(word address, hword value)
+{
+    write_word(address, value);
+}
+
+void DMAController::write_word(word address, word value)
+{
+    word offset = address - start_addr;
+    if ((offset & 0b11) == 0)
+    {
+        write_register(offset, value);
+    }
+}
+
+word DMAController::read_register(word offset)
+{
+    switch (offset)
+    {
+        case DMA_SRC:
+            return src;
+        case DMA_DST:
+            return dst;
+        case DMA_LEN:
+            return length;
+        case DMA_CTRL:
+            return ctrl;
+        case DMA_STATUS:
+            return status;
+        case DMA_COUNT:
+            return count;
+        default:
+            return 0;
+    }
+}
+
+void DMAController::write_register(word offset, word value)
+{
+    switch (offset)
+    {
+        case DMA_SRC:
+            src = value;
+            break;
+        case DMA_DST:
+            dst = value;
+            break;
+        case DMA_LEN:
+            length = value;
+            break;
+        case DMA_CTRL:
+            ctrl = value & ~DMA_CTRL_START;
+            if (value & DMA_CTRL_START)
+            {
+                start();
+            }
+            break;
+        case DMA_STATUS:
+            status &= ~(value & (DMA_STATUS_DONE | DMA_STATUS_ERROR));
+            break;
+        default:
+            break;
+    }
+}
+
+BaseMemory* DMAController::target(word address, word length, bool write)
+{
+    word last = address + length - 1;
+    if (last < address)
+    {
+        return nullptr;
+    }
+
+    BaseMemory *memories[] = {processor->ram, processor->rom, processor->disk};
+    for (BaseMemory *memory : memories)
+    {
+        if (memory->in_bounds(address) && memory->in_bounds(last))
+        {
+            return (write && memory == processor->rom) ? nullptr : memory;
+        }
+    }
+    return nullptr;
+}
+
+void DMAController::copy(BaseMemory *from, word from_address, BaseMemory *to, word to_address,
+        word length)
+{
+    SystemBus& bus = processor->system_bus;
+    Disk *disk = processor->disk;
+
+    if (from != disk && to != disk)
+    {
+        memmove(bus.host_pointer(to_address), bus.host_pointer(from_address), length);
+    }
+    else if (to != disk)
+    {
+        disk->read_bytes(from_address, bus.host_pointer(to_address), length);
+    }
+    else if (from != disk)
+    {
+        disk->write_bytes(to_address, bus.host_pointer(from_address), length);
+    }
+    else
+    {
+        /* disk to disk goes through a host buffer, which also makes overlapping ranges safe */
+        std::vector<byte> staging(length);
+        disk->read_bytes(from_address, staging.data(), length);
+        disk->write_bytes(to_address, staging.data(), length);
+    }
+}
+
+void DMAController::start()
+{
+    if (busy())
+    {
+        status |= DMA_STATUS_ERROR;
+        return;
+    }
+
+    status &= ~(DMA_STATUS_DONE | DMA_STATUS_ERROR);
+    count = 0;
+    if (length == 0)
+    {
+        finish(false, 0);
+        return;
+    }
+
+    BaseMemory *from = target(src, length, false);
+    BaseMemory *to = target(dst, length, true);
+    if (from == nullptr || to == nullptr)
+    {
+        finish(true, 0);
+        return;
+    }
+
+    if (!(ctrl & DMA_CTRL_ASYNC))
+    {
+        try
+        {
+            copy(from, src, to, dst, length);
+        }
+        catch (const std::exception&)
+        {
+            finish(true, 0);
+            return;
+        }
+        finish(false, length);
+        return;
+    }
+
+    /* the MMU must not swap the pages out from under the worker */
+    auto pin = [this](BaseMemory *memory, word address)
+    {
+        if (memory == processor->disk)
+        {
+            return;
+        }
+
+        for (word ppage = address >> PAGE_PSIZE; ppage <= (address + length - 1) >> PAGE_PSIZE; ppage++)
+        {
+            processor->mmu->pin_ppage(ppage);
+            pinned.push_back(ppage);
+        }
+    };
+    pin(from, src);
+    pin(to, dst);
+
+    status |= DMA_STATUS_BUSY;
+    in_flight = true;
+    in_flight_length = length;
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        copying = true;
+        failed = false;
+        job = [this, from, src = src, to, dst = dst, length = length]()
+        {
+            bool error = false;
+            try
+            {
+                copy(from, src, to, dst, length);
+            }
+            catch (const std::exception&)
+            {
+                error = true;
+            }
+
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                copying = false;
+                failed = error;
+            }
+            copied.notify_all();
+            processor->post_event([this]() { complete(); });
+        };
+    }
+
+    if (!worker.joinable())
+    {
+        worker = std::thread(&DMAController::work, this);
+    }
+    job_ready.notify_one();
+}
+
+void DMAController::finish(bool error, word copied_bytes)
+{
+    status = (status & ~DMA_STATUS_BUSY) | (error ? DMA_STATUS_ERROR : DMA_STATUS_DONE);
+    count = copied_bytes;
+
+    if (ctrl & DMA_CTRL_INTERRUPT)
+    {
+        /* a synchronous transfer ends in the middle of an instruction */
+        processor->schedule_event(0, [this]()
+        {
+            processor->raise_interrupt(Emulator32bit::DMA_DONE);
+        });
+    }
+}
+
+void DMAController::complete()
+{
+    bool error;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!in_flight || copying)
+        {
+            /* already completed by wait(), this is the post of the transfer before */
+            return;
+        }
+        error = failed;
+    }
+
+    for (word ppage : pinned)
+    {
+        processor->mmu->unpin_ppage(ppage);
+    }
+    pinned.clear();
+    in_flight = false;
+    finish(error, error ? 0 : in_flight_length);
+}
+
+void DMAController::wait_copied()
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    copied.wait(lock, [this]() { return !copying; });
+}
+
+void DMAController::wait()
+{
+    wait_copied();
+    complete();
+}
+
+void DMAController::reset()
+{
+    wait_copied();
+    for (word ppage : pinned)
+    {
+        processor->mmu->unpin_ppage(ppage);
+    }
+    pinned.clear();
+    in_flight = false;
+
+    src = dst = length = ctrl = status = count = 0;
+}
+
+void DMAController::work()
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true)
+    {
+        job_ready.wait(lock, [this]() { return stopping || job; });
+        if (stopping)
+        {
+            return;
+        }
+
+        std::function<void()> current = std::move(job);
+        job = nullptr;
+        lock.unlock();
+        current();
+        lock.lock();
+    }
+}
@@ -2,10 +2,16 @@
 #include "emulator32bit/emulator32bit.h"
 #include "emulator32bit/virtual_memory.h"
 #include "emulator32bit/kernel/better_virtual_memory.h"
+#include "emulator32bit/kernel/malloc.h"
 #include "emulator32bit/timer.h"
+#include "emulator32bit/uart.h"
+#include "emulator32bit/dma.h"
+#include "emulator32bit/kernel/file_io.h"
 
 #include "util/types.h"
 
+#include <algorithm>
+#include <initializer_list>
 #include <stdio.h>
 
 const word Emulator32bit::RAM_NPAGES = 16;
@@ -14,15 +20,38 @@ const byte Emulator32bit::ROM_DATA[16 << PAGE_PSIZE] = {};
 const word Emulator32bit::ROM_NPAGES = 16;
 const word Emulator32bit::ROM_START_PAGE = 16;
 
+/**
+ * @brief             Number of physical pages spanned by the installed memory, i.e. one past the
+ *                     highest physical page of any of the memories.
+ */
+static word installed_ppages(std::initializer_list<BaseMemory*> memories)
+{
+    word nppages = 0;
+    for (BaseMemory *memory : memories)
+    {
+        if (memory->get_mem_pages() > 0 && memory->get_hi_page() + 1 > nppages)
+        {
+            nppages = memory->get_hi_page() + 1;
+        }
+    }
+    return nppages;
+}
+
 Emulator32bit::Emulator32bit(word ram_npages, word ram_start_page, const byte rom_data[],
         word rom_npages, word rom_start_page) :
     ram(new RAM(ram_npages, ram_start_page)),
     rom(new ROM(rom_data, rom_npages, rom_start_page)),
     disk(new MockDisk()),
-    mmu(new VirtualMemory(disk)),
-    system_bus(*ram, *rom, *disk, *mmu)
+    mmu(new VirtualMemory(disk, installed_ppages({ram, rom, disk}))),
+    memory_manager(new MemoryManager(mmu)),
+    system_bus(*ram, *rom, *disk, *mmu),
+    timer(new Timer(this)),
+    uart(new UART(this)),
+    dma(new DMAController(this)),
+    file_manager(new FileManager(this))
 {
-    fill_out_instructions();
+    system_bus.attach_device(uart);
+    system_bus.attach_device(dma);
     reset();
 }
 
@@ -36,16 +65,27 @@ Emulator32bit::Emulator32bit(RAM *ram, ROM *rom, Disk *disk) :
     ram(ram),
     rom(rom),
     disk(disk),
-    mmu(new VirtualMemory(disk)),
-    system_bus(*ram, *rom, *disk, *mmu)
+    mmu(new VirtualMemory(disk, installed_ppages({ram, rom, disk}))),
+    memory_manager(new MemoryManager(mmu)),
+    system_bus(*ram, *rom, *disk, *mmu),
+    timer(new Timer(this)),
+    uart(new UART(this)),
+    dma(new DMAController(this)),
+    file_manager(new FileManager(this))
 {
-    fill_out_instructions();
+    system_bus.attach_device(uart);
+    system_bus.attach_device(dma);
     reset();
 }
 
 Emulator32bit::~Emulator32bit()
 {
+    delete file_manager;
+    delete dma;
+    delete timer;
+    delete uart;
     disk->save();
+    delete memory_manager;
     delete mmu;
     delete ram;
     delete rom;
@@ -63,92 +103,12 @@ const char* Emulator32bit::Exception::what() const noexcept
     return message.c_str();
 }
 
-void Emulator32bit::fill_out_instructions()
-{
-    for (int i = 0; i < _num_instructions; i++) {
-        _instructions[i] = Emulator32bit::_hlt;
-    }
-
-    /* fill out instruction functions and construct disassembler instruction mapping */
-    #define _INSTR(op) _instructions[_op_##op] = Emulator32bit::_##op;
-
-    _INSTR(hlt)
-
-    _INSTR(add)
-    _INSTR(sub)
-    _INSTR(rsb)
-    _INSTR(adc)
-    _INSTR(sbc)
-    _INSTR(rsc)
-    _INSTR(mul)
-    _INSTR(umull)
-    _INSTR(smull)
-
-    _INSTR(vabs)
-    _INSTR(vneg)
-    _INSTR(vsqrt)
-    _INSTR(vadd)
-    _INSTR(vsub)
-    _INSTR(vdiv)
-    _INSTR(vmul)
-    _INSTR(vcmp)
-    _INSTR(vsel)
-    _INSTR(vcint)
-    _INSTR(vcflo)
-    _INSTR(vmov)
-
-    _INSTR(and)
-    _INSTR(orr)
-    _INSTR(eor)
-    _INSTR(bic)
-    _INSTR(lsl)
-    _INSTR(lsr)
-    _INSTR(asr)
-    _INSTR(ror)
-
-    _INSTR(cmp)
-    _INSTR(cmn)
-    _INSTR(tst)
-    _INSTR(teq)
-
-    _INSTR(mov)
-    _INSTR(mvn)
-
-    _INSTR(ldr)
-    _INSTR(ldrb)
-    _INSTR(ldrh)
-    _INSTR(str)
-    _INSTR(strb)
-    _INSTR(strh)
-    _INSTR(swp)
-    _INSTR(swpb)
-    _INSTR(swph)
-
-    _INSTR(b)
-    _INSTR(bl)
-    _INSTR(bx)
-    _INSTR(blx)
-    _INSTR(swi)
-
-    _INSTR(adrp)
-
-    _INSTR(hlt)
-
-    // _INSTR(nop_)
-    // _INSTR(nop_)
-    // _INSTR(nop_)
-    // _INSTR(nop_)
-    // _INSTR(nop_)
-    // _INSTR(nop_)
-    // _INSTR(nop_)
-    // _INSTR(nop_)
-    // _INSTR(nop_)
-    // _INSTR(nop_)
-    // _INSTR(nop_)
-
-    _INSTR(nop)
-    #undef _INSTR
-}
+#define _INSTR(name, opcode, disassembly) &Emulator32bit::_##name,
+const Emulator32bit::InstructionFunction Emulator32bit::_instructions[_num_instructions] =
+{
+    EMU32_INSTRUCTIONS(_INSTR)
+};
+#undef _INSTR
 
 void Emulator32bit::print()
 {
@@ -164,53 +124,222 @@ void Emulator32bit::print()
 void Emulator32bit::run(unsigned long long instructions)
 {
     word instr = _op_hlt;
-    unsigned long long num_instructions_ran = 0;
+    const unsigned long long start_cycles = _cycles;
+    const unsigned long long end_cycles = instructions == 0 ? NO_DEADLINE : start_cycles + instructions;
     try
     {
-        if (instructions == 0)
+        /*
+            Run in bursts up to the next scheduled event, so the inner loop
+            does no more work per instruction than counting down the burst.
+        */
+        while (_cycles < end_cycles)
         {
-            while (true)
+            if (_waiting)
             {
-                instr = system_bus.read_word_aligned_ram(_pc);
-                execute(instr);
-                _pc += 4;
-                num_instructions_ran++;
+                wait_for_event(end_cycles);
+                continue;
             }
-        }
-        else
-        {
-            unsigned long long start_instructions = instructions;
-            while (instructions > 0)
+
+            unsigned long long deadline = std::min(_scheduler.next_deadline(), end_cycles);
+            _burst_len = deadline > _cycles ? std::min(deadline - _cycles, MAX_BURST_LENGTH) : 0;
+            _burst = _burst_len;
+            while (_burst > 0)
             {
+                _burst--;
                 instr = system_bus.read_word_aligned_ram(_pc);
                 execute(instr);
                 _pc += 4;
-                instructions--;
             }
-            num_instructions_ran = start_instructions - instructions;
+            _cycles += _burst_len;
+            _burst_len = 0;
+
+            if (run_events())
+            {
+                _waiting = false;
+            }
         }
     }
     catch(const Exception& e)
     {
+        uart->flush();
         std::cerr << "Caught Emulator Exception: " << e.what() << std::endl;
     }
     catch(const SystemBus::Exception& e)
     {
+        uart->flush();
         std::cerr << "Caught System Bus Exception: " << e.what() << std::endl;
     }
 
-    printf("Ran %llu instructions\n", num_instructions_ran);
+    /* The instruction that threw did not retire */
+    if (_burst_len > 0)
+    {
+        _cycles += _burst_len - _burst - 1;
+        _burst = _burst_len = 0;
+    }
+
+    uart->flush();
+    printf("Ran %llu instructions\n", _cycles - start_cycles);
+
+    const VirtualMemory::TLB_Stats& tlb_stats = mmu->get_tlb_stats();
+    if (tlb_stats.hits + tlb_stats.misses > 0)
+    {
+        mmu->print_tlb_stats();
+    }
+}
+
+EventScheduler::EventID Emulator32bit::schedule_event(unsigned long long delay, EventScheduler::Handler handler)
+{
+    EventScheduler::EventID id = _scheduler.schedule(cycles() + delay, std::move(handler));
+
+    /* Cut the current burst short so the event is not run late */
+    if (delay < _burst)
+    {
+        _burst_len -= _burst - delay;
+        _burst = delay;
+    }
+    return id;
+}
+
+void Emulator32bit::post_event(EventScheduler::Handler handler)
+{
+    {
+        std::lock_guard<std::mutex> lock(_external_mutex);
+        _external_events.push_back(std::move(handler));
+        _has_external_events.store(true, std::memory_order_release);
+    }
+    _external_signal.notify_one();
+}
+
+void Emulator32bit::attach_event_source()
+{
+    _event_sources.fetch_add(1, std::memory_order_relaxed);
+}
+
+void Emulator32bit::detach_event_source()
+{
+    _event_sources.fetch_sub(1, std::memory_order_relaxed);
+}
+
+bool Emulator32bit::run_events()
+{
+    bool ran = _scheduler.run_due(_cycles) > 0;
+    return run_external_events() || ran;
+}
+
+bool Emulator32bit::run_external_events()
+{
+    if (!_has_external_events.load(std::memory_order_acquire))
+    {
+        return false;
+    }
+
+    std::vector<EventScheduler::Handler> events;
+    {
+        std::lock_guard<std::mutex> lock(_external_mutex);
+        events.swap(_external_events);
+        _has_external_events.store(false, std::memory_order_relaxed);
+    }
+
+    for (EventScheduler::Handler& handler : events)
+    {
+        handler();
+    }
+    return !events.empty();
+}
+
+void Emulator32bit::wait_for_event(unsigned long long end_cycles)
+{
+    /*
+        Nothing runs until the next event, so the clock skips straight to it,
+        or to the end of the run if that comes first, instead of spinning. With
+        nothing scheduled the thread sleeps until another thread posts an event,
+        but a bounded run only does when a DMA transfer or file request in
+        flight is certain to post one. An unbounded run also sleeps for an
+        attached event source, with neither it stops instead of hanging.
+    */
+    unsigned long long deadline = _scheduler.next_deadline();
+    if (deadline != NO_DEADLINE)
+    {
+        _cycles = std::max(_cycles, std::min(deadline, end_cycles));
+    }
+    else if (end_cycles != NO_DEADLINE && !dma->busy() && !file_manager->busy())
+    {
+        _cycles = std::max(_cycles, end_cycles);
+    }
+    else
+    {
+        /* the guest is idle until someone else posts an event, show what it wrote so far */
+        uart->flush();
+        std::unique_lock<std::mutex> lock(_external_mutex);
+
+        /* DMA and file requests only stop being busy on this thread, once their event ran */
+        if (_external_events.empty() && !dma->busy() && !file_manager->busy() &&
+                _event_sources.load(std::memory_order_relaxed) == 0)
+        {
+            throw Exception(HALT_INSTR, "WFI with no event scheduled, in flight or attached to wake it");
+        }
+        _external_signal.wait(lock, [this]() { return !_external_events.empty(); });
+    }
+
+    if (run_events())
+    {
+        _waiting = false;
+    }
+}
+
+void Emulator32bit::raise_interrupt(InterruptType type)
+{
+    if (test_bit(_pstate, IRQ_MASK_FLAG))
+    {
+        _pending_interrupts = set_bit(_pending_interrupts, type, 1);
+        return;
+    }
+
+    _pending_interrupts = set_bit(_pending_interrupts, type, 0);
+
+    InterruptFrame frame;
+    for (int reg = 0; reg < NUM_REG; reg++)
+    {
+        frame.saved_reg[reg] = read_reg(reg);
+    }
+    frame.saved_px = _pc;
+    frame.saved_pstate = _pstate;
+    frame.saved_pagedir = _pagedir;
+    _interrupt_frames.push_back(frame);
+
+    /* Handlers run privileged with further interrupts held until they return */
+    _pstate = set_bit(_pstate, USER_FLAG, 0);
+    _pstate = set_bit(_pstate, IRQ_MASK_FLAG, 1);
+    _pc = _vector_table + type * 4;
+}
+
+void Emulator32bit::deliver_pending_interrupts()
+{
+    if (_pending_interrupts == 0 || test_bit(_pstate, IRQ_MASK_FLAG))
+    {
+        return;
+    }
+
+    /* Lowest type first, the rest stay pending until this handler returns */
+    raise_interrupt((InterruptType) __builtin_ctz(_pending_interrupts));
 }
 
 void Emulator32bit::reset()
 {
     system_bus.reset();
+    uart->reset();
+    dma->reset();
     for (unsigned long long i = 0; i < sizeof(_x) / sizeof(_x[0]); i++)
     {
         _x[i] = (1ULL << (8 * sizeof(word))) - 1;
     }
     _x[XZR] = 0;
     _pstate = 0;
+    _fpcr = 0;
+    _fpsr = 0;
     _pc = 0;
+    _interrupt_frames.clear();
+    _pending_interrupts = 0;
+    _waiting = false;
 
 }
\ No newline at end of file
@@ -126,7 +126,7 @@ FreeBlockList::FreeBlock *FreeBlockList::insert (word addr, word length)
     FreeBlock *next = new FreeBlock
     {
         .addr = addr,
-        .len = 1,
+        .len = length,
         .next = cur->next,
         .prev = cur,
     };
@@ -0,0 +1,255 @@
+#include "emulator32bit/emulator32bit.h"
+
+#include <cmath>
+#include <cstring>
+
+#if defined(__SSE__)
+#include <xmmintrin.h>
+#else
+#include <cfenv>
+#endif
+
+#define DEFAULT_NAN 0x7FC00000
+#define QUIET_BIT 0x00400000
+
+static inline float to_float(word bits)
+{
+    float f;
+    memcpy(&f, &bits, sizeof(f));
+    return f;
+}
+
+static inline word to_bits(float f)
+{
+    word bits;
+    memcpy(&bits, &f, sizeof(bits));
+    return bits;
+}
+
+static inline bool is_nan(word a)
+{
+    return (a & 0x7FFFFFFF) > 0x7F800000;
+}
+
+static inline bool is_signaling_nan(word a)
+{
+    return is_nan(a) && !(a & QUIET_BIT);
+}
+
+static inline bool is_denormal(word a)
+{
+    return (a & 0x7F800000) == 0 && (a & 0x007FFFFF) != 0;
+}
+
+/*
+ * Host floating point environment around one operation. host_begin() loads the guest rounding
+ * mode into the host and returns the host state to restore, host_end() gives back the exception
+ * flags the operation raised in the FPSR layout.
+ */
+#if defined(__SSE__)
+/* MXCSR rounding control for each FPRounding, nearest, down, up, toward zero in MXCSR order */
+static const word MXCSR_ROUNDING[4] = {0x0000, 0x4000, 0x2000, 0x6000};
+#define MXCSR_ROUNDING_MASK 0x6000
+#define MXCSR_FLAGS_MASK 0x3F
+
+static inline word mxcsr_to_fpsr(word mxcsr)
+{
+    /* IE, DE, ZE, OE, UE, PE, the denormal operand flag has no FPSR equivalent */
+    return (mxcsr & 0b1) << FPSR_IOC | ((mxcsr >> 2) & 0b1111) << FPSR_DZC;
+}
+
+/*
+ * An operation raising a flag that is clear in MXCSR takes a microcode assist, clearing the flags
+ * around every operation made floats several times slower than integers. The host flags are left
+ * sticky instead, and only cleared when they hold one the guest FPSR does not, so a flag already
+ * set was raised by an earlier guest operation and is in the FPSR anyway.
+ */
+static inline word host_begin(word fpcr, word fpsr, word& guest)
+{
+    word saved = _mm_getcsr();
+    guest = (saved & ~MXCSR_ROUNDING_MASK) | MXCSR_ROUNDING[bitfield_u32(fpcr, FPCR_RMODE, 2)];
+    if (mxcsr_to_fpsr(guest) & ~fpsr) {
+        guest &= ~MXCSR_FLAGS_MASK;
+    }
+
+    if (guest != saved) {
+        _mm_setcsr(guest);
+    }
+    return saved;
+}
+
+static inline word host_end(word saved, word guest)
+{
+    word raised = _mm_getcsr();
+    if ((raised ^ saved) & MXCSR_ROUNDING_MASK) {
+        _mm_setcsr((raised & ~MXCSR_ROUNDING_MASK) | (saved & MXCSR_ROUNDING_MASK));
+    }
+    return mxcsr_to_fpsr(raised & ~guest);
+}
+#else
+static const int FENV_ROUNDING[4] = {FE_TONEAREST, FE_UPWARD, FE_DOWNWARD, FE_TOWARDZERO};
+
+static inline word host_begin(word fpcr, word fpsr, word& guest)
+{
+    (void) fpsr;
+    guest = 0;
+    word saved = fegetround();
+    fesetround(FENV_ROUNDING[bitfield_u32(fpcr, FPCR_RMODE, 2)]);
+    feclearexcept(FE_ALL_EXCEPT);
+    return saved;
+}
+
+static inline word host_end(word saved, word guest)
+{
+    (void) guest;
+    int raised = fetestexcept(FE_ALL_EXCEPT);
+    fesetround(saved);
+    return (raised & FE_INVALID ? 1 << FPSR_IOC : 0) | (raised & FE_DIVBYZERO ? 1 << FPSR_DZC : 0)
+            | (raised & FE_OVERFLOW ? 1 << FPSR_OFC : 0) | (raised & FE_UNDERFLOW ? 1 << FPSR_UFC : 0)
+            | (raised & FE_INEXACT ? 1 << FPSR_IXC : 0);
+}
+#endif
+
+/* A denormal operand is read as a signed zero under FZ */
+word Emulator32bit::float_operand(word a)
+{
+    if (test_bit(_fpcr, FPCR_FZ) && is_denormal(a)) {
+        _fpsr = set_bit(_fpsr, FPSR_IDC, 1);
+        return a & 0x80000000;
+    }
+    return a;
+}
+
+/*
+ * Result of an operation with a NaN operand. A signaling NaN wins over a quiet one and the first
+ * operand over the second, the way arm picks it, instead of whatever the host happens to return.
+ */
+word Emulator32bit::float_nan(word a, word b)
+{
+    if (is_signaling_nan(a) || is_signaling_nan(b)) {
+        _fpsr = set_bit(_fpsr, FPSR_IOC, 1);
+    }
+
+    if (test_bit(_fpcr, FPCR_DN)) {
+        return DEFAULT_NAN;
+    }
+
+    word nan = is_signaling_nan(a) ? a : is_signaling_nan(b) ? b : is_nan(a) ? a : b;
+    return nan | QUIET_BIT;
+}
+
+word Emulator32bit::float_arith(byte opcode, word a, word b)
+{
+    a = float_operand(a);
+    b = float_operand(b);
+    if (is_nan(a) || is_nan(b)) {
+        return float_nan(a, b);
+    }
+
+    /* volatile keeps the operation between the host environment changes */
+    volatile float x = to_float(a);
+    volatile float y = to_float(b);
+    volatile float result;
+
+    word guest;
+    word saved = host_begin(_fpcr, _fpsr, guest);
+    switch (opcode) {
+        case _op_vadd:
+            result = x + y;
+            break;
+        case _op_vsub:
+            result = x - y;
+            break;
+        case _op_vmul:
+            result = x * y;
+            break;
+        case _op_vdiv:
+            result = x / y;
+            break;
+        case _op_vsqrt:
+            result = std::sqrt((float) x);
+            break;
+        default:
+            host_end(saved, guest);
+            throw Exception(BAD_INSTR, "Bad floating point operation " + std::to_string(opcode));
+    }
+    word raised = host_end(saved, guest);
+
+    word bits = to_bits(result);
+    if (is_nan(bits)) {
+        /* a new NaN, hosts differ in its sign */
+        bits = DEFAULT_NAN;
+    } else if (test_bit(_fpcr, FPCR_FZ) && is_denormal(bits)) {
+        bits &= 0x80000000;
+        raised = (raised | (1 << FPSR_UFC)) & ~(1 << FPSR_IXC);
+    }
+
+    _fpsr |= raised;
+    return bits;
+}
+
+/* Rounds toward zero and saturates, as a C cast would if it did not overflow */
+word Emulator32bit::float_to_int(word a, bool sign)
+{
+    a = float_operand(a);
+    if (is_nan(a)) {
+        _fpsr = set_bit(_fpsr, FPSR_IOC, 1);
+        return 0;
+    }
+
+    const double value = to_float(a);
+    const double truncated = std::trunc(value);
+    const double min = sign ? -2147483648.0 : 0.0;
+    const double max = sign ? 2147483647.0 : 4294967295.0;
+    if (truncated < min || truncated > max) {
+        _fpsr = set_bit(_fpsr, FPSR_IOC, 1);
+        return truncated < min ? (word) (sword) min : (word) max;
+    }
+
+    if (truncated != value) {
+        _fpsr = set_bit(_fpsr, FPSR_IXC, 1);
+    }
+    return sign ? (word) (sword) truncated : (word) truncated;
+}
+
+word Emulator32bit::int_to_float(word a, bool sign)
+{
+    volatile sword signed_value = (sword) a;
+    volatile word unsigned_value = a;
+    volatile float result;
+
+    word guest;
+    word saved = host_begin(_fpcr, _fpsr, guest);
+    if (sign) {
+        result = (float) signed_value;
+    } else {
+        result = (float) unsigned_value;
+    }
+    _fpsr |= host_end(saved, guest);
+
+    return to_bits(result);
+}
+
+/* Less than is N, equal is ZC, greater than is C and unordered is CV */
+void Emulator32bit::float_compare(word a, word b)
+{
+    a = float_operand(a);
+    b = float_operand(b);
+    if (is_nan(a) || is_nan(b)) {
+        if (is_signaling_nan(a) || is_signaling_nan(b)) {
+            _fpsr = set_bit(_fpsr, FPSR_IOC, 1);
+        }
+        set_NZCV(false, false, true, true);
+        return;
+    }
+
+    const float x = to_float(a);
+    const float y = to_float(b);
+    if (x == y) {
+        set_NZCV(false, true, true, false);
+    } else if (x < y) {
+        set_NZCV(true, false, false, false);
+    } else {
+        set_NZCV(false, false, true, false);
+    }
+}
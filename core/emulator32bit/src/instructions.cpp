@@ -3,6 +3,7 @@
 #define AEMU_ONLY_CRITICAL_LOG
 #include <util/logger.h>
 
+#include <algorithm>
 #include <string>
 
 /**
@@ -11,13 +12,16 @@
  * @hideinitializer
  *
  */
-#define _X1(instr) (bitfield_u32(instr, 20, 5))                /* bits 20 to 24 */
-#define _X2(instr) (bitfield_u32(instr, 15, 5))                /* bits 15 to 19 */
-#define _X3(instr) (bitfield_u32(instr, 9, 5))                /* bits 9 to 14 */
-#define _X4(instr) (bitfield_u32(instr, 4, 5))                /* bits 4 to 9 */
+#define _X1(instr) isa_x1(instr)                /* bits 20 to 24 */
+#define _X2(instr) isa_x2(instr)                /* bits 15 to 19 */
+#define _X3(instr) isa_x3(instr)                /* bits 9 to 13 */
+#define _X4(instr) isa_x4(instr)                /* bits 4 to 8 */
 
 #define UNUSED(x) (void)(x)
 
+/* Most bytes one execution of cpy or set moves before it is run again, bounds interrupt latency */
+#define MOPS_MAX_BYTES (16 * PAGE_SIZE)
+
 /**
  * @internal
  * @brief                     Calculates the new value after applying the specified shift
@@ -136,168 +140,13 @@ static bool get_v_flag_sub(const word op1, const word op2)
 
 /**
  * @internal
- * @brief                    A sequence of bits to add to a @ref Joiner
- *
- */
-struct JPart
-{
-    JPart(const int bits, const word val = 0) :
-        bits(bits), val(val)
-    {
-
-    }
-    const int bits;                                            /* Number of bits stored in this part */
-    const word val;                                            /* Contents of the bits stored in this part, stored with the first bit in the most significant bit */
-};
-
-/**
- * @internal
- * @brief                    A value that is formed by joining @ref JPart
- *
- */
-class Joiner
-{
-    public:
-        word val = 0;                                        /* Content stored so far */
-
-        /**
-         * @internal
-         * @brief            Add a new @ref JPart
-         *
-         * @param            p: @ref JPart to add
-         * @return             Reference to this object
-         */
-        Joiner& operator<<(const JPart& p)
-        {
-            val <<= p.bits;
-            val += p.val;
-            return *this;
-        }
-
-        /**
-         * @internal
-         * @brief            Add filler bits all set to 0
-         *
-         * @param             bits: Number of bits to add
-         * @return             Reference to this object
-         */
-        Joiner& operator<<(const int bits)
-        {
-            val <<= bits;
-            return *this;
-        }
-
-        /**
-         * @internal
-         * @brief             Extract the value of this object
-         *
-         * @return             word
-         */
-        operator word() const
-        {
-            return val;
-        }
-};
-
-/**
- * @brief                    Constructs instructions of format O with an imm14 operand
- *
- * @param                     opcode: 6 bit identifier of a format O instruction
- * @param                     s: whether condition flags are set
- * @param                     xd: 5 bit destination register identifier
- * @param                     xn: 5 bit operand register identifier
- * @param                     imm14: 14 bit immediate value
- * @return                     instruction word
- */
-word Emulator32bit::asm_format_o(const byte opcode, const bool s, const int xd, const int xn,
-                                 const int imm14)
-{
-    return Joiner() << JPart(6, opcode) << JPart(1, s) << JPart(5, xd) << JPart(5, xn)
-                    << JPart(1, 1) << JPart(14, imm14);
-}
-
-/**
- * @brief                     Constructs instructions of format O with an arg operand
+ * @brief                    Parse the operand of an instruction of format O3, the same way
+ *                             @ref Emulator32bit::_mov does
+ * @hideinitializer
  *
- * @param                     opcode: 6 bit identifier of a format O instruction
- * @param                     s: whether condition flags are set
- * @param                     xd: 5 bit destination register identifier
- * @param                     xn: 5 bit operand register identifier
- * @param                     xm: 5 bit operand register identifier
- * @param                     shift: shift type to be applied on the value in the xm register
- * @param                     imm5: shift amount
- * @return                     instruction word
  */
-word Emulator32bit::asm_format_o(const byte opcode, const bool s, const int xd, const int xn,
-                                 const int xm, const ShiftType shift, const int imm5)
-{
-    return Joiner() << JPart(6, opcode) << JPart(1, s) << JPart(5, xd) << JPart(5, xn) << 1
-                    << JPart(5, xm) << JPart(2, shift) << JPart(5, imm5) << 2;
-}
-
-word Emulator32bit::asm_format_o1(const byte opcode, const int xd, const int xn, const bool imm,
-                                  const int xm, const int imm5)
-{
-    return Joiner() << JPart(6, opcode) << 1 << JPart(5, xd) << JPart(5, xn) << JPart(1, imm)
-                    << JPart(5, xm) << 2 << JPart(5, imm5) << 2;
-}
-
-word Emulator32bit::asm_format_o2(const byte opcode, const bool s, const int xlo, const int xhi,
-                                  const int xn, const int xm)
-{
-    return Joiner() << JPart(6, opcode) << JPart(1, s) << JPart(5, xlo) << JPart(5, xhi)
-                    << 1 << JPart(5, xn) << JPart(5, xm) << 4;
-}
-
-word Emulator32bit::asm_format_o3(const byte opcode, const bool s, const int xd, const int imm19)
-{
-    return Joiner() << JPart(6, opcode) << JPart(1, s) << JPart(5, xd) << JPart(1, 1)
-                    << JPart(19, imm19);
-}
-
-word Emulator32bit::asm_format_o3(const byte opcode, const bool s, const int xd, const int xn,
-                                  const int imm14)
-{
-    return Joiner() << JPart(6, opcode) << JPart(1, s) << JPart(5, xd) << 0 << JPart(5, xn)
-                    << JPart(14, imm14);
-}
-
-word Emulator32bit::asm_format_m(const byte opcode, const bool sign, const int xt, const int xn,
-                                 const int xm, const ShiftType shift, const int imm5,
-                                 const AddrType adr)
-{
-    return Joiner() << JPart(6, opcode) << JPart(1, sign) << JPart(5, xt) << JPart(5, xn)
-                    << 1 << JPart(5, xm) << JPart(2, shift) << JPart(5, imm5) << JPart(2, adr);
-}
-
-word Emulator32bit::asm_format_m(const byte opcode, const bool sign, const int xt, const int xn,
-                                 const int simm12, const AddrType adr)
-{
-    return Joiner() << JPart(6, opcode) << JPart(1, sign) << JPart(5, xt) << JPart(5, xn)
-                    << JPart(1, 1) << JPart(12, bitfield_u32(simm12, 0, 12)) << JPart(2, adr);
-}
-
-word Emulator32bit::asm_format_m1(const byte opcode, const int xt, const int xn, const int xm)
-{
-    return Joiner() << JPart(6, opcode) << 1 << JPart(5, xt) << JPart(5, xn) << 1 << JPart(5, xm)
-                    << 9;
-}
-
-word Emulator32bit::asm_format_m2(const byte opcode, const int xd, const int imm20)
-{
-    return Joiner() << JPart(6, opcode) << 1 << JPart(5, xd) << JPart(20, imm20);
-}
-
-word Emulator32bit::asm_format_b1(const byte opcode, const ConditionCode cond, const sword simm22)
-{
-    return Joiner() << JPart(6, opcode) << JPart(4, (word) cond)
-                    << JPart(22, bitfield_u32(simm22, 0, 22));
-}
-
-word Emulator32bit::asm_format_b2(const byte opcode, const ConditionCode cond, const int xd)
-{
-    return Joiner() << JPart(6, opcode) << JPart(4, (word) cond) << JPart(5, xd) << 17;
-}
+#define FORMAT_O3__get_arg(instr) (test_bit(instr, 19) ? bitfield_u32(instr, 0, 19) : \
+        bitfield_u32(instr, 0, 14) + read_reg(bitfield_u32(instr, 14, 5)))
 
 void Emulator32bit::_hlt(const word instr)
 {
@@ -305,9 +154,14 @@ void Emulator32bit::_hlt(const word instr)
     throw Exception(HALT_INSTR, "HLT Exception");
 }
 
-word Emulator32bit::asm_hlt()
+void Emulator32bit::_wfi(const word instr)
 {
-    return Joiner() << JPart(6, _op_hlt) << 26;
+    UNUSED(instr);
+
+    /* End the burst here, the run loop idles until the next event runs */
+    _waiting = true;
+    _burst_len -= _burst;
+    _burst = 0;
 }
 
 void Emulator32bit::_nop(const word instr)
@@ -316,11 +170,6 @@ void Emulator32bit::_nop(const word instr)
     return; // do nothing
 }
 
-word Emulator32bit::asm_nop()
-{
-    return Joiner() << JPart(6, _op_nop) << 26;
-}
-
 void Emulator32bit::_add(const word instr)
 {
     const byte xd = _X1(instr);
@@ -502,80 +351,211 @@ void Emulator32bit::_smull(const word instr)
     write_reg(xhi, (word) (dst_val >> 32));
 }
 
-// todo WILL DO LATER JUST NOT NOW
+void Emulator32bit::_udiv(const word instr)
+{
+    const byte xd = _X1(instr);
+    const word xn_val = read_reg(_X2(instr));
+    const word xm_val = FORMAT_O__get_arg(instr);
+
+    /* like arm, dividing by zero gives zero instead of trapping */
+    const word dst_val = xm_val == 0 ? 0 : xn_val / xm_val;
+
+    // check to update NZCV
+    if (test_bit(instr, S_BIT)) {
+        set_NZCV(test_bit(dst_val, 31), dst_val == 0, test_bit(_pstate, C_FLAG),
+                 test_bit(_pstate, V_FLAG));
+    }
+
+    DEBUG_SS(std::stringstream() << "udiv " << std::to_string(xn_val) << " "
+            << std::to_string(xm_val) << " = " << std::to_string(dst_val));
+
+    write_reg(xd, dst_val);
+}
+
+void Emulator32bit::_sdiv(const word instr)
+{
+    const byte xd = _X1(instr);
+    const sword xn_val = read_reg(_X2(instr));
+    const sword xm_val = FORMAT_O__get_arg(instr);
+
+    /* INT_MIN / -1 overflows on the host, arm gives back INT_MIN */
+    sword dst_val = 0;
+    if (xm_val == -1) {
+        dst_val = (sword) (0U - (word) xn_val);
+    } else if (xm_val != 0) {
+        dst_val = xn_val / xm_val;
+    }
+
+    // check to update NZCV
+    if (test_bit(instr, S_BIT)) {
+        set_NZCV(test_bit(dst_val, 31), dst_val == 0, test_bit(_pstate, C_FLAG),
+                 test_bit(_pstate, V_FLAG));
+    }
+
+    DEBUG_SS(std::stringstream() << "sdiv " << std::to_string(xn_val) << " "
+            << std::to_string(xm_val) << " = " << std::to_string(dst_val));
+
+    write_reg(xd, (word) dst_val);
+}
+
+void Emulator32bit::_clz(const word instr)
+{
+    const byte xd = _X1(instr);
+    const word xn_val = FORMAT_O3__get_arg(instr);
+    const word dst_val = xn_val == 0 ? WORD_BITS : __builtin_clz(xn_val);
+
+    // check to update NZCV
+    if (test_bit(instr, S_BIT)) {
+        set_NZCV(test_bit(dst_val, 31), dst_val == 0, test_bit(_pstate, C_FLAG),
+                 test_bit(_pstate, V_FLAG));
+    }
+
+    DEBUG_SS(std::stringstream() << "clz " << std::to_string(xn_val) << " = "
+            << std::to_string(dst_val));
+    write_reg(xd, dst_val);
+}
+
+void Emulator32bit::_rbit(const word instr)
+{
+    const byte xd = _X1(instr);
+    const word xn_val = FORMAT_O3__get_arg(instr);
+
+    /* swap ever smaller halves, then the bytes */
+    word dst_val = xn_val;
+    dst_val = ((dst_val >> 1) & 0x55555555) | ((dst_val & 0x55555555) << 1);
+    dst_val = ((dst_val >> 2) & 0x33333333) | ((dst_val & 0x33333333) << 2);
+    dst_val = ((dst_val >> 4) & 0x0F0F0F0F) | ((dst_val & 0x0F0F0F0F) << 4);
+    dst_val = __builtin_bswap32(dst_val);
+
+    // check to update NZCV
+    if (test_bit(instr, S_BIT)) {
+        set_NZCV(test_bit(dst_val, 31), dst_val == 0, test_bit(_pstate, C_FLAG),
+                 test_bit(_pstate, V_FLAG));
+    }
+
+    DEBUG_SS(std::stringstream() << "rbit " << std::to_string(xn_val) << " = "
+            << std::to_string(dst_val));
+    write_reg(xd, dst_val);
+}
+
+void Emulator32bit::_rev(const word instr)
+{
+    const byte xd = _X1(instr);
+    const word xn_val = FORMAT_O3__get_arg(instr);
+    const word dst_val = __builtin_bswap32(xn_val);
+
+    // check to update NZCV
+    if (test_bit(instr, S_BIT)) {
+        set_NZCV(test_bit(dst_val, 31), dst_val == 0, test_bit(_pstate, C_FLAG),
+                 test_bit(_pstate, V_FLAG));
+    }
+
+    DEBUG_SS(std::stringstream() << "rev " << std::to_string(xn_val) << " = "
+            << std::to_string(dst_val));
+    write_reg(xd, dst_val);
+}
+
 void Emulator32bit::_vabs(const word instr)
 {
-    UNUSED(instr);
+    const byte xd = _X1(instr);
+    const word xn_val = read_reg(_X2(instr));
 
+    /* abs and neg only touch the sign bit, they never raise an exception */
+    write_reg(xd, xn_val & 0x7FFFFFFF);
 }
 
 void Emulator32bit::_vneg(const word instr)
 {
-    UNUSED(instr);
+    const byte xd = _X1(instr);
+    const word xn_val = read_reg(_X2(instr));
 
+    write_reg(xd, xn_val ^ 0x80000000);
 }
 
 void Emulator32bit::_vsqrt(const word instr)
 {
-    UNUSED(instr);
+    const byte xd = _X1(instr);
+    const word xn_val = read_reg(_X2(instr));
 
+    write_reg(xd, float_arith(_op_vsqrt, xn_val, xn_val));
 }
 
 void Emulator32bit::_vadd(const word instr)
 {
-    UNUSED(instr);
-
+    write_reg(_X1(instr), float_arith(_op_vadd, read_reg(_X2(instr)), read_reg(_X3(instr))));
 }
 
 void Emulator32bit::_vsub(const word instr)
 {
-    UNUSED(instr);
-
+    write_reg(_X1(instr), float_arith(_op_vsub, read_reg(_X2(instr)), read_reg(_X3(instr))));
 }
 
 void Emulator32bit::_vdiv(const word instr)
 {
-    UNUSED(instr);
-
+    write_reg(_X1(instr), float_arith(_op_vdiv, read_reg(_X2(instr)), read_reg(_X3(instr))));
 }
 
 void Emulator32bit::_vmul(const word instr)
 {
-    UNUSED(instr);
-
+    write_reg(_X1(instr), float_arith(_op_vmul, read_reg(_X2(instr)), read_reg(_X3(instr))));
 }
 
 void Emulator32bit::_vcmp(const word instr)
 {
-    UNUSED(instr);
+    const word xn_val = read_reg(_X2(instr));
+    const word xm_val = test_bit(instr, 14) ? 0 : read_reg(_X3(instr));
 
+    float_compare(xn_val, xm_val);
 }
 
 void Emulator32bit::_vsel(const word instr)
 {
-    UNUSED(instr);
+    const byte xd = _X1(instr);
+    const byte cond = bitfield_u32(instr, 0, 4);
 
+    write_reg(xd, check_cond(_pstate, cond) ? read_reg(_X2(instr)) : read_reg(_X3(instr)));
 }
 
 void Emulator32bit::_vcint(const word instr)
 {
-    UNUSED(instr);
-
+    write_reg(_X1(instr), float_to_int(read_reg(_X2(instr)), test_bit(instr, 25)));
 }
 
 void Emulator32bit::_vcflo(const word instr)
 {
-    UNUSED(instr);
-
+    write_reg(_X1(instr), int_to_float(read_reg(_X2(instr)), test_bit(instr, 25)));
 }
 
 void Emulator32bit::_vmov(const word instr)
 {
-    UNUSED(instr);
+    const byte xd = _X1(instr);
+    if (test_bit(instr, 25)) {
+        write_reg(xd, bitfield_u32(instr, 0, 20) << 12);
+        return;
+    }
 
+    const word xn_val = read_reg(_X2(instr));
+    switch ((VmovType) bitfield_u32(instr, 0, 3)) {
+        case VMOV_REGISTER:
+            write_reg(xd, xn_val);
+            break;
+        case VMRS_FPCR:
+            write_reg(xd, _fpcr);
+            break;
+        case VMRS_FPSR:
+            write_reg(xd, _fpsr);
+            break;
+        case VMSR_FPCR:
+            set_fpcr(xn_val);
+            break;
+        case VMSR_FPSR:
+            set_fpsr(xn_val);
+            break;
+        default:
+            throw Exception(BAD_INSTR, "Bad vmov type " + std::to_string(bitfield_u32(instr, 0, 3)));
+    }
 }
 
-
 void Emulator32bit::_and(const word instr)
 {
     const byte xd = _X1(instr);
@@ -808,6 +788,18 @@ void Emulator32bit::_mvn(const word instr)
     write_reg(xd, dst_val);
 }
 
+void Emulator32bit::_csel(const word instr)
+{
+    const bool inc = test_bit(instr, 25);
+    const byte xd = _X1(instr);
+    const byte cond = bitfield_u32(instr, 0, 4);
+    const word dst_val = check_cond(_pstate, cond) ? read_reg(_X2(instr)) : read_reg(_X3(instr)) + inc;
+
+    DEBUG_SS(std::stringstream() << (inc ? "csinc " : "csel ") << std::to_string(xd) << " "
+            << std::to_string(cond) << " = " << std::to_string(dst_val));
+    write_reg(xd, dst_val);
+}
+
 word Emulator32bit::calc_mem_addr(word xn, sword offset, byte addr_mode)
 {
     word mem_addr = 0;
@@ -1034,6 +1026,193 @@ void Emulator32bit::_strh(const word instr)
     system_bus.write_hword(mem_addr, write_val);
 }
 
+/**
+ * @internal
+ * @brief                    Moves consecutive words between guest memory and the host, translating
+ *                             once per page instead of once per word. Devices still see word
+ *                             accesses.
+ *
+ */
+static void read_words(SystemBus& bus, const word address, word *vals, const int n)
+{
+    if (address + 4 * n - 1 >= MMIO_START) {
+        for (int i = 0; i < n; i++) {
+            vals[i] = bus.read_word(address + 4 * i);
+        }
+        return;
+    }
+    bus.read_buffer(address, (byte*) vals, 4 * n);
+}
+
+static void write_words(SystemBus& bus, const word address, const word *vals, const int n)
+{
+    if (address + 4 * n - 1 >= MMIO_START) {
+        for (int i = 0; i < n; i++) {
+            bus.write_word(address + 4 * i, vals[i]);
+        }
+        return;
+    }
+    bus.write_buffer(address, (const byte*) vals, 4 * n);
+}
+
+void Emulator32bit::_ldstp(const word instr)
+{
+    const bool load = test_bit(instr, 25);
+    const byte xt1 = _X1(instr);
+    const byte xt2 = _X2(instr);
+    const byte xn = _X3(instr);
+    const sword offset = bitfield_s32(instr, 2, 7) * 4;
+
+    const byte address_mode = bitfield_u32(instr, 0, 2);
+    const word mem_addr = calc_mem_addr(xn, offset, address_mode);
+    word vals[2];
+
+    DEBUG_SS(std::stringstream() << (load ? "ldp x" : "stp x") << std::to_string(xt1) << ", x"
+            << std::to_string(xt2) << ", [x" << std::to_string(xn) << ", #" << offset
+            << "] (" << std::to_string(mem_addr) << ")");
+
+    if (load) {
+        read_words(system_bus, mem_addr, vals, 2);
+        write_reg(xt1, vals[0]);
+        write_reg(xt2, vals[1]);
+    } else {
+        vals[0] = read_reg(xt1);
+        vals[1] = read_reg(xt2);
+        write_words(system_bus, mem_addr, vals, 2);
+    }
+}
+
+void Emulator32bit::_ldstm(const word instr)
+{
+    const bool load = test_bit(instr, 25);
+    const byte xn = _X1(instr);
+    const bool writeback = test_bit(instr, 19);
+    const bool decrement = test_bit(instr, 18);
+    const byte first_reg = test_bit(instr, 17) ? 16 : 0;
+    const word reglist = bitfield_u32(instr, 0, 16);
+
+    /* lowest register at the lowest address, whichever way the base moves */
+    const int count = __builtin_popcount(reglist);
+    const word base = read_reg(xn);
+    const word mem_addr = decrement ? base - 4 * count : base;
+    const word new_base = decrement ? mem_addr : base + 4 * count;
+    word vals[16];
+
+    DEBUG_SS(std::stringstream() << (load ? "ldm" : "stm") << (decrement ? "db x" : " x")
+            << std::to_string(xn) << (writeback ? "!" : "") << ", {" << std::to_string(count)
+            << " registers from x" << std::to_string(first_reg) << "} ("
+            << std::to_string(mem_addr) << ")");
+
+    if (load) {
+        read_words(system_bus, mem_addr, vals, count);
+        if (writeback) {
+            write_reg(xn, new_base);
+        }
+
+        /* a loaded base register wins over the write back */
+        for (int reg = 0, i = 0; reg < 16; reg++) {
+            if (test_bit(reglist, reg)) {
+                write_reg(first_reg + reg, vals[i++]);
+            }
+        }
+    } else {
+        for (int reg = 0, i = 0; reg < 16; reg++) {
+            if (test_bit(reglist, reg)) {
+                vals[i++] = read_reg(first_reg + reg);
+            }
+        }
+
+        write_words(system_bus, mem_addr, vals, count);
+        if (writeback) {
+            write_reg(xn, new_base);
+        }
+    }
+}
+
+void Emulator32bit::_packed(const word instr)
+{
+    const byte xd = _X1(instr);
+    const word xn_val = read_reg(_X2(instr));
+    const word xm_val = read_reg(_X3(instr));
+    const PackedOp op = (PackedOp) bitfield_u32(instr, 0, 5);
+    const word dst_val = packed_op(op, xn_val, xm_val);
+
+    DEBUG_SS(std::stringstream() << packed_op_name(op) << " " << std::to_string(xn_val) << " "
+            << std::to_string(xm_val) << " = " << std::to_string(dst_val));
+    write_reg(xd, dst_val);
+}
+
+/*
+ * cpy copies xn bytes from [xs] to [xd], set fills xn bytes at [xd] with the low byte of xs. The
+ * registers are written back after every page, so an instruction that faults part way is restarted
+ * by running it again and only does the rest. Each execution moves at most MOPS_MAX_BYTES, then
+ * leaves the pc on itself so pending events run before it carries on.
+ *
+ * A forward copy leaves xd and xs past the bytes copied. Copying to a higher address that overlaps
+ * the source goes backward from the end instead, with xd and xs left where they are, so either
+ * way the registers always describe the bytes still to do and xn ends at 0.
+ */
+void Emulator32bit::_mops(const word instr)
+{
+    const bool set = test_bit(instr, 25);
+    const byte xd = _X1(instr);
+    const byte xs = _X2(instr);
+    const byte xn = _X3(instr);
+
+    if (xd == xn || (!set && (xs == xd || xs == xn))) {
+        throw Exception(BAD_INSTR, "cpy and set need distinct registers");
+    }
+
+    word dst = read_reg(xd);
+    word length = read_reg(xn);
+    word budget = std::min(length, (word) MOPS_MAX_BYTES);
+
+    DEBUG_SS(std::stringstream() << (set ? "set " : "cpy ") << std::to_string(dst) << ", "
+            << std::to_string(read_reg(xs)) << ", " << std::to_string(length));
+
+    if (set) {
+        const byte value = read_reg(xs);
+        while (budget > 0) {
+            const word n = system_bus.fill_chunk(dst, value, budget);
+            dst += n;
+            length -= n;
+            budget -= n;
+            write_reg(xd, dst);
+            write_reg(xn, length);
+        }
+    } else {
+        word src = read_reg(xs);
+        if (dst > src && dst - src < length) {
+            while (budget > 0) {
+                /* the last bytes, up to the start of the page of either end */
+                const word dst_end = dst + length;
+                const word src_end = src + length;
+                word n = std::min(budget, std::min(((dst_end - 1) & (PAGE_SIZE - 1)) + 1,
+                        ((src_end - 1) & (PAGE_SIZE - 1)) + 1));
+                n = system_bus.copy_chunk(dst_end - n, src_end - n, n);
+                length -= n;
+                budget -= n;
+                write_reg(xn, length);
+            }
+        } else {
+            while (budget > 0) {
+                const word n = system_bus.copy_chunk(dst, src, budget);
+                dst += n;
+                src += n;
+                length -= n;
+                budget -= n;
+                write_reg(xd, dst);
+                write_reg(xs, src);
+                write_reg(xn, length);
+            }
+        }
+    }
+
+    if (length > 0) {
+        _pc -= 4;
+    }
+}
+
 void Emulator32bit::_swp(const word instr)
 {
     const byte xt = _X1(instr);
@@ -1105,6 +1284,16 @@ void Emulator32bit::_bl(const word instr)
     DEBUG_SS(std::stringstream() << "bl " << std::to_string(cond));
 }
 
+void Emulator32bit::_cbz(const word instr)
+{
+    const bool nonzero = test_bit(instr, 25);
+    const word xt_val = read_reg(_X1(instr));
+    if ((xt_val != 0) == nonzero) {
+        _pc += (bitfield_s32(instr, 0, 20) << 2) - 4;
+    }
+    DEBUG_SS(std::stringstream() << (nonzero ? "cbnz " : "cbz ") << std::to_string(xt_val));
+}
+
 void Emulator32bit::_bx(const word instr)
 {
     const byte cond = bitfield_u32(instr, 22, 4);
@@ -1,61 +1,551 @@
 #include "emulator32bit/kernel/better_virtual_memory.h"
 
+#include "util/logger.h"
+
+#include <algorithm>
+
 MMU::MMU(Emulator32bit *processor, word user_low_page, word user_high_page,
-         word kernel_low_page, word kernel_high_page) 
+         word kernel_low_page, word kernel_high_page)
     : processor(processor), user_low_page(user_low_page), user_high_page(user_high_page),
     kernel_low_page(kernel_low_page), kernel_high_page(kernel_high_page),
-    free_user_ppages(processor->ram->data, user_low_page,
-        user_high_page - user_low_page + 1, PAGE_SIZE),
-    free_kernel_ppages(processor->ram->data, kernel_low_page, 
-        kernel_high_page - kernel_low_page + 1, PAGE_SIZE)
+    free_user_ppages(processor->ram->data,
+        (user_low_page - processor->ram->get_lo_page()) << PAGE_PSIZE,
+        (user_high_page + 1 - processor->ram->get_lo_page()) << PAGE_PSIZE, PAGE_SIZE),
+    free_kernel_ppages(processor->ram->data,
+        (kernel_low_page - processor->ram->get_lo_page()) << PAGE_PSIZE,
+        (kernel_high_page + 1 - processor->ram->get_lo_page()) << PAGE_PSIZE, PAGE_SIZE),
+    ppage_owner(user_high_page - user_low_page + 1, NO_OWNER),
+    ppage_diskpage(user_high_page - user_low_page + 1, 0),
+    ppage_refcount(user_high_page - user_low_page + 1, 0)
+{
+    EXPECT_TRUE(processor->ram->in_bounds(user_low_page << PAGE_PSIZE), "User page not in ram.");
+    EXPECT_TRUE(processor->ram->in_bounds(user_high_page << PAGE_PSIZE), "User page not in ram.");
+    EXPECT_TRUE(processor->ram->in_bounds(kernel_low_page << PAGE_PSIZE), "Kernel page not in ram.");
+    EXPECT_TRUE(processor->ram->in_bounds(kernel_high_page << PAGE_PSIZE), "Kernel page not in ram.");
+    EXPECT_TRUE(user_high_page < kernel_low_page || kernel_high_page < user_low_page,
+                "User and kernel pages overlap.");
+}
+
+MMU::Exception::Exception(const std::string& msg) :
+    message(msg)
+{
+
+}
+
+const char* MMU::Exception::what() const noexcept
+{
+    return message.c_str();
+}
+
+const MMU::Stats& MMU::get_stats() const
 {
-    EXPECT_TRUE(processor->ram->in_bounds(user_low_page), "User page not in ram.");
-    EXPECT_TRUE(processor->ram->in_bounds(user_high_page), "User page not in ram.");
-    EXPECT_TRUE(processor->ram->in_bounds(kernel_low_page), "Kernel page not in ram.");
-    EXPECT_TRUE(processor->ram->in_bounds(kernel_high_page), "Kernel page not in ram.");
+    return stats;
 }
 
 void MMU::create_pagedir()
 {
-    
+    processor->_pagedir = alloc_table();
 }
 
-void MMU::add_vpage(word vpage, bool kernel, bool write, 
+void MMU::add_vpage(word vpage, bool kernel, bool write,
                bool execute, bool copy_on_write)
 {
+    if (!processor->_pagedir)
+    {
+        throw Exception("No page directory to add virtual page " + std::to_string(vpage) + " to.");
+    }
+    else if (vpage >= N_VPAGES)
+    {
+        throw Exception("Virtual page " + std::to_string(vpage) + " is out of range.");
+    }
+    else if (vpage >= kernel_low_page && vpage <= kernel_high_page)
+    {
+        throw Exception("Virtual page " + std::to_string(vpage) + " is a directly mapped kernel page.");
+    }
 
+    word *entry = find_entry(vpage);
+    if (!entry)
+    {
+        word *pde = &phys_word(processor->_pagedir)[vpage >> PTABLE_PSIZE];
+        *pde = alloc_table() | PTE_VALID;
+        entry = find_entry(vpage);
+    }
+    else if (*entry & PTE_VALID)
+    {
+        throw Exception("Virtual page " + std::to_string(vpage) + " is already mapped.");
+    }
+
+    *entry = PTE_VALID | (kernel ? PTE_KERNEL : 0) | (write ? PTE_WRITE : 0) |
+        (execute ? PTE_EXECUTE : 0) | (copy_on_write ? PTE_COPY_ON_WRITE : 0);
 }
 
 void MMU::remove_vpage(word vpage)
 {
+    if (!processor->_pagedir)
+    {
+        throw Exception("No page directory to remove virtual page " + std::to_string(vpage) + " from.");
+    }
+
+    word *entry = vpage < N_VPAGES ? find_entry(vpage) : nullptr;
+    if (!entry || !(*entry & PTE_VALID))
+    {
+        throw Exception("Virtual page " + std::to_string(vpage) + " is not mapped.");
+    }
+    else if (*entry & PTE_HUGE)
+    {
+        throw Exception("Virtual page " + std::to_string(vpage) + " is part of a huge page.");
+    }
+
+    release_entry(entry);
+    *entry = 0;
+
+    /* Free the page table once its last page is removed. */
+    word *table = entry - (vpage & (PTABLE_NENTRIES - 1));
+    for (word i = 0; i < PTABLE_NENTRIES; i++)
+    {
+        if (table[i] & PTE_VALID)
+        {
+            return;
+        }
+    }
+
+    phys_word(processor->_pagedir)[vpage >> PTABLE_PSIZE] = 0;
+    free_kernel_ppages.return_block(phys_address(table) - (processor->ram->get_lo_page() << PAGE_PSIZE));
+    invalidate_pwc(processor->_pagedir);
+}
+
+void MMU::add_huge_vpage(word vpage, bool kernel, bool write, bool execute)
+{
+    if (!processor->_pagedir)
+    {
+        throw Exception("No page directory to add huge page " + std::to_string(vpage) + " to.");
+    }
+    else if (vpage >= N_VPAGES || (vpage & (PTABLE_NENTRIES - 1)))
+    {
+        throw Exception("Virtual page " + std::to_string(vpage) + " does not start a huge page.");
+    }
+    else if (vpage <= kernel_high_page && vpage + PTABLE_NENTRIES - 1 >= kernel_low_page)
+    {
+        throw Exception("Huge page " + std::to_string(vpage) + " overlaps directly mapped kernel pages.");
+    }
+
+    word *pde = &phys_word(processor->_pagedir)[vpage >> PTABLE_PSIZE];
+    if (*pde & PTE_VALID)
+    {
+        throw Exception("Virtual pages of huge page " + std::to_string(vpage) + " are already mapped.");
+    }
+
+    word ppage = alloc_huge();
+    memset(ppage_data(ppage), 0, HUGE_PAGE_SIZE);
+    *pde = (ppage << PAGE_PSIZE) | PTE_VALID | PTE_PRESENT | PTE_HUGE | (kernel ? PTE_KERNEL : 0) |
+        (write ? PTE_WRITE : 0) | (execute ? PTE_EXECUTE : 0);
+}
+
+void MMU::remove_huge_vpage(word vpage)
+{
+    if (!processor->_pagedir)
+    {
+        throw Exception("No page directory to remove huge page " + std::to_string(vpage) + " from.");
+    }
+
+    word *pde = vpage < N_VPAGES && !(vpage & (PTABLE_NENTRIES - 1)) ?
+        &phys_word(processor->_pagedir)[vpage >> PTABLE_PSIZE] : nullptr;
+    if (!pde || !(*pde & PTE_HUGE))
+    {
+        throw Exception("Virtual page " + std::to_string(vpage) + " does not start a huge page.");
+    }
 
+    return_huge(*pde >> PAGE_PSIZE);
+    *pde = 0;
+    invalidate_pwc(processor->_pagedir);
 }
 
-// todo fix for shared pages
 void MMU::remove_pagedir()
 {
-    struct PageTableEntry *pagetable = (struct PageTableEntry *) 
-                &processor->ram->data[processor->_pagedir];
+    if (!processor->_pagedir)
+    {
+        return;
+    }
 
-    word end_page = N_VPAGES;
-    for (word page = 0; page <= end_page; page++)
+    const word ram_lo = processor->ram->get_lo_page() << PAGE_PSIZE;
+    word *pagedir = phys_word(processor->_pagedir);
+    for (word dir_index = 0; dir_index < PTABLE_NENTRIES; dir_index++)
     {
-        struct PageTableEntry *entry = &pagetable[page];
-        entry->reference_count--;
-        if (!entry->valid || entry->reference_count > 0)
+        if (!(pagedir[dir_index] & PTE_VALID))
         {
             continue;
         }
-        
-        if (entry->disk)
+        else if (pagedir[dir_index] & PTE_HUGE)
         {
-            processor->disk->return_page(entry->disk);
+            return_huge(pagedir[dir_index] >> PAGE_PSIZE);
+            continue;
         }
-        else
+
+        word *table = phys_word(pagedir[dir_index] & PTE_FRAME);
+        for (word i = 0; i < PTABLE_NENTRIES; i++)
         {
-            free_user_ppages.return_block(entry->ppage);
+            if (table[i] & PTE_VALID)
+            {
+                release_entry(&table[i]);
+            }
         }
+        free_kernel_ppages.return_block((pagedir[dir_index] & PTE_FRAME) - ram_lo);
     }
 
+    free_kernel_ppages.return_block(processor->_pagedir - ram_lo);
+    invalidate_pwc(processor->_pagedir);
     processor->_pagedir = 0;
-}
\ No newline at end of file
+}
+
+word MMU::fork_pagedir()
+{
+    if (!processor->_pagedir)
+    {
+        throw Exception("No page directory to fork.");
+    }
+
+    word *pagedir = phys_word(processor->_pagedir);
+    int ntables = 1;
+    for (word dir_index = 0; dir_index < PTABLE_NENTRIES; dir_index++)
+    {
+        ntables += (pagedir[dir_index] & (PTE_VALID | PTE_HUGE)) == PTE_VALID ? 1 : 0;
+    }
+
+    if (free_kernel_ppages.nfree() < ntables)
+    {
+        throw Exception("Not enough free kernel pages to fork the page directory.");
+    }
+
+    /*
+        Swapped out pages are brought back in to be shared before anything is
+        shared or allocated, so running out of memory here leaves nothing to
+        undo. Each page is pinned with an extra reference until the pass is
+        done so paging in the next one cannot evict it again.
+    */
+    std::vector<word*> pinned;
+    try
+    {
+        for (word dir_index = 0; dir_index < PTABLE_NENTRIES; dir_index++)
+        {
+            if ((pagedir[dir_index] & (PTE_VALID | PTE_HUGE)) != PTE_VALID)
+            {
+                continue;
+            }
+
+            word *table = phys_word(pagedir[dir_index] & PTE_FRAME);
+            for (word i = 0; i < PTABLE_NENTRIES; i++)
+            {
+                if ((table[i] & (PTE_VALID | PTE_PRESENT | PTE_DISK)) == (PTE_VALID | PTE_DISK))
+                {
+                    page_in(&table[i]);
+                    ppage_refcount[(table[i] >> PAGE_PSIZE) - user_low_page]++;
+                    pinned.push_back(&table[i]);
+                }
+            }
+        }
+    }
+    catch (const Emulator32bit::Exception& e)
+    {
+        for (word *entry : pinned)
+        {
+            ppage_refcount[(*entry >> PAGE_PSIZE) - user_low_page]--;
+        }
+        throw Exception("Not enough memory to page in the page directory for fork: " +
+                        std::string(e.what()));
+    }
+
+    for (word *entry : pinned)
+    {
+        ppage_refcount[(*entry >> PAGE_PSIZE) - user_low_page]--;
+    }
+
+    /*
+        Huge pages are pinned and cannot be shared copy on write, the child
+        gets its own copy. They are taken first so running out of user pages
+        leaves nothing to undo but the copies.
+    */
+    std::vector<word> huge_copies(PTABLE_NENTRIES, 0);
+    for (word dir_index = 0; dir_index < PTABLE_NENTRIES; dir_index++)
+    {
+        if (!(pagedir[dir_index] & PTE_HUGE))
+        {
+            continue;
+        }
+
+        try
+        {
+            huge_copies[dir_index] = alloc_huge();
+        }
+        catch (const Exception&)
+        {
+            for (word copy : huge_copies)
+            {
+                if (copy)
+                {
+                    return_huge(copy);
+                }
+            }
+            throw;
+        }
+        memcpy(ppage_data(huge_copies[dir_index]), ppage_data(pagedir[dir_index] >> PAGE_PSIZE),
+               HUGE_PAGE_SIZE);
+    }
+
+    word child = alloc_table();
+    for (word dir_index = 0; dir_index < PTABLE_NENTRIES; dir_index++)
+    {
+        if (!(pagedir[dir_index] & PTE_VALID))
+        {
+            continue;
+        }
+        else if (pagedir[dir_index] & PTE_HUGE)
+        {
+            phys_word(child)[dir_index] = (pagedir[dir_index] & ~PTE_FRAME) |
+                (huge_copies[dir_index] << PAGE_PSIZE);
+            continue;
+        }
+
+        word child_table = alloc_table();
+        phys_word(child)[dir_index] = child_table | PTE_VALID;
+
+        word *table = phys_word(pagedir[dir_index] & PTE_FRAME);
+        word *ctable = phys_word(child_table);
+        for (word i = 0; i < PTABLE_NENTRIES; i++)
+        {
+            word *entry = &table[i];
+            if (!(*entry & PTE_VALID))
+            {
+                continue;
+            }
+
+            if (*entry & PTE_PRESENT)
+            {
+                word index = (*entry >> PAGE_PSIZE) - user_low_page;
+                std::vector<word>& mappers = ppage_mappers[index];
+                if (mappers.empty())
+                {
+                    mappers.push_back(phys_address(entry));
+                }
+                mappers.push_back(phys_address(&ctable[i]));
+                ppage_refcount[index]++;
+                if (*entry & PTE_WRITE)
+                {
+                    *entry |= PTE_COPY_ON_WRITE;
+                }
+            }
+
+            /* Untouched pages zero fill separately in each process. */
+            ctable[i] = *entry;
+        }
+    }
+
+    return child;
+}
+
+word MMU::alloc_huge()
+{
+    word block;
+    try
+    {
+        block = free_user_ppages.get_free_blocks(PTABLE_NENTRIES);
+    }
+    catch (const FBL_InMemory::Exception&)
+    {
+        throw Exception("No run of " + std::to_string(PTABLE_NENTRIES) +
+                        " free user pages for a huge page.");
+    }
+
+    return (block >> PAGE_PSIZE) + processor->ram->get_lo_page();
+}
+
+word MMU::alloc_table()
+{
+    if (free_kernel_ppages.empty())
+    {
+        throw Exception("No free kernel pages for a page table.");
+    }
+
+    word block = free_kernel_ppages.get_free_block();
+    memset(&processor->ram->data[block], 0, PAGE_SIZE);
+    return block + (processor->ram->get_lo_page() << PAGE_PSIZE);
+}
+
+void MMU::invalidate_pwc(word pagedir)
+{
+    for (PageWalkCacheEntry& cached : pwc)
+    {
+        if (cached.pagedir == pagedir)
+        {
+            cached.pagedir = 0;
+        }
+    }
+}
+
+void MMU::release_entry(word *entry)
+{
+    if (*entry & PTE_PRESENT)
+    {
+        word ppage = *entry >> PAGE_PSIZE;
+        word index = ppage - user_low_page;
+
+        /* The disk copy belongs to the physical page, it goes with the last mapping. */
+        if (--ppage_refcount[index] == 0)
+        {
+            if (*entry & PTE_DISK)
+            {
+                processor->disk->return_page(ppage_diskpage[index]);
+            }
+            return_ppage(ppage);
+        }
+        else
+        {
+            unshare(index, phys_address(entry));
+        }
+    }
+    else if (*entry & PTE_DISK)
+    {
+        processor->disk->return_page(*entry >> PAGE_PSIZE);
+    }
+
+    *entry &= ~(PTE_FRAME | PTE_PRESENT | PTE_DISK);
+}
+
+void MMU::unshare(word index, word entry_address)
+{
+    std::vector<word>& mappers = ppage_mappers[index];
+    mappers.erase(std::find(mappers.begin(), mappers.end(), entry_address));
+
+    /* The page stays resident while shared, once one mapping is left it can be evicted again. */
+    ppage_owner[index] = mappers.front();
+    if (mappers.size() == 1)
+    {
+        ppage_mappers.erase(index);
+    }
+}
+
+void MMU::page_in(word *entry)
+{
+    word ppage = get_free_ppage();
+    byte *data = ppage_data(ppage);
+
+    if (*entry & PTE_DISK)
+    {
+        /* The disk copy is kept, so the page can be dropped again if it stays clean. */
+        word diskpage = *entry >> PAGE_PSIZE;
+        std::vector<byte> page = processor->disk->read_page(diskpage);
+        memcpy(data, page.data(), PAGE_SIZE);
+        ppage_diskpage[ppage - user_low_page] = diskpage;
+        stats.page_ins++;
+    }
+    else
+    {
+        memset(data, 0, PAGE_SIZE);
+        stats.zero_fills++;
+    }
+
+    *entry = (*entry & ~(PTE_FRAME | PTE_DIRTY)) | (ppage << PAGE_PSIZE) | PTE_PRESENT;
+    ppage_owner[ppage - user_low_page] = phys_address(entry);
+    ppage_refcount[ppage - user_low_page] = 1;
+}
+
+void MMU::copy_on_write(word *entry)
+{
+    word ppage = *entry >> PAGE_PSIZE;
+    word index = ppage - user_low_page;
+
+    if (ppage_refcount[index] > 1)
+    {
+        /* Still shared, so it cannot be the page evicted to make room for the copy. */
+        word copy = get_free_ppage();
+        memcpy(ppage_data(copy), ppage_data(ppage), PAGE_SIZE);
+
+        ppage_refcount[index]--;
+        unshare(index, phys_address(entry));
+
+        ppage_refcount[copy - user_low_page] = 1;
+        ppage_owner[copy - user_low_page] = phys_address(entry);
+        *entry = (*entry & ~(PTE_FRAME | PTE_DISK)) | (copy << PAGE_PSIZE);
+        stats.cow_copies++;
+    }
+
+    /* Otherwise this is the last mapping, which unshare already made the owner. */
+
+    *entry &= ~PTE_COPY_ON_WRITE;
+}
+
+word MMU::evict_ppage()
+{
+    const word nppages = user_high_page - user_low_page + 1;
+
+    /*
+        Enhanced second chance. Even passes look for a page that is neither
+        referenced nor dirty, so it can be dropped without touching disk. Odd
+        passes settle for any unreferenced page and clear the reference bit of
+        every page the hand sweeps past. Four passes guarantee a victim if
+        there is any evictable page.
+    */
+    for (int pass = 0; pass < 4; pass++)
+    {
+        for (word i = 0; i < nppages; i++)
+        {
+            word index = clock_hand;
+            clock_hand = clock_hand + 1 == nppages ? 0 : clock_hand + 1;
+
+            word owner = ppage_owner[index];
+            if (owner == NO_OWNER)
+            {
+                continue;
+            }
+
+            word *entry = phys_word(owner);
+
+            /* Shared pages are mapped by entries the hand cannot find, they stay resident. */
+            if (ppage_refcount[index] > 1)
+            {
+                continue;
+            }
+
+            if (*entry & PTE_ACCESSED)
+            {
+                if (pass & 1)
+                {
+                    *entry &= ~PTE_ACCESSED;
+                }
+                continue;
+            }
+
+            if ((*entry & PTE_DIRTY) && !(pass & 1))
+            {
+                continue;
+            }
+
+            word ppage = user_low_page + index;
+            if (!(*entry & PTE_DISK) && (*entry & PTE_DIRTY))
+            {
+                ppage_diskpage[index] = processor->disk->get_free_page();
+                *entry |= PTE_DISK;
+            }
+
+            if (*entry & PTE_DIRTY)
+            {
+                byte *data = ppage_data(ppage);
+                processor->disk->write_page(ppage_diskpage[index], std::vector<byte>(data, data + PAGE_SIZE));
+                stats.write_backs++;
+            }
+
+            /*
+                Clean pages are dropped, they are either up to date on disk or
+                were never written and zero fill again on the next access.
+            */
+            word frame = (*entry & PTE_DISK) ? ppage_diskpage[index] << PAGE_PSIZE : 0;
+            *entry = (*entry & ~(PTE_FRAME | PTE_PRESENT | PTE_DIRTY | PTE_ACCESSED)) | frame;
+            ppage_owner[index] = NO_OWNER;
+            ppage_refcount[index] = 0;
+            stats.evictions++;
+            return ppage;
+        }
+    }
+
+    throw Emulator32bit::Exception(Emulator32bit::PAGEFAULT,
+        "Out of memory, no physical page can be evicted.");
+}
@@ -61,6 +61,59 @@ void FBL_InMemory::return_block(word block)
     coalesce(ret_block->prev);
 }
 
+word FBL_InMemory::get_free_blocks(word nblocks)
+{
+    /* Returned blocks are coalesced, so each node is a maximal run of free blocks. */
+    struct FreeBlock *cur = head;
+    while (cur != nullptr && cur->len < nblocks)
+    {
+        cur = cur->next;
+    }
+
+    if (cur == nullptr)
+    {
+        throw Exception("No run of " + std::to_string(nblocks) + " free blocks.");
+    }
+
+    struct FreeBlock *rest = cur->next;
+    if (cur->len > nblocks)
+    {
+        rest = (struct FreeBlock*) ((byte *) cur + nblocks * block_size);
+        rest->len = cur->len - nblocks;
+        rest->next = cur->next;
+        rest->prev = cur->prev;
+        if (rest->next)
+        {
+            rest->next->prev = rest;
+        }
+    }
+    else if (rest)
+    {
+        rest->prev = cur->prev;
+    }
+
+    if (cur->prev)
+    {
+        cur->prev->next = rest;
+    }
+    else
+    {
+        head = rest;
+    }
+
+    return ptr_to_mem_index(cur);
+}
+
+void FBL_InMemory::return_blocks(word block, word nblocks)
+{
+    EXPECT_TRUE((block - mem_start) % block_size == 0, "Block size must divide memory space.");
+
+    struct FreeBlock *ret_block = insert(block);
+    ret_block->len = nblocks;
+    coalesce(ret_block);
+    coalesce(ret_block->prev);
+}
+
 bool FBL_InMemory::empty()
 {
     return head == nullptr;
@@ -0,0 +1,671 @@
+#include "emulator32bit/kernel/file_io.h"
+#include "emulator32bit/uart.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <climits>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#endif
+
+#define GUEST_ERROR(err) ((word) -(err))
+#define UNUSED(x) (void)(x)
+
+void FileManager::set_root(const std::string& directory)
+{
+    root = directory.empty() ? std::filesystem::path() : std::filesystem::absolute(directory);
+}
+
+int FileManager::host_fd(word fd)
+{
+    return fd < fds.size() ? fds[fd] : -1;
+}
+
+word FileManager::console_write(word fd, word buf, word count)
+{
+    if (fd == 2)
+    {
+        processor->uart->flush();
+    }
+
+    /* straight from the guest's pages, a batch at a time, like a file write */
+    word done = 0;
+    std::vector<SystemBus::HostSpan> spans;
+    while (done < count)
+    {
+        word covered = processor->system_bus.pin_host_spans(buf + done, count - done, false, spans,
+                IO_BATCH_PAGES);
+        if (covered == 0)
+        {
+            return done > 0 ? done : GUEST_ERROR(EFAULT);
+        }
+
+        for (const SystemBus::HostSpan& span : spans)
+        {
+            if (fd == 1)
+            {
+                processor->uart->print(span.data, span.length);
+            }
+            else
+            {
+                fwrite(span.data, 1, span.length, stderr);
+            }
+        }
+        processor->system_bus.unpin_host_spans(spans);
+        done += covered;
+    }
+    return done;
+}
+
+#ifdef _WIN32
+/*
+    Host files need openat, O_NOFOLLOW and preadv, so Windows builds only have the console.
+*/
+FileManager::FileManager(Emulator32bit *processor) :
+    processor(processor),
+    fds(3, -1)
+{
+
+}
+
+FileManager::~FileManager()
+{
+
+}
+
+word FileManager::openat(word dirfd, word path, word flags, word mode)
+{
+    UNUSED(dirfd);
+    UNUSED(path);
+    UNUSED(flags);
+    UNUSED(mode);
+    return GUEST_ERROR(ENOSYS);
+}
+
+word FileManager::close(word fd)
+{
+    UNUSED(fd);
+    return GUEST_ERROR(ENOSYS);
+}
+
+word FileManager::read(word fd, word buf, word count)
+{
+    UNUSED(fd);
+    UNUSED(buf);
+    UNUSED(count);
+    return GUEST_ERROR(ENOSYS);
+}
+
+word FileManager::write(word fd, word buf, word count)
+{
+    if (fd == 1 || fd == 2)
+    {
+        return console_write(fd, buf, count);
+    }
+    return GUEST_ERROR(ENOSYS);
+}
+
+word FileManager::lseek(word fd, word offset, word whence)
+{
+    UNUSED(fd);
+    UNUSED(offset);
+    UNUSED(whence);
+    return GUEST_ERROR(ENOSYS);
+}
+
+word FileManager::io_setup(word nr_events, word ctxp)
+{
+    UNUSED(nr_events);
+    UNUSED(ctxp);
+    return GUEST_ERROR(ENOSYS);
+}
+
+word FileManager::io_destroy(word ctx)
+{
+    UNUSED(ctx);
+    return GUEST_ERROR(ENOSYS);
+}
+
+word FileManager::io_submit(word ctx, word nr, word iocbpp)
+{
+    UNUSED(ctx);
+    UNUSED(nr);
+    UNUSED(iocbpp);
+    return GUEST_ERROR(ENOSYS);
+}
+
+word FileManager::io_getevents(word ctx, word min_nr, word nr, word events, word timeout)
+{
+    UNUSED(ctx);
+    UNUSED(min_nr);
+    UNUSED(nr);
+    UNUSED(events);
+    UNUSED(timeout);
+    return GUEST_ERROR(ENOSYS);
+}
+
+bool FileManager::busy()
+{
+    return false;
+}
+#else
+
+/**
+ * @brief           Moves bytes between a host file and pinned guest pages with readv/writev, or
+ *                  preadv/pwritev at offset unless it is negative. Stream reads return after
+ *                  the first read that gets anything, everything else runs to completion.
+ *
+ * @return          Bytes transferred, or a negative errno if nothing was.
+ */
+static ssize_t transfer_spans(int fd, const std::vector<SystemBus::HostSpan>& spans, bool to_guest,
+        off_t offset)
+{
+    std::vector<iovec> iov;
+    iov.reserve(spans.size());
+    for (const SystemBus::HostSpan& span : spans)
+    {
+        iov.push_back(iovec{span.data, span.length});
+    }
+
+    ssize_t total = 0;
+    size_t i = 0;
+    while (i < iov.size())
+    {
+        int count = std::min(iov.size() - i, (size_t) IOV_MAX);
+        ssize_t n;
+        if (offset < 0)
+        {
+            n = to_guest ? readv(fd, &iov[i], count) : writev(fd, &iov[i], count);
+        }
+        else
+        {
+            n = to_guest ? preadv(fd, &iov[i], count, offset + total) :
+                    pwritev(fd, &iov[i], count, offset + total);
+        }
+
+        if (n < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            return total > 0 ? total : -errno;
+        }
+        else if (n == 0)
+        {
+            break;
+        }
+
+        total += n;
+        while (n > 0)
+        {
+            if ((size_t) n >= iov[i].iov_len)
+            {
+                n -= iov[i].iov_len;
+                i++;
+            }
+            else
+            {
+                iov[i].iov_base = (byte*) iov[i].iov_base + n;
+                iov[i].iov_len -= n;
+                n = 0;
+            }
+        }
+
+        if (to_guest && offset < 0)
+        {
+            break;
+        }
+    }
+    return total;
+}
+
+FileManager::FileManager(Emulator32bit *processor) :
+    processor(processor),
+    fds(3, -1)
+{
+
+}
+
+FileManager::~FileManager()
+{
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        completed.wait(lock, [this]()
+        {
+            for (const std::pair<const word, IOContext>& context : contexts)
+            {
+                if (context.second.in_flight > 0)
+                {
+                    return false;
+                }
+            }
+            return true;
+        });
+        stopping = true;
+    }
+
+    job_ready.notify_all();
+    for (std::thread& worker : workers)
+    {
+        worker.join();
+    }
+    release_finished();
+
+    for (int fd : fds)
+    {
+        if (fd >= 0)
+        {
+            ::close(fd);
+        }
+    }
+}
+
+word FileManager::openat(word dirfd, word path, word flags, word mode)
+{
+    if (dirfd != GUEST_AT_FDCWD)
+    {
+        return GUEST_ERROR(EBADF);
+    }
+    else if (root.empty())
+    {
+        return GUEST_ERROR(EACCES);
+    }
+
+    /* "/" is the sandbox root, anything that climbs out of it is refused */
+    std::filesystem::path relative =
+            std::filesystem::path(processor->system_bus.read_cstring(path)).lexically_normal().relative_path();
+    if (relative.empty())
+    {
+        return GUEST_ERROR(ENOENT);
+    }
+    else if (*relative.begin() == "..")
+    {
+        return GUEST_ERROR(EACCES);
+    }
+
+    /*
+        Walked a component at a time from the root without following symlinks, so a link
+        inside the sandbox cannot point the open outside of it. A symlink fails with ELOOP,
+        or ENOTDIR part way along the path.
+    */
+    std::vector<std::string> components;
+    for (const std::filesystem::path& component : relative)
+    {
+        if (!component.empty())
+        {
+            components.push_back(component.string());
+        }
+    }
+
+    int dir = ::open(root.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    for (size_t i = 0; dir >= 0 && i + 1 < components.size(); i++)
+    {
+        int next = ::openat(dir, components[i].c_str(), O_RDONLY | O_DIRECTORY | O_NOFOLLOW | O_CLOEXEC);
+        ::close(dir);
+        dir = next;
+    }
+    if (dir < 0)
+    {
+        return GUEST_ERROR(errno);
+    }
+
+    const int honored = O_ACCMODE | O_CREAT | O_EXCL | O_TRUNC | O_APPEND;
+    int host = ::openat(dir, components.back().c_str(), (flags & honored) | O_NOFOLLOW | O_CLOEXEC,
+            mode & 0777);
+    int error = errno;
+    ::close(dir);
+    if (host < 0)
+    {
+        return GUEST_ERROR(error);
+    }
+
+    for (word fd = 3; fd < fds.size(); fd++)
+    {
+        if (fds[fd] < 0)
+        {
+            fds[fd] = host;
+            return fd;
+        }
+    }
+    fds.push_back(host);
+    return fds.size() - 1;
+}
+
+word FileManager::close(word fd)
+{
+    int host = host_fd(fd);
+    if (host < 0)
+    {
+        return GUEST_ERROR(EBADF);
+    }
+
+    fds[fd] = -1;
+    return ::close(host) < 0 ? GUEST_ERROR(errno) : 0;
+}
+
+word FileManager::transfer(int host, word buf, word count, bool to_guest)
+{
+    word done = 0;
+    std::vector<SystemBus::HostSpan> spans;
+    while (done < count)
+    {
+        word covered = processor->system_bus.pin_host_spans(buf + done, count - done, to_guest, spans,
+                IO_BATCH_PAGES);
+        if (covered == 0)
+        {
+            return done > 0 ? done : GUEST_ERROR(EFAULT);
+        }
+
+        ssize_t n = transfer_spans(host, spans, to_guest, -1);
+        processor->system_bus.unpin_host_spans(spans);
+        if (n < 0)
+        {
+            return done > 0 ? done : (word) n;
+        }
+
+        done += n;
+        if ((word) n < covered)
+        {
+            break;
+        }
+    }
+    return done;
+}
+
+word FileManager::read(word fd, word buf, word count)
+{
+    int host = host_fd(fd);
+    if (host < 0)
+    {
+        return GUEST_ERROR(EBADF);
+    }
+
+    return transfer(host, buf, count, true);
+}
+
+word FileManager::write(word fd, word buf, word count)
+{
+    if (fd == 1 || fd == 2)
+    {
+        return console_write(fd, buf, count);
+    }
+
+    int host = host_fd(fd);
+    if (host < 0)
+    {
+        return GUEST_ERROR(EBADF);
+    }
+
+    return transfer(host, buf, count, false);
+}
+
+word FileManager::lseek(word fd, word offset, word whence)
+{
+    int host = host_fd(fd);
+    if (host < 0)
+    {
+        return GUEST_ERROR(EBADF);
+    }
+
+    off_t position = ::lseek(host, (sword) offset, whence);
+    if (position < 0)
+    {
+        return GUEST_ERROR(errno);
+    }
+    else if (position > INT_MAX)
+    {
+        return GUEST_ERROR(EOVERFLOW);
+    }
+    return position;
+}
+
+word FileManager::io_setup(word nr_events, word ctxp)
+{
+    if (nr_events == 0)
+    {
+        return GUEST_ERROR(EINVAL);
+    }
+
+    if (workers.empty())
+    {
+        for (int i = 0; i < IO_THREADS; i++)
+        {
+            workers.emplace_back([this]() { work(); });
+        }
+    }
+
+    word ctx;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        ctx = next_context++;
+        contexts[ctx].max_events = nr_events;
+    }
+
+    processor->system_bus.write_word(ctxp, ctx);
+    return 0;
+}
+
+word FileManager::io_destroy(word ctx)
+{
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        auto it = contexts.find(ctx);
+        if (it == contexts.end())
+        {
+            return GUEST_ERROR(EINVAL);
+        }
+
+        completed.wait(lock, [&it]() { return it->second.in_flight == 0; });
+        contexts.erase(it);
+    }
+
+    release_finished();
+    return 0;
+}
+
+word FileManager::io_submit(word ctx, word nr, word iocbpp)
+{
+    release_finished();
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (contexts.find(ctx) == contexts.end())
+        {
+            return GUEST_ERROR(EINVAL);
+        }
+    }
+
+    word i = 0;
+    for (; i < nr; i++)
+    {
+        word iocb = processor->system_bus.read_word(iocbpp + 4 * i);
+        word data = processor->system_bus.read_word(iocb);
+        word opcode = processor->system_bus.read_word(iocb + 4);
+        word fd = processor->system_bus.read_word(iocb + 8);
+        word buf = processor->system_bus.read_word(iocb + 12);
+        word nbytes = processor->system_bus.read_word(iocb + 16);
+        word offset = processor->system_bus.read_word(iocb + 20);
+
+        int host = host_fd(fd);
+        word error = 0;
+        if (opcode != IOCB_CMD_PREAD && opcode != IOCB_CMD_PWRITE)
+        {
+            error = GUEST_ERROR(EINVAL);
+        }
+        else if (host < 0)
+        {
+            error = GUEST_ERROR(EBADF);
+        }
+        else
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            IOContext& context = contexts.at(ctx);
+            if (context.in_flight + context.done.size() >= context.max_events)
+            {
+                error = GUEST_ERROR(EAGAIN);
+            }
+            else
+            {
+                context.in_flight++;
+            }
+        }
+
+        if (error != 0)
+        {
+            return i > 0 ? i : error;
+        }
+
+        submit(ctx, iocb, data, opcode, host, buf, nbytes, offset);
+    }
+    return i;
+}
+
+void FileManager::submit(word ctx, word iocb, word data, word opcode, int fd, word buf, word nbytes,
+        word offset)
+{
+    bool to_guest = opcode == IOCB_CMD_PREAD;
+
+    std::vector<SystemBus::HostSpan> spans;
+    word covered = processor->system_bus.pin_host_spans(buf, nbytes, to_guest, spans,
+            nbytes / PAGE_SIZE + 2);
+    if (covered == 0 && nbytes > 0)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        IOContext& context = contexts.at(ctx);
+        context.in_flight--;
+        context.done.push_back(Completion{data, iocb, -EFAULT});
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        jobs.push_back([this, ctx, data, iocb, fd, spans, to_guest, offset]()
+        {
+            ssize_t res = transfer_spans(fd, spans, to_guest, offset);
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                IOContext& context = contexts.at(ctx);
+                context.in_flight--;
+                context.done.push_back(Completion{data, iocb, (sword) res});
+                finished_spans.push_back(spans);
+            }
+            completed.notify_all();
+
+            /* wakes a processor waiting in WFI for the completion */
+            processor->post_event([this]() { release_finished(); });
+        });
+    }
+    job_ready.notify_one();
+}
+
+word FileManager::io_getevents(word ctx, word min_nr, word nr, word events, word timeout)
+{
+    release_finished();
+
+    word seconds = 0;
+    word nanoseconds = 0;
+    if (timeout != 0)
+    {
+        seconds = processor->system_bus.read_word(timeout);
+        nanoseconds = processor->system_bus.read_word(timeout + 4);
+    }
+
+    std::vector<Completion> harvested;
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        auto it = contexts.find(ctx);
+        if (it == contexts.end())
+        {
+            return GUEST_ERROR(EINVAL);
+        }
+
+        /* never wait for more requests than there are */
+        IOContext& context = it->second;
+        auto ready = [&context, min_nr, nr]()
+        {
+            word wanted = std::min(std::min(min_nr, nr), (word) context.done.size() + context.in_flight);
+            return context.done.size() >= wanted;
+        };
+        if (timeout != 0)
+        {
+            completed.wait_for(lock, std::chrono::seconds(seconds) + std::chrono::nanoseconds(nanoseconds), ready);
+        }
+        else
+        {
+            completed.wait(lock, ready);
+        }
+
+        while (harvested.size() < nr && !context.done.empty())
+        {
+            harvested.push_back(context.done.front());
+            context.done.pop_front();
+        }
+    }
+    release_finished();
+
+    for (word i = 0; i < harvested.size(); i++)
+    {
+        word event = events + i * IO_EVENT_SIZE;
+        processor->system_bus.write_word(event, harvested[i].data);
+        processor->system_bus.write_word(event + 4, harvested[i].obj);
+        processor->system_bus.write_word(event + 8, harvested[i].res);
+        processor->system_bus.write_word(event + 12, 0);
+    }
+    return harvested.size();
+}
+
+bool FileManager::busy()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!finished_spans.empty())
+    {
+        return true;
+    }
+
+    for (const std::pair<const word, IOContext>& context : contexts)
+    {
+        if (context.second.in_flight > 0)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+void FileManager::release_finished()
+{
+    std::vector<std::vector<SystemBus::HostSpan>> spans;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        spans.swap(finished_spans);
+    }
+
+    for (const std::vector<SystemBus::HostSpan>& finished : spans)
+    {
+        processor->system_bus.unpin_host_spans(finished);
+    }
+}
+
+void FileManager::work()
+{
+    while (true)
+    {
+        std::function<void()> job;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            job_ready.wait(lock, [this]() { return stopping || !jobs.empty(); });
+            if (jobs.empty())
+            {
+                return;
+            }
+            job = std::move(jobs.front());
+            jobs.pop_front();
+        }
+        job();
+    }
+}
+#endif
@@ -1 +1,124 @@
-#include "emulator32bit/kernel/malloc.h"
\ No newline at end of file
+#include "emulator32bit/kernel/malloc.h"
+
+#include <algorithm>
+#include <cerrno>
+
+/**
+ * @brief           Rounds an address up to the next page boundary.
+ */
+static inline dword page_align(word address)
+{
+    return ((dword) address + PAGE_SIZE - 1) & ~((dword) PAGE_SIZE - 1);
+}
+
+MemoryManager::MemoryManager(VirtualMemory *mmu) :
+    mmu(mmu)
+{
+
+}
+
+void MemoryManager::set_break(long long pid, word address)
+{
+    Heap& heap = get_heap(pid);
+    heap.start = std::min(page_align(address), (dword) MMAP_START);
+    heap.brk = heap.start;
+}
+
+word MemoryManager::brk(long long pid, word address)
+{
+    Heap& heap = get_heap(pid);
+    if (address < heap.start || address > MMAP_START)
+    {
+        return heap.brk;
+    }
+
+    word old_end = page_align(heap.brk);
+    word new_end = page_align(address);
+    if (new_end > old_end)
+    {
+        for (word vpage = old_end >> PAGE_PSIZE; vpage < new_end >> PAGE_PSIZE; vpage++)
+        {
+            if (mmu->has_vpage(pid, vpage))
+            {
+                return heap.brk;
+            }
+        }
+
+        mmu->add_segment(pid, old_end, new_end - old_end, {}, true, false);
+    }
+
+    for (word vpage = new_end >> PAGE_PSIZE; vpage < old_end >> PAGE_PSIZE; vpage++)
+    {
+        mmu->remove_vpage(pid, vpage);
+    }
+
+    heap.brk = address;
+    return heap.brk;
+}
+
+word MemoryManager::mmap(long long pid, word length, word prot, word flags)
+{
+    if (length == 0 || length > MMAP_END - MMAP_START || !(flags & MMAP_ANONYMOUS))
+    {
+        return -EINVAL;
+    }
+
+    Heap& heap = get_heap(pid);
+    word npages = page_align(length) >> PAGE_PSIZE;
+    if (!heap.free_vpages.can_fit(npages))
+    {
+        return -ENOMEM;
+    }
+
+    word address = heap.free_vpages.get_free_block(npages) << PAGE_PSIZE;
+    mmu->add_segment(pid, address, npages << PAGE_PSIZE, {}, prot & MMAP_PROT_WRITE,
+                     prot & MMAP_PROT_EXEC);
+    return address;
+}
+
+word MemoryManager::munmap(long long pid, word address, word length)
+{
+    if ((address & (PAGE_SIZE - 1)) != 0 || length == 0 || address < MMAP_START ||
+        page_align(address + (dword) length) > MMAP_END)
+    {
+        return -EINVAL;
+    }
+
+    Heap& heap = get_heap(pid);
+    word first_vpage = address >> PAGE_PSIZE;
+    word npages = page_align(length) >> PAGE_PSIZE;
+    for (word vpage = first_vpage; vpage < first_vpage + npages; vpage++)
+    {
+        if (!mmu->has_vpage(pid, vpage))
+        {
+            return -EINVAL;
+        }
+    }
+
+    for (word vpage = first_vpage; vpage < first_vpage + npages; vpage++)
+    {
+        mmu->remove_vpage(pid, vpage);
+    }
+    heap.free_vpages.return_block(first_vpage, npages);
+    return 0;
+}
+
+void MemoryManager::release(long long pid)
+{
+    heaps.erase(pid);
+}
+
+MemoryManager::Heap& MemoryManager::get_heap(long long pid)
+{
+    std::unique_ptr<Heap>& heap = heaps[pid];
+    if (!heap)
+    {
+        heap.reset(new Heap
+        {
+            .start = HEAP_START,
+            .brk = HEAP_START,
+            .free_vpages = FreeBlockList(MMAP_START >> PAGE_PSIZE, (MMAP_END - MMAP_START) >> PAGE_PSIZE),
+        });
+    }
+    return *heap;
+}
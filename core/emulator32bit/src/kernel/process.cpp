@@ -1 +1,146 @@
-#include "emulator32bit/kernel/process.h"
\ No newline at end of file
+#include "emulator32bit/kernel/process.h"
+#include "emulator32bit/kernel/malloc.h"
+#include "emulator32bit/virtual_memory.h"
+
+#include <algorithm>
+
+ProcessScheduler::ProcessScheduler(Emulator32bit *processor, unsigned long long quantum)
+    : processor(processor), quantum(quantum > 0 ? quantum : 1)
+{
+
+}
+
+ProcessScheduler::~ProcessScheduler()
+{
+    stop();
+    if (running)
+    {
+        run_queue.push_back(running);
+        running = nullptr;
+    }
+
+    for (Process *process : run_queue)
+    {
+        processor->memory_manager->release(process->pid);
+        processor->mmu->end_process(process->pid);
+        delete process;
+    }
+}
+
+Process* ProcessScheduler::spawn(word entry, word stack, bool kernel_privilege)
+{
+    long long cur_pid = processor->mmu->current_process();
+    Process *process = new Process
+    {
+        .pid = processor->mmu->begin_process(kernel_privilege),
+        .context = {},
+    };
+
+    /* begin_process switches to the new address space */
+    if (cur_pid >= 0)
+    {
+        processor->mmu->set_process(cur_pid);
+    }
+
+    for (int reg = 0; reg < NUM_REG; reg++)
+    {
+        process->context.x[reg] = (1ULL << (8 * sizeof(word))) - 1;
+    }
+    process->context.x[XZR] = 0;
+    process->context.write_reg(SP, stack);
+    process->context.pc = entry;
+
+    run_queue.push_back(process);
+    return process;
+}
+
+void ProcessScheduler::exit(Process *process)
+{
+    if (process == running)
+    {
+        running = nullptr;
+        if (!run_queue.empty())
+        {
+            Process *next = run_queue.front();
+            run_queue.pop_front();
+            switch_to(next);
+        }
+    }
+    else
+    {
+        run_queue.erase(std::find(run_queue.begin(), run_queue.end(), process));
+    }
+
+    processor->memory_manager->release(process->pid);
+    processor->mmu->end_process(process->pid);
+    delete process;
+}
+
+void ProcessScheduler::start()
+{
+    if (!running && !run_queue.empty())
+    {
+        Process *next = run_queue.front();
+        run_queue.pop_front();
+        switch_to(next);
+    }
+
+    if (!preempting)
+    {
+        preempting = true;
+        schedule_preempt();
+    }
+}
+
+void ProcessScheduler::stop()
+{
+    if (preempting)
+    {
+        processor->cancel_event(next_preempt);
+        preempting = false;
+    }
+}
+
+void ProcessScheduler::yield()
+{
+    if (run_queue.empty())
+    {
+        return;
+    }
+
+    Process *next = run_queue.front();
+    run_queue.pop_front();
+    if (running)
+    {
+        run_queue.push_back(running);
+    }
+    switch_to(next);
+}
+
+void ProcessScheduler::switch_to(Process *next)
+{
+    if (running)
+    {
+        processor->save_context(running->context);
+    }
+
+    /* no TLB flush, entries of the other processes are tagged with their ASID */
+    processor->mmu->set_process(next->pid);
+    processor->restore_context(next->context);
+    running = next;
+    nswitches++;
+}
+
+void ProcessScheduler::schedule_preempt()
+{
+    next_preempt = processor->schedule_event(quantum, [this]()
+    {
+        schedule_preempt();
+
+        /* the interrupt frames belong to the running process, switch once its handler returns */
+        if (running && !processor->get_flag(IRQ_MASK_FLAG))
+        {
+            yield();
+        }
+    });
+}
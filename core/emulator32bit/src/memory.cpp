@@ -24,6 +24,13 @@ Memory::Memory(word npages, word start_page) :
 
 }
 
+Memory::Memory(word npages, word start_page, byte* data) :
+    BaseMemory(npages, start_page),
+    data(data)
+{
+
+}
+
 Memory::Memory(Memory& other) :
     BaseMemory(other.npages, other.start_page),
     data(new byte[(other.npages << PAGE_PSIZE)])
@@ -44,7 +51,7 @@ Memory::~Memory()
 
 void Memory::reset()
 {
-    for (word addr = start_page << PAGE_PSIZE; addr < get_hi_page() << PAGE_PSIZE; addr++) {
+    for (word addr = start_page << PAGE_PSIZE; addr < (get_hi_page() + 1) << PAGE_PSIZE; addr++) {
         Memory::write_byte(addr, 0);
     }
 }
@@ -65,47 +72,56 @@ RAM::RAM(word npages, word start_page) :
 */
 
 ROM::ROM(const byte* rom_data, word npages, word start_page) :
-    Memory(npages, start_page)
+    Memory(npages, start_page),
+    dirty_pages(npages)
 {
     for (word i = 0; i < npages << PAGE_PSIZE; i++) {
         data[i] = rom_data[i];
     }
 }
 
-ROM::ROM(File file, word npages, word start_page) :
-    Memory(npages, start_page),
-    save_file(true),
-    file(file)
+ROM::ROM(File file, word npages, word start_page, Mode mode) :
+    Memory(npages, start_page, nullptr),
+    mode(mode),
+    mapping(new MappedFile(file, npages << PAGE_PSIZE,
+            mode == Mode::FLASH ? MappedFile::Mode::SHARED : MappedFile::Mode::PRIVATE)),
+    dirty_pages(npages)
 {
-    FileReader fr(file, std::ios::binary | std::ios::in);
-    std::vector<byte> bytes;
-    while (fr.has_next_byte())
-    {
-        bytes.push_back(fr.read_byte());
-    }
-
-    if (bytes.size() > npages << PAGE_PSIZE) {
+    if (mapping->file_size() > npages << PAGE_PSIZE) {
         throw ROM_Exception("ROM File is larger than the specified ROM size " +
                 std::to_string(npages << PAGE_PSIZE) + " bytes. Got " +
-                std::to_string(bytes.size()) + " bytes.");
+                std::to_string(mapping->file_size()) + " bytes.");
     }
 
-    for (size_t i = 0; i < bytes.size(); i++) {
-        data[i] = bytes[i];
-    }
+    data = mapping->data();
 }
 
 ROM::~ROM()
 {
-    if (save_file)
+    if (!mapping)
+    {
+        return;
+    }
+
+    /* Writes already went through to the file, only pages written to need flushing */
+    if (mode == Mode::FLASH && is_dirty())
     {
-        // save data to file
-        FileWriter fw(file, std::ios::out | std::ios::binary);
-        for (word i = 0; i < npages << PAGE_PSIZE; i++)
+        for (word page = 0; page < npages; page++)
         {
-            fw.write(data[i]);
+            if (dirty_pages[page])
+            {
+                mapping->sync(page << PAGE_PSIZE, PAGE_SIZE);
+            }
         }
     }
+
+    /* The mapping owns data */
+    data = nullptr;
+}
+
+void ROM::reset()
+{
+
 }
 
 ROM::ROM_Exception::ROM_Exception(std::string msg) :
@@ -0,0 +1,178 @@
+#include "emulator32bit/emulator32bit.h"
+
+#include <type_traits>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+#if defined(__SSSE3__)
+#include <tmmintrin.h>
+#endif
+
+static const char* const PACKED_OP_NAMES[Emulator32bit::PACKED_NUM_OPS] =
+{
+    "add8", "sub8", "umin8", "umax8", "smin8", "smax8", "cmeq8", "cmgt8",
+    "add16", "sub16", "umin16", "umax16", "smin16", "smax16", "cmeq16", "cmgt16",
+    "tbl",
+};
+
+const char* Emulator32bit::packed_op_name(PackedOp op)
+{
+    return op < PACKED_NUM_OPS ? PACKED_OP_NAMES[op] : nullptr;
+}
+
+/* Applies f to each pair of Lane sized lanes of a and b */
+template <typename Lane, typename F>
+static inline word lanes(word a, word b, F f)
+{
+    typedef typename std::make_unsigned<Lane>::type ULane;
+    const int bits = sizeof(Lane) * 8;
+
+    word result = 0;
+    for (int shift = 0; shift < WORD_BITS; shift += bits)
+    {
+        Lane x = (Lane) (ULane) (a >> shift);
+        Lane y = (Lane) (ULane) (b >> shift);
+        result |= (word) (ULane) f(x, y) << shift;
+    }
+    return result;
+}
+
+template <typename Lane>
+static inline Lane lane_min(Lane x, Lane y)
+{
+    return x < y ? x : y;
+}
+
+template <typename Lane>
+static inline Lane lane_max(Lane x, Lane y)
+{
+    return x > y ? x : y;
+}
+
+word Emulator32bit::packed_op_scalar(PackedOp op, word a, word b)
+{
+    switch (op)
+    {
+        /* adds and subtracts keep carries out of the next lane by working on the low bits */
+        case PACKED_ADD8:
+            return ((a & 0x7F7F7F7F) + (b & 0x7F7F7F7F)) ^ ((a ^ b) & 0x80808080);
+        case PACKED_SUB8:
+            return ((a | 0x80808080) - (b & 0x7F7F7F7F)) ^ ((a ^ ~b) & 0x80808080);
+        case PACKED_UMIN8:
+            return lanes<byte>(a, b, lane_min<byte>);
+        case PACKED_UMAX8:
+            return lanes<byte>(a, b, lane_max<byte>);
+        case PACKED_SMIN8:
+            return lanes<signed char>(a, b, lane_min<signed char>);
+        case PACKED_SMAX8:
+            return lanes<signed char>(a, b, lane_max<signed char>);
+        case PACKED_CMEQ8:
+            return lanes<byte>(a, b, [](byte x, byte y) { return (byte) (x == y ? 0xFF : 0); });
+        case PACKED_CMGT8:
+            return lanes<signed char>(a, b, [](signed char x, signed char y)
+                    { return (signed char) (x > y ? -1 : 0); });
+        case PACKED_ADD16:
+            return ((a & 0x7FFF7FFF) + (b & 0x7FFF7FFF)) ^ ((a ^ b) & 0x80008000);
+        case PACKED_SUB16:
+            return ((a | 0x80008000) - (b & 0x7FFF7FFF)) ^ ((a ^ ~b) & 0x80008000);
+        case PACKED_UMIN16:
+            return lanes<hword>(a, b, lane_min<hword>);
+        case PACKED_UMAX16:
+            return lanes<hword>(a, b, lane_max<hword>);
+        case PACKED_SMIN16:
+            return lanes<short>(a, b, lane_min<short>);
+        case PACKED_SMAX16:
+            return lanes<short>(a, b, lane_max<short>);
+        case PACKED_CMEQ16:
+            return lanes<hword>(a, b, [](hword x, hword y) { return (hword) (x == y ? 0xFFFF : 0); });
+        case PACKED_CMGT16:
+            return lanes<short>(a, b, [](short x, short y) { return (short) (x > y ? -1 : 0); });
+        case PACKED_TBL:
+            return lanes<byte>(b, 0, [a](byte index, byte) { return (byte) (index < 4 ? a >> (index * 8) : 0); });
+        default:
+            throw Exception(BAD_INSTR, "Bad packed operation " + std::to_string(op));
+    }
+}
+
+#if defined(__SSE2__)
+/*
+ * A register fills the low lanes of an SSE register. Unsigned compares and the min and max SSE2
+ * lacks are done on operands biased by the sign bit, which maps unsigned order onto signed order
+ * and back.
+ */
+word Emulator32bit::packed_op(PackedOp op, word a, word b)
+{
+    const __m128i va = _mm_cvtsi32_si128(a);
+    const __m128i vb = _mm_cvtsi32_si128(b);
+    const __m128i bias8 = _mm_set1_epi8((char) 0x80);
+    const __m128i bias16 = _mm_set1_epi16((short) 0x8000);
+
+    __m128i result;
+    switch (op)
+    {
+        case PACKED_ADD8:
+            result = _mm_add_epi8(va, vb);
+            break;
+        case PACKED_SUB8:
+            result = _mm_sub_epi8(va, vb);
+            break;
+        case PACKED_UMIN8:
+            result = _mm_min_epu8(va, vb);
+            break;
+        case PACKED_UMAX8:
+            result = _mm_max_epu8(va, vb);
+            break;
+        case PACKED_SMIN8:
+            result = _mm_xor_si128(_mm_min_epu8(_mm_xor_si128(va, bias8), _mm_xor_si128(vb, bias8)), bias8);
+            break;
+        case PACKED_SMAX8:
+            result = _mm_xor_si128(_mm_max_epu8(_mm_xor_si128(va, bias8), _mm_xor_si128(vb, bias8)), bias8);
+            break;
+        case PACKED_CMEQ8:
+            result = _mm_cmpeq_epi8(va, vb);
+            break;
+        case PACKED_CMGT8:
+            result = _mm_cmpgt_epi8(va, vb);
+            break;
+        case PACKED_ADD16:
+            result = _mm_add_epi16(va, vb);
+            break;
+        case PACKED_SUB16:
+            result = _mm_sub_epi16(va, vb);
+            break;
+        case PACKED_UMIN16:
+            result = _mm_xor_si128(_mm_min_epi16(_mm_xor_si128(va, bias16), _mm_xor_si128(vb, bias16)), bias16);
+            break;
+        case PACKED_UMAX16:
+            result = _mm_xor_si128(_mm_max_epi16(_mm_xor_si128(va, bias16), _mm_xor_si128(vb, bias16)), bias16);
+            break;
+        case PACKED_SMIN16:
+            result = _mm_min_epi16(va, vb);
+            break;
+        case PACKED_SMAX16:
+            result = _mm_max_epi16(va, vb);
+            break;
+        case PACKED_CMEQ16:
+            result = _mm_cmpeq_epi16(va, vb);
+            break;
+        case PACKED_CMGT16:
+            result = _mm_cmpgt_epi16(va, vb);
+            break;
+#if defined(__SSSE3__)
+        case PACKED_TBL:
+            /* indices past 15 saturate to 0x80 and up, which pshufb zeroes, 4 to 15 pick zeroes */
+            result = _mm_shuffle_epi8(va, _mm_adds_epu8(vb, _mm_set1_epi8(0x70)));
+            break;
+#endif
+        default:
+            return packed_op_scalar(op, a, b);
+    }
+    return _mm_cvtsi128_si32(result);
+}
+#else
+word Emulator32bit::packed_op(PackedOp op, word a, word b)
+{
+    return packed_op_scalar(op, a, b);
+}
+#endif
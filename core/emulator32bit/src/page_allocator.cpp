@@ -0,0 +1,178 @@
+#include "emulator32bit/page_allocator.h"
+
+#include <algorithm>
+
+PageAllocator::PageAllocator(word begin, word npages) :
+    m_begin(begin),
+    m_npages(npages),
+    m_nfree(npages),
+    m_free((npages + WORD_PAGES - 1) / WORD_PAGES, ~0ULL),
+    m_summary((m_free.size() + WORD_PAGES - 1) / WORD_PAGES, ~0ULL)
+{
+    /* Pages past the end of the last word are never free. */
+    if (npages % WORD_PAGES != 0)
+    {
+        m_free.back() = (1ULL << (npages % WORD_PAGES)) - 1;
+    }
+
+    if (m_free.size() % WORD_PAGES != 0)
+    {
+        m_summary.back() = (1ULL << (m_free.size() % WORD_PAGES)) - 1;
+    }
+}
+
+PageAllocator::PageAllocatorException::PageAllocatorException(const std::string& msg) :
+    message(msg)
+{
+
+}
+
+const char *PageAllocator::PageAllocatorException::what() const noexcept
+{
+    return message.c_str();
+}
+
+word PageAllocator::alloc()
+{
+    while (m_first_summary < m_summary.size() && m_summary[m_first_summary] == 0)
+    {
+        m_first_summary++;
+    }
+
+    if (m_first_summary == m_summary.size())
+    {
+        throw PageAllocatorException("No free page to allocate.");
+    }
+
+    word index = m_first_summary * WORD_PAGES + __builtin_ctzll(m_summary[m_first_summary]);
+    word offset = index * WORD_PAGES + __builtin_ctzll(m_free[index]);
+    set_free(offset, false);
+    return m_begin + offset;
+}
+
+word PageAllocator::alloc_contiguous(word npages)
+{
+    if (npages == 1)
+    {
+        return alloc();
+    }
+
+    word offset = find_run(npages);
+    if (offset == m_npages)
+    {
+        throw PageAllocatorException("No run of " + std::to_string(npages) + " free pages to allocate.");
+    }
+
+    for (word i = 0; i < npages; i++)
+    {
+        set_free(offset + i, false);
+    }
+    return m_begin + offset;
+}
+
+void PageAllocator::reserve(word page)
+{
+    if (!is_free(page))
+    {
+        throw PageAllocatorException("Cannot reserve page " + std::to_string(page) +
+                " because it is not free.");
+    }
+
+    set_free(page - m_begin, false);
+}
+
+void PageAllocator::free(word page, word npages)
+{
+    if (page < m_begin || npages > m_npages || page - m_begin > m_npages - npages)
+    {
+        throw PageAllocatorException("Cannot free pages " + std::to_string(page) + " - " +
+                std::to_string(page + npages - 1) + " because they are out of range.");
+    }
+
+    for (word i = 0; i < npages; i++)
+    {
+        if (is_free(page + i))
+        {
+            throw PageAllocatorException("Cannot free page " + std::to_string(page + i) +
+                    " because it is already free.");
+        }
+    }
+
+    for (word i = 0; i < npages; i++)
+    {
+        set_free(page - m_begin + i, true);
+    }
+}
+
+bool PageAllocator::can_fit(word npages)
+{
+    if (npages <= 1)
+    {
+        return m_nfree >= npages;
+    }
+
+    return find_run(npages) != m_npages;
+}
+
+bool PageAllocator::is_free(word page)
+{
+    if (page < m_begin || page - m_begin >= m_npages)
+    {
+        return false;
+    }
+
+    word offset = page - m_begin;
+    return (m_free[offset / WORD_PAGES] >> (offset % WORD_PAGES)) & 1;
+}
+
+word PageAllocator::find_run(word npages)
+{
+    if (npages > m_nfree)
+    {
+        return m_npages;
+    }
+
+    /* Rare, only huge pages want more than one page, so skipping full words is enough. */
+    word run = 0;
+    word offset = 0;
+    while (offset < m_npages)
+    {
+        if (offset % WORD_PAGES == 0 && m_free[offset / WORD_PAGES] == 0)
+        {
+            run = 0;
+            offset += WORD_PAGES;
+            continue;
+        }
+
+        run = (m_free[offset / WORD_PAGES] >> (offset % WORD_PAGES)) & 1 ? run + 1 : 0;
+        offset++;
+        if (run == npages)
+        {
+            return offset - npages;
+        }
+    }
+    return m_npages;
+}
+
+void PageAllocator::set_free(word offset, bool free)
+{
+    word index = offset / WORD_PAGES;
+    dword& bits = m_free[index];
+    dword& summary = m_summary[index / WORD_PAGES];
+    if (free)
+    {
+        bits |= 1ULL << (offset % WORD_PAGES);
+        summary |= 1ULL << (index % WORD_PAGES);
+        m_first_summary = std::min(m_first_summary, index / WORD_PAGES);
+        m_nfree++;
+    }
+    else
+    {
+        bits &= ~(1ULL << (offset % WORD_PAGES));
+        if (bits == 0)
+        {
+            summary &= ~(1ULL << (index % WORD_PAGES));
+        }
+        m_nfree--;
+    }
+}
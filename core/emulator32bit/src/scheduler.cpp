@@ -0,0 +1,42 @@
+#include "emulator32bit/scheduler.h"
+
+EventScheduler::EventID EventScheduler::schedule(unsigned long long deadline, Handler handler)
+{
+    EventID id = m_next_id++;
+    m_events.push(Event{.deadline = deadline, .id = id});
+    m_handlers[id] = std::move(handler);
+    return id;
+}
+
+bool EventScheduler::cancel(EventID id)
+{
+    return m_handlers.erase(id) > 0;
+}
+
+unsigned long long EventScheduler::next_deadline()
+{
+    /* Cancelled events are only dropped once they reach the front */
+    while (!m_events.empty() && m_handlers.find(m_events.top().id) == m_handlers.end())
+    {
+        m_events.pop();
+    }
+
+    return m_events.empty() ? NO_DEADLINE : m_events.top().deadline;
+}
+
+size_t EventScheduler::run_due(unsigned long long now)
+{
+    size_t nran = 0;
+    while (next_deadline() <= now)
+    {
+        EventID id = m_events.top().id;
+        m_events.pop();
+
+        std::unordered_map<EventID, Handler>::iterator it = m_handlers.find(id);
+        Handler handler = std::move(it->second);
+        m_handlers.erase(it);
+        handler();
+        nran++;
+    }
+    return nran;
+}
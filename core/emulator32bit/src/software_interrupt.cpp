@@ -1,44 +1,72 @@
 
 #include "emulator32bit/emulator32bit.h"
+#include "emulator32bit/kernel/better_virtual_memory.h"
+#include "emulator32bit/kernel/file_io.h"
+#include "emulator32bit/kernel/malloc.h"
+#include "emulator32bit/uart.h"
 
 #define AEMU_ONLY_CRITICAL_LOG
 #include "util/logger.h"
 
+#include <cerrno>
+#include <climits>
+#include <cstdarg>
 #include <iostream>
 
 #define UNUSED(x) (void)(x)
 
+/* Formats like printf into the console's buffer instead of writing to stdout right away. */
+static void uart_printf(UART *uart, const char *format, ...)
+{
+    char buffer[128];
+    va_list args;
+    va_start(args, format);
+    vsnprintf(buffer, sizeof(buffer), format, args);
+    va_end(args);
+    uart->print(buffer);
+}
+
 void Emulator32bit::_emu_print()
 {
+    uart->flush();
     print();
 }
 
 void Emulator32bit::_emu_printr(byte reg_id)
 {
-    printf("REG: %d = %x\n", reg_id, read_reg(reg_id));
+    uart_printf(uart, "REG: %d = %x\n", reg_id, read_reg(reg_id));
 }
 
-void Emulator32bit::_emu_printm(word mem_addr, byte size, bool little_endian)
+/* Reads size bytes at mem_addr in one bulk copy, then combines them like the syscalls always have. */
+static word read_value(SystemBus& system_bus, word mem_addr, byte size, bool little_endian)
 {
+    byte bytes[UINT8_MAX];
+    system_bus.read_buffer(mem_addr, bytes, size);
+
     word val = 0;
     if (little_endian) {
         for (byte i = 0; i < size; i++) {
             val <<= 8;
-            val += system_bus.read_byte(mem_addr + i);
+            val += bytes[i];
         }
     } else {
         for (int i = size - 1; i >= 0; i--) {
             val <<= 8;
-            val += system_bus.read_byte(mem_addr + i);
+            val += bytes[i];
         }
     }
+    return val;
+}
 
-    printf("MEM: %x = %.2x", mem_addr, val);
+void Emulator32bit::_emu_printm(word mem_addr, byte size, bool little_endian)
+{
+    word val = read_value(system_bus, mem_addr, size, little_endian);
+    uart_printf(uart, "MEM: %x = %.2x", mem_addr, val);
 }
 
 void Emulator32bit::_emu_printp()
 {
-    printf("PSTATE: N=%lli,Z=%lli,C=%lli,V=%lli", test_bit(_pstate, N_FLAG), test_bit(_pstate, Z_FLAG),
+    uart_printf(uart, "PSTATE: N=%lli,Z=%lli,C=%lli,V=%lli", test_bit(_pstate, N_FLAG), test_bit(_pstate, Z_FLAG),
            test_bit(_pstate, C_FLAG), test_bit(_pstate, V_FLAG));
 }
 
@@ -58,19 +86,7 @@ void Emulator32bit::_emu_assertr(byte reg_id, word min_value, word max_value) {
 void Emulator32bit::_emu_assertm(word mem_addr, byte size, bool little_endian, word min_value,
                                  word max_value)
 {
-    word val = 0;
-    if (little_endian) {
-        for (byte i = 0; i < size; i++) {
-            val <<= 8;
-            val += system_bus.read_byte(mem_addr + i);
-        }
-    } else {
-        for (int i = size - 1; i >= 0; i--) {
-            val <<= 8;
-            val += system_bus.read_byte(mem_addr + i);
-        }
-    }
-
+    word val = read_value(system_bus, mem_addr, size, little_endian);
     if (val < min_value || val > max_value) {
         throw Exception(FAILED_ASSERT, "Expected value at memory address " + std::to_string(mem_addr) +
                 " to be between " + std::to_string(min_value) + " and " +
@@ -91,25 +107,101 @@ void Emulator32bit::_emu_assertp(byte p_state_id, bool expected_value)
 
 void Emulator32bit::_emu_log(word str)
 {
-    std::string msg;
-    while (system_bus.read_byte(str) != '\0') {
-        msg += (char) system_bus.read_byte(str);
-        str++;
-    }
-
-    std::cout << msg << "\n";
+    uart->print(system_bus.read_cstring(str) + "\n");
 }
 
 // todo, raise interrupt so kernel can handle
 void Emulator32bit::_emu_err(word err)
 {
-    std::string msg;
-    while (system_bus.read_byte(err) != '\0') {
-        msg += (char) system_bus.read_byte(err);
-        err++;
+    uart->flush();
+    std::cerr << system_bus.read_cstring(err) << "\n";
+}
+
+word Emulator32bit::_sys_fork()
+{
+    if (!kernel_mmu) {
+        throw Exception(BAD_INSTR, "fork requires an in guest MMU to be attached.");
+    }
+
+    /* out of kernel pages for the child's tables, or user pages for its huge page copies */
+    try {
+        return kernel_mmu->fork_pagedir();
+    } catch (const MMU::Exception& e) {
+        DEBUG("Emulator32bit::_sys_fork() - %s", e.what());
+        return -ENOMEM;
+    }
+}
+
+void Emulator32bit::_sys_rt_sigreturn()
+{
+    if (_interrupt_frames.empty()) {
+        throw Exception(BAD_INSTR, "rt_sigreturn outside of an interrupt handler.");
+    }
+
+    InterruptFrame frame = _interrupt_frames.back();
+    _interrupt_frames.pop_back();
+    for (int reg = 0; reg < XZR; reg++) {
+        write_reg(reg, frame.saved_reg[reg]);
+    }
+    _pstate = frame.saved_pstate;
+    _pagedir = frame.saved_pagedir;
+    _pc = frame.saved_px - 4;                                /* account for execution loop incrementing _pc by 4 */
+
+    /* interrupts raised while the handler ran are delivered right after this instruction */
+    if (_pending_interrupts != 0 && !test_bit(_pstate, IRQ_MASK_FLAG)) {
+        schedule_event(0, [this]() { deliver_pending_interrupts(); });
+    }
+}
+
+word Emulator32bit::_sys_brk(word address)
+{
+    long long pid = mmu->current_process();
+    if (pid < 0) {
+        return 0;
+    }
+
+    return memory_manager->brk(pid, address);
+}
+
+word Emulator32bit::_sys_mmap(word address, word length, word prot, word flags, word fd, word offset)
+{
+    /* only anonymous mappings, the kernel always picks the address */
+    UNUSED(address);
+    UNUSED(fd);
+    UNUSED(offset);
+
+    long long pid = mmu->current_process();
+    if (pid < 0) {
+        return -ENOMEM;
+    }
+
+    return memory_manager->mmap(pid, length, prot, flags);
+}
+
+word Emulator32bit::_sys_munmap(word address, word length)
+{
+    long long pid = mmu->current_process();
+    if (pid < 0) {
+        return -EINVAL;
     }
 
-    std::cerr << msg << "\n";
+    return memory_manager->munmap(pid, address, length);
+}
+
+void Emulator32bit::register_syscall(word id, SyscallHandler handler)
+{
+    _syscalls[id] = std::move(handler);
+}
+
+bool Emulator32bit::unregister_syscall(word id)
+{
+    auto it = _syscalls.find(id);
+    bool registered = it != _syscalls.end() ? (bool) it->second :
+            id <= MAX_SYSCALL && builtin_syscalls()[id];
+    if (registered) {
+        _syscalls[id] = nullptr;
+    }
+    return registered;
 }
 
 /**
@@ -176,23 +268,75 @@ void Emulator32bit::_emu_err(word err)
  * |
  **|0001: io_destroy            aio_context_t ctx
  * |
- * |     invalidates the previously created context information
+ * |     waits for the requests in flight, then invalidates the previously created context information
  * |
  **|0002: io_submit            aio_context_t            long                    struct iocb * *
  * |
- * |     with the file descriptor (some unique number that identifies a specific file), begins an operation
+ * |     queues reads (opcode 0) and writes (opcode 1) at an offset of a file on host threads.
+ * |     struct iocb is 6 words: data, opcode, fd, buf, nbytes, offset. returns the number queued
  * |
  **|0003: io_cancel            aio_context_t ctx_id    struct iocb *iocb        struct io_event *result
  * |
- * |    cancels a specific I/O operation
+ * |    cancels a specific I/O operation (not implemented)
  * |
  **|0004: io_getevents        aio_context_t ctx_id    long min_nr                long nr                    struct io_event *events        struct __kernel_timespec *timeout
  * |
- * |     waits for when a specific I/O operation finishes or timesout
+ * |     waits for when a specific I/O operation finishes or timesout. struct io_event is 4 words:
+ * |     data, obj (the iocb), res, res2. the timespec is 2 words, seconds and nanoseconds
+ * |
+ * |
+ * |
+ * |======================= Process Operations ======================
+ **|0220: fork                -                        -                        -                        -                            -                                        -
+ * |
+ * |     duplicates the current page directory, sharing user pages copy on write. returns the
+ * |     physical address of the child page directory in x0
+ * |
+ **|0139: rt_sigreturn        -                        -                        -                        -                            -                                        -
+ * |
+ * |     returns from an interrupt handler, restoring the registers, pstate and page directory
+ * |     saved when the interrupt was delivered
+ * |
+ * |
+ * |
+ * |======================= Memory Operations =======================
+ **|0214: brk                void *addr                -                        -                        -                            -                                        -
+ * |
+ * |     moves the program break to addr, or queries it when addr is 0. returns the new break,
+ * |     the old one if it could not be moved
+ * |
+ **|0215: munmap            void *addr                size_t length            -                        -                            -                                        -
+ * |
+ * |     unmaps pages mapped by mmap. returns 0 or -EINVAL
+ * |
+ **|0222: mmap                void *addr                size_t length            int prot                int flags                    int fd                                    off_t offset
+ * |
+ * |     maps zeroed anonymous pages (MAP_ANONYMOUS only, addr is a hint that is ignored).
+ * |     returns the address or -EINVAL/-ENOMEM
  * |
  * |
  * |
  * |======================= File Operations =========================
+ **|0056: openat            int dirfd                const char *path        int flags                mode_t mode                    -                                        -
+ * |
+ * |     opens a file in the host sandbox directory, dirfd must be AT_FDCWD (-100). returns the fd
+ * |
+ **|0057: close                int fd                    -                        -                        -                            -                                        -
+ * |
+ * |
+ * |
+ **|0062: lseek                int fd                    off_t offset            int whence                -                            -                                        -
+ * |
+ * |
+ * |
+ **|0063: read                int fd                    void *buf                size_t count            -                            -                                        -
+ * |
+ * |     reads straight into the guest pages of buf
+ * |
+ **|0064: write                int fd                    const void *buf            size_t count            -                            -                                        -
+ * |
+ * |     fds 1 and 2 write to the console
+ * |
  **|0005: setxattr            const char *path        const char *name        const void *value        size_t size                    int flags                                -
  * |
  * |
@@ -253,40 +397,90 @@ void Emulator32bit::_swi(word instr)
         return;
     }
 
-    // software interrupts.. perfect to add functionality to this like console print,
-    // file operations, ports, etc
     word id = read_reg(NR);
-    word arg0 = read_reg(0);
-    word arg1 = read_reg(1);
-    word arg2 = read_reg(2);
-    word arg3 = read_reg(3);
-    word arg4 = read_reg(4);
-    word arg5 = read_reg(5);
-    UNUSED(arg5); // temporary
-    switch(id) {
-        case 1000:
-            _emu_print();
-            break;
-        case 1001:
-            _emu_printr(arg0);
-            break;
-        case 1002:
-            _emu_printm(arg0, arg1, arg2);
-            break;
-        case 1003:
-            _emu_printp();
-            break;
-
-        case 1010:
-            _emu_assertr(arg0, arg1, arg2);
-            break;
-        case 1011:
-            _emu_assertm(arg0, arg1, arg2, arg3, arg4);
-            break;
-        case 1012:
-            _emu_assertp(arg0, arg1);
-            break;
-        default:
-            throw Exception(BAD_INSTR, "Invalid syscall number " + std::to_string(id));
+    if (UNLIKELY(!_syscalls.empty())) {
+        auto it = _syscalls.find(id);
+        if (it != _syscalls.end()) {
+            if (!it->second) {
+                throw Exception(BAD_INSTR, "Invalid syscall number " + std::to_string(id));
+            }
+            it->second(*this);
+            return;
+        }
+    }
+
+    const SyscallTable& builtins = builtin_syscalls();
+    if (UNLIKELY(id > MAX_SYSCALL || !builtins[id])) {
+        throw Exception(BAD_INSTR, "Invalid syscall number " + std::to_string(id));
     }
-}
\ No newline at end of file
+    builtins[id](*this);
+}
+
+const Emulator32bit::SyscallTable& Emulator32bit::builtin_syscalls()
+{
+    static const SyscallTable table = fill_out_syscalls();
+    return table;
+}
+
+/* The syscalls documented above, host code may add more with register_syscall. */
+Emulator32bit::SyscallTable Emulator32bit::fill_out_syscalls()
+{
+    SyscallTable table = {};
+    table[1000] = [](Emulator32bit& emu) { emu._emu_print(); };
+    table[1001] = [](Emulator32bit& emu) { emu._emu_printr(emu.read_reg(0)); };
+    table[1002] = [](Emulator32bit& emu) {
+        emu._emu_printm(emu.read_reg(0), emu.read_reg(1), emu.read_reg(2));
+    };
+    table[1003] = [](Emulator32bit& emu) { emu._emu_printp(); };
+
+    table[1010] = [](Emulator32bit& emu) {
+        emu._emu_assertr(emu.read_reg(0), emu.read_reg(1), emu.read_reg(2));
+    };
+    table[1011] = [](Emulator32bit& emu) {
+        emu._emu_assertm(emu.read_reg(0), emu.read_reg(1), emu.read_reg(2), emu.read_reg(3),
+                emu.read_reg(4));
+    };
+    table[1012] = [](Emulator32bit& emu) { emu._emu_assertp(emu.read_reg(0), emu.read_reg(1)); };
+
+    table[1020] = [](Emulator32bit& emu) { emu._emu_log(emu.read_reg(0)); };
+    table[1021] = [](Emulator32bit& emu) { emu._emu_err(emu.read_reg(0)); };
+
+    table[0] = [](Emulator32bit& emu) {
+        emu.write_reg(0, emu.file_manager->io_setup(emu.read_reg(0), emu.read_reg(1)));
+    };
+    table[1] = [](Emulator32bit& emu) { emu.write_reg(0, emu.file_manager->io_destroy(emu.read_reg(0))); };
+    table[2] = [](Emulator32bit& emu) {
+        emu.write_reg(0, emu.file_manager->io_submit(emu.read_reg(0), emu.read_reg(1), emu.read_reg(2)));
+    };
+    table[4] = [](Emulator32bit& emu) {
+        emu.write_reg(0, emu.file_manager->io_getevents(emu.read_reg(0), emu.read_reg(1), emu.read_reg(2),
+                emu.read_reg(3), emu.read_reg(4)));
+    };
+
+    table[56] = [](Emulator32bit& emu) {
+        emu.write_reg(0, emu.file_manager->openat(emu.read_reg(0), emu.read_reg(1), emu.read_reg(2),
+                emu.read_reg(3)));
+    };
+    table[57] = [](Emulator32bit& emu) { emu.write_reg(0, emu.file_manager->close(emu.read_reg(0))); };
+    table[62] = [](Emulator32bit& emu) {
+        emu.write_reg(0, emu.file_manager->lseek(emu.read_reg(0), emu.read_reg(1), emu.read_reg(2)));
+    };
+    table[63] = [](Emulator32bit& emu) {
+        emu.write_reg(0, emu.file_manager->read(emu.read_reg(0), emu.read_reg(1), emu.read_reg(2)));
+    };
+    table[64] = [](Emulator32bit& emu) {
+        emu.write_reg(0, emu.file_manager->write(emu.read_reg(0), emu.read_reg(1), emu.read_reg(2)));
+    };
+
+    table[139] = [](Emulator32bit& emu) { emu._sys_rt_sigreturn(); };
+    table[214] = [](Emulator32bit& emu) { emu.write_reg(0, emu._sys_brk(emu.read_reg(0))); };
+    table[215] = [](Emulator32bit& emu) {
+        emu.write_reg(0, emu._sys_munmap(emu.read_reg(0), emu.read_reg(1)));
+    };
+    table[220] = [](Emulator32bit& emu) { emu.write_reg(0, emu._sys_fork()); };
+    table[222] = [](Emulator32bit& emu) {
+        emu.write_reg(0, emu._sys_mmap(emu.read_reg(0), emu.read_reg(1), emu.read_reg(2),
+                emu.read_reg(3), emu.read_reg(4), emu.read_reg(5)));
+    };
+    return table;
+}
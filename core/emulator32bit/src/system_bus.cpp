@@ -1,5 +1,8 @@
 #include "emulator32bit/system_bus.h"
 
+#include <algorithm>
+#include <cstring>
+
 SystemBus::SystemBus(RAM& ram, ROM& rom, Disk& disk, VirtualMemory& mmu) :
     ram(ram),
     rom(rom),
@@ -20,8 +23,234 @@ const char* SystemBus::Exception::what() const noexcept
     return message.c_str();
 }
 
+word SystemBus::pin_host_spans(word address, word length, bool write, std::vector<HostSpan>& spans,
+        word max_spans)
+{
+    spans.clear();
+    word covered = 0;
+    while (covered < length && spans.size() < max_spans)
+    {
+        word chunk = std::min(length - covered, page_remaining(address));
+        word paddr;
+        try
+        {
+            paddr = translate_address(address);
+        }
+        catch (const VirtualMemory::VirtualMemoryException&)
+        {
+            break;
+        }
+
+        if (!ram.in_bounds(paddr) && (write || !rom.in_bounds(paddr)))
+        {
+            break;
+        }
+
+        /* pinned before the next translation can evict it */
+        mmu.pin_ppage(paddr >> PAGE_PSIZE);
+        spans.push_back(HostSpan{host_pointer(paddr), chunk, paddr >> PAGE_PSIZE});
+        address += chunk;
+        covered += chunk;
+    }
+    return covered;
+}
+
+void SystemBus::unpin_host_spans(const std::vector<HostSpan>& spans)
+{
+    for (const HostSpan& span : spans)
+    {
+        mmu.unpin_ppage(span.ppage);
+    }
+}
+
+void SystemBus::attach_device(BaseMemory *device)
+{
+    if (device->get_lo_page() < (MMIO_START >> PAGE_PSIZE))
+    {
+        throw Exception("Devices must be mapped at or above " + std::to_string(MMIO_START) + ".");
+    }
+
+    devices.push_back(device);
+}
+
 void SystemBus::reset()
 {
     ram.reset();
-    rom.reset();     // Do we really want to reset rom??
-}
\ No newline at end of file
+    rom.reset();     // keeps the ROM image, see ROM::reset
+}
+
+std::string SystemBus::read_cstring(word address)
+{
+    std::string str;
+    while (true)
+    {
+        word chunk = page_remaining(address);
+        word paddr = translate_address(address);
+        const byte *host = host_pointer(paddr);
+
+        if (host)
+        {
+            const byte *end = (const byte*) memchr(host, '\0', chunk);
+            if (end)
+            {
+                str.append((const char*) host, end - host);
+                return str;
+            }
+            str.append((const char*) host, chunk);
+        }
+        else
+        {
+            BaseMemory *target = route_memory(paddr);
+            for (word i = 0; i < chunk; i++)
+            {
+                byte c = target->read_byte(paddr + i);
+                if (c == '\0')
+                {
+                    return str;
+                }
+                str += (char) c;
+            }
+        }
+
+        address += chunk;
+    }
+}
+
+void SystemBus::read_buffer(word address, byte* dst, word length)
+{
+    while (length > 0)
+    {
+        word chunk = std::min(length, page_remaining(address));
+        word paddr = translate_address(address);
+        const byte *host = host_pointer(paddr);
+
+        if (host)
+        {
+            memcpy(dst, host, chunk);
+        }
+        else
+        {
+            BaseMemory *target = route_memory(paddr);
+            for (word i = 0; i < chunk; i++)
+            {
+                dst[i] = target->read_byte(paddr + i);
+            }
+        }
+
+        address += chunk;
+        dst += chunk;
+        length -= chunk;
+    }
+}
+
+void SystemBus::write_buffer(word address, const byte* src, word length)
+{
+    while (length > 0)
+    {
+        word chunk = std::min(length, page_remaining(address));
+        word paddr = translate_address(address);
+        byte *host = host_pointer(paddr);
+
+        if (host)
+        {
+            /* the first byte goes through the ROM so the page is marked dirty */
+            route_memory(paddr)->write_byte(paddr, src[0]);
+            memcpy(host + 1, src + 1, chunk - 1);
+        }
+        else
+        {
+            BaseMemory *target = route_memory(paddr);
+            for (word i = 0; i < chunk; i++)
+            {
+                target->write_byte(paddr + i, src[i]);
+            }
+        }
+
+        address += chunk;
+        src += chunk;
+        length -= chunk;
+    }
+}
+
+word SystemBus::copy_chunk(word dst, word src, word length)
+{
+    word chunk = std::min(length, std::min(page_remaining(dst), page_remaining(src)));
+    if (chunk == 0)
+    {
+        return 0;
+    }
+
+    /* the source page is pinned so a fault translating dst cannot evict it and reuse it */
+    word psrc = translate_address(src);
+    mmu.pin_ppage(psrc >> PAGE_PSIZE);
+    word pdst;
+    try
+    {
+        pdst = translate_address(dst);
+    }
+    catch (...)
+    {
+        mmu.unpin_ppage(psrc >> PAGE_PSIZE);
+        throw;
+    }
+    mmu.unpin_ppage(psrc >> PAGE_PSIZE);
+
+    const byte *host_src = host_pointer(psrc);
+    byte *host_dst = host_pointer(pdst);
+
+    if (host_src && host_dst)
+    {
+        memmove(host_dst, host_src, chunk);
+        /* written again through the ROM so the page is marked dirty */
+        route_memory(pdst)->write_byte(pdst, host_dst[0]);
+    }
+    else
+    {
+        BaseMemory *from = route_memory(psrc);
+        BaseMemory *to = route_memory(pdst);
+        if (pdst > psrc)
+        {
+            for (word i = chunk; i-- > 0;)
+            {
+                to->write_byte(pdst + i, from->read_byte(psrc + i));
+            }
+        }
+        else
+        {
+            for (word i = 0; i < chunk; i++)
+            {
+                to->write_byte(pdst + i, from->read_byte(psrc + i));
+            }
+        }
+    }
+
+    return chunk;
+}
+
+word SystemBus::fill_chunk(word address, byte value, word length)
+{
+    word chunk = std::min(length, page_remaining(address));
+    if (chunk == 0)
+    {
+        return 0;
+    }
+
+    word paddr = translate_address(address);
+    byte *host = host_pointer(paddr);
+
+    if (host)
+    {
+        route_memory(paddr)->write_byte(paddr, value);
+        memset(host + 1, value, chunk - 1);
+    }
+    else
+    {
+        BaseMemory *target = route_memory(paddr);
+        for (word i = 0; i < chunk; i++)
+        {
+            target->write_byte(paddr + i, value);
+        }
+    }
+
+    return chunk;
+}
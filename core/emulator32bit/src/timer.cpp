@@ -4,4 +4,35 @@ Timer::Timer(Emulator32bit *processor)
     : processor(processor)
 {
 
-}
\ No newline at end of file
+}
+
+Timer::~Timer()
+{
+    stop();
+}
+
+void Timer::start(unsigned long long period)
+{
+    stop();
+    this->period = period > 0 ? period : 1;
+    running = true;
+    schedule_tick();
+}
+
+void Timer::stop()
+{
+    if (running)
+    {
+        processor->cancel_event(next_tick);
+        running = false;
+    }
+}
+
+void Timer::schedule_tick()
+{
+    next_tick = processor->schedule_event(period, [this]()
+    {
+        schedule_tick();
+        tick();
+    });
+}
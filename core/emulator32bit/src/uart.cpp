@@ -0,0 +1,253 @@
+#include "emulator32bit/uart.h"
+
+#include <algorithm>
+
+#define RING_MASK (UART_RING_SIZE - 1)
+
+UART::UART(Emulator32bit *processor) :
+    BaseMemory(1, UART_BASE >> PAGE_PSIZE),
+    processor(processor)
+{
+
+}
+
+UART::~UART()
+{
+    flush();
+}
+
+byte UART::read_byte(word address)
+{
+    word offset = address - start_addr;
+    if (offset >= UART_RX_RING)
+    {
+        return rx_ring[(offset - UART_RX_RING) & RING_MASK];
+    }
+    else if (offset >= UART_TX_RING)
+    {
+        return tx_ring[(offset - UART_TX_RING) & RING_MASK];
+    }
+    return read_register(offset & ~0b11) >> (8 * (offset & 0b11));
+}
+
+hword UART::read_hword(word address)
+{
+    word offset = address - start_addr;
+    if (offset < UART_TX_RING)
+    {
+        return read_register(offset & ~0b11) >> (8 * (offset & 0b11));
+    }
+    return read_byte(address) | (read_byte(address + 1) << 8);
+}
+
+word UART::read_word(word address)
+{
+    word offset = address - start_addr;
+    if (offset < UART_TX_RING)
+    {
+        return read_register(offset & ~0b11) >> (8 * (offset & 0b11));
+    }
+    return read_hword(address) | (read_hword(address + 2) << 16);
+}
+
+void UART::write_byte(word address, byte value)
+{
+    word offset = address - start_addr;
+    if (offset >= UART_RX_RING)
+    {
+        rx_ring[(offset - UART_RX_RING) & RING_MASK] = value;
+    }
+    else if (offset >= UART_TX_RING)
+    {
+        tx_ring[(offset - UART_TX_RING) & RING_MASK] = value;
+    }
+    else if ((offset & 0b11) == 0)
+    {
+        write_register(offset, value);
+    }
+}
+
+void UART::write_hword(word address, hword value)
+{
+    word offset = address - start_addr;
+    if (offset < UART_TX_RING)
+    {
+        if ((offset & 0b11) == 0)
+        {
+            write_register(offset, value);
+        }
+        return;
+    }
+    write_byte(address, value);
+    write_byte(address + 1, value >> 8);
+}
+
+void UART::write_word(word address, word value)
+{
+    word offset = address - start_addr;
+    if (offset < UART_TX_RING)
+    {
+        if ((offset & 0b11) == 0)
+        {
+            write_register(offset, value);
+        }
+        return;
+    }
+    write_hword(address, value);
+    write_hword(address + 2, value >> 16);
+}
+
+word UART::read_register(word offset)
+{
+    switch (offset)
+    {
+        case UART_DATA:
+        {
+            if (rx_pending() == 0)
+            {
+                return 0;
+            }
+            byte value = rx_ring[rx_tail++ & RING_MASK];
+            refill();
+            return value;
+        }
+        case UART_STATUS:
+            return (rx_pending() > 0 ? UART_STATUS_RX_READY : 0) |
+                    (tx_pending() == UART_RING_SIZE ? UART_STATUS_TX_FULL : 0);
+        case UART_CTRL:
+            return ctrl;
+        case UART_TX_HEAD:
+            return tx_head;
+        case UART_TX_TAIL:
+            return tx_tail;
+        case UART_RX_HEAD:
+            return rx_head;
+        case UART_RX_TAIL:
+            return rx_tail;
+        default:
+            return 0;
+    }
+}
+
+void UART::write_register(word offset, word value)
+{
+    switch (offset)
+    {
+        case UART_DATA:
+            if (tx_pending() == UART_RING_SIZE)
+            {
+                drain();
+            }
+            tx_ring[tx_head++ & RING_MASK] = value;
+            break;
+        case UART_CTRL:
+            ctrl = value;
+            break;
+        case UART_TX_HEAD:
+            /* publish at most a full ring past what the host has drained */
+            tx_head = tx_tail + std::min(value - tx_tail, (word) UART_RING_SIZE);
+            drain();
+            if (ctrl & UART_CTRL_TX_FLUSH)
+            {
+                write_out();
+            }
+            break;
+        case UART_RX_TAIL:
+            rx_tail += std::min(value - rx_tail, rx_pending());
+            refill();
+            break;
+        default:
+            break;
+    }
+}
+
+void UART::drain()
+{
+    while (tx_tail != tx_head)
+    {
+        word start = tx_tail & RING_MASK;
+        word length = std::min(tx_pending(), UART_RING_SIZE - start);
+        out_buffer.append((const char*) tx_ring + start, length);
+        tx_tail += length;
+    }
+
+    if (out_buffer.size() >= UART_FLUSH_THRESHOLD)
+    {
+        write_out();
+    }
+}
+
+void UART::write_out()
+{
+    if (!out_buffer.empty())
+    {
+        fwrite(out_buffer.data(), 1, out_buffer.size(), output);
+        fflush(output);
+        out_buffer.clear();
+    }
+}
+
+void UART::refill()
+{
+    word length = std::min((word) in_backlog.size(), UART_RING_SIZE - rx_pending());
+    for (word i = 0; i < length; i++)
+    {
+        rx_ring[rx_head++ & RING_MASK] = in_backlog[i];
+    }
+    in_backlog.erase(0, length);
+}
+
+void UART::print(const std::string& str)
+{
+    print((const byte*) str.data(), str.size());
+}
+
+void UART::print(const byte *data, word length)
+{
+    drain();
+    out_buffer.append((const char*) data, length);
+    if (out_buffer.size() >= UART_FLUSH_THRESHOLD)
+    {
+        write_out();
+    }
+}
+
+void UART::flush()
+{
+    drain();
+    write_out();
+}
+
+void UART::set_output(FILE *output)
+{
+    flush();
+    this->output = output;
+}
+
+void UART::receive(const byte *data, word length)
+{
+    in_backlog.append((const char*) data, length);
+
+    word before = rx_pending();
+    refill();
+    if (rx_pending() > before && (ctrl & UART_CTRL_RX_INTERRUPT))
+    {
+        processor->raise_interrupt(Emulator32bit::UART_RX);
+    }
+}
+
+void UART::post_input(std::string data)
+{
+    processor->post_event([this, data]()
+    {
+        receive((const byte*) data.data(), data.size());
+    });
+}
+
+void UART::reset()
+{
+    flush();
+    in_backlog.clear();
+    ctrl = 0;
+    tx_head = tx_tail = rx_head = rx_tail = 0;
+}
@@ -3,21 +3,43 @@
 #define AEMU_ONLY_CRITICAL_LOG
 #include "util/logger.h"
 
+#include <algorithm>
+#include <cstring>
+#include <stdio.h>
 #include <unordered_set>
 
-VirtualMemory::VirtualMemory(Disk *disk) :
+VirtualMemory::VirtualMemory(Disk *disk, word nppages) :
     m_disk(disk),
     m_freepids(0, MAX_PROCESSES),
-    m_freelist(0, NUM_PPAGES)
+    m_nppages(nppages),
+    m_freelist(0, nppages)
 {
-    for (int i = 0; i < NUM_PPAGES; i++)
+    word tlb_size = TLB_WAYS;
+    while (tlb_size < nppages && tlb_size < TLB_SIZE)
     {
-        m_physical_memory_map[i].ppage = (word) i;
+        tlb_size <<= 1;
     }
+
+    configure_tlb(tlb_size, TLB_WAYS);
 }
 
 VirtualMemory::~VirtualMemory()
 {
+    /* Only the host memory is freed here, the disk may already have been saved. */
+    for (PageTable *ptable : m_process_ptables)
+    {
+        if (ptable == nullptr)
+        {
+            continue;
+        }
+
+        for (PageTableLevel *level : ptable->levels)
+        {
+            delete level;
+        }
+        delete ptable;
+    }
+
     LRU_Node *cur = m_lru_head;
     while (cur != nullptr)
     {
@@ -89,8 +111,26 @@ word VirtualMemory::InvalidVPageException::get_vpage() const noexcept
 
 
 
+VirtualMemory::PageTableEntry::PageTableEntry() :
+    valid(false),
+    pid(-1),
+    vpage(0),
+    ppage(0),
+    disk(false),
+    diskpage(0),
+    mapped(false),
+    mapped_ppage(0),
+    write(false),
+    execute(false),
+    demand(false),
+    segment(NO_SEGMENT)
+{
+
+}
+
 VirtualMemory::PageTableEntry::PageTableEntry(long long pid, word vpage, word diskpage,
                                               bool write, bool execute) :
+    valid(true),
     pid(pid),
     vpage(vpage),
     ppage(0),
@@ -99,31 +139,34 @@ VirtualMemory::PageTableEntry::PageTableEntry(long long pid, word vpage, word di
     mapped(false),
     mapped_ppage(0),
     write(write),
-    execute(execute)
+    execute(execute),
+    demand(false),
+    segment(NO_SEGMENT)
 {
 
 }
 
-VirtualMemory::PhysicalPage::PhysicalPage() :
+VirtualMemory::PhysicalPage::PhysicalPage(word ppage) :
     mapped_vpages(std::vector<PageTableEntry*>()),
-    ppage(0),
+    ppage(ppage),
     used(false),
     swappable(true),
-    kernel_locked(false)
+    kernel_locked(false),
+    huge(false)
 {
 
 }
 
 void VirtualMemory::set_process(long long pid)
 {
-    if (m_process_ptable_map.find(pid) == m_process_ptable_map.end())
+    if (pid < 0 || pid >= MAX_PROCESSES || m_process_ptables[pid] == nullptr)
     {
         throw InvalidPIDException("Cannot set memory map of process " + std::to_string(pid) +
                 " because it doesn't exist.", pid);
         return;
     }
 
-    m_cur_ptable = m_process_ptable_map.at(pid);
+    m_cur_ptable = m_process_ptables[pid];
     DEBUG("Setting memory map to process %llu.", pid);
 }
 
@@ -143,7 +186,7 @@ long long VirtualMemory::begin_process(bool kernel_privilege)
         .kernel_privilege = kernel_privilege,
     };
 
-    m_process_ptable_map.insert(std::make_pair(pid, new_pagetable));
+    m_process_ptables[pid] = new_pagetable;
     m_cur_ptable = new_pagetable;
 
     DEBUG("Beginning process %llu.", pid);
@@ -152,36 +195,55 @@ long long VirtualMemory::begin_process(bool kernel_privilege)
 
 void VirtualMemory::end_process(long long pid)
 {
-    if (m_process_ptable_map.find(pid) == m_process_ptable_map.end())
+    if (pid < 0 || pid >= MAX_PROCESSES || m_process_ptables[pid] == nullptr)
     {
         throw InvalidPIDException("Cannot end process " + std::to_string(pid) + " since it does "
                 "not exist.", pid);
         return;
     }
 
-    /*
-     * Store into a temporary array because when vpage entry is removed, it will also be removed
-     * from the process PageTableEntry map. This would have caused a concurrent modification error.
-     */
-    std::vector<word> vpages;
-    for (std::pair<const word, PageTableEntry*>& pair : m_process_ptable_map.at(pid)->entries)
+    PageTable *ptable = m_process_ptables[pid];
+
+    /* Walk the directory in order, releasing every valid entry before freeing the whole level. */
+    for (word l1 = 0; l1 < PTABLE_L1_SIZE; l1++)
     {
-        vpages.push_back(pair.first);
+        PageTableLevel *level = ptable->levels[l1];
+        if (level == nullptr)
+        {
+            continue;
+        }
+
+        for (word l2 = 0; l2 < PTABLE_L2_SIZE && level->nvalid > 0; l2++)
+        {
+            PageTableEntry *entry = &level->entries[l2];
+            if (entry->valid)
+            {
+                release_vpage(entry);
+                entry->valid = false;
+                level->nvalid--;
+            }
+        }
+
+        delete level;
+        ptable->levels[l1] = nullptr;
     }
 
-    for (word vpage : vpages)
+    while (!ptable->huge_pages.empty())
     {
-        remove_vpage(pid, vpage);
+        remove_huge_vpage(pid, ptable->huge_pages.begin()->first << PTABLE_L2_PSIZE);
     }
 
-    if (m_cur_ptable == m_process_ptable_map.at(pid))
+    if (m_cur_ptable == ptable)
     {
         m_cur_ptable = nullptr;
     }
 
-    delete m_process_ptable_map.at(pid);
-    m_process_ptable_map.erase(pid);
+    delete ptable;
+    m_process_ptables[pid] = nullptr;
     m_freepids.return_block(pid, 1);
+
+    /* the pid (ASID) may be reused, so no translation of it can survive */
+    invalidate_tlb_process(pid);
     DEBUG("Ending process %llu.", pid);
 }
 
@@ -199,28 +261,24 @@ void VirtualMemory::set_ppage_permissions(word ppage_begin, word ppage_end, word
 {
     for (word i = ppage_begin; i <= ppage_end; i++)
     {
-        m_physical_memory_map[i].swappable = swappable;
-        m_physical_memory_map[i].kernel_locked = kernel_locked;
+        PhysicalPage& ppage = get_ppage(i);
+        ppage.swappable = swappable;
+        ppage.kernel_locked = kernel_locked;
     }
 }
 
 void VirtualMemory::set_vpage_permissions(long long pid, word vpage_begin, word vpage_end, bool write, bool execute)
 {
-    if (UNLIKELY(m_process_ptable_map.find(pid) == m_process_ptable_map.end()))
-    {
-        throw InvalidPIDException("Cannot set vpage permissions since pid is invalid.", pid);
-    }
-
-    PageTable *ptable = m_process_ptable_map.at(pid);
+    PageTable *ptable = get_ptable(pid);
     for (word vpage = vpage_begin; vpage <= vpage_end; vpage++)
     {
-        if (ptable->entries.find(vpage) == ptable->entries.end())
+        PageTableEntry *entry = ptable->find(vpage);
+        if (entry == nullptr)
         {
             add_vpage(pid, vpage, 1, write, execute);
         }
         else
         {
-            PageTableEntry *entry = ptable->entries.at(vpage);
             entry->write = write;
             entry->execute = execute;
         }
@@ -229,168 +287,510 @@ void VirtualMemory::set_vpage_permissions(long long pid, word vpage_begin, word
 
 bool VirtualMemory::can_write_vpage(long long pid, word vpage)
 {
-    if (UNLIKELY(m_process_ptable_map.find(pid) == m_process_ptable_map.end()))
+    PageTable *ptable = get_ptable(pid);
+    PageTableEntry *entry = ptable->find(vpage);
+    HugePage *huge = ptable->find_huge(vpage);
+    return (entry != nullptr && entry->write) || (huge != nullptr && huge->write);
+}
+
+bool VirtualMemory::can_execute_vpage(long long pid, word vpage)
+{
+    PageTable *ptable = get_ptable(pid);
+    PageTableEntry *entry = ptable->find(vpage);
+    HugePage *huge = ptable->find_huge(vpage);
+    return (entry != nullptr && entry->execute) || (huge != nullptr && huge->execute);
+}
+
+bool VirtualMemory::has_vpage(long long pid, word vpage)
+{
+    PageTable *ptable = get_ptable(pid);
+    return ptable->find(vpage) != nullptr || ptable->find_huge(vpage) != nullptr;
+}
+
+bool VirtualMemory::can_access_ppage(long long pid, word ppage)
+{
+    PageTable *ptable = get_ptable(pid);
+    if (ptable->kernel_privilege)
+    {
+        return true;
+    }
+
+    std::unordered_map<word, PhysicalPage>::iterator it = m_physical_memory_map.find(ppage);
+    return it == m_physical_memory_map.end() || !it->second.kernel_locked;
+}
+
+void VirtualMemory::add_vpage(long long pid, word vpage, word length, bool write, bool execute)
+{
+    PageTable *ptable = get_ptable(pid);
+
+    DEBUG("Adding vpages from %u to %u.", vpage, vpage + length - 1);
+
+    word last_vpage = vpage + length - 1;
+    if (length == 0 || last_vpage < vpage || last_vpage >= NUM_VPAGES)
     {
-        throw InvalidPIDException("Cannot check write permission of virtual page because pid is invalid.", pid);
+        throw InvalidVPageException("Cannot add virtual pages " + std::to_string(vpage) + " to " +
+                std::to_string(last_vpage) + " because they are out of range.", vpage);
     }
 
-    PageTable *ptable = m_process_ptable_map.at(pid);
-    if (ptable->entries.find(vpage) == ptable->entries.end())
+    for (; vpage <= last_vpage; vpage++)
     {
-        return false;
+        if (ptable->find(vpage) != nullptr || ptable->find_huge(vpage) != nullptr)
+        {
+            throw InvalidVPageException("Cannot add virtual page " + std::to_string(vpage) +
+                    " because it is already mapped to process " + std::to_string(pid), vpage);
+            return;
+        }
+
+        PageTableLevel *&level = ptable->levels[vpage >> PTABLE_L2_PSIZE];
+        if (level == nullptr)
+        {
+            level = new PageTableLevel();
+        }
+
+        level->entries[vpage & (PTABLE_L2_SIZE-1)] = PageTableEntry(pid, vpage, m_disk->get_free_page(), write, execute);
+        level->nvalid++;
+
+        DEBUG("Adding virtual page %u to process %llu.", vpage, pid);
     }
-    return ptable->entries.at(vpage)->write;
 }
 
-bool VirtualMemory::can_execute_vpage(long long pid, word vpage)
+void VirtualMemory::add_huge_vpage(long long pid, word vpage, bool write, bool execute)
 {
-    if (UNLIKELY(m_process_ptable_map.find(pid) == m_process_ptable_map.end()))
+    PageTable *ptable = get_ptable(pid);
+
+    if ((vpage & (HUGE_PAGE_NPAGES - 1)) != 0 || vpage >= NUM_VPAGES)
+    {
+        throw InvalidVPageException("Cannot add huge page at virtual page " + std::to_string(vpage) +
+                " because it is not aligned to " + std::to_string(HUGE_PAGE_NPAGES) + " pages.", vpage);
+    }
+
+    word l1 = vpage >> PTABLE_L2_PSIZE;
+    if (ptable->levels[l1] != nullptr || ptable->find_huge(vpage) != nullptr)
+    {
+        throw InvalidVPageException("Cannot add huge page at virtual page " + std::to_string(vpage) +
+                " because part of it is already mapped to process " + std::to_string(pid), vpage);
+    }
+
+    if (!m_freelist.can_fit(HUGE_PAGE_NPAGES))
     {
-        throw InvalidPIDException("Cannot check execute permission of virtual page because pid is invalid.", pid);
+        throw VirtualMemoryException("Not enough contiguous physical pages for a huge page.");
     }
 
-    PageTable *ptable = m_process_ptable_map.at(pid);
-    if (ptable->entries.find(vpage) == ptable->entries.end())
+    word ppage = m_freelist.alloc_contiguous(HUGE_PAGE_NPAGES);
+    for (word i = 0; i < HUGE_PAGE_NPAGES; i++)
     {
-        return false;
+        PhysicalPage& huge_ppage = get_ppage(ppage + i);
+        huge_ppage.used = true;
+        huge_ppage.huge = true;
     }
-    return ptable->entries.at(vpage)->execute;
+
+    ptable->huge_pages[l1] = HugePage
+    {
+        .ppage = ppage,
+        .write = write,
+        .execute = execute,
+    };
+    m_nhuge_pages++;
+
+    DEBUG("Adding huge page at virtual page %u to physical page %u of process %llu.", vpage, ppage, pid);
 }
 
-bool VirtualMemory::can_access_ppage(long long pid, word ppage)
+void VirtualMemory::remove_huge_vpage(long long pid, word vpage)
 {
-    if (UNLIKELY(m_process_ptable_map.find(pid) == m_process_ptable_map.end()))
+    PageTable *ptable = get_ptable(pid);
+    HugePage *huge = ptable->find_huge(vpage);
+    if (huge == nullptr || (vpage & (HUGE_PAGE_NPAGES - 1)) != 0)
+    {
+        throw InvalidVPageException("Cannot remove huge page because it is not mapped to process.", vpage);
+    }
+
+    for (word i = 0; i < HUGE_PAGE_NPAGES; i++)
     {
-        throw InvalidPIDException("Cannot check access permission of physical page because pid is invalid.", pid);
+        PhysicalPage& huge_ppage = get_ppage(huge->ppage + i);
+        huge_ppage.used = false;
+        huge_ppage.huge = false;
     }
+    m_freelist.free(huge->ppage, HUGE_PAGE_NPAGES);
 
-    PageTable *ptable = m_process_ptable_map.at(pid);
-    return !m_physical_memory_map[ppage].kernel_locked || ptable->kernel_privilege;
+    ptable->huge_pages.erase(vpage >> PTABLE_L2_PSIZE);
+    m_nhuge_pages--;
+    invalidate_tlb_page(pid, vpage);
 }
 
-void VirtualMemory::add_vpage(long long pid, word vpage, word length, bool write, bool execute)
+void VirtualMemory::add_segment(long long pid, word address, word size, std::vector<byte> image,
+                                bool write, bool execute)
+{
+    word image_size = image.size();
+    std::shared_ptr<std::vector<byte>> owner = std::make_shared<std::vector<byte>>(std::move(image));
+    add_segment(pid, address, size, std::shared_ptr<const byte>(owner, owner->data()), image_size,
+                write, execute);
+}
+
+void VirtualMemory::add_segment(long long pid, word address, word size, std::shared_ptr<const byte> image,
+                                word image_size, bool write, bool execute)
 {
-    if (UNLIKELY(m_process_ptable_map.find(pid) == m_process_ptable_map.end()))
+    PageTable *ptable = get_ptable(pid);
+    if (size == 0)
     {
-        throw InvalidPIDException("Cannot add virtual pages because pid is invalid.", pid);
+        return;
     }
 
-    DEBUG("Adding vpages from %u to %u.", vpage, vpage + length - 1);
+    word first_vpage = address >> PAGE_PSIZE;
+    word last_vpage = (address + size - 1) >> PAGE_PSIZE;
+    if (last_vpage < first_vpage)
+    {
+        throw InvalidVPageException("Cannot add segment at " + std::to_string(address) +
+                " because it is out of range.", first_vpage);
+    }
 
-    PageTable *ptable = m_process_ptable_map.at(pid);
-    word last_vpage = vpage + length - 1;
-    for (; vpage <= last_vpage; vpage++)
+    for (word vpage = first_vpage; vpage <= last_vpage; vpage++)
     {
-        if (ptable->entries.find(vpage) != ptable->entries.end())
+        if (ptable->find(vpage) != nullptr || ptable->find_huge(vpage) != nullptr)
         {
             throw InvalidVPageException("Cannot add virtual page " + std::to_string(vpage) +
                     " because it is already mapped to process " + std::to_string(pid), vpage);
-            return;
         }
+    }
 
-        ptable->entries.insert(std::make_pair(vpage, new PageTableEntry(pid, vpage, m_disk->get_free_page(), write, execute)));
+    word segment = NO_SEGMENT;
+    if (image_size > 0)
+    {
+        segment = m_next_segment++;
+        m_segments[segment] = Segment
+        {
+            .image = std::move(image),
+            .image_size = std::min(image_size, size),
+            .address = address,
+            .nrefs = last_vpage - first_vpage + 1,
+        };
+    }
 
-        DEBUG("Adding virtual page %u to process %llu.", vpage, pid);
+    /* No disk page is taken until a filled page is evicted. */
+    for (word vpage = first_vpage; vpage <= last_vpage; vpage++)
+    {
+        PageTableLevel *&level = ptable->levels[vpage >> PTABLE_L2_PSIZE];
+        if (level == nullptr)
+        {
+            level = new PageTableLevel();
+        }
+
+        PageTableEntry& entry = level->entries[vpage & (PTABLE_L2_SIZE-1)];
+        entry = PageTableEntry(pid, vpage, 0, write, execute);
+        entry.demand = true;
+        entry.segment = segment;
+        level->nvalid++;
     }
+
+    DEBUG("Adding segment of %u bytes at %x to process %llu.", size, address, pid);
 }
 
-void VirtualMemory::map_ppage(long long pid, word vpage, word ppage, Exception& exception)
+std::vector<byte> VirtualMemory::fill_demand_page(PageTableEntry *entry)
 {
-    if (UNLIKELY(m_process_ptable_map.find(pid) == m_process_ptable_map.end()))
+    std::vector<byte> page(PAGE_SIZE, 0);
+    if (entry->segment != NO_SEGMENT)
     {
-        throw InvalidPIDException("Cannot map virtual page to physical page because pid is invalid.", pid);
+        const Segment& segment = m_segments.at(entry->segment);
+        word page_address = entry->vpage << PAGE_PSIZE;
+
+        /* The image may start or end part way through the page. */
+        word begin = std::max(page_address, segment.address);
+        word end = std::min((dword) page_address + PAGE_SIZE, (dword) segment.address + segment.image_size);
+        if (begin < end)
+        {
+            memcpy(&page[begin - page_address], segment.image.get() + (begin - segment.address), end - begin);
+        }
     }
 
-    PageTable *ptable = m_process_ptable_map.at(pid);
-    if (ptable->entries.find(vpage) != ptable->entries.end())
+    release_segment(entry->segment);
+    entry->demand = false;
+    entry->segment = NO_SEGMENT;
+    return page;
+}
+
+void VirtualMemory::release_segment(word segment)
+{
+    if (segment == NO_SEGMENT)
+    {
+        return;
+    }
+
+    std::unordered_map<word, Segment>::iterator it = m_segments.find(segment);
+    if (--it->second.nrefs == 0)
+    {
+        m_segments.erase(it);
+    }
+}
+
+void VirtualMemory::map_ppage(long long pid, word vpage, word ppage, Exception& exception)
+{
+    PageTable *ptable = get_ptable(pid);
+    if (ptable->find(vpage) != nullptr)
     {
         throw InvalidVPageException("Cannot map virtual page to physical page because virtual page has already been added.", vpage);
     }
 
-    add_vpage(vpage, 1, true, true, true);
+    if (get_ppage(ppage).huge)
+    {
+        throw VirtualMemoryException("Cannot map virtual page " + std::to_string(vpage) +
+                " to physical page " + std::to_string(ppage) + " because it is part of a huge page.");
+    }
 
-    if (m_physical_memory_map[ppage].used)
+    add_vpage(pid, vpage, 1, true, true);
+
+    if (get_ppage(ppage).used)
     {
         evict_ppage(ppage, exception);
     }
 
-    m_freelist.remove_block(ppage, 1);
-    map_vpage_to_ppage(pid, vpage, ppage, exception);
+    m_freelist.reserve(ppage);
 
-    PageTableEntry *entry = ptable->entries.at(vpage);
+    PageTableEntry *entry = ptable->find(vpage);
+    map_vpage_to_ppage(entry, ppage, exception);
     entry->mapped = true;
     entry->mapped_ppage = ppage;
 }
 
 void VirtualMemory::remove_vpage(long long pid, word vpage)
 {
-    if (UNLIKELY(m_process_ptable_map.find(pid) == m_process_ptable_map.end()))
+    PageTable *ptable = get_ptable(pid);
+    PageTableEntry *entry = ptable->find(vpage);
+
+    if (entry == nullptr)
     {
-        throw InvalidPIDException("Cannot remove virtual page because pid is invalid.", pid);
+        throw InvalidVPageException("Cannot remove virtual page because it is not mapped to process.", vpage);
+        return;
     }
 
-    PageTable *ptable = m_process_ptable_map.at(pid);
+    release_vpage(entry);
+    entry->valid = false;
 
-    if (ptable->entries.find(vpage) == ptable->entries.end())
+    PageTableLevel *&level = ptable->levels[vpage >> PTABLE_L2_PSIZE];
+    if (--level->nvalid == 0)
     {
-        throw InvalidVPageException("Cannot remove virtual page because it is not mapped to process.", vpage);
-        return;
+        delete level;
+        level = nullptr;
     }
+}
+
+void VirtualMemory::release_vpage(PageTableEntry *entry)
+{
+    invalidate_tlb_page(entry->pid, entry->vpage);
 
-    PageTableEntry *entry = ptable->entries.at(vpage);
-    ptable->entries.erase(vpage);
+    if (entry->demand)
+    {
+        release_segment(entry->segment);
+        return;
+    }
 
     if (entry->disk)
     {
         m_disk->return_page(entry->diskpage);
 
-        DEBUG("Returning disk page %u coressponding to virtual page %u.", entry->diskpage, vpage);
+        DEBUG("Returning disk page %u coressponding to virtual page %u.", entry->diskpage, entry->vpage);
+        return;
     }
-    else
+
+    PhysicalPage& ppage = get_ppage(entry->ppage);
+    for (size_t i = 0; i < ppage.mapped_vpages.size(); i++)
     {
-        m_physical_memory_map[entry->ppage].used = false;
+        if (ppage.mapped_vpages[i] == entry)
+        {
+            ppage.mapped_vpages.erase(ppage.mapped_vpages.begin() + i);
+            break;
+        }
+    }
 
-        /* add back to free list */
-        m_freelist.return_block(entry->ppage, 1);
+    if (ppage.mapped_vpages.empty())
+    {
+        ppage.used = false;
 
-        DEBUG("Returning physical page %u corresponding to virtual page %u.", entry->ppage, vpage);
+        /* add back to free list */
+        m_freelist.free(entry->ppage);
+        erase_lru(entry->ppage);
     }
 
-    delete entry;
+    DEBUG("Returning physical page %u corresponding to virtual page %u.", entry->ppage, entry->vpage);
 }
 
 void VirtualMemory::check_vm()
 {
-    for (int i = 0; i < NUM_PPAGES; i++)
+    for (std::pair<const word, PhysicalPage>& pair : m_physical_memory_map)
     {
-        PhysicalPage& ppage = m_physical_memory_map[i];
+        PhysicalPage& ppage = pair.second;
 
-        EXPECT_TRUE((word) i == ppage.ppage, "Expected physical memory to match");
+        EXPECT_TRUE(pair.first == ppage.ppage, "Expected physical memory to match");
+        EXPECT_TRUE(ppage.ppage < m_nppages, "Expected physical page to be installed");
 
         if (ppage.mapped_vpages.size() > 0)
         {
             word diskpage = ppage.mapped_vpages.at(0)->diskpage;
             for (PageTableEntry *entry : ppage.mapped_vpages)
             {
+                EXPECT_TRUE(entry->valid, "Expected virtual pages mapped to the physical page to be valid.");
                 EXPECT_TRUE(entry->diskpage == diskpage, "Expected all virtual pages mapped to the "
                         "physical page to have same diskpage location.");
             }
         }
     }
 
-    for (std::pair<long long, PageTable*> pair : m_process_ptable_map)
+    for (long long pid = 0; pid < MAX_PROCESSES; pid++)
     {
-        DEBUG("Checking process %llu.", pair.first);
-        EXPECT_TRUE(pair.second->pid == pair.first, "Expected Process ID to match");
-        for (std::pair<word,PageTableEntry*> entry : pair.second->entries)
+        PageTable *ptable = m_process_ptables[pid];
+        if (ptable == nullptr)
+        {
+            continue;
+        }
+
+        DEBUG("Checking process %llu.", pid);
+        EXPECT_TRUE(ptable->pid == pid, "Expected Process ID to match");
+        for (word l1 = 0; l1 < PTABLE_L1_SIZE; l1++)
         {
-            DEBUG("Checking page entry at vpage %u.", entry.first);
+            PageTableLevel *level = ptable->levels[l1];
+            if (level == nullptr)
+            {
+                continue;
+            }
 
-            EXPECT_TRUE(entry.second->vpage == entry.first, "Expected virtual memory to match");
+            word nvalid = 0;
+            for (word l2 = 0; l2 < PTABLE_L2_SIZE; l2++)
+            {
+                PageTableEntry& entry = level->entries[l2];
+                if (!entry.valid)
+                {
+                    continue;
+                }
+
+                word vpage = (l1 << PTABLE_L2_PSIZE) | l2;
+                DEBUG("Checking page entry at vpage %u.", vpage);
+
+                EXPECT_TRUE(entry.vpage == vpage, "Expected virtual memory to match");
+                EXPECT_TRUE(entry.pid == pid, "Expected entry to belong to the process");
+                nvalid++;
+            }
+
+            EXPECT_TRUE(nvalid > 0 && nvalid == level->nvalid, "Expected level valid count to match");
         }
     }
 }
 
+void VirtualMemory::configure_tlb(word nentries, word nways)
+{
+    if (nentries == 0 || nways == 0 || (nentries & (nentries - 1)) != 0 ||
+            (nways & (nways - 1)) != 0 || nways > nentries || nways > 256)
+    {
+        throw VirtualMemoryException("Invalid TLB configuration of " + std::to_string(nentries) +
+                " entries and " + std::to_string(nways) + " ways.");
+    }
+
+    word ways_psize = 0;
+    while (((word) 1 << ways_psize) < nways)
+    {
+        ways_psize++;
+    }
+
+    tlb.assign(nentries, TLB_Entry());
+    m_tlb_next_victim.assign(nentries / nways, 0);
+    m_tlb_set_mask = nentries / nways - 1;
+    m_tlb_ways_psize = ways_psize;
+}
+
+void VirtualMemory::invalidate_tlb_page(long long pid, word vpage)
+{
+    word tag = tlb_tag(pid, vpage);
+    TLB_Entry *ways = &tlb[tlb_set(pid, vpage) << m_tlb_ways_psize];
+    for (word way = 0; way < ((word) 1 << m_tlb_ways_psize); way++)
+    {
+        if (ways[way].tag == tag)
+        {
+            ways[way].tag = TLB_INVALID_TAG;
+            m_tlb_stats.invalidations++;
+        }
+    }
+
+    word huge_tag = tlb_tag(pid, vpage >> PTABLE_L2_PSIZE);
+    for (TLB_Entry& huge_entry : m_huge_tlb)
+    {
+        if (huge_entry.tag == huge_tag)
+        {
+            huge_entry.tag = TLB_INVALID_TAG;
+            m_tlb_stats.invalidations++;
+        }
+    }
+}
+
+void VirtualMemory::invalidate_tlb_process(long long pid)
+{
+    word asid = (word) pid;
+    for (TLB_Entry& tlb_entry : m_huge_tlb)
+    {
+        if (tlb_entry.tag != TLB_INVALID_TAG && (tlb_entry.tag >> (8 * sizeof(word) - PAGE_PSIZE)) == asid)
+        {
+            tlb_entry.tag = TLB_INVALID_TAG;
+            m_tlb_stats.invalidations++;
+        }
+    }
+
+    for (TLB_Entry& tlb_entry : tlb)
+    {
+        if (tlb_entry.tag != TLB_INVALID_TAG && (tlb_entry.tag >> (8 * sizeof(word) - PAGE_PSIZE)) == asid)
+        {
+            tlb_entry.tag = TLB_INVALID_TAG;
+            m_tlb_stats.invalidations++;
+        }
+    }
+}
+
+void VirtualMemory::flush_tlb()
+{
+    for (TLB_Entry& tlb_entry : tlb)
+    {
+        if (tlb_entry.tag != TLB_INVALID_TAG)
+        {
+            tlb_entry.tag = TLB_INVALID_TAG;
+            m_tlb_stats.invalidations++;
+        }
+    }
+
+    for (TLB_Entry& tlb_entry : m_huge_tlb)
+    {
+        if (tlb_entry.tag != TLB_INVALID_TAG)
+        {
+            tlb_entry.tag = TLB_INVALID_TAG;
+            m_tlb_stats.invalidations++;
+        }
+    }
+}
+
+const VirtualMemory::TLB_Stats& VirtualMemory::get_tlb_stats() const
+{
+    return m_tlb_stats;
+}
+
+void VirtualMemory::reset_tlb_stats()
+{
+    m_tlb_stats = TLB_Stats();
+}
+
+void VirtualMemory::print_tlb_stats()
+{
+    unsigned long long accesses = m_tlb_stats.hits + m_tlb_stats.misses;
+    printf("TLB (%zu entries, %u-way): %llu hits (%llu huge), %llu misses (%.2f%% hit rate), "
+            "%llu evictions, %llu invalidations\n", tlb.size(), 1U << m_tlb_ways_psize,
+            m_tlb_stats.hits, m_tlb_stats.huge_hits, m_tlb_stats.misses,
+            accesses == 0 ? 0.0 : 100.0 * m_tlb_stats.hits / accesses, m_tlb_stats.evictions,
+            m_tlb_stats.invalidations);
+}
+
+VirtualMemory::PhysicalPage& VirtualMemory::get_ppage(word ppage)
+{
+    if (UNLIKELY(ppage >= m_nppages))
+    {
+        throw VirtualMemoryException("Physical page " + std::to_string(ppage) + " is not installed.");
+    }
+
+    return m_physical_memory_map.try_emplace(ppage, ppage).first->second;
+}
+
 void VirtualMemory::evict_ppage(word ppage, Exception& exception)
 {
     DEBUG("Evicting physical page %u to disk.", ppage);
@@ -399,45 +799,43 @@ void VirtualMemory::evict_ppage(word ppage, Exception& exception)
      * NOTE: this location will be overwritten below since we return the
      * block to the free list, and then request a free block immediately
      */
-    PhysicalPage& evicted_ppage = m_physical_memory_map[ppage];
+    PhysicalPage& evicted_ppage = get_ppage(ppage);
     evicted_ppage.used = false;
 
+    /* All virtual pages mapped to the physical page share the same disk page. */
+    word diskpage = m_disk->get_free_page();
     for (PageTableEntry *removed_entry : evicted_ppage.mapped_vpages)
     {
         removed_entry->disk = true;
-        removed_entry->diskpage = m_disk->get_free_page();
-        word tlb_addr = removed_entry->vpage & (TLB_SIZE-1);
-        TLB_Entry& tlb_entry = tlb[tlb_addr];
-        if (tlb_entry.valid && tlb_entry.ppage == ppage && tlb_entry.vpage == removed_entry->vpage) // todo, this should check for pid i think.
-        {
-            tlb_entry.valid = false;
-        }
+        removed_entry->diskpage = diskpage;
+        invalidate_tlb_page(removed_entry->pid, removed_entry->vpage);
     }
     evicted_ppage.mapped_vpages.clear();
 
     // exception to tell system bus to write to disk
-    exception.disk_page_return = evicted_ppage.mapped_vpages.at(0)->diskpage;        // there MUST be a mapped vpage or else we should not be evicting this ppage.
+    exception.disk_page_return = diskpage;
     exception.ppage_return = ppage;
     exception.type = Exception::Type::DISK_RETURN_AND_FETCH_SUCCESS;
 
-    m_freelist.return_block(ppage, 1);
+    m_freelist.free(ppage);
 }
 
-void VirtualMemory::map_vpage_to_ppage(long long pid, word vpage, word ppage, Exception& exception)
+void VirtualMemory::map_vpage_to_ppage(PageTableEntry *entry, word ppage, Exception& exception)
 {
-    if (UNLIKELY(m_process_ptable_map.find(pid) == m_process_ptable_map.end()))
+    if (entry->demand)
     {
-        throw InvalidPIDException("Cannot map virtual page to physical page because pid is invalid.", pid);
-    }
+        exception.disk_fetch = fill_demand_page(entry);
 
-    PageTable *ptable = m_process_ptable_map.at(pid);
-
-    PageTableEntry *entry = ptable->entries.at(vpage);
-    exception.disk_fetch = m_disk->read_page(entry->diskpage);
+        DEBUG("Demand fill of virtual page %u to physical page %u.", entry->vpage, ppage);
+    }
+    else
+    {
+        exception.disk_fetch = m_disk->read_page(entry->diskpage);
 
-    DEBUG("Disk Fetch from page %u to physical page %u.", entry->diskpage, ppage);
+        DEBUG("Disk Fetch from page %u to physical page %u.", entry->diskpage, ppage);
 
-    m_disk->return_page(entry->diskpage);
+        m_disk->return_page(entry->diskpage);
+    }
 
     if (exception.type != Exception::Type::DISK_RETURN_AND_FETCH_SUCCESS)
     {
@@ -447,7 +845,7 @@ void VirtualMemory::map_vpage_to_ppage(long long pid, word vpage, word ppage, Ex
     entry->ppage = ppage;
     entry->disk = false;
 
-    PhysicalPage& mapped_ppage = m_physical_memory_map[ppage];
+    PhysicalPage& mapped_ppage = get_ppage(ppage);
     mapped_ppage.mapped_vpages.push_back(entry);
     mapped_ppage.used = true;
 
@@ -461,31 +859,40 @@ void VirtualMemory::ensure_physical_page_mapping(long long pid, word vpage, word
         return;
     }
 
-    if (UNLIKELY(m_process_ptable_map.find(pid) == m_process_ptable_map.end()))
-    {
-        throw InvalidPIDException("Invalid Process ID " + std::to_string(pid), pid);
-    }
-
-    PageTable *ptable = m_process_ptable_map.at(pid);
+    PageTable *ptable = get_ptable(pid);
 
     /*
      * It is likely that the virtual page has already been mapped since this is a temporary
      * way to allow the emulator to load a program at a specific physical address.
      */
-    if (LIKELY(ptable->entries.find(vpage) != ptable->entries.end()))
+    PageTableEntry *entry = ptable->find(vpage);
+    if (LIKELY(entry != nullptr))
     {
         /*
          * It is likely that the virtual page maps to the same physical page.
          */
-        if (LIKELY(ptable->entries.at(vpage)->ppage == ppage))
+        if (LIKELY(entry->ppage == ppage))
         {
             return;
         }
 
         throw VPageRemapException("Virtual page " + std::to_string(vpage) + " is already "
-                "mapped to a different physical page " +
-                std::to_string(ptable->entries.at(vpage)->ppage) + " of process " +
-                std::to_string(pid), vpage, ptable->entries.at(vpage)->ppage, ppage);
+                "mapped to a different physical page " + std::to_string(entry->ppage) +
+                " of process " + std::to_string(pid), vpage, entry->ppage, ppage);
+    }
+
+    HugePage *huge = ptable->find_huge(vpage);
+    if (UNLIKELY(huge != nullptr))
+    {
+        word huge_ppage = huge->ppage + (vpage & (PTABLE_L2_SIZE - 1));
+        if (huge_ppage == ppage)
+        {
+            return;
+        }
+
+        throw VPageRemapException("Virtual page " + std::to_string(vpage) + " is already "
+                "mapped to a different physical page " + std::to_string(huge_ppage) +
+                " of process " + std::to_string(pid), vpage, huge_ppage, ppage);
     }
 
     DEBUG("Mapping physical page %u to virtual page %u.", ppage, vpage);
@@ -593,8 +1000,48 @@ void VirtualMemory::add_lru(word ppage)
     // check_lru();
 }
 
+void VirtualMemory::pin_ppage(word ppage)
+{
+    m_pinned[ppage]++;
+}
+
+void VirtualMemory::unpin_ppage(word ppage)
+{
+    auto it = m_pinned.find(ppage);
+    if (it == m_pinned.end())
+    {
+        throw VirtualMemoryException("Cannot unpin physical page " + std::to_string(ppage) +
+                " because it is not pinned.");
+    }
+
+    if (--it->second == 0)
+    {
+        m_pinned.erase(it);
+    }
+}
+
 word VirtualMemory::remove_lru()
 {
+    /* huge pages never enter the LRU, they may hold every page that is not free */
+    if (UNLIKELY(m_lru_head == nullptr))
+    {
+        throw VirtualMemoryException("Cannot evict a physical page because none is evictable.");
+    }
+
+    /* pinned pages are under I/O, move them out of the way to the tail */
+    if (UNLIKELY(!m_pinned.empty()))
+    {
+        for (size_t i = 0; i < m_lru_map.size() && m_pinned.count(m_lru_head->ppage); i++)
+        {
+            add_lru(m_lru_head->ppage);
+        }
+
+        if (m_pinned.count(m_lru_head->ppage))
+        {
+            throw VirtualMemoryException("Cannot evict a physical page because every page is pinned.");
+        }
+    }
+
     LRU_Node *removed_node = m_lru_head;
     m_lru_head = m_lru_head->next;
 
@@ -615,4 +1062,34 @@ word VirtualMemory::remove_lru()
 
     // check_lru();
     return lru_ppage;
-}
\ No newline at end of file
+}
+
+void VirtualMemory::erase_lru(word ppage)
+{
+    if (m_lru_map.find(ppage) == m_lru_map.end())
+    {
+        return;
+    }
+
+    LRU_Node *node = m_lru_map.at(ppage);
+    if (node->prev == nullptr)
+    {
+        m_lru_head = node->next;
+    }
+    else
+    {
+        node->prev->next = node->next;
+    }
+
+    if (node->next == nullptr)
+    {
+        m_lru_tail = node->prev;
+    }
+    else
+    {
+        node->next->prev = node->prev;
+    }
+
+    m_lru_map.erase(ppage);
+    delete node;
+}
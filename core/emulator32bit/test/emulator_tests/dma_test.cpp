@@ -0,0 +1,139 @@
+#include "emulator32bit_test/emulator32bit_test.h"
+
+#include "emulator32bit/dma.h"
+
+#include <cstdio>
+#include <vector>
+
+#define VECTOR_TABLE 0x100
+#define DONE_HANDLER 0x200
+#define DISK_NAME "dma_test_disk"
+#define DISK_FILE DISK_NAME ".bin"
+#define RAM_NPAGES 8
+#define DISK_NPAGES 16
+#define DISK_START (RAM_NPAGES << PAGE_PSIZE)
+
+static void program(Emulator32bit *cpu, word src, word dst, word length, word ctrl)
+{
+    cpu->system_bus.write_word(DMA_BASE + DMA_SRC, src);
+    cpu->system_bus.write_word(DMA_BASE + DMA_DST, dst);
+    cpu->system_bus.write_word(DMA_BASE + DMA_LEN, length);
+    cpu->system_bus.write_word(DMA_BASE + DMA_CTRL, ctrl | DMA_CTRL_START);
+}
+
+static std::vector<byte> pattern(word length, word seed)
+{
+    std::vector<byte> bytes(length);
+    for (word i = 0; i < length; i++)
+    {
+        bytes[i] = (i * 7 + seed) ^ (i >> 8);
+    }
+    return bytes;
+}
+
+TEST (dma, ram_copy)
+{
+    Emulator32bit *cpu = new Emulator32bit(4, 0, {}, 0, 4);
+    std::vector<byte> data = pattern(PAGE_SIZE + 100, 3);
+    cpu->system_bus.write_buffer(PAGE_SIZE + 10, data.data(), data.size());
+
+    program(cpu, PAGE_SIZE + 10, 2 * PAGE_SIZE + 50, data.size(), 0);
+    EXPECT_EQ (cpu->system_bus.read_word(DMA_BASE + DMA_STATUS), DMA_STATUS_DONE);
+    EXPECT_EQ (cpu->system_bus.read_word(DMA_BASE + DMA_COUNT), data.size());
+    std::vector<byte> copied(data.size());
+    cpu->system_bus.read_buffer(2 * PAGE_SIZE + 50, copied.data(), copied.size());
+    EXPECT_EQ (copied == data, true);
+
+    cpu->system_bus.write_word(DMA_BASE + DMA_STATUS, DMA_STATUS_DONE);
+    EXPECT_EQ (cpu->system_bus.read_word(DMA_BASE + DMA_STATUS), 0);
+
+    /* past the end of RAM, and into ROM */
+    program(cpu, 3 * PAGE_SIZE, 0, PAGE_SIZE + 1, 0);
+    EXPECT_EQ (cpu->system_bus.read_word(DMA_BASE + DMA_STATUS), DMA_STATUS_ERROR);
+    EXPECT_EQ (cpu->system_bus.read_word(DMA_BASE + DMA_COUNT), 0);
+    delete cpu;
+}
+
+TEST (dma, disk_round_trip)
+{
+    static const byte rom_data[1] = {0};
+    RAM *ram = new RAM(RAM_NPAGES, 0);
+    ROM *rom = new ROM(rom_data, 0, RAM_NPAGES);
+    Disk *disk = new Disk(File(DISK_NAME, "bin", "", true), DISK_NPAGES, RAM_NPAGES);
+    Emulator32bit *cpu = new Emulator32bit(ram, rom, disk);
+
+    std::vector<byte> data = pattern(3 * PAGE_SIZE - 50, 11);
+    cpu->system_bus.write_buffer(PAGE_SIZE + 100, data.data(), data.size());
+
+    /* a cached, dirty disk page is part of the transfer */
+    disk->write_byte(DISK_START + 5 * PAGE_SIZE + 500, 0xAB);
+    program(cpu, PAGE_SIZE + 100, DISK_START + 2 * PAGE_SIZE + 100, data.size(), DMA_CTRL_ASYNC);
+    cpu->dma->wait();
+    EXPECT_EQ (cpu->system_bus.read_word(DMA_BASE + DMA_STATUS), DMA_STATUS_DONE);
+    EXPECT_EQ (cpu->system_bus.read_word(DMA_BASE + DMA_COUNT), data.size());
+    EXPECT_EQ (cpu->system_bus.read_byte(DISK_START + 2 * PAGE_SIZE + 100), data[0]);
+    EXPECT_EQ (cpu->system_bus.read_byte(DISK_START + 4 * PAGE_SIZE + 1000), data[2 * PAGE_SIZE + 900]);
+
+    program(cpu, DISK_START + 2 * PAGE_SIZE + 100, 5 * PAGE_SIZE, data.size(), 0);
+    EXPECT_EQ (cpu->system_bus.read_word(DMA_BASE + DMA_STATUS), DMA_STATUS_DONE);
+    std::vector<byte> copied(data.size());
+    cpu->system_bus.read_buffer(5 * PAGE_SIZE, copied.data(), copied.size());
+    EXPECT_EQ (copied == data, true);
+
+    /* disk to disk, through the file for whole pages */
+    program(cpu, DISK_START + 2 * PAGE_SIZE, DISK_START + 10 * PAGE_SIZE, 4 * PAGE_SIZE, 0);
+    EXPECT_EQ (cpu->system_bus.read_byte(DISK_START + 10 * PAGE_SIZE + 100), data[0]);
+    EXPECT_EQ (cpu->system_bus.read_byte(DISK_START + 13 * PAGE_SIZE + 500), 0xAB);
+
+    delete cpu;
+    std::remove(DISK_FILE);
+    std::remove(DISK_FILE ".info");
+}
+
+TEST (dma, completion_interrupt)
+{
+    Emulator32bit *cpu = new Emulator32bit(2, 0, {}, 0, 2);
+    for (word addr = 0; addr < VECTOR_TABLE; addr += 4)
+    {
+        cpu->system_bus.write_word(addr, Emulator32bit::asm_nop());
+    }
+    word done_vector = VECTOR_TABLE + Emulator32bit::DMA_DONE * 4;
+    cpu->system_bus.write_word(done_vector, Emulator32bit::asm_format_b1(Emulator32bit::_op_b,
+            Emulator32bit::ConditionCode::AL, (DONE_HANDLER - done_vector) / 4));
+    cpu->system_bus.write_word(DONE_HANDLER, Emulator32bit::asm_format_o(Emulator32bit::_op_add, false, 2, 2, 1));
+    cpu->system_bus.write_word(DONE_HANDLER + 4, Emulator32bit::asm_format_o(Emulator32bit::_op_add, false, NR, XZR, 139));
+    cpu->system_bus.write_word(DONE_HANDLER + 8, Emulator32bit::asm_format_b1(Emulator32bit::_op_swi,
+            Emulator32bit::ConditionCode::AL, 0));
+    cpu->set_vector_table(VECTOR_TABLE);
+
+    std::vector<byte> data = pattern(PAGE_SIZE, 5);
+    cpu->system_bus.write_buffer(0x400, data.data(), 0x400);
+    cpu->system_bus.write_word(DMA_BASE + DMA_SRC, 0x400);
+    cpu->system_bus.write_word(DMA_BASE + DMA_DST, PAGE_SIZE);
+    cpu->system_bus.write_word(DMA_BASE + DMA_LEN, 0x400);
+
+    /* str x0, [x1] starts the transfer, the guest waits for it in WFI */
+    cpu->system_bus.write_word(0, Emulator32bit::asm_format_m(Emulator32bit::_op_str, false, 0, 1, 0,
+            Emulator32bit::ADDR_OFFSET));
+    cpu->system_bus.write_word(4, Emulator32bit::asm_wfi());
+    cpu->write_reg(0, DMA_CTRL_START | DMA_CTRL_INTERRUPT | DMA_CTRL_ASYNC);
+    cpu->write_reg(1, DMA_BASE + DMA_CTRL);
+    cpu->write_reg(2, 0);
+    cpu->set_pc(0);
+
+    cpu->run(3);
+    EXPECT_EQ (cpu->get_pc(), DONE_HANDLER) << "WFI wakes up when the transfer completes";
+    EXPECT_EQ (cpu->system_bus.read_word(DMA_BASE + DMA_STATUS), DMA_STATUS_DONE);
+    EXPECT_EQ (cpu->system_bus.read_word(PAGE_SIZE + 0x3FC), cpu->system_bus.read_word(0x7FC));
+    cpu->run(2);
+    EXPECT_EQ (cpu->read_reg(2), 1);
+    cpu->run(1);
+    EXPECT_EQ (cpu->get_pc(), 8) << "returns after the WFI";
+
+    /* a synchronous transfer interrupts right after the instruction that started it */
+    cpu->write_reg(0, DMA_CTRL_START | DMA_CTRL_INTERRUPT);
+    cpu->set_pc(0);
+    cpu->run(1);
+    EXPECT_EQ (cpu->get_pc(), done_vector);
+    delete cpu;
+}
@@ -0,0 +1,247 @@
+#include "emulator32bit_test/emulator32bit_test.h"
+
+#include "emulator32bit/kernel/file_io.h"
+#include "emulator32bit/uart.h"
+
+#include <cerrno>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <string>
+
+/* Host files are POSIX only, see @ref FileManager */
+#ifndef _WIN32
+#include <fcntl.h>
+
+#define SANDBOX "file_io_test_sandbox"
+#define PATH_ADDRESS 0x1000
+#define BUFFER_ADDRESS 0x2800                   /* Halfway into a page so transfers cross pages */
+
+static std::string make_contents(word length)
+{
+    std::string contents(length, '\0');
+    for (word i = 0; i < length; i++)
+    {
+        contents[i] = 'a' + (i * 7) % 26;
+    }
+    return contents;
+}
+
+static std::string read_host_file(const std::string& path)
+{
+    std::ifstream file(path, std::ios::binary);
+    std::stringstream contents;
+    contents << file.rdbuf();
+    return contents.str();
+}
+
+static word guest_string(Emulator32bit *cpu, const std::string& str)
+{
+    cpu->system_bus.write_buffer(PATH_ADDRESS, (const byte*) str.c_str(), str.size() + 1);
+    return PATH_ADDRESS;
+}
+
+static Emulator32bit* create_sandboxed(long long& pid, const std::string& contents)
+{
+    std::filesystem::create_directory(SANDBOX);
+    std::ofstream(SANDBOX "/input.bin", std::ios::binary) << contents;
+
+    Emulator32bit *cpu = new Emulator32bit(16, 0, {}, 0, 16);
+    pid = cpu->mmu->begin_process();
+    cpu->mmu->add_vpage(pid, 1, 8, true, false);
+    cpu->file_manager->set_root(SANDBOX);
+    return cpu;
+}
+
+TEST (file_io, read_write_lseek)
+{
+    long long pid;
+    const std::string contents = make_contents(3 * PAGE_SIZE + 10);
+    Emulator32bit *cpu = create_sandboxed(pid, contents);
+    FileManager *files = cpu->file_manager;
+
+    word fd = files->openat(GUEST_AT_FDCWD, guest_string(cpu, "/input.bin"), O_RDONLY, 0);
+    EXPECT_EQ (fd, 3);
+    EXPECT_EQ (files->read(fd, BUFFER_ADDRESS, contents.size() + 100), contents.size()) << "stops at the end of the file";
+    std::string guest(contents.size(), '\0');
+    cpu->system_bus.read_buffer(BUFFER_ADDRESS, (byte*) guest.data(), guest.size());
+    EXPECT_EQ (guest, contents);
+    EXPECT_EQ (files->read(fd, BUFFER_ADDRESS, 10), 0);
+
+    EXPECT_EQ (files->lseek(fd, PAGE_SIZE, SEEK_SET), PAGE_SIZE);
+    EXPECT_EQ (files->read(fd, BUFFER_ADDRESS, 4), 4);
+    EXPECT_EQ (cpu->system_bus.read_byte(BUFFER_ADDRESS + 3), (byte) contents[PAGE_SIZE + 3]);
+
+    word out = files->openat(GUEST_AT_FDCWD, guest_string(cpu, "output.bin"), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    EXPECT_EQ (out, 4);
+    cpu->system_bus.write_buffer(BUFFER_ADDRESS, (const byte*) contents.data(), contents.size());
+    EXPECT_EQ (files->write(out, BUFFER_ADDRESS, contents.size()), contents.size());
+    EXPECT_EQ (files->close(out), 0);
+    EXPECT_EQ (files->close(out), (word) -EBADF);
+    EXPECT_EQ (read_host_file(SANDBOX "/output.bin"), contents);
+
+    EXPECT_EQ (files->openat(GUEST_AT_FDCWD, guest_string(cpu, "a/../../input.bin"), O_RDONLY, 0), (word) -EACCES)
+            << "paths cannot leave the sandbox";
+    EXPECT_EQ (files->openat(GUEST_AT_FDCWD, guest_string(cpu, "missing"), O_RDONLY, 0), (word) -ENOENT);
+    EXPECT_EQ (files->read(fd, 0x40000000, 10), (word) -EFAULT) << "unmapped buffer";
+
+    /* symlinks inside the sandbox are not followed, not even to files in it */
+    std::filesystem::create_directory(SANDBOX "/dir");
+    std::filesystem::create_directory_symlink(std::filesystem::absolute(SANDBOX).parent_path(), SANDBOX "/out");
+    std::filesystem::create_symlink(std::filesystem::absolute(SANDBOX "/input.bin"), SANDBOX "/dir/link.bin");
+    EXPECT_EQ (files->openat(GUEST_AT_FDCWD, guest_string(cpu, "out/" SANDBOX "/input.bin"), O_RDONLY, 0),
+               (word) -ENOTDIR) << "a directory link cannot leave the sandbox";
+    EXPECT_EQ (files->openat(GUEST_AT_FDCWD, guest_string(cpu, "dir/link.bin"), O_RDONLY, 0), (word) -ELOOP);
+    word nested = files->openat(GUEST_AT_FDCWD, guest_string(cpu, "/dir/../input.bin"), O_RDONLY, 0);
+    EXPECT_EQ (nested, 4);
+    EXPECT_EQ (files->close(nested), 0);
+
+    cpu->mmu->end_process(pid);
+    delete cpu;
+    std::filesystem::remove_all(SANDBOX);
+}
+
+TEST (file_io, console_write)
+{
+    long long pid;
+    const std::string contents = make_contents(2 * PAGE_SIZE);
+    Emulator32bit *cpu = create_sandboxed(pid, "");
+    FILE *output = tmpfile();
+    cpu->uart->set_output(output);
+    cpu->system_bus.write_buffer(BUFFER_ADDRESS, (const byte*) contents.data(), contents.size());
+
+    EXPECT_EQ (cpu->file_manager->write(1, BUFFER_ADDRESS, contents.size()), contents.size());
+
+    /* a huge count is not staged on the host, it stops where the guest's pages do */
+    const word mapped = (9 << PAGE_PSIZE) - BUFFER_ADDRESS;
+    EXPECT_EQ (cpu->file_manager->write(1, BUFFER_ADDRESS, 0x80000000), mapped);
+    EXPECT_EQ (cpu->file_manager->write(1, 0x40000000, 10), (word) -EFAULT);
+    cpu->uart->flush();
+
+    std::string written(contents.size() + mapped, '\0');
+    rewind(output);
+    EXPECT_EQ (fread(written.data(), 1, written.size(), output), written.size());
+    EXPECT_EQ (fgetc(output), EOF);
+    EXPECT_EQ (written.substr(0, contents.size()), contents);
+    EXPECT_EQ (written.substr(contents.size(), contents.size()), contents);
+
+    cpu->uart->set_output(stdout);
+    fclose(output);
+    cpu->mmu->end_process(pid);
+    delete cpu;
+    std::filesystem::remove_all(SANDBOX);
+}
+
+TEST (file_io, syscalls)
+{
+    long long pid;
+    const std::string contents = make_contents(100);
+    Emulator32bit *cpu = create_sandboxed(pid, contents);
+    cpu->mmu->add_vpage(pid, 0, 1, true, true);
+    guest_string(cpu, "input.bin");
+
+    /* fd = openat(AT_FDCWD, path, O_RDONLY, 0), read(fd, buf, 50) */
+    word program[] = {
+        Emulator32bit::asm_format_o(Emulator32bit::_op_sub, false, 0, XZR, 100),
+        Emulator32bit::asm_format_o(Emulator32bit::_op_add, false, 1, XZR, PATH_ADDRESS),
+        Emulator32bit::asm_format_o(Emulator32bit::_op_add, false, 2, XZR, O_RDONLY),
+        Emulator32bit::asm_format_o(Emulator32bit::_op_add, false, NR, XZR, 56),
+        Emulator32bit::asm_format_b1(Emulator32bit::_op_swi, Emulator32bit::ConditionCode::AL, 0),
+        Emulator32bit::asm_format_o(Emulator32bit::_op_add, false, 1, XZR, BUFFER_ADDRESS),
+        Emulator32bit::asm_format_o(Emulator32bit::_op_add, false, 2, XZR, 50),
+        Emulator32bit::asm_format_o(Emulator32bit::_op_add, false, NR, XZR, 63),
+        Emulator32bit::asm_format_b1(Emulator32bit::_op_swi, Emulator32bit::ConditionCode::AL, 0),
+    };
+    for (word i = 0; i < sizeof(program) / sizeof(program[0]); i++)
+    {
+        cpu->system_bus.write_word(i * 4, program[i]);
+    }
+    cpu->set_pc(0);
+    cpu->run(sizeof(program) / sizeof(program[0]));
+
+    EXPECT_EQ (cpu->read_reg(0), 50);
+    EXPECT_EQ (cpu->system_bus.read_byte(BUFFER_ADDRESS + 49), (byte) contents[49]);
+
+    cpu->mmu->end_process(pid);
+    delete cpu;
+    std::filesystem::remove_all(SANDBOX);
+}
+
+TEST (file_io, async_requests)
+{
+    long long pid;
+    const std::string contents = make_contents(4 * PAGE_SIZE);
+    Emulator32bit *cpu = create_sandboxed(pid, contents);
+    FileManager *files = cpu->file_manager;
+
+    const word ctxp = 0x1800;
+    const word iocbs = 0x1900;
+    const word iocbpp = 0x1A00;
+    const word events = 0x1B00;
+    EXPECT_EQ (files->io_setup(2, ctxp), 0);
+    word ctx = cpu->system_bus.read_word(ctxp);
+    word fd = files->openat(GUEST_AT_FDCWD, guest_string(cpu, "input.bin"), O_RDONLY, 0);
+
+    /* read the second page, then the first two, into the buffer after it */
+    const word requests[2][3] = {{PAGE_SIZE, PAGE_SIZE, BUFFER_ADDRESS}, {0, 2 * PAGE_SIZE, BUFFER_ADDRESS + PAGE_SIZE}};
+    for (word i = 0; i < 2; i++)
+    {
+        word iocb = iocbs + i * IOCB_SIZE;
+        word fields[6] = {100 + i, IOCB_CMD_PREAD, fd, requests[i][2], requests[i][1], requests[i][0]};
+        for (word field = 0; field < 6; field++)
+        {
+            cpu->system_bus.write_word(iocb + 4 * field, fields[field]);
+        }
+        cpu->system_bus.write_word(iocbpp + 4 * i, iocb);
+    }
+
+    EXPECT_EQ (files->io_submit(ctx, 2, iocbpp), 2);
+    EXPECT_EQ (files->io_submit(ctx, 1, iocbpp), (word) -EAGAIN) << "the context is full";
+    EXPECT_EQ (files->io_getevents(ctx, 2, 2, events, 0), 2);
+
+    word seen = 0;
+    for (word i = 0; i < 2; i++)
+    {
+        word data = cpu->system_bus.read_word(events + i * IO_EVENT_SIZE);
+        word iocb = cpu->system_bus.read_word(events + i * IO_EVENT_SIZE + 4);
+        EXPECT_EQ (iocb, iocbs + (data - 100) * IOCB_SIZE);
+        EXPECT_EQ (cpu->system_bus.read_word(events + i * IO_EVENT_SIZE + 8), requests[data - 100][1]);
+        seen |= 1 << (data - 100);
+    }
+    EXPECT_EQ (seen, 0b11);
+    EXPECT_EQ (files->io_getevents(ctx, 0, 2, events, 0), 0) << "nothing left to harvest";
+
+    std::string guest(3 * PAGE_SIZE, '\0');
+    cpu->system_bus.read_buffer(BUFFER_ADDRESS, (byte*) guest.data(), guest.size());
+    EXPECT_EQ (guest, contents.substr(PAGE_SIZE, PAGE_SIZE) + contents.substr(0, 2 * PAGE_SIZE));
+
+    EXPECT_EQ (files->io_destroy(ctx), 0);
+    EXPECT_EQ (files->io_destroy(ctx), (word) -EINVAL);
+    cpu->mmu->end_process(pid);
+    delete cpu;
+    std::filesystem::remove_all(SANDBOX);
+}
+
+TEST (file_io, pinned_pages_are_not_evicted)
+{
+    Emulator32bit *cpu = new Emulator32bit(4, 0, {}, 0, 4);
+    long long pid = cpu->mmu->begin_process();
+    cpu->mmu->add_vpage(pid, 16, 8, true, false);
+
+    std::vector<SystemBus::HostSpan> spans;
+    EXPECT_EQ (cpu->system_bus.pin_host_spans(16 * PAGE_SIZE, 8, true, spans, 1), 8);
+    ASSERT_EQ (spans.size(), 1);
+
+    /* touch more pages than there are physical ones */
+    for (word vpage = 17; vpage < 24; vpage++)
+    {
+        cpu->system_bus.write_word(vpage * PAGE_SIZE, vpage);
+    }
+    spans[0].data[0] = 42;
+    EXPECT_EQ (cpu->system_bus.read_byte(16 * PAGE_SIZE), 42) << "the host pointer still backs the page";
+    cpu->system_bus.unpin_host_spans(spans);
+
+    cpu->mmu->end_process(pid);
+    delete cpu;
+}
+#endif
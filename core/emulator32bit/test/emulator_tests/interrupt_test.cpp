@@ -0,0 +1,98 @@
+#include "emulator32bit_test/emulator32bit_test.h"
+
+#include "emulator32bit/timer.h"
+
+#define VECTOR_TABLE 0x100
+#define TIMER_HANDLER 0x200
+
+/*
+ * Loops incrementing x0 at address 0. The timer vector branches to a handler that runs
+ * 4 instructions, clobbering x1 and x8, and returns with rt_sigreturn.
+ */
+static Emulator32bit* create_timer_program()
+{
+    Emulator32bit *cpu = new Emulator32bit(1, 0, {}, 0, 1);
+    cpu->system_bus.write_word(0, Emulator32bit::asm_format_o(Emulator32bit::_op_add, false, 0, 0, 1));
+    cpu->system_bus.write_word(4, Emulator32bit::asm_format_b1(Emulator32bit::_op_b,
+            Emulator32bit::ConditionCode::AL, -1));
+
+    word timer_vector = VECTOR_TABLE + Emulator32bit::TIMER * 4;
+    cpu->system_bus.write_word(timer_vector, Emulator32bit::asm_format_b1(Emulator32bit::_op_b,
+            Emulator32bit::ConditionCode::AL, (TIMER_HANDLER - timer_vector) / 4));
+    cpu->system_bus.write_word(TIMER_HANDLER, Emulator32bit::asm_format_o(Emulator32bit::_op_add, false, 1, 1, 1));
+    cpu->system_bus.write_word(TIMER_HANDLER + 4, Emulator32bit::asm_format_o(Emulator32bit::_op_add, false, NR, XZR, 139));
+    cpu->system_bus.write_word(TIMER_HANDLER + 8, Emulator32bit::asm_format_b1(Emulator32bit::_op_swi,
+            Emulator32bit::ConditionCode::AL, 0));
+
+    cpu->set_vector_table(VECTOR_TABLE);
+    cpu->set_pc(0);
+    return cpu;
+}
+
+TEST (interrupt, events_run_in_deadline_order)
+{
+    Emulator32bit *cpu = new Emulator32bit(1, 0, {}, 0, 1);
+    for (word addr = 0; addr < 64; addr += 4)
+    {
+        cpu->system_bus.write_word(addr, Emulator32bit::asm_nop());
+    }
+    cpu->set_pc(0);
+
+    std::vector<std::pair<int, unsigned long long>> ran;
+    cpu->schedule_event(7, [&]() { ran.push_back({7, cpu->cycles()}); });
+    cpu->schedule_event(3, [&]() {
+        ran.push_back({3, cpu->cycles()});
+        cpu->schedule_event(0, [&]() { ran.push_back({0, cpu->cycles()}); });
+    });
+    EventScheduler::EventID cancelled = cpu->schedule_event(5, [&]() { ran.push_back({5, cpu->cycles()}); });
+    EXPECT_EQ (cpu->cancel_event(cancelled), true);
+    EXPECT_EQ (cpu->cancel_event(cancelled), false);
+
+    cpu->run(10);
+    ASSERT_EQ (ran.size(), 3);
+    EXPECT_EQ (ran[0], std::make_pair(3, 3ULL));
+    EXPECT_EQ (ran[1], std::make_pair(0, 3ULL)) << "events due now run before the processor resumes";
+    EXPECT_EQ (ran[2], std::make_pair(7, 7ULL));
+    EXPECT_EQ (cpu->cycles(), 10);
+    EXPECT_EQ (cpu->get_pc(), 40);
+    delete cpu;
+}
+
+TEST (interrupt, timer_preempts_and_returns)
+{
+    Emulator32bit *cpu = create_timer_program();
+    cpu->timer->start(10);
+    cpu->run(995);
+
+    /* each interrupt runs 4 handler instructions out of every 10 */
+    EXPECT_EQ (cpu->timer->time(), 99);
+    EXPECT_EQ (cpu->read_reg(0), 300);
+    EXPECT_EQ (cpu->read_reg(1), 0) << "registers are restored from the interrupt frame";
+    EXPECT_EQ (cpu->read_reg(NR), 0);
+    EXPECT_EQ (cpu->get_flag(IRQ_MASK_FLAG), false);
+    EXPECT_EQ (cpu->get_pc() < 8, true) << "returned to the interrupted loop";
+
+    cpu->timer->stop();
+    cpu->run(100);
+    EXPECT_EQ (cpu->timer->time(), 99);
+    EXPECT_EQ (cpu->read_reg(0), 350);
+    delete cpu;
+}
+
+TEST (interrupt, masked_interrupts_are_held)
+{
+    Emulator32bit *cpu = create_timer_program();
+    cpu->set_flag(IRQ_MASK_FLAG, true);
+    cpu->timer->start(10);
+    cpu->run(100);
+
+    EXPECT_EQ (cpu->timer->time(), 10);
+    EXPECT_EQ (cpu->read_reg(0), 50);
+
+    /* the held ticks collapse into the next one delivered */
+    cpu->set_flag(IRQ_MASK_FLAG, false);
+    cpu->run(15);
+    EXPECT_EQ (cpu->read_reg(0), 56) << "4 of the 15 instructions ran in the handler";
+    EXPECT_EQ (cpu->get_pc() < 8, true);
+    delete cpu;
+}
@@ -0,0 +1,96 @@
+#include "emulator32bit_test/emulator32bit_test.h"
+
+#include "emulator32bit/kernel/malloc.h"
+
+#include <cerrno>
+
+TEST (memory_manager, brk_maps_zeroed_pages)
+{
+    Emulator32bit *cpu = new Emulator32bit(8, 0, {}, 0, 8);
+    long long pid = cpu->mmu->begin_process();
+    cpu->memory_manager->set_break(pid, 0x1234);
+
+    EXPECT_EQ (cpu->memory_manager->brk(pid, 0), 0x2000);
+    EXPECT_EQ (cpu->memory_manager->brk(pid, 0x3010), 0x3010);
+    EXPECT_EQ (cpu->mmu->has_vpage(pid, 2), true);
+    EXPECT_EQ (cpu->mmu->has_vpage(pid, 3), true);
+    EXPECT_EQ (cpu->mmu->has_vpage(pid, 4), false);
+    EXPECT_EQ (cpu->system_bus.read_word(0x3000), 0);
+    cpu->system_bus.write_word(0x2000, 7);
+
+    EXPECT_EQ (cpu->memory_manager->brk(pid, 0x2001), 0x2001);
+    EXPECT_EQ (cpu->mmu->has_vpage(pid, 3), false) << "shrinking unmaps pages past the break";
+    EXPECT_EQ (cpu->system_bus.read_word(0x2000), 7);
+    EXPECT_EQ (cpu->memory_manager->brk(pid, 0x1000), 0x2001) << "cannot move below the heap start";
+
+    cpu->mmu->end_process(pid);
+    delete cpu;
+}
+
+TEST (memory_manager, mmap_and_munmap)
+{
+    Emulator32bit *cpu = new Emulator32bit(8, 0, {}, 0, 8);
+    long long pid = cpu->mmu->begin_process();
+
+    word a = cpu->memory_manager->mmap(pid, 3 * PAGE_SIZE, MMAP_PROT_WRITE, MMAP_ANONYMOUS);
+    word b = cpu->memory_manager->mmap(pid, 1, MMAP_PROT_WRITE, MMAP_ANONYMOUS);
+    EXPECT_EQ (a, MMAP_START);
+    EXPECT_EQ (b, MMAP_START + 3 * PAGE_SIZE);
+    cpu->system_bus.write_word(a + PAGE_SIZE, 5);
+    EXPECT_EQ (cpu->system_bus.read_word(a + PAGE_SIZE), 5);
+    EXPECT_EQ (cpu->mmu->can_write_vpage(pid, b >> PAGE_PSIZE), true);
+
+    EXPECT_EQ (cpu->memory_manager->mmap(pid, PAGE_SIZE, 0, 0), (word) -EINVAL) << "file mappings are not supported";
+    EXPECT_EQ (cpu->memory_manager->munmap(pid, a + 1, PAGE_SIZE), (word) -EINVAL);
+
+    /* unmap the middle page, the hole is reused by the next single page mapping */
+    EXPECT_EQ (cpu->memory_manager->munmap(pid, a + PAGE_SIZE, PAGE_SIZE), 0);
+    EXPECT_EQ (cpu->mmu->has_vpage(pid, (a >> PAGE_PSIZE) + 1), false);
+    EXPECT_EQ (cpu->memory_manager->munmap(pid, a + PAGE_SIZE, PAGE_SIZE), (word) -EINVAL);
+    EXPECT_EQ (cpu->memory_manager->mmap(pid, PAGE_SIZE, MMAP_PROT_WRITE, MMAP_ANONYMOUS), a + PAGE_SIZE);
+    EXPECT_EQ (cpu->system_bus.read_word(a + PAGE_SIZE), 0) << "remapped pages are zeroed";
+
+    cpu->mmu->end_process(pid);
+    delete cpu;
+}
+
+TEST (memory_manager, syscalls)
+{
+    Emulator32bit *cpu = new Emulator32bit(8, 0, {}, 0, 8);
+    long long pid = cpu->mmu->begin_process();
+    cpu->mmu->add_vpage(pid, 0, 1, true, true);
+    cpu->memory_manager->set_break(pid, PAGE_SIZE);
+
+    /* mmap(0, 100, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0), brk(0x1800) */
+    word program[] = {
+        Emulator32bit::asm_format_o(Emulator32bit::_op_add, false, 1, XZR, 100),
+        Emulator32bit::asm_format_o(Emulator32bit::_op_add, false, 2, XZR, 3),
+        Emulator32bit::asm_format_o(Emulator32bit::_op_add, false, 3, XZR, 0x22),
+        Emulator32bit::asm_format_o(Emulator32bit::_op_add, false, NR, XZR, 222),
+        Emulator32bit::asm_format_b1(Emulator32bit::_op_swi, Emulator32bit::ConditionCode::AL, 0),
+        Emulator32bit::asm_format_o(Emulator32bit::_op_add, false, 10, 0, 0),
+        Emulator32bit::asm_format_o(Emulator32bit::_op_add, false, 0, XZR, 0x1800),
+        Emulator32bit::asm_format_o(Emulator32bit::_op_add, false, NR, XZR, 214),
+        Emulator32bit::asm_format_b1(Emulator32bit::_op_swi, Emulator32bit::ConditionCode::AL, 0),
+        Emulator32bit::asm_format_o(Emulator32bit::_op_add, false, 11, 0, 0),
+        Emulator32bit::asm_format_o(Emulator32bit::_op_add, false, 0, 10, 0),
+        Emulator32bit::asm_format_o(Emulator32bit::_op_add, false, 1, XZR, 100),
+        Emulator32bit::asm_format_o(Emulator32bit::_op_add, false, NR, XZR, 215),
+        Emulator32bit::asm_format_b1(Emulator32bit::_op_swi, Emulator32bit::ConditionCode::AL, 0),
+    };
+    for (word i = 0; i < sizeof(program) / sizeof(program[0]); i++)
+    {
+        cpu->system_bus.write_word(i * 4, program[i]);
+    }
+    cpu->set_pc(0);
+    cpu->run(sizeof(program) / sizeof(program[0]));
+
+    EXPECT_EQ (cpu->read_reg(10), MMAP_START);
+    EXPECT_EQ (cpu->read_reg(11), 0x1800);
+    EXPECT_EQ (cpu->read_reg(0), 0);
+    EXPECT_EQ (cpu->mmu->has_vpage(pid, MMAP_START >> PAGE_PSIZE), false);
+    EXPECT_EQ (cpu->mmu->has_vpage(pid, 1), true);
+
+    cpu->mmu->end_process(pid);
+    delete cpu;
+}
@@ -0,0 +1,389 @@
+#include "emulator32bit_test/emulator32bit_test.h"
+
+#include "emulator32bit/kernel/better_virtual_memory.h"
+
+#include <cerrno>
+#include <cstdio>
+
+/* Physical page 0 is left out so the page directory is never at the null address. */
+#define KERNEL_NPAGES 16
+#define USER_LOW_PAGE (KERNEL_NPAGES + 1)
+#define USER_NPAGES 8
+#define DISK_NPAGES 64
+#define VPAGE_BASE 0x10000
+#define DISK_NAME "mmu_test_disk"
+#define DISK_FILE DISK_NAME ".bin"
+
+static Emulator32bit *create_emulator()
+{
+    static const byte rom_data[1] = {0};
+    RAM *ram = new RAM(USER_LOW_PAGE + USER_NPAGES, 0);
+    ROM *rom = new ROM(rom_data, 0, USER_LOW_PAGE + USER_NPAGES);
+    Disk *disk = new Disk(File(DISK_NAME, "bin", "", true), DISK_NPAGES, USER_LOW_PAGE + USER_NPAGES);
+    return new Emulator32bit(ram, rom, disk);
+}
+
+static void destroy_emulator(Emulator32bit *cpu)
+{
+    delete cpu;
+    std::remove(DISK_FILE);
+    std::remove(DISK_FILE ".info");
+}
+
+static word read_vword(Emulator32bit *cpu, MMU& mmu, word vpage)
+{
+    return cpu->ram->read_word(mmu.map_address(vpage << PAGE_PSIZE, MMU::READ_ACCESSMODE));
+}
+
+static void write_vword(Emulator32bit *cpu, MMU& mmu, word vpage, word value)
+{
+    cpu->ram->write_word(mmu.map_address(vpage << PAGE_PSIZE, MMU::WRITE_ACCESSMODE), value);
+}
+
+TEST (mmu, zero_fill_on_first_touch)
+{
+    Emulator32bit *cpu = create_emulator();
+    MMU mmu(cpu, USER_LOW_PAGE, USER_LOW_PAGE + USER_NPAGES - 1, 1, KERNEL_NPAGES);
+    mmu.create_pagedir();
+    mmu.add_vpage(VPAGE_BASE, false, true, false, false);
+
+    EXPECT_EQ (read_vword(cpu, mmu, VPAGE_BASE), 0);
+    EXPECT_EQ (mmu.get_stats().zero_fills, 1);
+    EXPECT_EQ (mmu.get_stats().evictions, 0);
+
+    EXPECT_THROW (mmu.add_vpage(VPAGE_BASE, false, true, false, false), MMU::Exception);
+    EXPECT_THROW (mmu.map_address((VPAGE_BASE + 1) << PAGE_PSIZE, MMU::READ_ACCESSMODE),
+                  Emulator32bit::Exception);
+
+    mmu.remove_pagedir();
+    destroy_emulator(cpu);
+}
+
+TEST (mmu, swap_working_set_larger_than_ram)
+{
+    Emulator32bit *cpu = create_emulator();
+    MMU mmu(cpu, USER_LOW_PAGE, USER_LOW_PAGE + USER_NPAGES - 1, 1, KERNEL_NPAGES);
+    mmu.create_pagedir();
+
+    const word nvpages = USER_NPAGES * 3;
+    for (word i = 0; i < nvpages; i++)
+    {
+        mmu.add_vpage(VPAGE_BASE + i, false, true, false, false);
+        write_vword(cpu, mmu, VPAGE_BASE + i, 0xC0DE0000 + i);
+    }
+
+    for (word i = 0; i < nvpages; i++)
+    {
+        EXPECT_EQ (read_vword(cpu, mmu, VPAGE_BASE + i), 0xC0DE0000 + i);
+    }
+
+    EXPECT_GT (mmu.get_stats().evictions, 0);
+    EXPECT_GT (mmu.get_stats().write_backs, 0);
+    EXPECT_GT (mmu.get_stats().page_ins, 0);
+
+    mmu.remove_pagedir();
+    destroy_emulator(cpu);
+}
+
+TEST (mmu, clean_pages_are_dropped)
+{
+    Emulator32bit *cpu = create_emulator();
+    MMU mmu(cpu, USER_LOW_PAGE, USER_LOW_PAGE + USER_NPAGES - 1, 1, KERNEL_NPAGES);
+    mmu.create_pagedir();
+
+    const word nvpages = USER_NPAGES * 2;
+    for (word i = 0; i < nvpages; i++)
+    {
+        mmu.add_vpage(VPAGE_BASE + i, false, true, false, false);
+        write_vword(cpu, mmu, VPAGE_BASE + i, i);
+    }
+
+    /* The first read pass writes back the pages still dirty from the writes. */
+    for (word i = 0; i < nvpages; i++)
+    {
+        EXPECT_EQ (read_vword(cpu, mmu, VPAGE_BASE + i), i);
+    }
+
+    unsigned long long write_backs = mmu.get_stats().write_backs;
+    unsigned long long evictions = mmu.get_stats().evictions;
+    for (int pass = 0; pass < 3; pass++)
+    {
+        for (word i = 0; i < nvpages; i++)
+        {
+            EXPECT_EQ (read_vword(cpu, mmu, VPAGE_BASE + i), i);
+        }
+    }
+
+    EXPECT_GT (mmu.get_stats().evictions, evictions);
+    EXPECT_EQ (mmu.get_stats().write_backs, write_backs) << "clean victims should not be written back";
+
+    mmu.remove_pagedir();
+    destroy_emulator(cpu);
+}
+
+TEST (mmu, second_chance)
+{
+    Emulator32bit *cpu = create_emulator();
+    MMU mmu(cpu, USER_LOW_PAGE, USER_LOW_PAGE + USER_NPAGES - 1, 1, KERNEL_NPAGES);
+    mmu.create_pagedir();
+
+    for (word i = 0; i <= USER_NPAGES; i++)
+    {
+        mmu.add_vpage(VPAGE_BASE + i, false, true, false, false);
+    }
+
+    /* Fill physical memory, then fault in one more page so the hand clears every reference bit. */
+    for (word i = 0; i <= USER_NPAGES; i++)
+    {
+        read_vword(cpu, mmu, VPAGE_BASE + i);
+    }
+    EXPECT_EQ (mmu.get_stats().evictions, 1);
+
+    /* The hot page is referenced again, so the next fault must pick another victim. */
+    read_vword(cpu, mmu, VPAGE_BASE + 1);
+    read_vword(cpu, mmu, VPAGE_BASE);
+    EXPECT_EQ (mmu.get_stats().evictions, 2);
+
+    unsigned long long zero_fills = mmu.get_stats().zero_fills;
+    read_vword(cpu, mmu, VPAGE_BASE + 1);
+    EXPECT_EQ (mmu.get_stats().zero_fills, zero_fills) << "referenced page should still be resident";
+
+    mmu.remove_pagedir();
+    destroy_emulator(cpu);
+}
+
+TEST (mmu, page_walk_cache)
+{
+    Emulator32bit *cpu = create_emulator();
+    MMU mmu(cpu, USER_LOW_PAGE, USER_LOW_PAGE + USER_NPAGES - 1, 1, KERNEL_NPAGES);
+
+    /* Two processes map the same virtual page, the walk cache is tagged by page directory. */
+    mmu.create_pagedir();
+    word pagedir1 = cpu->_pagedir;
+    mmu.add_vpage(VPAGE_BASE, false, true, false, false);
+    write_vword(cpu, mmu, VPAGE_BASE, 1);
+
+    mmu.create_pagedir();
+    word pagedir2 = cpu->_pagedir;
+    mmu.add_vpage(VPAGE_BASE, false, true, false, false);
+    write_vword(cpu, mmu, VPAGE_BASE, 2);
+
+    unsigned long long misses = mmu.get_stats().pwc_misses;
+    EXPECT_EQ (read_vword(cpu, mmu, VPAGE_BASE), 2);
+    EXPECT_EQ (mmu.get_stats().pwc_misses, misses) << "same page table should hit the walk cache";
+
+    cpu->_pagedir = pagedir1;
+    EXPECT_EQ (read_vword(cpu, mmu, VPAGE_BASE), 1);
+    EXPECT_EQ (mmu.get_stats().pwc_misses, misses + 1);
+
+    /* Removing the only page frees its page table, the region is unmapped again. */
+    mmu.remove_vpage(VPAGE_BASE);
+    EXPECT_THROW (read_vword(cpu, mmu, VPAGE_BASE), Emulator32bit::Exception);
+    mmu.remove_pagedir();
+
+    cpu->_pagedir = pagedir2;
+    EXPECT_EQ (read_vword(cpu, mmu, VPAGE_BASE), 2);
+    mmu.remove_pagedir();
+
+    /* Every kernel page is free again, so a process can map one page in each region. */
+    mmu.create_pagedir();
+    for (word i = 0; i < KERNEL_NPAGES - 1; i++)
+    {
+        mmu.add_vpage(VPAGE_BASE + (i << 10), false, true, false, false);
+    }
+    EXPECT_THROW (mmu.add_vpage(VPAGE_BASE + ((KERNEL_NPAGES - 1) << 10), false, true, false, false),
+                  MMU::Exception);
+    mmu.remove_pagedir();
+
+    destroy_emulator(cpu);
+}
+
+TEST (mmu, fork_copy_on_write)
+{
+    Emulator32bit *cpu = create_emulator();
+    MMU mmu(cpu, USER_LOW_PAGE, USER_LOW_PAGE + USER_NPAGES - 1, 1, KERNEL_NPAGES);
+    mmu.create_pagedir();
+    word parent = cpu->_pagedir;
+
+    mmu.add_vpage(VPAGE_BASE, false, true, false, false);
+    mmu.add_vpage(VPAGE_BASE + 1, false, true, false, false);
+    mmu.add_vpage(VPAGE_BASE + 2, false, true, false, false);
+    write_vword(cpu, mmu, VPAGE_BASE, 1);
+    write_vword(cpu, mmu, VPAGE_BASE + 1, 2);
+    unsigned long long zero_fills = mmu.get_stats().zero_fills;
+
+    /* fork through the syscall, the child page directory is returned in x0. */
+    cpu->kernel_mmu = &mmu;
+    cpu->system_bus.write_word(0, Emulator32bit::asm_format_b1(Emulator32bit::_op_swi,
+                               Emulator32bit::ConditionCode::AL, 0));
+    cpu->write_reg(NR, 220);
+    cpu->set_pc(0);
+    cpu->run(1);
+    word child = cpu->read_reg(0);
+    ASSERT_NE (child, 0);
+    ASSERT_NE (child, parent);
+
+    cpu->_pagedir = child;
+    EXPECT_EQ (read_vword(cpu, mmu, VPAGE_BASE), 1);
+    EXPECT_EQ (read_vword(cpu, mmu, VPAGE_BASE + 1), 2);
+    EXPECT_EQ (mmu.get_stats().cow_copies, 0) << "reads share the parent pages";
+
+    write_vword(cpu, mmu, VPAGE_BASE, 10);
+    EXPECT_EQ (mmu.get_stats().cow_copies, 1);
+    EXPECT_EQ (read_vword(cpu, mmu, VPAGE_BASE), 10);
+
+    cpu->_pagedir = parent;
+    EXPECT_EQ (read_vword(cpu, mmu, VPAGE_BASE), 1) << "parent keeps its copy";
+
+    /* The child copied it, so the parent is the last mapping and takes the page over. */
+    write_vword(cpu, mmu, VPAGE_BASE, 11);
+    EXPECT_EQ (mmu.get_stats().cow_copies, 1);
+
+    /* Untouched pages are not shared, each process zero fills its own. */
+    write_vword(cpu, mmu, VPAGE_BASE + 2, 3);
+    cpu->_pagedir = child;
+    EXPECT_EQ (read_vword(cpu, mmu, VPAGE_BASE + 2), 0);
+    EXPECT_EQ (mmu.get_stats().zero_fills, zero_fills + 2);
+
+    mmu.remove_pagedir();
+    cpu->_pagedir = parent;
+    EXPECT_EQ (read_vword(cpu, mmu, VPAGE_BASE + 1), 2);
+    mmu.remove_pagedir();
+
+    cpu->kernel_mmu = nullptr;
+    destroy_emulator(cpu);
+}
+
+TEST (mmu, fork_then_parent_exits)
+{
+    Emulator32bit *cpu = create_emulator();
+    MMU mmu(cpu, USER_LOW_PAGE, USER_LOW_PAGE + USER_NPAGES - 1, 1, KERNEL_NPAGES);
+    mmu.create_pagedir();
+
+    for (word i = 0; i < USER_NPAGES; i++)
+    {
+        mmu.add_vpage(VPAGE_BASE + i, false, true, false, false);
+        write_vword(cpu, mmu, VPAGE_BASE + i, i);
+    }
+    word child = mmu.fork_pagedir();
+
+    /* The parent owned every page, once it exits the child is the only mapping left. */
+    mmu.remove_pagedir();
+    cpu->_pagedir = child;
+
+    /* Memory is full of the pages the child was left with, they are evicted to make room. */
+    mmu.add_vpage(VPAGE_BASE + USER_NPAGES, false, true, false, false);
+    write_vword(cpu, mmu, VPAGE_BASE + USER_NPAGES, USER_NPAGES);
+    EXPECT_EQ (mmu.get_stats().evictions, 1);
+    for (word i = 0; i <= USER_NPAGES; i++)
+    {
+        EXPECT_EQ (read_vword(cpu, mmu, VPAGE_BASE + i), i);
+    }
+
+    mmu.remove_pagedir();
+    destroy_emulator(cpu);
+}
+
+TEST (mmu, fork_out_of_kernel_pages)
+{
+    Emulator32bit *cpu = create_emulator();
+    MMU mmu(cpu, USER_LOW_PAGE, USER_LOW_PAGE + USER_NPAGES - 1, 1, KERNEL_NPAGES);
+    mmu.create_pagedir();
+    for (word i = 0; i < KERNEL_NPAGES - 1; i++)
+    {
+        mmu.add_vpage(VPAGE_BASE + (i << 10), false, true, false, false);
+    }
+
+    /* Every kernel page holds the parent's tables, the child's cannot be allocated. */
+    cpu->kernel_mmu = &mmu;
+    cpu->system_bus.write_word(0, Emulator32bit::asm_format_b1(Emulator32bit::_op_swi,
+                               Emulator32bit::ConditionCode::AL, 0));
+    cpu->write_reg(NR, 220);
+    cpu->set_pc(0);
+    cpu->run(1);
+    EXPECT_EQ (cpu->read_reg(0), (word) -ENOMEM);
+    EXPECT_EQ (cpu->get_pc(), 4);
+
+    mmu.remove_pagedir();
+    cpu->kernel_mmu = nullptr;
+    destroy_emulator(cpu);
+}
+
+TEST (mmu, fork_out_of_user_pages)
+{
+    Emulator32bit *cpu = create_emulator();
+    MMU mmu(cpu, USER_LOW_PAGE, USER_LOW_PAGE + USER_NPAGES - 1, 1, KERNEL_NPAGES);
+    mmu.create_pagedir();
+
+    const word nvpages = USER_NPAGES * 2;
+    for (word i = 0; i < nvpages; i++)
+    {
+        mmu.add_vpage(VPAGE_BASE + i, false, true, false, false);
+        write_vword(cpu, mmu, VPAGE_BASE + i, i);
+    }
+
+    /* Sharing every page needs them all resident, more than fit in memory. */
+    word parent = cpu->_pagedir;
+    EXPECT_THROW (mmu.fork_pagedir(), MMU::Exception);
+    EXPECT_EQ (cpu->_pagedir, parent);
+
+    /* Nothing was left shared or pinned, every page still swaps and writes in place. */
+    for (word i = 0; i < nvpages; i++)
+    {
+        write_vword(cpu, mmu, VPAGE_BASE + i, i + 1);
+    }
+    for (word i = 0; i < nvpages; i++)
+    {
+        EXPECT_EQ (read_vword(cpu, mmu, VPAGE_BASE + i), i + 1);
+    }
+    EXPECT_EQ (mmu.get_stats().cow_copies, 0);
+
+    mmu.remove_pagedir();
+    destroy_emulator(cpu);
+}
+
+TEST (mmu, huge_page)
+{
+    static const byte rom_data[1] = {0};
+    const word nuser = HUGE_PAGE_NPAGES + USER_NPAGES;
+    RAM *ram = new RAM(USER_LOW_PAGE + nuser, 0);
+    ROM *rom = new ROM(rom_data, 0, USER_LOW_PAGE + nuser);
+    Disk *disk = new Disk(File(DISK_NAME, "bin", "", true), DISK_NPAGES, USER_LOW_PAGE + nuser);
+    Emulator32bit *cpu = new Emulator32bit(ram, rom, disk);
+    MMU mmu(cpu, USER_LOW_PAGE, USER_LOW_PAGE + nuser - 1, 1, KERNEL_NPAGES);
+    mmu.create_pagedir();
+
+    const word huge_vpage = VPAGE_BASE;
+    EXPECT_THROW (mmu.add_huge_vpage(huge_vpage + 1, false, true, false), MMU::Exception);
+    mmu.add_huge_vpage(huge_vpage, false, true, false);
+    EXPECT_THROW (mmu.add_vpage(huge_vpage + 3, false, true, false, false), MMU::Exception);
+    EXPECT_THROW (mmu.remove_vpage(huge_vpage + 3), MMU::Exception);
+    EXPECT_THROW (mmu.map_address(huge_vpage << PAGE_PSIZE, MMU::EXECUTE_ACCESSMODE),
+                  Emulator32bit::Exception);
+
+    /* Contiguous physical pages, one directory entry and no page table. */
+    word base = mmu.map_address(huge_vpage << PAGE_PSIZE, MMU::WRITE_ACCESSMODE);
+    EXPECT_EQ (mmu.map_address(((huge_vpage + 700) << PAGE_PSIZE) + 12, MMU::READ_ACCESSMODE),
+               base + 700 * PAGE_SIZE + 12);
+    write_vword(cpu, mmu, huge_vpage + 700, 7);
+    EXPECT_EQ (read_vword(cpu, mmu, huge_vpage), 0) << "huge pages are zero filled";
+
+    /* Small pages still swap in the remaining user pages without evicting the huge page. */
+    for (word i = 0; i < USER_NPAGES * 2; i++)
+    {
+        mmu.add_vpage(VPAGE_BASE + HUGE_PAGE_NPAGES + i, false, true, false, false);
+        write_vword(cpu, mmu, VPAGE_BASE + HUGE_PAGE_NPAGES + i, i);
+    }
+    EXPECT_GT (mmu.get_stats().evictions, 0);
+    EXPECT_EQ (read_vword(cpu, mmu, huge_vpage + 700), 7);
+
+    /* Not enough user pages are left for a forked copy of the huge page. */
+    EXPECT_THROW (mmu.fork_pagedir(), MMU::Exception);
+
+    mmu.remove_huge_vpage(huge_vpage);
+    EXPECT_THROW (read_vword(cpu, mmu, huge_vpage), Emulator32bit::Exception);
+    mmu.add_huge_vpage(huge_vpage, false, true, false);
+
+    mmu.remove_pagedir();
+    destroy_emulator(cpu);
+}
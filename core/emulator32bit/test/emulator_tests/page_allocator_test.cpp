@@ -0,0 +1,64 @@
+#include "emulator32bit_test/emulator32bit_test.h"
+
+#include "emulator32bit/page_allocator.h"
+
+
+TEST (page_allocator, lowest_first)
+{
+    PageAllocator allocator (4, 200);
+    ASSERT_EQ (allocator.available (), 200);
+
+    for (word page = 4; page < 204; page++)
+    {
+        ASSERT_EQ (allocator.alloc (), page);
+    }
+    ASSERT_EQ (allocator.available (), 0);
+    ASSERT_THROW (allocator.alloc (), PageAllocator::PageAllocatorException);
+
+    allocator.free (150);
+    allocator.free (70);
+    ASSERT_EQ (allocator.alloc (), 70);
+    ASSERT_EQ (allocator.alloc (), 150);
+}
+
+TEST (page_allocator, free_checks_pages)
+{
+    PageAllocator allocator (0, 64);
+    word page = allocator.alloc ();
+    allocator.free (page);
+    ASSERT_THROW (allocator.free (page), PageAllocator::PageAllocatorException);
+    ASSERT_THROW (allocator.free (64), PageAllocator::PageAllocatorException);
+    ASSERT_EQ (allocator.available (), 64);
+}
+
+TEST (page_allocator, reserve)
+{
+    PageAllocator allocator (0, 130);
+    allocator.reserve (65);
+    ASSERT_EQ (allocator.is_free (65), false);
+    ASSERT_THROW (allocator.reserve (65), PageAllocator::PageAllocatorException);
+    ASSERT_EQ (allocator.available (), 129);
+
+    allocator.free (65);
+    ASSERT_EQ (allocator.is_free (65), true);
+}
+
+TEST (page_allocator, contiguous)
+{
+    PageAllocator allocator (0, 300);
+    for (word i = 0; i < 300; i++)
+    {
+        allocator.alloc ();
+    }
+
+    /* a hole of 3 pages, then one of 100 spanning several words */
+    allocator.free (10, 3);
+    allocator.free (100, 100);
+    ASSERT_EQ (allocator.can_fit (100), true);
+    ASSERT_EQ (allocator.can_fit (101), false);
+    ASSERT_EQ (allocator.alloc_contiguous (2), 10);
+    ASSERT_EQ (allocator.alloc_contiguous (64), 100);
+    ASSERT_EQ (allocator.alloc_contiguous (36), 164);
+    ASSERT_THROW (allocator.alloc_contiguous (2), PageAllocator::PageAllocatorException);
+    ASSERT_EQ (allocator.alloc (), 12);
+}
@@ -0,0 +1,129 @@
+#include "emulator32bit_test/emulator32bit_test.h"
+
+#include "emulator32bit/kernel/malloc.h"
+#include "emulator32bit/kernel/process.h"
+#include "emulator32bit/virtual_memory.h"
+
+/*
+ * Spawns a process that loops incrementing x0, at virtual address 0 of its own address space.
+ */
+static Process* spawn_counter(Emulator32bit *cpu, ProcessScheduler& scheduler)
+{
+    Process *process = scheduler.spawn(0, PAGE_SIZE);
+    long long cur_pid = cpu->mmu->current_process();
+    cpu->mmu->add_vpage(process->pid, 0, 1, true, true);
+    cpu->mmu->set_process(process->pid);
+    cpu->system_bus.write_word(0, Emulator32bit::asm_format_o(Emulator32bit::_op_add, false, 0, 0, 1));
+    cpu->system_bus.write_word(4, Emulator32bit::asm_format_b1(Emulator32bit::_op_b,
+            Emulator32bit::ConditionCode::AL, -1));
+    if (cur_pid >= 0)
+    {
+        cpu->mmu->set_process(cur_pid);
+    }
+    return process;
+}
+
+TEST (process, context_round_trip)
+{
+    Emulator32bit *cpu = new Emulator32bit(1, 0, {}, 0, 1);
+    for (int reg = 0; reg < XZR; reg++)
+    {
+        cpu->write_reg(reg, reg * 3 + 1);
+    }
+    cpu->set_pc(0x40);
+    cpu->set_NZCV(true, false, true, false);
+    cpu->_pagedir = 0x1000;
+
+    Emulator32bit::ProcessContext context;
+    cpu->save_context(context);
+    cpu->reset();
+    cpu->_pagedir = 0;
+    EXPECT_EQ (context.read_reg(5), 16);
+
+    cpu->restore_context(context);
+    for (int reg = 0; reg < XZR; reg++)
+    {
+        EXPECT_EQ (cpu->read_reg(reg), reg * 3 + 1);
+    }
+    EXPECT_EQ (cpu->read_reg(XZR), 0) << "the zero register mask is restored with the value";
+    EXPECT_EQ (cpu->get_pc(), 0x40);
+    EXPECT_EQ (cpu->get_flag(N_FLAG), true);
+    EXPECT_EQ (cpu->get_flag(C_FLAG), true);
+    EXPECT_EQ (cpu->_pagedir, 0x1000);
+    delete cpu;
+}
+
+TEST (process, round_robin)
+{
+    Emulator32bit *cpu = new Emulator32bit(8, 0, {}, 0, 8);
+    {
+        ProcessScheduler scheduler(cpu, 100);
+        Process *processes[3];
+        for (int i = 0; i < 3; i++)
+        {
+            processes[i] = spawn_counter(cpu, scheduler);
+        }
+
+        scheduler.start();
+        EXPECT_EQ (scheduler.current(), processes[0]);
+        EXPECT_EQ (cpu->read_reg(SP), PAGE_SIZE);
+        cpu->run(3000);
+
+        /* every process ran 10 quanta of a 2 instruction loop */
+        EXPECT_EQ (scheduler.switches(), 31);
+        EXPECT_EQ (scheduler.current(), processes[0]);
+        EXPECT_EQ (cpu->read_reg(0), 500);
+        EXPECT_EQ (processes[1]->context.read_reg(0), 500);
+        EXPECT_EQ (processes[2]->context.read_reg(0), 500);
+        EXPECT_EQ (cpu->mmu->current_process(), processes[0]->pid);
+
+        scheduler.exit(processes[0]);
+        EXPECT_EQ (scheduler.current(), processes[1]);
+        cpu->run(200);
+        EXPECT_EQ (processes[2]->context.read_reg(0), 550);
+        EXPECT_EQ (cpu->read_reg(0), 550);
+
+        scheduler.stop();
+        cpu->run(200);
+        EXPECT_EQ (scheduler.current(), processes[1]) << "no preemption once stopped";
+        EXPECT_EQ (cpu->read_reg(0), 650);
+    }
+    delete cpu;
+}
+
+TEST (process, switches_keep_tlb_warm)
+{
+    Emulator32bit *cpu = new Emulator32bit(8, 0, {}, 0, 8);
+    {
+        ProcessScheduler scheduler(cpu, 50);
+        spawn_counter(cpu, scheduler);
+        spawn_counter(cpu, scheduler);
+        scheduler.start();
+        cpu->run(100);
+
+        cpu->mmu->reset_tlb_stats();
+        cpu->run(1000);
+        EXPECT_EQ (scheduler.switches(), 23);
+        EXPECT_EQ (cpu->mmu->get_tlb_stats().misses, 0) << "translations survive the switches";
+        EXPECT_EQ (cpu->mmu->get_tlb_stats().invalidations, 0);
+    }
+    delete cpu;
+}
+
+TEST (process, ended_processes_release_their_heap)
+{
+    Emulator32bit *cpu = new Emulator32bit(8, 0, {}, 0, 8);
+    long long pid;
+    {
+        ProcessScheduler scheduler(cpu, 50);
+        pid = scheduler.spawn(0, PAGE_SIZE)->pid;
+        cpu->memory_manager->set_break(pid, 0x1000);
+        EXPECT_EQ (cpu->memory_manager->brk(pid, 0x3000), 0x3000);
+    }
+
+    /* the pid is reused and starts with a fresh heap */
+    EXPECT_EQ (cpu->mmu->begin_process(), pid);
+    EXPECT_EQ (cpu->memory_manager->brk(pid, 0), HEAP_START);
+    cpu->mmu->end_process(pid);
+    delete cpu;
+}
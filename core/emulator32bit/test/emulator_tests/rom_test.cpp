@@ -0,0 +1,75 @@
+#include "emulator32bit_test/emulator32bit_test.h"
+
+#include <cstdio>
+#include <vector>
+
+#define ROM_FILE "rom_test.bin"
+#define ROM_START_PAGE 16
+
+static void write_rom_file(const std::vector<byte>& bytes)
+{
+    FILE *file = fopen(ROM_FILE, "wb");
+    fwrite(bytes.data(), 1, bytes.size(), file);
+    fclose(file);
+}
+
+static std::vector<byte> read_rom_file()
+{
+    std::vector<byte> bytes;
+    FILE *file = fopen(ROM_FILE, "rb");
+    for (int c = fgetc(file); c != EOF; c = fgetc(file))
+    {
+        bytes.push_back(c);
+    }
+    fclose(file);
+    return bytes;
+}
+
+TEST (rom, read_only_never_writes_back)
+{
+    const word base = ROM_START_PAGE << PAGE_PSIZE;
+    std::vector<byte> image(PAGE_SIZE + 16);
+    for (word i = 0; i < image.size(); i++)
+    {
+        image[i] = (byte) (i * 7);
+    }
+    write_rom_file(image);
+
+    ROM *rom = new ROM(File(ROM_FILE), 2, ROM_START_PAGE);
+    EXPECT_EQ (rom->read_byte(base + 1), 7);
+    EXPECT_EQ (rom->read_byte(base + PAGE_SIZE + 15), (byte) ((PAGE_SIZE + 15) * 7));
+    EXPECT_EQ (rom->read_word(base + PAGE_SIZE + 16), 0) << "past the file is zero filled";
+    EXPECT_EQ (rom->is_dirty(), false);
+
+    rom->write_word(base, 0xDEADBEEF);
+    rom->reset();
+    EXPECT_EQ (rom->read_word(base), 0xDEADBEEF);
+    EXPECT_EQ (rom->is_dirty(), true);
+    delete rom;
+
+    EXPECT_EQ (read_rom_file(), image);
+    EXPECT_THROW (ROM(File(ROM_FILE), 1, ROM_START_PAGE), ROM::ROM_Exception);
+    std::remove(ROM_FILE);
+}
+
+TEST (rom, flash_writes_through)
+{
+    const word base = ROM_START_PAGE << PAGE_PSIZE;
+    write_rom_file(std::vector<byte>(16, 0xAB));
+
+    ROM *rom = new ROM(File(ROM_FILE), 2, ROM_START_PAGE, ROM::Mode::FLASH);
+    EXPECT_EQ (rom->read_byte(base + 15), 0xAB);
+    rom->write_word(base + PAGE_SIZE, 0x12345678);
+    delete rom;
+
+    std::vector<byte> flashed = read_rom_file();
+    ASSERT_EQ (flashed.size(), 2 * PAGE_SIZE);
+    EXPECT_EQ (flashed[15], 0xAB);
+    EXPECT_EQ (flashed[PAGE_SIZE], 0x78);
+    EXPECT_EQ (flashed[PAGE_SIZE + 3], 0x12);
+
+    rom = new ROM(File(ROM_FILE), 2, ROM_START_PAGE, ROM::Mode::FLASH);
+    EXPECT_EQ (rom->read_word(base + PAGE_SIZE), 0x12345678);
+    delete rom;
+    std::remove(ROM_FILE);
+}
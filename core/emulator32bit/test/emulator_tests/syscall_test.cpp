@@ -0,0 +1,99 @@
+#include "emulator32bit_test/emulator32bit_test.h"
+
+#include <cstring>
+#include <string>
+
+static void load_program(Emulator32bit *cpu, const word *program, word length)
+{
+    for (word i = 0; i < length; i++)
+    {
+        cpu->system_bus.write_word(i * 4, program[i]);
+    }
+    cpu->set_pc(0);
+}
+
+TEST (syscall, register_at_runtime)
+{
+    Emulator32bit *cpu = new Emulator32bit(8, 0, {}, 0, 8);
+    long long pid = cpu->mmu->begin_process();
+    cpu->mmu->add_vpage(pid, 0, 1, true, true);
+
+    int calls = 0;
+    cpu->register_syscall(500, [&calls](Emulator32bit& emu) {
+        calls++;
+        emu.write_reg(0, emu.read_reg(0) * 2 + emu.read_reg(1));
+    });
+
+    word program[] = {
+        Emulator32bit::asm_format_o(Emulator32bit::_op_add, false, 0, XZR, 20),
+        Emulator32bit::asm_format_o(Emulator32bit::_op_add, false, 1, XZR, 2),
+        Emulator32bit::asm_format_o(Emulator32bit::_op_add, false, NR, XZR, 500),
+        Emulator32bit::asm_format_b1(Emulator32bit::_op_swi, Emulator32bit::ConditionCode::AL, 0),
+    };
+    load_program(cpu, program, sizeof(program) / sizeof(program[0]));
+    cpu->run(sizeof(program) / sizeof(program[0]));
+    EXPECT_EQ (calls, 1);
+    EXPECT_EQ (cpu->read_reg(0), 42);
+
+    EXPECT_EQ (cpu->unregister_syscall(500), true);
+    EXPECT_EQ (cpu->unregister_syscall(500), false);
+    load_program(cpu, program, sizeof(program) / sizeof(program[0]));
+    cpu->run(sizeof(program) / sizeof(program[0]));
+    EXPECT_EQ (calls, 1);
+    EXPECT_EQ (cpu->read_reg(0), 20) << "an unregistered syscall stops the processor";
+
+    /* any number can be registered, and built in syscalls can be replaced or removed */
+    cpu->register_syscall(0xFFFFFFFF, [&calls](Emulator32bit& emu) { calls++; });
+    EXPECT_EQ (cpu->unregister_syscall(0xFFFFFFFF), true);
+    EXPECT_EQ (cpu->unregister_syscall(1000), true);
+    EXPECT_EQ (cpu->unregister_syscall(1000), false);
+    EXPECT_EQ (cpu->unregister_syscall(MAX_SYSCALL), false);
+    EXPECT_EQ (calls, 1);
+
+    cpu->mmu->end_process(pid);
+    delete cpu;
+}
+
+TEST (syscall, bulk_access_across_pages)
+{
+    Emulator32bit *cpu = new Emulator32bit(8, 0, {}, 0, 8);
+    long long pid = cpu->mmu->begin_process();
+
+    /* back the two virtual pages with physical pages in the opposite order */
+    cpu->mmu->add_vpage(pid, 3, 1, true, false);
+    cpu->mmu->add_vpage(pid, 2, 1, true, false);
+
+    const std::string msg = "crosses from virtual page two into virtual page three";
+    const word address = 3 * PAGE_SIZE - 20;
+    cpu->system_bus.write_buffer(address, (const byte*) msg.c_str(), msg.size() + 1);
+
+    EXPECT_EQ (cpu->system_bus.read_byte(address + 19), (byte) msg[19]);
+    EXPECT_EQ (cpu->system_bus.read_byte(address + 20), (byte) msg[20]);
+    EXPECT_EQ (cpu->system_bus.read_cstring(address), msg);
+    EXPECT_EQ (cpu->system_bus.read_cstring(address + 30), msg.substr(30));
+
+    char buffer[64] = {};
+    cpu->system_bus.read_buffer(address + 10, (byte*) buffer, 20);
+    EXPECT_EQ (std::string(buffer), msg.substr(10, 20));
+
+    cpu->mmu->end_process(pid);
+    delete cpu;
+}
+
+TEST (syscall, write_buffer_marks_rom_dirty)
+{
+    const byte rom_data[PAGE_SIZE] = {};
+    Emulator32bit *cpu = new Emulator32bit(8, 0, rom_data, 1, 8);
+    long long pid = cpu->mmu->begin_process();
+    VirtualMemory::Exception exception;
+    cpu->mmu->ensure_physical_page_mapping(pid, 8, 8, exception);
+
+    EXPECT_EQ (cpu->rom->is_dirty(), false);
+    const byte bytes[] = {1, 2, 3, 4};
+    cpu->system_bus.write_buffer(8 * PAGE_SIZE + 4, bytes, sizeof(bytes));
+    EXPECT_EQ (cpu->rom->is_dirty(), true);
+    EXPECT_EQ (cpu->system_bus.read_word(8 * PAGE_SIZE + 4), 0x04030201);
+
+    cpu->mmu->end_process(pid);
+    delete cpu;
+}
@@ -0,0 +1,162 @@
+#include "emulator32bit_test/emulator32bit_test.h"
+
+#include "emulator32bit/virtual_memory.h"
+
+
+TEST (tlb, hit_after_miss)
+{
+    Emulator32bit *cpu = new Emulator32bit(4, 0, {}, 0, 4);
+    long long pid = cpu->mmu->begin_process();
+    cpu->mmu->add_vpage(pid, 0, 2, true, true);
+
+    cpu->system_bus.write_word(0, 1);                 /* page fault, brings page in from disk */
+    cpu->mmu->reset_tlb_stats();
+
+    EXPECT_EQ (cpu->system_bus.read_word(0), 1);
+    EXPECT_EQ (cpu->mmu->get_tlb_stats().misses, 1);
+    EXPECT_EQ (cpu->mmu->get_tlb_stats().hits, 0);
+
+    EXPECT_EQ (cpu->system_bus.read_word(4), 0);
+    EXPECT_EQ (cpu->mmu->get_tlb_stats().misses, 1) << "same page should hit the TLB";
+    EXPECT_EQ (cpu->mmu->get_tlb_stats().hits, 1);
+
+    cpu->mmu->end_process(pid);
+    delete cpu;
+}
+
+TEST (tlb, invalidate_page)
+{
+    Emulator32bit *cpu = new Emulator32bit(4, 0, {}, 0, 4);
+    long long pid = cpu->mmu->begin_process();
+    cpu->mmu->add_vpage(pid, 0, 2, true, true);
+
+    cpu->system_bus.write_word(0, 1);
+    cpu->system_bus.write_word(PAGE_SIZE, 2);
+    cpu->system_bus.read_word(0);
+    cpu->system_bus.read_word(PAGE_SIZE);
+    cpu->mmu->reset_tlb_stats();
+
+    cpu->mmu->invalidate_tlb_page(pid, 0);
+    EXPECT_EQ (cpu->mmu->get_tlb_stats().invalidations, 1);
+
+    EXPECT_EQ (cpu->system_bus.read_word(0), 1);
+    EXPECT_EQ (cpu->system_bus.read_word(PAGE_SIZE), 2);
+    EXPECT_EQ (cpu->mmu->get_tlb_stats().misses, 1) << "only the invalidated page should miss";
+    EXPECT_EQ (cpu->mmu->get_tlb_stats().hits, 1);
+
+    cpu->mmu->end_process(pid);
+    delete cpu;
+}
+
+TEST (tlb, asid_isolation)
+{
+    Emulator32bit *cpu = new Emulator32bit(4, 0, {}, 0, 4);
+    long long pid1 = cpu->mmu->begin_process();
+    cpu->mmu->add_vpage(pid1, 0, 1, true, true);
+    cpu->system_bus.write_word(0, 1);
+
+    long long pid2 = cpu->mmu->begin_process();
+    cpu->mmu->add_vpage(pid2, 0, 1, true, true);
+    cpu->system_bus.write_word(0, 2);
+
+    cpu->mmu->set_process(pid1);
+    EXPECT_EQ (cpu->system_bus.read_word(0), 1);
+    cpu->mmu->set_process(pid2);
+    EXPECT_EQ (cpu->system_bus.read_word(0), 2);
+
+    /* both translations stay resident across context switches */
+    cpu->mmu->reset_tlb_stats();
+    cpu->mmu->set_process(pid1);
+    EXPECT_EQ (cpu->system_bus.read_word(0), 1);
+    cpu->mmu->set_process(pid2);
+    EXPECT_EQ (cpu->system_bus.read_word(0), 2);
+    EXPECT_EQ (cpu->mmu->get_tlb_stats().hits, 2);
+    EXPECT_EQ (cpu->mmu->get_tlb_stats().misses, 0);
+
+    cpu->mmu->invalidate_tlb_process(pid1);
+    cpu->mmu->reset_tlb_stats();
+    cpu->mmu->set_process(pid1);
+    EXPECT_EQ (cpu->system_bus.read_word(0), 1);
+    cpu->mmu->set_process(pid2);
+    EXPECT_EQ (cpu->system_bus.read_word(0), 2);
+    EXPECT_EQ (cpu->mmu->get_tlb_stats().misses, 1) << "only the invalidated process should miss";
+    EXPECT_EQ (cpu->mmu->get_tlb_stats().hits, 1);
+
+    cpu->mmu->end_process(pid1);
+    cpu->mmu->end_process(pid2);
+    delete cpu;
+}
+
+TEST (tlb, set_eviction)
+{
+    Emulator32bit *cpu = new Emulator32bit(8, 0, {}, 0, 8);
+    cpu->mmu->configure_tlb(4, 2);
+    long long pid = cpu->mmu->begin_process();
+    cpu->mmu->add_vpage(pid, 0, 8, true, true);
+
+    for (word vpage = 0; vpage < 8; vpage++)
+    {
+        cpu->system_bus.write_word(vpage << PAGE_PSIZE, vpage);
+        cpu->system_bus.read_word(vpage << PAGE_PSIZE);
+    }
+
+    EXPECT_EQ (cpu->mmu->get_tlb_stats().evictions, 4) << "8 pages in a 4 entry TLB should evict 4";
+
+    cpu->mmu->end_process(pid);
+    delete cpu;
+}
+
+TEST (tlb, huge_page)
+{
+    Emulator32bit *cpu = new Emulator32bit(HUGE_PAGE_NPAGES + 4, 0, {}, 0, HUGE_PAGE_NPAGES + 4);
+    long long pid = cpu->mmu->begin_process();
+
+    EXPECT_THROW (cpu->mmu->add_huge_vpage(pid, HUGE_PAGE_NPAGES + 1, true, false),
+                  VirtualMemory::InvalidVPageException);
+    cpu->mmu->add_huge_vpage(pid, HUGE_PAGE_NPAGES, true, false);
+    EXPECT_THROW (cpu->mmu->add_vpage(pid, HUGE_PAGE_NPAGES + 5, 1, true, false),
+                  VirtualMemory::InvalidVPageException);
+    EXPECT_EQ (cpu->mmu->can_write_vpage(pid, HUGE_PAGE_NPAGES + 5), true);
+    EXPECT_EQ (cpu->mmu->can_execute_vpage(pid, HUGE_PAGE_NPAGES + 5), false);
+
+    cpu->system_bus.write_word(HUGE_PAGE_SIZE, 1);
+    cpu->mmu->reset_tlb_stats();
+
+    /* Every page of the huge page translates through the one TLB entry filled above. */
+    for (word vpage = 0; vpage < HUGE_PAGE_NPAGES; vpage += 16)
+    {
+        cpu->system_bus.write_word(HUGE_PAGE_SIZE + (vpage << PAGE_PSIZE), vpage + 1);
+    }
+    for (word vpage = 0; vpage < HUGE_PAGE_NPAGES; vpage += 16)
+    {
+        EXPECT_EQ (cpu->system_bus.read_word(HUGE_PAGE_SIZE + (vpage << PAGE_PSIZE)), vpage + 1);
+    }
+    EXPECT_EQ (cpu->mmu->get_tlb_stats().misses, 0);
+    EXPECT_EQ (cpu->mmu->get_tlb_stats().huge_hits, 2 * HUGE_PAGE_NPAGES / 16);
+
+    cpu->mmu->remove_huge_vpage(pid, HUGE_PAGE_NPAGES);
+    EXPECT_EQ (cpu->mmu->get_tlb_stats().invalidations, 1);
+    EXPECT_ANY_THROW (cpu->system_bus.read_word(HUGE_PAGE_SIZE));
+
+    /* The physical pages are free again for small pages. */
+    cpu->mmu->add_vpage(pid, HUGE_PAGE_NPAGES + 5, 1, true, false);
+    cpu->system_bus.write_word(HUGE_PAGE_SIZE + 5 * PAGE_SIZE, 2);
+    EXPECT_EQ (cpu->system_bus.read_word(HUGE_PAGE_SIZE + 5 * PAGE_SIZE), 2);
+
+    cpu->mmu->end_process(pid);
+    delete cpu;
+}
+
+TEST (tlb, huge_page_takes_every_free_page)
+{
+    Emulator32bit *cpu = new Emulator32bit(HUGE_PAGE_NPAGES, 0, {}, 0, HUGE_PAGE_NPAGES);
+    long long pid = cpu->mmu->begin_process();
+    cpu->mmu->add_huge_vpage(pid, HUGE_PAGE_NPAGES, true, false);
+    cpu->mmu->add_vpage(pid, 0, 1, true, false);
+
+    /* Huge pages are never evicted, so there is no page for the small one. */
+    EXPECT_THROW (cpu->system_bus.write_word(0, 1), VirtualMemory::VirtualMemoryException);
+
+    cpu->mmu->end_process(pid);
+    delete cpu;
+}
@@ -0,0 +1,150 @@
+#include "emulator32bit_test/emulator32bit_test.h"
+
+#include "emulator32bit/uart.h"
+
+#include <cstdio>
+#include <string>
+
+#define VECTOR_TABLE 0x100
+#define RX_HANDLER 0x200
+
+static std::string read_output(FILE *file)
+{
+    std::string str;
+    rewind(file);
+    for (int c = fgetc(file); c != EOF; c = fgetc(file))
+    {
+        str += (char) c;
+    }
+    return str;
+}
+
+TEST (uart, guest_output_is_batched)
+{
+    Emulator32bit *cpu = new Emulator32bit(1, 0, {}, 0, 1);
+    FILE *output = tmpfile();
+    cpu->uart->set_output(output);
+
+    /* strb x0, [x1] with x1 at the data register, once per character */
+    const std::string msg = "hello\n";
+    for (word i = 0; i < msg.size(); i++)
+    {
+        cpu->system_bus.write_word(8 * i, Emulator32bit::asm_format_o(Emulator32bit::_op_add, false, 0, XZR, msg[i]));
+        cpu->system_bus.write_word(8 * i + 4, Emulator32bit::asm_format_m(Emulator32bit::_op_strb, false, 0, 1, 0,
+                Emulator32bit::ADDR_OFFSET));
+    }
+    cpu->write_reg(1, UART_BASE + UART_DATA);
+    cpu->set_pc(0);
+
+    cpu->run(msg.size() * 2 - 1);
+    EXPECT_EQ (cpu->system_bus.read_word(UART_BASE + UART_TX_HEAD), msg.size() - 1);
+    EXPECT_EQ (read_output(output), msg.substr(0, msg.size() - 1)) << "stopping flushes the output";
+
+    cpu->run(1);
+    EXPECT_EQ (read_output(output), msg);
+
+    /* a full ring is drained to the host buffer, not written out */
+    for (word i = 0; i < 3 * UART_RING_SIZE; i++)
+    {
+        cpu->system_bus.write_byte(UART_BASE + UART_DATA, 'a' + i % 26);
+    }
+    EXPECT_EQ (read_output(output), msg);
+    EXPECT_EQ (cpu->uart->tx_pending(), UART_RING_SIZE);
+    cpu->uart->flush();
+    std::string out = read_output(output);
+    ASSERT_EQ (out.size(), msg.size() + 3 * UART_RING_SIZE);
+    EXPECT_EQ (out[msg.size() + 27], 'b');
+    EXPECT_EQ (out.back(), 'a' + (3 * UART_RING_SIZE - 1) % 26);
+
+    delete cpu;
+    fclose(output);
+}
+
+TEST (uart, guest_fills_tx_ring)
+{
+    Emulator32bit *cpu = new Emulator32bit(1, 0, {}, 0, 1);
+    FILE *output = tmpfile();
+    cpu->uart->set_output(output);
+
+    /* wrap around the end of the ring */
+    cpu->system_bus.write_word(UART_BASE + UART_TX_HEAD, UART_RING_SIZE - 2);
+    cpu->uart->flush();
+    const std::string msg = "wrapped";
+    for (word i = 0; i < msg.size(); i++)
+    {
+        cpu->system_bus.write_byte(UART_BASE + UART_TX_RING + ((UART_RING_SIZE - 2 + i) & (UART_RING_SIZE - 1)), msg[i]);
+    }
+    cpu->system_bus.write_word(UART_BASE + UART_TX_HEAD, UART_RING_SIZE - 2 + msg.size());
+    EXPECT_EQ (cpu->uart->tx_pending(), 0) << "publishing drains the ring";
+    EXPECT_EQ (read_output(output).size(), UART_RING_SIZE - 2) << "but does not write the output out";
+    cpu->uart->flush();
+    EXPECT_EQ (read_output(output).substr(UART_RING_SIZE - 2), msg);
+    EXPECT_EQ (cpu->system_bus.read_word(UART_BASE + UART_TX_TAIL), UART_RING_SIZE - 2 + msg.size());
+
+    cpu->system_bus.write_word(UART_BASE + UART_CTRL, UART_CTRL_TX_FLUSH);
+    cpu->system_bus.write_byte(UART_BASE + UART_TX_RING + ((UART_RING_SIZE - 2 + msg.size()) & (UART_RING_SIZE - 1)), '>');
+    cpu->system_bus.write_word(UART_BASE + UART_TX_HEAD, UART_RING_SIZE - 1 + msg.size());
+    EXPECT_EQ (read_output(output).back(), '>') << "UART_CTRL_TX_FLUSH writes every publish out";
+
+    delete cpu;
+    fclose(output);
+}
+
+TEST (uart, input_waits_for_room)
+{
+    Emulator32bit *cpu = new Emulator32bit(1, 0, {}, 0, 1);
+    std::string input(UART_RING_SIZE + 100, 'x');
+    input[0] = 'a';
+    input[UART_RING_SIZE] = 'b';
+
+    EXPECT_EQ (cpu->system_bus.read_word(UART_BASE + UART_STATUS) & UART_STATUS_RX_READY, 0);
+    EXPECT_EQ (cpu->system_bus.read_byte(UART_BASE + UART_DATA), 0);
+    cpu->uart->receive((const byte*) input.data(), input.size());
+    EXPECT_EQ (cpu->uart->rx_pending(), UART_RING_SIZE);
+    EXPECT_EQ (cpu->system_bus.read_word(UART_BASE + UART_STATUS) & UART_STATUS_RX_READY, UART_STATUS_RX_READY);
+
+    EXPECT_EQ (cpu->system_bus.read_hword(UART_BASE + UART_DATA), 'a');
+    EXPECT_EQ (cpu->system_bus.read_word(UART_BASE + UART_RX_TAIL), 1) << "a halfword read pops one byte";
+    EXPECT_EQ (cpu->uart->rx_pending(), UART_RING_SIZE) << "the backlog refills the ring";
+
+    /* consume the rest of the ring directly, up to the 'b' from the backlog */
+    cpu->system_bus.write_word(UART_BASE + UART_RX_TAIL, UART_RING_SIZE);
+    EXPECT_EQ (cpu->system_bus.read_byte(UART_BASE + UART_RX_RING), 'b');
+    EXPECT_EQ (cpu->system_bus.read_word(UART_BASE + UART_RX_HEAD), UART_RING_SIZE + 100);
+    EXPECT_EQ (cpu->uart->rx_pending(), 100);
+
+    delete cpu;
+}
+
+TEST (uart, input_interrupt)
+{
+    Emulator32bit *cpu = new Emulator32bit(1, 0, {}, 0, 1);
+    for (word addr = 0; addr < VECTOR_TABLE; addr += 4)
+    {
+        cpu->system_bus.write_word(addr, Emulator32bit::asm_nop());
+    }
+    word rx_vector = VECTOR_TABLE + Emulator32bit::UART_RX * 4;
+    cpu->system_bus.write_word(rx_vector, Emulator32bit::asm_format_b1(Emulator32bit::_op_b,
+            Emulator32bit::ConditionCode::AL, (RX_HANDLER - rx_vector) / 4));
+    cpu->system_bus.write_word(RX_HANDLER, Emulator32bit::asm_format_m(Emulator32bit::_op_ldrb, false, 2, 1, 0,
+            Emulator32bit::ADDR_OFFSET));
+    cpu->system_bus.write_word(RX_HANDLER + 4, Emulator32bit::asm_format_o(Emulator32bit::_op_add, false, NR, XZR, 139));
+    cpu->system_bus.write_word(RX_HANDLER + 8, Emulator32bit::asm_format_b1(Emulator32bit::_op_swi,
+            Emulator32bit::ConditionCode::AL, 0));
+    cpu->set_vector_table(VECTOR_TABLE);
+    cpu->set_pc(0);
+    cpu->write_reg(1, UART_BASE + UART_DATA);
+    cpu->write_reg(2, 0);
+
+    cpu->system_bus.write_word(UART_BASE + UART_CTRL, UART_CTRL_RX_INTERRUPT);
+    cpu->uart->post_input("z");
+    cpu->run(10);
+    EXPECT_EQ (cpu->get_pc(), rx_vector) << "posted input arrives between bursts";
+    cpu->run(3);
+    EXPECT_EQ (cpu->read_reg(2), 'z');
+    EXPECT_EQ (cpu->uart->rx_pending(), 0);
+
+    cpu->run(1);
+    EXPECT_EQ (cpu->get_pc(), 40) << "returns to where the input interrupted";
+    delete cpu;
+}
@@ -0,0 +1,77 @@
+#include "emulator32bit_test/emulator32bit_test.h"
+
+#include "emulator32bit/virtual_memory.h"
+
+TEST (virtual_memory, segment_filled_on_first_touch)
+{
+    Emulator32bit *cpu = new Emulator32bit(8, 0, {}, 0, 8);
+    long long pid = cpu->mmu->begin_process();
+
+    /* The image starts part way into the first page and ends part way into the second. */
+    std::vector<byte> image(PAGE_SIZE);
+    for (word i = 0; i < PAGE_SIZE; i++)
+    {
+        image[i] = (byte) i;
+    }
+    const word address = 0x10000 + 0x800;
+    cpu->mmu->add_segment(pid, address, 3 * PAGE_SIZE, image, true, false);
+    EXPECT_THROW (cpu->mmu->add_vpage(pid, (address >> PAGE_PSIZE) + 2, 1, true, false),
+                  VirtualMemory::InvalidVPageException);
+
+    EXPECT_EQ (cpu->system_bus.read_byte(address - 1), 0);
+    EXPECT_EQ (cpu->system_bus.read_byte(address), 0);
+    EXPECT_EQ (cpu->system_bus.read_byte(address + 0x7FF), 0xFF);
+    EXPECT_EQ (cpu->system_bus.read_byte(address + 0x800), 0x00);
+    EXPECT_EQ (cpu->system_bus.read_byte(address + PAGE_SIZE - 1), 0xFF);
+    EXPECT_EQ (cpu->system_bus.read_word(address + PAGE_SIZE), 0) << "past the image is zero filled";
+    EXPECT_EQ (cpu->system_bus.read_word(address + 2 * PAGE_SIZE), 0);
+
+    /* Filled pages behave like any other page once touched. */
+    cpu->system_bus.write_word(address, 0xDEADBEEF);
+    EXPECT_EQ (cpu->system_bus.read_word(address), 0xDEADBEEF);
+
+    cpu->mmu->end_process(pid);
+    delete cpu;
+}
+
+TEST (virtual_memory, demand_zero_segment)
+{
+    Emulator32bit *cpu = new Emulator32bit(4, 0, {}, 0, 4);
+    long long pid = cpu->mmu->begin_process();
+
+    /* More demand zero pages than physical pages, only touched pages take one. */
+    cpu->mmu->add_segment(pid, 0, 64 * PAGE_SIZE, {}, true, false);
+    for (word vpage = 0; vpage < 64; vpage += 8)
+    {
+        EXPECT_EQ (cpu->system_bus.read_word(vpage << PAGE_PSIZE), 0);
+        cpu->system_bus.write_word(vpage << PAGE_PSIZE, vpage);
+    }
+
+    cpu->mmu->end_process(pid);
+    delete cpu;
+}
+
+TEST (virtual_memory, block_copy_keeps_source_page)
+{
+    Emulator32bit *cpu = new Emulator32bit(2, 0, {}, 0, 2);
+    long long pid = cpu->mmu->begin_process();
+    cpu->mmu->add_segment(pid, 0, 64 * PAGE_SIZE, {}, true, false);
+
+    /* The source is the least recently used page, the fault on the destination evicts one. */
+    const word src = 10 * PAGE_SIZE;
+    const word dst = 30 * PAGE_SIZE;
+    for (word i = 0; i < 64; i += 4)
+    {
+        cpu->system_bus.write_word(src + i, 0x01010101 * (i + 1));
+    }
+    cpu->system_bus.write_word(20 * PAGE_SIZE, 7);
+
+    EXPECT_EQ (cpu->system_bus.copy_chunk(dst, src, 64), 64);
+    for (word i = 0; i < 64; i += 4)
+    {
+        EXPECT_EQ (cpu->system_bus.read_word(dst + i), 0x01010101 * (i + 1));
+    }
+
+    cpu->mmu->end_process(pid);
+    delete cpu;
+}
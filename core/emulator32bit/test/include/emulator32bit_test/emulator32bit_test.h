@@ -6,4 +6,21 @@
 #include <emulator32bit/emulator32bit.h>
 #include <emulator32bit/emulator32bit_util.h>
 
+#include <cstring>
+
+/* Bit pattern of a binary32 value, as the v* instructions keep it in a register */
+inline word float_bits(float f)
+{
+    word bits;
+    memcpy(&bits, &f, sizeof(bits));
+    return bits;
+}
+
+inline float bits_float(word bits)
+{
+    float f;
+    memcpy(&f, &bits, sizeof(f));
+    return f;
+}
+
 #endif /* EMULATOR32BITTEST_H */
\ No newline at end of file
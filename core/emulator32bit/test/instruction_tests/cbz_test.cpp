@@ -0,0 +1,55 @@
+#include <emulator32bit_test/emulator32bit_test.h>
+
+TEST(cbz, zero) {
+    Emulator32bit *cpu = new Emulator32bit(1, 0, {}, 0, 1);
+    // cbz x3, #16
+    // cbz x4, #-8 (at 16)
+    cpu->system_bus.write_word(0, Emulator32bit::asm_format_b3(Emulator32bit::_op_cbz, false, 3, 4));
+    cpu->system_bus.write_word(16, Emulator32bit::asm_format_b3(Emulator32bit::_op_cbz, false, 4, -2));
+    cpu->set_pc(0);
+    cpu->write_reg(3, 0);
+    cpu->write_reg(4, 1);
+    cpu->set_NZCV(true, false, true, false);
+
+    cpu->run(1);
+    EXPECT_EQ(cpu->get_pc(), 16) << "branches when \'x3\' is zero";
+
+    cpu->run(1);
+    EXPECT_EQ(cpu->get_pc(), 20) << "falls through when \'x4\' is not zero";
+    EXPECT_EQ(cpu->get_flag(N_FLAG), 1) << "flags are untouched";
+    EXPECT_EQ(cpu->get_flag(Z_FLAG), 0);
+    EXPECT_EQ(cpu->get_flag(C_FLAG), 1);
+    delete cpu;
+}
+
+TEST(cbz, nonzero) {
+    Emulator32bit *cpu = new Emulator32bit(1, 0, {}, 0, 1);
+    // cbnz x3, #-8 (at 16)
+    cpu->system_bus.write_word(16, Emulator32bit::asm_format_b3(Emulator32bit::_op_cbz, true, 3, -2));
+    cpu->set_pc(16);
+    cpu->write_reg(3, 0x80000000);
+
+    cpu->run(1);
+    EXPECT_EQ(cpu->get_pc(), 8) << "branches when \'x3\' is not zero";
+
+    cpu->set_pc(16);
+    cpu->write_reg(3, 0);
+    cpu->run(1);
+    EXPECT_EQ(cpu->get_pc(), 20);
+    delete cpu;
+}
+
+TEST(cbz, count_down) {
+    Emulator32bit *cpu = new Emulator32bit(1, 0, {}, 0, 1);
+    // sub x0, x0, #1
+    // cbnz x0, #-4
+    cpu->system_bus.write_word(0, Emulator32bit::asm_format_o(Emulator32bit::_op_sub, false, 0, 0, 1));
+    cpu->system_bus.write_word(4, Emulator32bit::asm_format_b3(Emulator32bit::_op_cbz, true, 0, -1));
+    cpu->set_pc(0);
+    cpu->write_reg(0, 5);
+
+    cpu->run(10);
+    EXPECT_EQ(cpu->get_pc(), 8);
+    EXPECT_EQ(cpu->read_reg(0), 0);
+    delete cpu;
+}
@@ -0,0 +1,50 @@
+#include <emulator32bit_test/emulator32bit_test.h>
+
+TEST(clz, register_clz) {
+    Emulator32bit *cpu = new Emulator32bit(1, 0, {}, 0, 1);
+    // clz x0, x1
+    // x1: 0x00010000
+    cpu->system_bus.write_word(0, Emulator32bit::asm_format_o3(Emulator32bit::_op_clz, false, 0, 1, 0));
+    cpu->set_pc(0);
+    cpu->write_reg(1, 0x00010000);
+
+    cpu->run(1);
+
+    EXPECT_EQ(cpu->read_reg(0), 15) << "\'clz x0, x1\' : where x1=0x00010000, should result in x0=15";
+    EXPECT_EQ(cpu->read_reg(1), 0x00010000) << "operation should not alter operand register \'x1\'";
+    delete cpu;
+}
+
+TEST(clz, immediate) {
+    Emulator32bit *cpu = new Emulator32bit(1, 0, {}, 0, 1);
+    // clz x0, #1
+    cpu->system_bus.write_word(0, Emulator32bit::asm_format_o3(Emulator32bit::_op_clz, false, 0, 1));
+    cpu->set_pc(0);
+
+    cpu->run(1);
+
+    EXPECT_EQ(cpu->read_reg(0), 31) << "\'clz x0, #1\' : should result in x0=31";
+    delete cpu;
+}
+
+TEST(clz, zero) {
+    Emulator32bit *cpu = new Emulator32bit(1, 0, {}, 0, 1);
+    // clzs x0, x1
+    // clzs x2, x3
+    // x1: 0
+    // x3: 0x80000000
+    cpu->system_bus.write_word(0, Emulator32bit::asm_format_o3(Emulator32bit::_op_clz, true, 0, 1, 0));
+    cpu->system_bus.write_word(4, Emulator32bit::asm_format_o3(Emulator32bit::_op_clz, true, 2, 3, 0));
+    cpu->set_pc(0);
+    cpu->write_reg(1, 0);
+    cpu->write_reg(3, 0x80000000);
+
+    cpu->run(1);
+    EXPECT_EQ(cpu->read_reg(0), 32) << "\'clzs x0, x1\' : where x1=0, should result in x0=32";
+    EXPECT_EQ(cpu->get_flag(Z_FLAG), 0) << "operation should not cause Z flag to be set";
+
+    cpu->run(1);
+    EXPECT_EQ(cpu->read_reg(2), 0) << "\'clzs x2, x3\' : where x3=0x80000000, should result in x2=0";
+    EXPECT_EQ(cpu->get_flag(Z_FLAG), 1) << "operation should cause Z flag to be set";
+    delete cpu;
+}
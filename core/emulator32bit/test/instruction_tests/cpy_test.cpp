@@ -0,0 +1,135 @@
+#include <emulator32bit_test/emulator32bit_test.h>
+
+#include <emulator32bit/dma.h>
+
+#include <vector>
+
+static std::vector<byte> pattern(word length, word seed)
+{
+    std::vector<byte> bytes(length);
+    for (word i = 0; i < length; i++) {
+        bytes[i] = (i * 13 + seed) ^ (i >> 8);
+    }
+    return bytes;
+}
+
+TEST(cpy, across_pages) {
+    Emulator32bit *cpu = new Emulator32bit(8, 0, {}, 0, 8);
+    // cpy x0, x1, x2
+    // x0: 3 * PAGE_SIZE + 100
+    // x1: PAGE_SIZE + 10
+    // x2: 2 * PAGE_SIZE + 50
+    cpu->system_bus.write_word(0, Emulator32bit::asm_format_m5(Emulator32bit::_op_mops, false, 0, 1, 2));
+    std::vector<byte> data = pattern(2 * PAGE_SIZE + 50, 1);
+    cpu->system_bus.write_buffer(PAGE_SIZE + 10, data.data(), data.size());
+    cpu->set_pc(0);
+    cpu->write_reg(0, 3 * PAGE_SIZE + 100);
+    cpu->write_reg(1, PAGE_SIZE + 10);
+    cpu->write_reg(2, data.size());
+
+    cpu->run(1);
+
+    std::vector<byte> copied(data.size());
+    cpu->system_bus.read_buffer(3 * PAGE_SIZE + 100, copied.data(), copied.size());
+    EXPECT_EQ(copied == data, true);
+    EXPECT_EQ(cpu->system_bus.read_byte(3 * PAGE_SIZE + 99), 0) << "bytes before the destination are untouched";
+    EXPECT_EQ(cpu->system_bus.read_byte(3 * PAGE_SIZE + 100 + data.size()), 0) << "and after it";
+    EXPECT_EQ(cpu->read_reg(0), 3 * PAGE_SIZE + 100 + data.size()) << "\'x0\' is left past the copied bytes";
+    EXPECT_EQ(cpu->read_reg(1), PAGE_SIZE + 10 + data.size());
+    EXPECT_EQ(cpu->read_reg(2), 0);
+    EXPECT_EQ(cpu->get_pc(), 4);
+    delete cpu;
+}
+
+TEST(cpy, overlapping) {
+    Emulator32bit *cpu = new Emulator32bit(8, 0, {}, 0, 8);
+    std::vector<byte> data = pattern(PAGE_SIZE + 300, 2);
+
+    // cpy x3, x4, x5 to a higher address, copied backward
+    cpu->system_bus.write_word(0, Emulator32bit::asm_format_m5(Emulator32bit::_op_mops, false, 3, 4, 5));
+    cpu->system_bus.write_buffer(PAGE_SIZE, data.data(), data.size());
+    cpu->set_pc(0);
+    cpu->write_reg(3, PAGE_SIZE + 200);
+    cpu->write_reg(4, PAGE_SIZE);
+    cpu->write_reg(5, data.size());
+
+    cpu->run(1);
+
+    std::vector<byte> copied(data.size());
+    cpu->system_bus.read_buffer(PAGE_SIZE + 200, copied.data(), copied.size());
+    EXPECT_EQ(copied == data, true);
+    EXPECT_EQ(cpu->read_reg(3), PAGE_SIZE + 200) << "a backward copy leaves the addresses";
+    EXPECT_EQ(cpu->read_reg(4), PAGE_SIZE);
+    EXPECT_EQ(cpu->read_reg(5), 0);
+
+    // and back down to a lower address, copied forward
+    cpu->set_pc(0);
+    cpu->write_reg(3, PAGE_SIZE);
+    cpu->write_reg(4, PAGE_SIZE + 200);
+    cpu->write_reg(5, data.size());
+
+    cpu->run(1);
+
+    cpu->system_bus.read_buffer(PAGE_SIZE, copied.data(), copied.size());
+    EXPECT_EQ(copied == data, true);
+    EXPECT_EQ(cpu->read_reg(3), PAGE_SIZE + data.size());
+    delete cpu;
+}
+
+TEST(cpy, restarts) {
+    Emulator32bit *cpu = new Emulator32bit(40, 0, {}, 0, 40);
+    const word length = 17 * PAGE_SIZE + 8;
+    // cpy x0, x1, x2
+    cpu->system_bus.write_word(0, Emulator32bit::asm_format_m5(Emulator32bit::_op_mops, false, 0, 1, 2));
+    std::vector<byte> data = pattern(length, 3);
+    cpu->system_bus.write_buffer(PAGE_SIZE, data.data(), data.size());
+    cpu->set_pc(0);
+    cpu->write_reg(0, 20 * PAGE_SIZE);
+    cpu->write_reg(1, PAGE_SIZE);
+    cpu->write_reg(2, length);
+
+    cpu->run(1);
+
+    EXPECT_EQ(cpu->get_pc(), 0) << "a long copy stops after 16 pages to run again";
+    EXPECT_EQ(cpu->read_reg(0), 36 * PAGE_SIZE);
+    EXPECT_EQ(cpu->read_reg(1), 17 * PAGE_SIZE);
+    EXPECT_EQ(cpu->read_reg(2), PAGE_SIZE + 8);
+
+    cpu->run(1);
+
+    EXPECT_EQ(cpu->get_pc(), 4);
+    EXPECT_EQ(cpu->read_reg(2), 0);
+    std::vector<byte> copied(data.size());
+    cpu->system_bus.read_buffer(20 * PAGE_SIZE, copied.data(), copied.size());
+    EXPECT_EQ(copied == data, true);
+
+    // a fault part way leaves the registers at the bytes still to copy
+    cpu->set_pc(0);
+    cpu->write_reg(0, 0x400);
+    cpu->write_reg(1, DMA_BASE + PAGE_SIZE - 16);
+    cpu->write_reg(2, 64);
+
+    cpu->run(1);
+
+    EXPECT_EQ(cpu->get_pc(), 0) << "the faulting instruction does not retire";
+    EXPECT_EQ(cpu->read_reg(0), 0x410);
+    EXPECT_EQ(cpu->read_reg(1), DMA_BASE + PAGE_SIZE);
+    EXPECT_EQ(cpu->read_reg(2), 48);
+    delete cpu;
+}
+
+TEST(cpy, zero_length) {
+    Emulator32bit *cpu = new Emulator32bit(1, 0, {}, 0, 1);
+    // cpy x0, x1, xzr
+    cpu->system_bus.write_word(0, Emulator32bit::asm_format_m5(Emulator32bit::_op_mops, false, 0, 1, XZR));
+    cpu->set_pc(0);
+    cpu->write_reg(0, 0x200);
+    cpu->write_reg(1, 0x100);
+
+    cpu->run(1);
+
+    EXPECT_EQ(cpu->get_pc(), 4);
+    EXPECT_EQ(cpu->read_reg(0), 0x200);
+    EXPECT_EQ(cpu->read_reg(1), 0x100);
+    delete cpu;
+}
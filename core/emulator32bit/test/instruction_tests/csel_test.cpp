@@ -0,0 +1,62 @@
+#include <emulator32bit_test/emulator32bit_test.h>
+
+TEST(csel, select) {
+    Emulator32bit *cpu = new Emulator32bit(1, 0, {}, 0, 1);
+    // csel x0, x1, x2, lt
+    cpu->system_bus.write_word(0, Emulator32bit::asm_format_o4(Emulator32bit::_op_csel, false,
+            Emulator32bit::ConditionCode::LT, 0, 1, 2));
+    cpu->set_pc(0);
+    cpu->write_reg(1, 10);
+    cpu->write_reg(2, 20);
+    cpu->set_NZCV(true, false, false, false);
+
+    cpu->run(1);
+    EXPECT_EQ(cpu->read_reg(0), 10) << "N != V selects \'x1\'";
+    EXPECT_EQ(cpu->get_flag(N_FLAG), 1) << "flags are untouched";
+    EXPECT_EQ(cpu->get_flag(V_FLAG), 0);
+
+    cpu->set_pc(0);
+    cpu->set_NZCV(true, false, false, true);
+    cpu->run(1);
+    EXPECT_EQ(cpu->read_reg(0), 20) << "N == V selects \'x2\'";
+    delete cpu;
+}
+
+TEST(csel, increment) {
+    Emulator32bit *cpu = new Emulator32bit(1, 0, {}, 0, 1);
+    // csinc x0, x1, x2, eq
+    cpu->system_bus.write_word(0, Emulator32bit::asm_format_o4(Emulator32bit::_op_csel, true,
+            Emulator32bit::ConditionCode::EQ, 0, 1, 2));
+    cpu->set_pc(0);
+    cpu->write_reg(1, 10);
+    cpu->write_reg(2, 20);
+    cpu->set_NZCV(false, true, false, false);
+
+    cpu->run(1);
+    EXPECT_EQ(cpu->read_reg(0), 10);
+
+    cpu->set_pc(0);
+    cpu->set_NZCV(false, false, false, false);
+    cpu->run(1);
+    EXPECT_EQ(cpu->read_reg(0), 21) << "the second register is incremented";
+    delete cpu;
+}
+
+TEST(csel, set) {
+    Emulator32bit *cpu = new Emulator32bit(1, 0, {}, 0, 1);
+    // csinc x0, xzr, xzr, ne (cset x0, eq)
+    cpu->system_bus.write_word(0, Emulator32bit::asm_format_o4(Emulator32bit::_op_csel, true,
+            Emulator32bit::ConditionCode::NE, 0, XZR, XZR));
+    cpu->set_pc(0);
+    cpu->write_reg(0, 7);
+    cpu->set_NZCV(false, true, false, false);
+
+    cpu->run(1);
+    EXPECT_EQ(cpu->read_reg(0), 1);
+
+    cpu->set_pc(0);
+    cpu->set_NZCV(false, false, false, false);
+    cpu->run(1);
+    EXPECT_EQ(cpu->read_reg(0), 0);
+    delete cpu;
+}
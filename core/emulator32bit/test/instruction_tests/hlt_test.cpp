@@ -1,5 +1,8 @@
 #include <emulator32bit_test/emulator32bit_test.h>
 
+static_assert(Emulator32bit::asm_hlt() == (word) Emulator32bit::_op_hlt << 26,
+        "instruction encoders are evaluated at compile time");
+
 TEST(hlt, test_execution_halting) {
     Emulator32bit *cpu = new Emulator32bit(1, 0, {}, 0, 1);
     cpu->system_bus.write_word(0, Emulator32bit::asm_hlt());
@@ -0,0 +1,46 @@
+#include <emulator32bit_test/emulator32bit_test.h>
+
+TEST(ldm, increment_after) {
+    Emulator32bit *cpu = new Emulator32bit(1, 0, {}, 0, 1);
+    // ldm sp!, {x19-x21, x28, x29}
+    // sp: 0x200
+    cpu->system_bus.write_word(0, Emulator32bit::asm_format_m4(Emulator32bit::_op_ldstm, true, SP, true, false,
+            (0b111 << 19) | (1 << FP) | (1 << LINKR)));
+    for (word i = 0; i < 5; i++) {
+        cpu->system_bus.write_word(0x200 + 4 * i, 100 + i);
+    }
+    cpu->set_pc(0);
+    cpu->write_reg(SP, 0x200);
+
+    cpu->run(1);
+
+    EXPECT_EQ(cpu->read_reg(19), 100) << "the lowest register is loaded from the lowest address";
+    EXPECT_EQ(cpu->read_reg(20), 101);
+    EXPECT_EQ(cpu->read_reg(21), 102);
+    EXPECT_EQ(cpu->read_reg(FP), 103);
+    EXPECT_EQ(cpu->read_reg(LINKR), 104);
+    EXPECT_EQ(cpu->read_reg(22), 0) << "registers outside the list are not loaded";
+    EXPECT_EQ(cpu->read_reg(SP), 0x214) << "\'sp\' is written back past the loaded words";
+    delete cpu;
+}
+
+TEST(ldm, low_registers) {
+    Emulator32bit *cpu = new Emulator32bit(1, 0, {}, 0, 1);
+    // ldm x15, {x0, x2, x15}
+    // x15: 0x100
+    cpu->system_bus.write_word(0, Emulator32bit::asm_format_m4(Emulator32bit::_op_ldstm, true, 15, false, false,
+            0b1000000000000101));
+    cpu->system_bus.write_word(0x100, 7);
+    cpu->system_bus.write_word(0x104, 8);
+    cpu->system_bus.write_word(0x108, 9);
+    cpu->set_pc(0);
+    cpu->write_reg(15, 0x100);
+
+    cpu->run(1);
+
+    EXPECT_EQ(cpu->read_reg(0), 7);
+    EXPECT_EQ(cpu->read_reg(1), 0) << "registers outside the list are not loaded";
+    EXPECT_EQ(cpu->read_reg(2), 8);
+    EXPECT_EQ(cpu->read_reg(15), 9) << "a loaded base register takes the loaded value";
+    delete cpu;
+}
@@ -0,0 +1,57 @@
+#include <emulator32bit_test/emulator32bit_test.h>
+
+TEST(ldp, offset) {
+    Emulator32bit *cpu = new Emulator32bit(1, 0, {}, 0, 1);
+    // ldp x0, x1, [x2, #8]
+    // x2: 0x100
+    cpu->system_bus.write_word(0, Emulator32bit::asm_format_m3(Emulator32bit::_op_ldstp, true, 0, 1, 2, 8,
+            Emulator32bit::ADDR_OFFSET));
+    cpu->system_bus.write_word(0x108, 0x11223344);
+    cpu->system_bus.write_word(0x10C, 0x55667788);
+    cpu->set_pc(0);
+    cpu->write_reg(2, 0x100);
+
+    cpu->run(1);
+
+    EXPECT_EQ(cpu->read_reg(0), 0x11223344) << "\'ldp x0, x1, [x2, #8]\' : should load x0 from x2+8";
+    EXPECT_EQ(cpu->read_reg(1), 0x55667788) << "\'ldp x0, x1, [x2, #8]\' : should load x1 from x2+12";
+    EXPECT_EQ(cpu->read_reg(2), 0x100) << "operation should not alter address register \'x2\'";
+    delete cpu;
+}
+
+TEST(ldp, post_index) {
+    Emulator32bit *cpu = new Emulator32bit(1, 0, {}, 0, 1);
+    // ldp x28, x29, [sp], #8
+    // sp: 0x200
+    cpu->system_bus.write_word(0, Emulator32bit::asm_format_m3(Emulator32bit::_op_ldstp, true, FP, LINKR, SP, 8,
+            Emulator32bit::ADDR_POST_INC));
+    cpu->system_bus.write_word(0x200, 0x300);
+    cpu->system_bus.write_word(0x204, 0x40);
+    cpu->set_pc(0);
+    cpu->write_reg(SP, 0x200);
+
+    cpu->run(1);
+
+    EXPECT_EQ(cpu->read_reg(FP), 0x300) << "\'ldp x28, x29, [sp], #8\' : should load x28 from sp";
+    EXPECT_EQ(cpu->read_reg(LINKR), 0x40) << "\'ldp x28, x29, [sp], #8\' : should load x29 from sp+4";
+    EXPECT_EQ(cpu->read_reg(SP), 0x208) << "operation should increment \'sp\' after loading";
+    delete cpu;
+}
+
+TEST(ldp, across_page) {
+    Emulator32bit *cpu = new Emulator32bit(2, 0, {}, 0, 2);
+    // ldp x0, x1, [x2, #-4]
+    // x2: PAGE_SIZE
+    cpu->system_bus.write_word(0, Emulator32bit::asm_format_m3(Emulator32bit::_op_ldstp, true, 0, 1, 2, -4,
+            Emulator32bit::ADDR_OFFSET));
+    cpu->system_bus.write_word(PAGE_SIZE - 4, 0xAAAA5555);
+    cpu->system_bus.write_word(PAGE_SIZE, 0x5555AAAA);
+    cpu->set_pc(0);
+    cpu->write_reg(2, PAGE_SIZE);
+
+    cpu->run(1);
+
+    EXPECT_EQ(cpu->read_reg(0), 0xAAAA5555) << "the first word is the last of one page";
+    EXPECT_EQ(cpu->read_reg(1), 0x5555AAAA) << "the second word is the first of the next page";
+    delete cpu;
+}
@@ -32,4 +32,19 @@ TEST(mov, zero_flag) {
     EXPECT_EQ(cpu->get_flag(C_FLAG), 1) << "operation should not alter C flag";
     EXPECT_EQ(cpu->get_flag(V_FLAG), 0) << "operation should not cause V flag to be set";
     delete cpu;
-}
\ No newline at end of file
+}
+
+TEST(mov, register_mov_register) {
+    Emulator32bit *cpu = new Emulator32bit(1, 0, {}, 0, 1);
+    // mov x0, x3, #4
+    // x3: 10
+    cpu->system_bus.write_word(0, Emulator32bit::asm_format_o3(Emulator32bit::_op_mov, false, 0, 3, 4));
+    cpu->set_pc(0);
+    cpu->write_reg(3, 10);
+
+    cpu->run(1);
+
+    EXPECT_EQ(cpu->read_reg(0), 14) << "\'mov x0, x3, #4\' : where x3=10, should result in x0=14";
+    EXPECT_EQ(cpu->read_reg(3), 10) << "operation should not alter operand register \'x3\'";
+    delete cpu;
+}
@@ -0,0 +1,81 @@
+#include <emulator32bit_test/emulator32bit_test.h>
+
+#include <random>
+
+/* op x0, x1, x2 */
+static word run_packed(Emulator32bit::PackedOp op, word xn_val, word xm_val)
+{
+    Emulator32bit *cpu = new Emulator32bit(1, 0, {}, 0, 1);
+    cpu->system_bus.write_word(0, Emulator32bit::asm_format_p(Emulator32bit::_op_packed, op, 0, 1, 2));
+    cpu->set_pc(0);
+    cpu->write_reg(1, xn_val);
+    cpu->write_reg(2, xm_val);
+    cpu->set_NZCV(0, 0, 1, 0);
+
+    cpu->run(1);
+
+    word result = cpu->read_reg(0);
+    EXPECT_EQ(cpu->read_reg(1), xn_val) << "operation should not alter operand register \'x1\'";
+    EXPECT_EQ(cpu->read_reg(2), xm_val) << "operation should not alter operand register \'x2\'";
+    EXPECT_EQ(cpu->get_flag(C_FLAG), 1) << "operation should not alter flags";
+    delete cpu;
+    return result;
+}
+
+TEST(packed, add_sub8) {
+    EXPECT_EQ(run_packed(Emulator32bit::PACKED_ADD8, 0xFF01807F, 0x01FF8001), 0x00000080)
+            << "\'add8\' : lanes wrap without carrying into the next lane";
+    EXPECT_EQ(run_packed(Emulator32bit::PACKED_SUB8, 0x00010203, 0x01010101), 0xFF000102)
+            << "\'sub8\' : lanes wrap without borrowing from the next lane";
+}
+
+TEST(packed, min_max8) {
+    EXPECT_EQ(run_packed(Emulator32bit::PACKED_UMIN8, 0x80FF0110, 0x7F000220), 0x7F000110);
+    EXPECT_EQ(run_packed(Emulator32bit::PACKED_UMAX8, 0x80FF0110, 0x7F000220), 0x80FF0220);
+    EXPECT_EQ(run_packed(Emulator32bit::PACKED_SMIN8, 0x80FF0110, 0x7F000220), 0x80FF0110);
+    EXPECT_EQ(run_packed(Emulator32bit::PACKED_SMAX8, 0x80FF0110, 0x7F000220), 0x7F000220);
+}
+
+TEST(packed, compare8) {
+    EXPECT_EQ(run_packed(Emulator32bit::PACKED_CMEQ8, 0x12345678, 0x12005600), 0xFF00FF00);
+    EXPECT_EQ(run_packed(Emulator32bit::PACKED_CMEQ8, 0x00616263, 0), 0xFF000000)
+            << "\'cmeq8\' against xzr finds the null terminator of a string";
+    EXPECT_EQ(run_packed(Emulator32bit::PACKED_CMGT8, 0x7F800100, 0x807F0000), 0xFF00FF00)
+            << "\'cmgt8\' compares signed lanes";
+}
+
+TEST(packed, lanes16) {
+    EXPECT_EQ(run_packed(Emulator32bit::PACKED_ADD16, 0xFFFF0001, 0x00010001), 0x00000002);
+    EXPECT_EQ(run_packed(Emulator32bit::PACKED_SUB16, 0x00000001, 0x00010002), 0xFFFFFFFF);
+    EXPECT_EQ(run_packed(Emulator32bit::PACKED_UMIN16, 0x8000FFFF, 0x7FFF0001), 0x7FFF0001);
+    EXPECT_EQ(run_packed(Emulator32bit::PACKED_UMAX16, 0x8000FFFF, 0x7FFF0001), 0x8000FFFF);
+    EXPECT_EQ(run_packed(Emulator32bit::PACKED_SMIN16, 0x8000FFFF, 0x7FFF0001), 0x8000FFFF);
+    EXPECT_EQ(run_packed(Emulator32bit::PACKED_SMAX16, 0x8000FFFF, 0x7FFF0001), 0x7FFF0001);
+    EXPECT_EQ(run_packed(Emulator32bit::PACKED_CMEQ16, 0x12345678, 0x12340078), 0xFFFF0000);
+    EXPECT_EQ(run_packed(Emulator32bit::PACKED_CMGT16, 0x00018000, 0xFFFF7FFF), 0xFFFF0000);
+}
+
+TEST(packed, tbl) {
+    EXPECT_EQ(run_packed(Emulator32bit::PACKED_TBL, 0x44332211, 0x00010203), 0x11223344)
+            << "\'tbl\' : reversing the byte indices reverses the bytes";
+    EXPECT_EQ(run_packed(Emulator32bit::PACKED_TBL, 0x44332211, 0x80040100), 0x00002211)
+            << "\'tbl\' : indices past the last byte give zero";
+    EXPECT_EQ(run_packed(Emulator32bit::PACKED_TBL, 0x44332211, 0x10101010), 0)
+            << "\'tbl\' : indices past the host vector give zero too";
+}
+
+TEST(packed, host_matches_scalar) {
+    std::mt19937 rng(46);
+    for (int op = 0; op < Emulator32bit::PACKED_NUM_OPS; op++) {
+        for (int i = 0; i < 1000; i++) {
+            word a = rng();
+            word b = i % 4 == 0 ? a : rng();
+            if (op == Emulator32bit::PACKED_TBL) {
+                b &= 0x87878787;
+            }
+            ASSERT_EQ(Emulator32bit::packed_op((Emulator32bit::PackedOp) op, a, b),
+                      Emulator32bit::packed_op_scalar((Emulator32bit::PackedOp) op, a, b))
+                    << Emulator32bit::packed_op_name((Emulator32bit::PackedOp) op) << " " << a << ", " << b;
+        }
+    }
+}
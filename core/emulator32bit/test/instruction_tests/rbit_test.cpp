@@ -0,0 +1,32 @@
+#include <emulator32bit_test/emulator32bit_test.h>
+
+TEST(rbit, register_rbit) {
+    Emulator32bit *cpu = new Emulator32bit(1, 0, {}, 0, 1);
+    // rbits x0, x1
+    // x1: 0x00000001
+    cpu->system_bus.write_word(0, Emulator32bit::asm_format_o3(Emulator32bit::_op_rbit, true, 0, 1, 0));
+    cpu->set_pc(0);
+    cpu->write_reg(1, 0x00000001);
+
+    cpu->run(1);
+
+    EXPECT_EQ(cpu->read_reg(0), 0x80000000) << "\'rbits x0, x1\' : where x1=1, should result in x0=0x80000000";
+    EXPECT_EQ(cpu->read_reg(1), 0x00000001) << "operation should not alter operand register \'x1\'";
+    EXPECT_EQ(cpu->get_flag(N_FLAG), 1) << "operation should cause N flag to be set";
+    EXPECT_EQ(cpu->get_flag(Z_FLAG), 0) << "operation should not cause Z flag to be set";
+    delete cpu;
+}
+
+TEST(rbit, pattern) {
+    Emulator32bit *cpu = new Emulator32bit(1, 0, {}, 0, 1);
+    // rbit x0, x1
+    // x1: 0x12345678
+    cpu->system_bus.write_word(0, Emulator32bit::asm_format_o3(Emulator32bit::_op_rbit, false, 0, 1, 0));
+    cpu->set_pc(0);
+    cpu->write_reg(1, 0x12345678);
+
+    cpu->run(1);
+
+    EXPECT_EQ(cpu->read_reg(0), 0x1E6A2C48) << "\'rbit x0, x1\' : where x1=0x12345678, should result in x0=0x1E6A2C48";
+    delete cpu;
+}
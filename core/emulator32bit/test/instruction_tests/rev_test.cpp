@@ -0,0 +1,29 @@
+#include <emulator32bit_test/emulator32bit_test.h>
+
+TEST(rev, register_rev) {
+    Emulator32bit *cpu = new Emulator32bit(1, 0, {}, 0, 1);
+    // rev x0, x1
+    // x1: 0x12345678
+    cpu->system_bus.write_word(0, Emulator32bit::asm_format_o3(Emulator32bit::_op_rev, false, 0, 1, 0));
+    cpu->set_pc(0);
+    cpu->write_reg(1, 0x12345678);
+
+    cpu->run(1);
+
+    EXPECT_EQ(cpu->read_reg(0), 0x78563412) << "\'rev x0, x1\' : where x1=0x12345678, should result in x0=0x78563412";
+    EXPECT_EQ(cpu->read_reg(1), 0x12345678) << "operation should not alter operand register \'x1\'";
+    delete cpu;
+}
+
+TEST(rev, immediate) {
+    Emulator32bit *cpu = new Emulator32bit(1, 0, {}, 0, 1);
+    // revs x0, #0xFF
+    cpu->system_bus.write_word(0, Emulator32bit::asm_format_o3(Emulator32bit::_op_rev, true, 0, 0xFF));
+    cpu->set_pc(0);
+
+    cpu->run(1);
+
+    EXPECT_EQ(cpu->read_reg(0), 0xFF000000) << "\'revs x0, #0xFF\' : should result in x0=0xFF000000";
+    EXPECT_EQ(cpu->get_flag(N_FLAG), 1) << "operation should cause N flag to be set";
+    delete cpu;
+}
@@ -0,0 +1,59 @@
+#include <emulator32bit_test/emulator32bit_test.h>
+
+TEST(sdiv, register_sdiv_immediate) {
+    Emulator32bit *cpu = new Emulator32bit(1, 0, {}, 0, 1);
+    // sdivs x0, x1, #7
+    // x1: -100
+    cpu->system_bus.write_word(0, Emulator32bit::asm_format_o(Emulator32bit::_op_sdiv, true, 0, 1, 7));
+    cpu->set_pc(0);
+    cpu->write_reg(1, -100);
+
+    cpu->run(1);
+
+    EXPECT_EQ(cpu->read_reg(0), (word) -14) << "\'sdivs x0, x1, #7\' : where x1=-100, should round toward zero to x0=-14";
+    EXPECT_EQ(cpu->read_reg(1), (word) -100) << "operation should not alter operand register \'x1\'";
+    EXPECT_EQ(cpu->get_flag(N_FLAG), 1) << "operation should cause N flag to be set";
+    EXPECT_EQ(cpu->get_flag(Z_FLAG), 0) << "operation should not cause Z flag to be set";
+    EXPECT_EQ(cpu->get_flag(C_FLAG), 0) << "operation should not cause C flag to be set";
+    EXPECT_EQ(cpu->get_flag(V_FLAG), 0) << "operation should not cause V flag to be set";
+    delete cpu;
+}
+
+TEST(sdiv, register_sdiv_register) {
+    Emulator32bit *cpu = new Emulator32bit(1, 0, {}, 0, 1);
+    // sdiv x0, x1, x2
+    // x1: -100
+    // x2: -3
+    cpu->system_bus.write_word(0, Emulator32bit::asm_format_o(Emulator32bit::_op_sdiv, false, 0, 1, 2, Emulator32bit::SHIFT_LSL, 0));
+    cpu->set_pc(0);
+    cpu->write_reg(1, -100);
+    cpu->write_reg(2, -3);
+
+    cpu->run(1);
+
+    EXPECT_EQ(cpu->read_reg(0), 33) << "\'sdiv x0, x1, x2\' : where x1=-100, x2=-3, should result in x0=33";
+    EXPECT_EQ(cpu->read_reg(2), (word) -3) << "operation should not alter operand register \'x2\'";
+    delete cpu;
+}
+
+TEST(sdiv, edge_cases) {
+    Emulator32bit *cpu = new Emulator32bit(1, 0, {}, 0, 1);
+    // sdiv x0, x1, x2
+    // sdiv x3, x1, x4
+    // x1: INT_MIN
+    // x2: -1
+    // x4: 0
+    cpu->system_bus.write_word(0, Emulator32bit::asm_format_o(Emulator32bit::_op_sdiv, false, 0, 1, 2, Emulator32bit::SHIFT_LSL, 0));
+    cpu->system_bus.write_word(4, Emulator32bit::asm_format_o(Emulator32bit::_op_sdiv, false, 3, 1, 4, Emulator32bit::SHIFT_LSL, 0));
+    cpu->set_pc(0);
+    cpu->write_reg(1, 0x80000000);
+    cpu->write_reg(2, -1);
+    cpu->write_reg(3, 7);
+    cpu->write_reg(4, 0);
+
+    cpu->run(2);
+
+    EXPECT_EQ(cpu->read_reg(0), 0x80000000) << "\'sdiv x0, x1, x2\' : where x1=INT_MIN, x2=-1, should wrap to x0=INT_MIN";
+    EXPECT_EQ(cpu->read_reg(3), 0) << "\'sdiv x3, x1, x4\' : where x4=0, should result in x3=0";
+    delete cpu;
+}
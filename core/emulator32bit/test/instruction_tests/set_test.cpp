@@ -0,0 +1,68 @@
+#include <emulator32bit_test/emulator32bit_test.h>
+
+TEST(set, across_pages) {
+    Emulator32bit *cpu = new Emulator32bit(4, 0, {}, 0, 4);
+    // set x0, x1, x2
+    // x0: PAGE_SIZE + 100
+    // x1: PAGE_SIZE + 20
+    // x2: 0x1AB, only the low byte is stored
+    cpu->system_bus.write_word(0, Emulator32bit::asm_format_m5(Emulator32bit::_op_mops, true, 0, 2, 1));
+    cpu->set_pc(0);
+    cpu->write_reg(0, PAGE_SIZE + 100);
+    cpu->write_reg(1, PAGE_SIZE + 20);
+    cpu->write_reg(2, 0x1AB);
+
+    cpu->run(1);
+
+    EXPECT_EQ(cpu->system_bus.read_byte(PAGE_SIZE + 99), 0) << "bytes before the destination are untouched";
+    EXPECT_EQ(cpu->system_bus.read_byte(PAGE_SIZE + 100), 0xAB);
+    EXPECT_EQ(cpu->system_bus.read_word(2 * PAGE_SIZE - 4), 0xABABABAB);
+    EXPECT_EQ(cpu->system_bus.read_word(2 * PAGE_SIZE + 116), 0xABABABAB);
+    EXPECT_EQ(cpu->system_bus.read_byte(2 * PAGE_SIZE + 120), 0) << "and after it";
+    EXPECT_EQ(cpu->read_reg(0), 2 * PAGE_SIZE + 120) << "\'x0\' is left past the filled bytes";
+    EXPECT_EQ(cpu->read_reg(1), 0);
+    EXPECT_EQ(cpu->read_reg(2), 0x1AB);
+    EXPECT_EQ(cpu->get_pc(), 4);
+    delete cpu;
+}
+
+TEST(set, restarts) {
+    Emulator32bit *cpu = new Emulator32bit(24, 0, {}, 0, 24);
+    // set x3, x4, xzr
+    cpu->system_bus.write_word(0, Emulator32bit::asm_format_m5(Emulator32bit::_op_mops, true, 3, XZR, 4));
+    cpu->system_bus.write_word(3 * PAGE_SIZE, 0xFFFFFFFF);
+    cpu->system_bus.write_word(22 * PAGE_SIZE - 4, 0xFFFFFFFF);
+    cpu->set_pc(0);
+    cpu->write_reg(3, PAGE_SIZE);
+    cpu->write_reg(4, 21 * PAGE_SIZE);
+
+    cpu->run(1);
+
+    EXPECT_EQ(cpu->get_pc(), 0) << "a long fill stops after 16 pages to run again";
+    EXPECT_EQ(cpu->read_reg(3), 17 * PAGE_SIZE);
+    EXPECT_EQ(cpu->read_reg(4), 5 * PAGE_SIZE);
+    EXPECT_EQ(cpu->system_bus.read_word(3 * PAGE_SIZE), 0);
+
+    cpu->run(1);
+
+    EXPECT_EQ(cpu->get_pc(), 4);
+    EXPECT_EQ(cpu->read_reg(4), 0);
+    EXPECT_EQ(cpu->system_bus.read_word(22 * PAGE_SIZE - 4), 0);
+    delete cpu;
+}
+
+TEST(set, same_registers) {
+    Emulator32bit *cpu = new Emulator32bit(1, 0, {}, 0, 1);
+    // set x0, x0, x1
+    cpu->system_bus.write_word(0, Emulator32bit::asm_format_m5(Emulator32bit::_op_mops, true, 0, 1, 0));
+    cpu->set_pc(0);
+    cpu->write_reg(0, 0x200);
+    cpu->write_reg(1, 0x5A);
+    cpu->system_bus.write_byte(0x200, 0xAB);
+
+    cpu->run(1);
+
+    EXPECT_EQ(cpu->get_pc(), 0) << "a length register that is also the destination is a bad instruction";
+    EXPECT_EQ(cpu->system_bus.read_byte(0x200), 0xAB);
+    delete cpu;
+}
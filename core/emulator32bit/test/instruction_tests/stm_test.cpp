@@ -0,0 +1,53 @@
+#include <emulator32bit_test/emulator32bit_test.h>
+
+TEST(stm, decrement_before) {
+    Emulator32bit *cpu = new Emulator32bit(1, 0, {}, 0, 1);
+    // stmdb sp!, {x19-x21, x29}
+    // sp: 0x200
+    cpu->system_bus.write_word(0, Emulator32bit::asm_format_m4(Emulator32bit::_op_ldstm, false, SP, true, true,
+            (0b111 << 19) | (1 << LINKR)));
+    cpu->set_pc(0);
+    cpu->write_reg(19, 19);
+    cpu->write_reg(20, 20);
+    cpu->write_reg(21, 21);
+    cpu->write_reg(LINKR, 0x40);
+    cpu->write_reg(SP, 0x200);
+
+    cpu->run(1);
+
+    EXPECT_EQ(cpu->read_reg(SP), 0x1F0) << "\'sp\' is written back below the stored words";
+    EXPECT_EQ(cpu->system_bus.read_word(0x1F0), 19) << "the lowest register is stored at the lowest address";
+    EXPECT_EQ(cpu->system_bus.read_word(0x1F4), 20);
+    EXPECT_EQ(cpu->system_bus.read_word(0x1F8), 21);
+    EXPECT_EQ(cpu->system_bus.read_word(0x1FC), 0x40);
+    delete cpu;
+}
+
+TEST(stm, round_trip) {
+    Emulator32bit *cpu = new Emulator32bit(2, 0, {}, 0, 2);
+    // stmdb sp!, {x0-x15}
+    // ldm sp!, {x0-x15}
+    // sp: PAGE_SIZE + 32, so the words straddle a page boundary
+    cpu->system_bus.write_word(0, Emulator32bit::asm_format_m4(Emulator32bit::_op_ldstm, false, SP, true, true, 0xFFFF));
+    cpu->system_bus.write_word(4, Emulator32bit::asm_format_m4(Emulator32bit::_op_ldstm, true, SP, true, false, 0xFFFF));
+    cpu->set_pc(0);
+    for (int reg = 0; reg < 16; reg++) {
+        cpu->write_reg(reg, 1000 + reg);
+    }
+    cpu->write_reg(SP, PAGE_SIZE + 32);
+
+    cpu->run(1);
+    EXPECT_EQ(cpu->read_reg(SP), PAGE_SIZE - 32);
+    EXPECT_EQ(cpu->system_bus.read_word(PAGE_SIZE - 32), 1000);
+    EXPECT_EQ(cpu->system_bus.read_word(PAGE_SIZE + 28), 1015);
+
+    for (int reg = 0; reg < 16; reg++) {
+        cpu->write_reg(reg, 0);
+    }
+    cpu->run(1);
+    for (int reg = 0; reg < 16; reg++) {
+        EXPECT_EQ(cpu->read_reg(reg), 1000 + reg);
+    }
+    EXPECT_EQ(cpu->read_reg(SP), PAGE_SIZE + 32);
+    delete cpu;
+}
@@ -0,0 +1,40 @@
+#include <emulator32bit_test/emulator32bit_test.h>
+
+TEST(stp, pre_index) {
+    Emulator32bit *cpu = new Emulator32bit(1, 0, {}, 0, 1);
+    // stp x28, x29, [sp, #-8]!
+    // sp: 0x200
+    cpu->system_bus.write_word(0, Emulator32bit::asm_format_m3(Emulator32bit::_op_ldstp, false, FP, LINKR, SP, -8,
+            Emulator32bit::ADDR_PRE_INC));
+    cpu->set_pc(0);
+    cpu->write_reg(FP, 0x300);
+    cpu->write_reg(LINKR, 0x40);
+    cpu->write_reg(SP, 0x200);
+
+    cpu->run(1);
+
+    EXPECT_EQ(cpu->read_reg(SP), 0x1F8) << "\'stp x28, x29, [sp, #-8]!\' : should decrement \'sp\' before storing";
+    EXPECT_EQ(cpu->system_bus.read_word(0x1F8), 0x300) << "x28 is stored at the lower address";
+    EXPECT_EQ(cpu->system_bus.read_word(0x1FC), 0x40) << "x29 is stored above x28";
+    EXPECT_EQ(cpu->read_reg(FP), 0x300) << "operation should not alter source register \'x28\'";
+    delete cpu;
+}
+
+TEST(stp, offset) {
+    Emulator32bit *cpu = new Emulator32bit(1, 0, {}, 0, 1);
+    // stp x0, xzr, [x2, #252]
+    // x2: 0x100
+    cpu->system_bus.write_word(0, Emulator32bit::asm_format_m3(Emulator32bit::_op_ldstp, false, 0, XZR, 2, 252,
+            Emulator32bit::ADDR_OFFSET));
+    cpu->system_bus.write_word(0x100 + 256, 0xFFFFFFFF);
+    cpu->set_pc(0);
+    cpu->write_reg(0, 0x12345678);
+    cpu->write_reg(2, 0x100);
+
+    cpu->run(1);
+
+    EXPECT_EQ(cpu->system_bus.read_word(0x100 + 252), 0x12345678) << "x0 is stored at x2+252";
+    EXPECT_EQ(cpu->system_bus.read_word(0x100 + 256), 0) << "xzr stores zero";
+    EXPECT_EQ(cpu->read_reg(2), 0x100) << "operation should not alter address register \'x2\'";
+    delete cpu;
+}
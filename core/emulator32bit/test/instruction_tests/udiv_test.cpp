@@ -0,0 +1,60 @@
+#include <emulator32bit_test/emulator32bit_test.h>
+
+TEST(udiv, register_udiv_immediate) {
+    Emulator32bit *cpu = new Emulator32bit(1, 0, {}, 0, 1);
+    // udiv x0, x1, #7
+    // x1: 100
+    cpu->system_bus.write_word(0, Emulator32bit::asm_format_o(Emulator32bit::_op_udiv, false, 0, 1, 7));
+    cpu->set_pc(0);
+    cpu->write_reg(1, 100);
+
+    cpu->run(1);
+
+    EXPECT_EQ(cpu->read_reg(0), 14) << "\'udiv x0, x1, #7\' : where x1=100, should result in x0=14";
+    EXPECT_EQ(cpu->read_reg(1), 100) << "operation should not alter operand register \'x1\'";
+    EXPECT_EQ(cpu->get_flag(N_FLAG), 0) << "operation should not cause N flag to be set";
+    EXPECT_EQ(cpu->get_flag(Z_FLAG), 0) << "operation should not cause Z flag to be set";
+    EXPECT_EQ(cpu->get_flag(C_FLAG), 0) << "operation should not cause C flag to be set";
+    EXPECT_EQ(cpu->get_flag(V_FLAG), 0) << "operation should not cause V flag to be set";
+    delete cpu;
+}
+
+TEST(udiv, register_udiv_register) {
+    Emulator32bit *cpu = new Emulator32bit(1, 0, {}, 0, 1);
+    // udiv x0, x1, x2
+    // x1: 0xFFFFFFFE
+    // x2: 2
+    cpu->system_bus.write_word(0, Emulator32bit::asm_format_o(Emulator32bit::_op_udiv, false, 0, 1, 2, Emulator32bit::SHIFT_LSL, 0));
+    cpu->set_pc(0);
+    cpu->write_reg(1, 0xFFFFFFFE);
+    cpu->write_reg(2, 2);
+
+    cpu->run(1);
+
+    EXPECT_EQ(cpu->read_reg(0), 0x7FFFFFFF) << "\'udiv x0, x1, x2\' : where x1=0xFFFFFFFE, x2=2, should result in x0=0x7FFFFFFF";
+    EXPECT_EQ(cpu->read_reg(1), 0xFFFFFFFE) << "operation should not alter operand register \'x1\'";
+    EXPECT_EQ(cpu->read_reg(2), 2) << "operation should not alter operand register \'x2\'";
+    delete cpu;
+}
+
+TEST(udiv, divide_by_zero) {
+    Emulator32bit *cpu = new Emulator32bit(1, 0, {}, 0, 1);
+    // udivs x0, x1, x2
+    // x1: 5
+    // x2: 0
+    cpu->system_bus.write_word(0, Emulator32bit::asm_format_o(Emulator32bit::_op_udiv, true, 0, 1, 2, Emulator32bit::SHIFT_LSL, 0));
+    cpu->set_pc(0);
+    cpu->write_reg(0, 3);
+    cpu->write_reg(1, 5);
+    cpu->write_reg(2, 0);
+    cpu->set_NZCV(0, 0, 1, 0);
+
+    cpu->run(1);
+
+    EXPECT_EQ(cpu->read_reg(0), 0) << "\'udivs x0, x1, x2\' : where x2=0, should result in x0=0";
+    EXPECT_EQ(cpu->get_flag(N_FLAG), 0) << "operation should not cause N flag to be set";
+    EXPECT_EQ(cpu->get_flag(Z_FLAG), 1) << "operation should cause Z flag to be set";
+    EXPECT_EQ(cpu->get_flag(C_FLAG), 1) << "operation should not alter C flag";
+    EXPECT_EQ(cpu->get_flag(V_FLAG), 0) << "operation should not cause V flag to be set";
+    delete cpu;
+}
@@ -0,0 +1,22 @@
+#include <emulator32bit_test/emulator32bit_test.h>
+
+TEST(vabs, register_vabs) {
+    Emulator32bit *cpu = new Emulator32bit(1, 0, {}, 0, 1);
+    // vabs.f32 x0, x1
+    // vabs.f32 x2, x3
+    // x1: -2.5
+    // x3: -nan
+    cpu->system_bus.write_word(0, Emulator32bit::asm_format_f(Emulator32bit::_op_vabs, false, 0, 1));
+    cpu->system_bus.write_word(4, Emulator32bit::asm_format_f(Emulator32bit::_op_vabs, false, 2, 3));
+    cpu->set_pc(0);
+    cpu->write_reg(1, float_bits(-2.5f));
+    cpu->write_reg(3, 0xFF800001);
+
+    cpu->run(2);
+
+    EXPECT_EQ(bits_float(cpu->read_reg(0)), 2.5f) << "\'vabs.f32 x0, x1\' : where x1=-2.5, should result in x0=2.5";
+    EXPECT_EQ(cpu->read_reg(1), float_bits(-2.5f)) << "operation should not alter operand register \'x1\'";
+    EXPECT_EQ(cpu->read_reg(2), 0x7F800001) << "a NaN only loses its sign, even a signaling one";
+    EXPECT_EQ(cpu->get_fpsr(), 0) << "operation should not raise floating point exceptions";
+    delete cpu;
+}
@@ -0,0 +1,103 @@
+#include <emulator32bit_test/emulator32bit_test.h>
+
+TEST(vadd, register_vadd) {
+    Emulator32bit *cpu = new Emulator32bit(1, 0, {}, 0, 1);
+    // vadd.f32 x0, x1, x2
+    // x1: 1.5
+    // x2: 2.25
+    cpu->system_bus.write_word(0, Emulator32bit::asm_format_f1(Emulator32bit::_op_vadd, 0, 1, 2));
+    cpu->set_pc(0);
+    cpu->write_reg(1, float_bits(1.5f));
+    cpu->write_reg(2, float_bits(2.25f));
+
+    cpu->run(1);
+
+    EXPECT_EQ(bits_float(cpu->read_reg(0)), 3.75f) << "\'vadd.f32 x0, x1, x2\' : where x1=1.5, x2=2.25, should result in x0=3.75";
+    EXPECT_EQ(cpu->read_reg(1), float_bits(1.5f)) << "operation should not alter operand register \'x1\'";
+    EXPECT_EQ(cpu->read_reg(2), float_bits(2.25f)) << "operation should not alter operand register \'x2\'";
+    EXPECT_EQ(cpu->get_fpsr(), 0) << "an exact sum should not raise floating point exceptions";
+    delete cpu;
+}
+
+TEST(vadd, rounding_mode) {
+    Emulator32bit *cpu = new Emulator32bit(1, 0, {}, 0, 1);
+    // vadd.f32 x0, x1, x2
+    // x1: 1
+    // x2: 2^-24, half way between 1 and the next float
+    for (int i = 0; i < 4; i++) {
+        cpu->system_bus.write_word(i * 4, Emulator32bit::asm_format_f1(Emulator32bit::_op_vadd, i, 8, 9));
+    }
+    cpu->set_pc(0);
+    cpu->write_reg(8, float_bits(1.0f));
+    cpu->write_reg(9, float_bits(1.0f / (1 << 24)));
+
+    cpu->set_fpcr(Emulator32bit::FP_ROUND_NEAREST << FPCR_RMODE);
+    cpu->run(1);
+    cpu->set_fpcr(Emulator32bit::FP_ROUND_PLUS_INF << FPCR_RMODE);
+    cpu->run(1);
+    cpu->set_fpcr(Emulator32bit::FP_ROUND_MINUS_INF << FPCR_RMODE);
+    cpu->run(1);
+    cpu->set_fpcr(Emulator32bit::FP_ROUND_ZERO << FPCR_RMODE);
+    cpu->run(1);
+
+    EXPECT_EQ(cpu->read_reg(0), 0x3F800000) << "a tie should round to even";
+    EXPECT_EQ(cpu->read_reg(1), 0x3F800001) << "should round toward plus infinity";
+    EXPECT_EQ(cpu->read_reg(2), 0x3F800000) << "should round toward minus infinity";
+    EXPECT_EQ(cpu->read_reg(3), 0x3F800000) << "should round toward zero";
+    EXPECT_EQ(cpu->get_fpsr(), 1 << FPSR_IXC) << "operation should raise inexact";
+    delete cpu;
+}
+
+TEST(vadd, nan) {
+    Emulator32bit *cpu = new Emulator32bit(1, 0, {}, 0, 1);
+    // vadd.f32 x0, x1, x2
+    // vadd.f32 x3, x4, x5
+    // x1: 1, x2: signaling NaN
+    // x4: inf, x5: -inf
+    cpu->system_bus.write_word(0, Emulator32bit::asm_format_f1(Emulator32bit::_op_vadd, 0, 1, 2));
+    cpu->system_bus.write_word(4, Emulator32bit::asm_format_f1(Emulator32bit::_op_vadd, 3, 4, 5));
+    cpu->system_bus.write_word(8, Emulator32bit::asm_format_f1(Emulator32bit::_op_vadd, 0, 1, 2));
+    cpu->set_pc(0);
+    cpu->write_reg(1, float_bits(1.0f));
+    cpu->write_reg(2, 0xFF800123);
+    cpu->write_reg(4, 0x7F800000);
+    cpu->write_reg(5, 0xFF800000);
+
+    cpu->run(1);
+    EXPECT_EQ(cpu->read_reg(0), 0xFFC00123) << "a NaN operand should be propagated quieted";
+    EXPECT_EQ(cpu->get_fpsr(), 1 << FPSR_IOC) << "a signaling NaN should raise invalid operation";
+
+    cpu->run(1);
+    EXPECT_EQ(cpu->read_reg(3), 0x7FC00000) << "inf + -inf should be the default NaN";
+
+    cpu->set_fpcr(1 << FPCR_DN);
+    cpu->run(1);
+    EXPECT_EQ(cpu->read_reg(0), 0x7FC00000) << "with DN set, NaN results should be the default NaN";
+    delete cpu;
+}
+
+TEST(vadd, flush_to_zero) {
+    Emulator32bit *cpu = new Emulator32bit(1, 0, {}, 0, 1);
+    // vadd.f32 x0, x1, x2
+    // vadd.f32 x3, x4, x5
+    // x1: smallest denormal, x2: 1
+    // x4: 1.5 * smallest normal, x5: -smallest normal
+    cpu->system_bus.write_word(0, Emulator32bit::asm_format_f1(Emulator32bit::_op_vadd, 0, 1, 2));
+    cpu->system_bus.write_word(4, Emulator32bit::asm_format_f1(Emulator32bit::_op_vadd, 3, 4, 5));
+    cpu->set_pc(0);
+    cpu->set_fpcr(1 << FPCR_FZ);
+    cpu->write_reg(1, 0x00000001);
+    cpu->write_reg(2, float_bits(1.0f));
+    cpu->write_reg(4, 0x00C00000);
+    cpu->write_reg(5, 0x80800000);
+
+    cpu->run(1);
+    EXPECT_EQ(bits_float(cpu->read_reg(0)), 1.0f) << "a denormal operand should be read as zero";
+    EXPECT_EQ(cpu->get_fpsr(), 1 << FPSR_IDC) << "a flushed operand should raise input denormal";
+
+    cpu->set_fpsr(0);
+    cpu->run(1);
+    EXPECT_EQ(cpu->read_reg(3), 0) << "a denormal result should be flushed to zero";
+    EXPECT_EQ(cpu->get_fpsr(), 1 << FPSR_UFC) << "a flushed result should raise underflow";
+    delete cpu;
+}
@@ -0,0 +1,34 @@
+#include <emulator32bit_test/emulator32bit_test.h>
+
+TEST(vcflo, register_vcflo) {
+    Emulator32bit *cpu = new Emulator32bit(1, 0, {}, 0, 1);
+    // vcflo.s32.f32 x0, x1
+    // vcflo.u32.f32 x2, x1
+    // x1: -3
+    cpu->system_bus.write_word(0, Emulator32bit::asm_format_f(Emulator32bit::_op_vcflo, true, 0, 1));
+    cpu->system_bus.write_word(4, Emulator32bit::asm_format_f(Emulator32bit::_op_vcflo, false, 2, 1));
+    cpu->set_pc(0);
+    cpu->write_reg(1, (word) -3);
+
+    cpu->run(2);
+
+    EXPECT_EQ(bits_float(cpu->read_reg(0)), -3.0f) << "\'vcflo.s32.f32 x0, x1\' : where x1=-3, should result in x0=-3.0";
+    EXPECT_EQ(bits_float(cpu->read_reg(2)), 4294967296.0f) << "\'vcflo.u32.f32 x2, x1\' : where x1=0xFFFFFFFD, should round to 2^32";
+    EXPECT_EQ(cpu->get_fpsr(), 1 << FPSR_IXC) << "a rounded conversion should raise inexact";
+    delete cpu;
+}
+
+TEST(vcflo, rounding_mode) {
+    Emulator32bit *cpu = new Emulator32bit(1, 0, {}, 0, 1);
+    // vcflo.s32.f32 x0, x1
+    // x1: 2^24 + 1
+    cpu->system_bus.write_word(0, Emulator32bit::asm_format_f(Emulator32bit::_op_vcflo, true, 0, 1));
+    cpu->set_pc(0);
+    cpu->set_fpcr(Emulator32bit::FP_ROUND_PLUS_INF << FPCR_RMODE);
+    cpu->write_reg(1, (1 << 24) + 1);
+
+    cpu->run(1);
+
+    EXPECT_EQ(bits_float(cpu->read_reg(0)), 16777218.0f) << "should round toward plus infinity";
+    delete cpu;
+}
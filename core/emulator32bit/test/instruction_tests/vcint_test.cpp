@@ -0,0 +1,45 @@
+#include <emulator32bit_test/emulator32bit_test.h>
+
+TEST(vcint, register_vcint) {
+    Emulator32bit *cpu = new Emulator32bit(1, 0, {}, 0, 1);
+    // vcint.s32.f32 x0, x1
+    // vcint.u32.f32 x2, x3
+    // x1: -7.75
+    // x3: 3000000000
+    cpu->system_bus.write_word(0, Emulator32bit::asm_format_f(Emulator32bit::_op_vcint, true, 0, 1));
+    cpu->system_bus.write_word(4, Emulator32bit::asm_format_f(Emulator32bit::_op_vcint, false, 2, 3));
+    cpu->set_pc(0);
+    cpu->write_reg(1, float_bits(-7.75f));
+    cpu->write_reg(3, float_bits(3000000000.0f));
+
+    cpu->run(1);
+    EXPECT_EQ((sword) cpu->read_reg(0), -7) << "\'vcint.s32.f32 x0, x1\' : where x1=-7.75, should round toward zero";
+    EXPECT_EQ(cpu->get_fpsr(), 1 << FPSR_IXC) << "a fraction should raise inexact";
+
+    cpu->run(1);
+    EXPECT_EQ(cpu->read_reg(2), 3000000000U) << "\'vcint.u32.f32 x2, x3\' : where x3=3000000000, should result in x2=3000000000";
+    delete cpu;
+}
+
+TEST(vcint, saturate) {
+    Emulator32bit *cpu = new Emulator32bit(1, 0, {}, 0, 1);
+    // vcint.s32.f32 x0, x4
+    // vcint.u32.f32 x1, x5
+    // vcint.s32.f32 x2, x6
+    // x4: 1e10, x5: -1, x6: NaN
+    cpu->system_bus.write_word(0, Emulator32bit::asm_format_f(Emulator32bit::_op_vcint, true, 0, 4));
+    cpu->system_bus.write_word(4, Emulator32bit::asm_format_f(Emulator32bit::_op_vcint, false, 1, 5));
+    cpu->system_bus.write_word(8, Emulator32bit::asm_format_f(Emulator32bit::_op_vcint, true, 2, 6));
+    cpu->set_pc(0);
+    cpu->write_reg(4, float_bits(1e10f));
+    cpu->write_reg(5, float_bits(-1.0f));
+    cpu->write_reg(6, 0x7FC00000);
+
+    cpu->run(3);
+
+    EXPECT_EQ(cpu->read_reg(0), 0x7FFFFFFF) << "should saturate to the largest signed word";
+    EXPECT_EQ(cpu->read_reg(1), 0) << "should saturate to 0";
+    EXPECT_EQ(cpu->read_reg(2), 0) << "NaN should convert to 0";
+    EXPECT_EQ(cpu->get_fpsr(), 1 << FPSR_IOC) << "operation should raise invalid operation";
+    delete cpu;
+}
@@ -0,0 +1,67 @@
+#include <emulator32bit_test/emulator32bit_test.h>
+
+static void expect_nzcv(Emulator32bit *cpu, bool n, bool z, bool c, bool v, const char *msg)
+{
+    EXPECT_EQ(cpu->get_flag(N_FLAG), n) << msg;
+    EXPECT_EQ(cpu->get_flag(Z_FLAG), z) << msg;
+    EXPECT_EQ(cpu->get_flag(C_FLAG), c) << msg;
+    EXPECT_EQ(cpu->get_flag(V_FLAG), v) << msg;
+}
+
+TEST(vcmp, register_vcmp) {
+    Emulator32bit *cpu = new Emulator32bit(1, 0, {}, 0, 1);
+    // vcmp.f32 x1, x2
+    // vcmp.f32 x2, x1
+    // vcmp.f32 x1, x1
+    // x1: -1.5
+    // x2: 2
+    cpu->system_bus.write_word(0, Emulator32bit::asm_format_f1(Emulator32bit::_op_vcmp, 0, 1, 2));
+    cpu->system_bus.write_word(4, Emulator32bit::asm_format_f1(Emulator32bit::_op_vcmp, 0, 2, 1));
+    cpu->system_bus.write_word(8, Emulator32bit::asm_format_f1(Emulator32bit::_op_vcmp, 0, 1, 1));
+    cpu->set_pc(0);
+    cpu->write_reg(1, float_bits(-1.5f));
+    cpu->write_reg(2, float_bits(2.0f));
+
+    cpu->run(1);
+    expect_nzcv(cpu, 1, 0, 0, 0, "less than should set N");
+    cpu->run(1);
+    expect_nzcv(cpu, 0, 0, 1, 0, "greater than should set C");
+    cpu->run(1);
+    expect_nzcv(cpu, 0, 1, 1, 0, "equal should set Z and C");
+    EXPECT_EQ(cpu->read_reg(0), 0) << "operation should not write a register";
+    delete cpu;
+}
+
+TEST(vcmp, zero) {
+    Emulator32bit *cpu = new Emulator32bit(1, 0, {}, 0, 1);
+    // vcmp.f32 x1, #0
+    // x1: -0
+    cpu->system_bus.write_word(0, Emulator32bit::asm_format_f1(Emulator32bit::_op_vcmp,
+            Emulator32bit::ConditionCode::AL, 0, 1, true, 0));
+    cpu->set_pc(0);
+    cpu->write_reg(1, 0x80000000);
+
+    cpu->run(1);
+    expect_nzcv(cpu, 0, 1, 1, 0, "-0 should equal 0");
+    delete cpu;
+}
+
+TEST(vcmp, unordered) {
+    Emulator32bit *cpu = new Emulator32bit(1, 0, {}, 0, 1);
+    // vcmp.f32 x1, x2
+    // vcmp.f32 x1, x3
+    // x1: 1, x2: quiet NaN, x3: signaling NaN
+    cpu->system_bus.write_word(0, Emulator32bit::asm_format_f1(Emulator32bit::_op_vcmp, 0, 1, 2));
+    cpu->system_bus.write_word(4, Emulator32bit::asm_format_f1(Emulator32bit::_op_vcmp, 0, 1, 3));
+    cpu->set_pc(0);
+    cpu->write_reg(1, float_bits(1.0f));
+    cpu->write_reg(2, 0x7FC00000);
+    cpu->write_reg(3, 0x7F800001);
+
+    cpu->run(1);
+    expect_nzcv(cpu, 0, 0, 1, 1, "unordered should set C and V");
+    EXPECT_EQ(cpu->get_fpsr(), 0) << "a quiet NaN should not raise invalid operation";
+    cpu->run(1);
+    EXPECT_EQ(cpu->get_fpsr(), 1 << FPSR_IOC) << "a signaling NaN should raise invalid operation";
+    delete cpu;
+}
@@ -0,0 +1,40 @@
+#include <emulator32bit_test/emulator32bit_test.h>
+
+TEST(vdiv, register_vdiv) {
+    Emulator32bit *cpu = new Emulator32bit(1, 0, {}, 0, 1);
+    // vdiv.f32 x0, x1, x2
+    // x1: 1
+    // x2: 3
+    cpu->system_bus.write_word(0, Emulator32bit::asm_format_f1(Emulator32bit::_op_vdiv, 0, 1, 2));
+    cpu->set_pc(0);
+    cpu->write_reg(1, float_bits(1.0f));
+    cpu->write_reg(2, float_bits(3.0f));
+
+    cpu->run(1);
+
+    EXPECT_EQ(bits_float(cpu->read_reg(0)), 1.0f / 3.0f) << "\'vdiv.f32 x0, x1, x2\' : where x1=1, x2=3, should result in x0=1/3";
+    EXPECT_EQ(cpu->get_fpsr(), 1 << FPSR_IXC) << "operation should raise inexact";
+    delete cpu;
+}
+
+TEST(vdiv, divide_by_zero) {
+    Emulator32bit *cpu = new Emulator32bit(1, 0, {}, 0, 1);
+    // vdiv.f32 x0, x1, x2
+    // vdiv.f32 x3, x2, x2
+    // x1: -1
+    // x2: 0
+    cpu->system_bus.write_word(0, Emulator32bit::asm_format_f1(Emulator32bit::_op_vdiv, 0, 1, 2));
+    cpu->system_bus.write_word(4, Emulator32bit::asm_format_f1(Emulator32bit::_op_vdiv, 3, 2, 2));
+    cpu->set_pc(0);
+    cpu->write_reg(1, float_bits(-1.0f));
+    cpu->write_reg(2, 0);
+
+    cpu->run(1);
+    EXPECT_EQ(cpu->read_reg(0), 0xFF800000) << "-1 / 0 should be -inf";
+    EXPECT_EQ(cpu->get_fpsr(), 1 << FPSR_DZC) << "operation should raise division by zero";
+
+    cpu->run(1);
+    EXPECT_EQ(cpu->read_reg(3), 0x7FC00000) << "0 / 0 should be the default NaN";
+    EXPECT_EQ(cpu->get_fpsr(), (1 << FPSR_DZC) | (1 << FPSR_IOC)) << "0 / 0 should raise invalid operation";
+    delete cpu;
+}
@@ -0,0 +1,53 @@
+#include <emulator32bit_test/emulator32bit_test.h>
+
+TEST(vmov, register_vmov) {
+    Emulator32bit *cpu = new Emulator32bit(1, 0, {}, 0, 1);
+    // vmov.f32 x0, x1
+    // x1: signaling NaN
+    cpu->system_bus.write_word(0, Emulator32bit::asm_format_f2(Emulator32bit::_op_vmov,
+            Emulator32bit::VMOV_REGISTER, 0, 1));
+    cpu->set_pc(0);
+    cpu->write_reg(1, 0x7F800001);
+
+    cpu->run(1);
+
+    EXPECT_EQ(cpu->read_reg(0), 0x7F800001) << "a move should copy the bits unchanged";
+    EXPECT_EQ(cpu->get_fpsr(), 0) << "a move should not raise floating point exceptions";
+    delete cpu;
+}
+
+TEST(vmov, immediate) {
+    Emulator32bit *cpu = new Emulator32bit(1, 0, {}, 0, 1);
+    // vmov.f32 x0, #-0.15625
+    cpu->system_bus.write_word(0, Emulator32bit::asm_format_f2(Emulator32bit::_op_vmov, 0,
+            float_bits(-0.15625f) >> 12));
+    cpu->set_pc(0);
+
+    cpu->run(1);
+
+    EXPECT_EQ(bits_float(cpu->read_reg(0)), -0.15625f) << "\'vmov.f32 x0, #-0.15625\' : should result in x0=-0.15625";
+    delete cpu;
+}
+
+TEST(vmov, system_registers) {
+    Emulator32bit *cpu = new Emulator32bit(1, 0, {}, 0, 1);
+    // vmsr fpcr, x1
+    // vmrs x0, fpcr
+    // vmsr fpsr, x2
+    // vmrs x3, fpsr
+    // x1: all ones
+    // x2: 1 << FPSR_DZC
+    cpu->system_bus.write_word(0, Emulator32bit::asm_format_f2(Emulator32bit::_op_vmov, Emulator32bit::VMSR_FPCR, 0, 1));
+    cpu->system_bus.write_word(4, Emulator32bit::asm_format_f2(Emulator32bit::_op_vmov, Emulator32bit::VMRS_FPCR, 0, 0));
+    cpu->system_bus.write_word(8, Emulator32bit::asm_format_f2(Emulator32bit::_op_vmov, Emulator32bit::VMSR_FPSR, 0, 2));
+    cpu->system_bus.write_word(12, Emulator32bit::asm_format_f2(Emulator32bit::_op_vmov, Emulator32bit::VMRS_FPSR, 3, 0));
+    cpu->set_pc(0);
+    cpu->write_reg(1, 0xFFFFFFFF);
+    cpu->write_reg(2, 1 << FPSR_DZC);
+
+    cpu->run(4);
+
+    EXPECT_EQ(cpu->read_reg(0), FPCR_MASK) << "unimplemented FPCR bits should read as 0";
+    EXPECT_EQ(cpu->read_reg(3), 1 << FPSR_DZC) << "FPSR should read back what was written";
+    delete cpu;
+}
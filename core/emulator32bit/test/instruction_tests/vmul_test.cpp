@@ -0,0 +1,32 @@
+#include <emulator32bit_test/emulator32bit_test.h>
+
+TEST(vmul, register_vmul) {
+    Emulator32bit *cpu = new Emulator32bit(1, 0, {}, 0, 1);
+    // vmul.f32 x0, x1, x2
+    // x1: -1.5
+    // x2: 2.5
+    cpu->system_bus.write_word(0, Emulator32bit::asm_format_f1(Emulator32bit::_op_vmul, 0, 1, 2));
+    cpu->set_pc(0);
+    cpu->write_reg(1, float_bits(-1.5f));
+    cpu->write_reg(2, float_bits(2.5f));
+
+    cpu->run(1);
+
+    EXPECT_EQ(bits_float(cpu->read_reg(0)), -3.75f) << "\'vmul.f32 x0, x1, x2\' : where x1=-1.5, x2=2.5, should result in x0=-3.75";
+    delete cpu;
+}
+
+TEST(vmul, underflow) {
+    Emulator32bit *cpu = new Emulator32bit(1, 0, {}, 0, 1);
+    // vmul.f32 x0, x1, x1
+    // x1: 1e-30
+    cpu->system_bus.write_word(0, Emulator32bit::asm_format_f1(Emulator32bit::_op_vmul, 0, 1, 1));
+    cpu->set_pc(0);
+    cpu->write_reg(1, float_bits(1e-30f));
+
+    cpu->run(1);
+
+    EXPECT_EQ(cpu->read_reg(0), 0) << "should underflow to zero";
+    EXPECT_EQ(cpu->get_fpsr(), (1 << FPSR_UFC) | (1 << FPSR_IXC)) << "operation should raise underflow and inexact";
+    delete cpu;
+}
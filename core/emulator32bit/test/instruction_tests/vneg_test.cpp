@@ -0,0 +1,20 @@
+#include <emulator32bit_test/emulator32bit_test.h>
+
+TEST(vneg, register_vneg) {
+    Emulator32bit *cpu = new Emulator32bit(1, 0, {}, 0, 1);
+    // vneg.f32 x0, x1
+    // vneg.f32 x2, x3
+    // x1: 1.5
+    // x3: 0
+    cpu->system_bus.write_word(0, Emulator32bit::asm_format_f(Emulator32bit::_op_vneg, false, 0, 1));
+    cpu->system_bus.write_word(4, Emulator32bit::asm_format_f(Emulator32bit::_op_vneg, false, 2, 3));
+    cpu->set_pc(0);
+    cpu->write_reg(1, float_bits(1.5f));
+    cpu->write_reg(3, 0);
+
+    cpu->run(2);
+
+    EXPECT_EQ(bits_float(cpu->read_reg(0)), -1.5f) << "\'vneg.f32 x0, x1\' : where x1=1.5, should result in x0=-1.5";
+    EXPECT_EQ(cpu->read_reg(2), 0x80000000) << "\'vneg.f32 x2, x3\' : where x3=0, should result in x2=-0";
+    delete cpu;
+}
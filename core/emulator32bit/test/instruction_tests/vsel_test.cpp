@@ -0,0 +1,24 @@
+#include <emulator32bit_test/emulator32bit_test.h>
+
+TEST(vsel, register_vsel) {
+    Emulator32bit *cpu = new Emulator32bit(1, 0, {}, 0, 1);
+    // vcmp.f32 x1, x2
+    // vsel.lt.f32 x0, x1, x2
+    // vsel.gt.f32 x3, x1, x2
+    // x1: 1
+    // x2: 2
+    cpu->system_bus.write_word(0, Emulator32bit::asm_format_f1(Emulator32bit::_op_vcmp, 0, 1, 2));
+    cpu->system_bus.write_word(4, Emulator32bit::asm_format_f1(Emulator32bit::_op_vsel,
+            Emulator32bit::ConditionCode::LT, 0, 1, false, 2));
+    cpu->system_bus.write_word(8, Emulator32bit::asm_format_f1(Emulator32bit::_op_vsel,
+            Emulator32bit::ConditionCode::GT, 3, 1, false, 2));
+    cpu->set_pc(0);
+    cpu->write_reg(1, float_bits(1.0f));
+    cpu->write_reg(2, float_bits(2.0f));
+
+    cpu->run(3);
+
+    EXPECT_EQ(bits_float(cpu->read_reg(0)), 1.0f) << "\'vsel.lt.f32 x0, x1, x2\' : should select the minimum";
+    EXPECT_EQ(bits_float(cpu->read_reg(3)), 2.0f) << "\'vsel.gt.f32 x3, x1, x2\' : should select the maximum";
+    delete cpu;
+}
@@ -0,0 +1,38 @@
+#include <emulator32bit_test/emulator32bit_test.h>
+
+TEST(vsqrt, register_vsqrt) {
+    Emulator32bit *cpu = new Emulator32bit(1, 0, {}, 0, 1);
+    // vsqrt.f32 x0, x1
+    // x1: 6.25
+    cpu->system_bus.write_word(0, Emulator32bit::asm_format_f(Emulator32bit::_op_vsqrt, false, 0, 1));
+    cpu->set_pc(0);
+    cpu->write_reg(1, float_bits(6.25f));
+
+    cpu->run(1);
+
+    EXPECT_EQ(bits_float(cpu->read_reg(0)), 2.5f) << "\'vsqrt.f32 x0, x1\' : where x1=6.25, should result in x0=2.5";
+    EXPECT_EQ(cpu->get_fpsr(), 0) << "an exact root should not raise floating point exceptions";
+    delete cpu;
+}
+
+TEST(vsqrt, negative) {
+    Emulator32bit *cpu = new Emulator32bit(1, 0, {}, 0, 1);
+    // vsqrt.f32 x0, x1
+    // vsqrt.f32 x2, x3
+    // x1: -1
+    // x3: 2
+    cpu->system_bus.write_word(0, Emulator32bit::asm_format_f(Emulator32bit::_op_vsqrt, false, 0, 1));
+    cpu->system_bus.write_word(4, Emulator32bit::asm_format_f(Emulator32bit::_op_vsqrt, false, 2, 3));
+    cpu->set_pc(0);
+    cpu->write_reg(1, float_bits(-1.0f));
+    cpu->write_reg(3, float_bits(2.0f));
+
+    cpu->run(1);
+    EXPECT_EQ(cpu->read_reg(0), 0x7FC00000) << "root of a negative number should be the default NaN";
+    EXPECT_EQ(cpu->get_fpsr(), 1 << FPSR_IOC) << "root of a negative number should raise invalid operation";
+
+    cpu->run(1);
+    EXPECT_EQ(bits_float(cpu->read_reg(2)), 1.41421354f) << "\'vsqrt.f32 x2, x3\' : where x3=2, should round to nearest";
+    EXPECT_EQ(cpu->get_fpsr(), (1 << FPSR_IOC) | (1 << FPSR_IXC)) << "exception flags should be cumulative";
+    delete cpu;
+}
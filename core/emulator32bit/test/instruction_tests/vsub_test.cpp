@@ -0,0 +1,35 @@
+#include <emulator32bit_test/emulator32bit_test.h>
+
+TEST(vsub, register_vsub) {
+    Emulator32bit *cpu = new Emulator32bit(1, 0, {}, 0, 1);
+    // vsub.f32 x0, x1, x2
+    // x1: 1.5
+    // x2: 4
+    cpu->system_bus.write_word(0, Emulator32bit::asm_format_f1(Emulator32bit::_op_vsub, 0, 1, 2));
+    cpu->set_pc(0);
+    cpu->write_reg(1, float_bits(1.5f));
+    cpu->write_reg(2, float_bits(4.0f));
+
+    cpu->run(1);
+
+    EXPECT_EQ(bits_float(cpu->read_reg(0)), -2.5f) << "\'vsub.f32 x0, x1, x2\' : where x1=1.5, x2=4, should result in x0=-2.5";
+    EXPECT_EQ(cpu->get_fpsr(), 0) << "an exact difference should not raise floating point exceptions";
+    delete cpu;
+}
+
+TEST(vsub, overflow) {
+    Emulator32bit *cpu = new Emulator32bit(1, 0, {}, 0, 1);
+    // vsub.f32 x0, x1, x2
+    // x1: -max float
+    // x2: max float
+    cpu->system_bus.write_word(0, Emulator32bit::asm_format_f1(Emulator32bit::_op_vsub, 0, 1, 2));
+    cpu->set_pc(0);
+    cpu->write_reg(1, 0xFF7FFFFF);
+    cpu->write_reg(2, 0x7F7FFFFF);
+
+    cpu->run(1);
+
+    EXPECT_EQ(cpu->read_reg(0), 0xFF800000) << "should overflow to -inf";
+    EXPECT_EQ(cpu->get_fpsr(), (1 << FPSR_OFC) | (1 << FPSR_IXC)) << "operation should raise overflow and inexact";
+    delete cpu;
+}
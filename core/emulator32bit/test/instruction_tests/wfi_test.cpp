@@ -0,0 +1,87 @@
+#include <emulator32bit_test/emulator32bit_test.h>
+
+#include <chrono>
+#include <ctime>
+#include <thread>
+
+/* wfi; add x0, x0, #1; hlt */
+static Emulator32bit* create_wfi_program()
+{
+    Emulator32bit *cpu = new Emulator32bit(1, 0, {}, 0, 1);
+    cpu->system_bus.write_word(0, Emulator32bit::asm_wfi());
+    cpu->system_bus.write_word(4, Emulator32bit::asm_format_o(Emulator32bit::_op_add, false, 0, 0, 1));
+    cpu->system_bus.write_word(8, Emulator32bit::asm_hlt());
+    cpu->set_pc(0);
+    return cpu;
+}
+
+TEST(wfi, disassemble) {
+    EXPECT_EQ(disassemble_instr(Emulator32bit::asm_wfi()), "wfi");
+}
+
+TEST(wfi, fast_forwards_to_next_event) {
+    Emulator32bit *cpu = create_wfi_program();
+    bool woke = false;
+    cpu->schedule_event(1000000000ULL, [&]() { woke = true; });
+
+    cpu->run(0);
+    EXPECT_EQ(cpu->is_waiting(), false) << "the clock skips to the event instead of spinning";
+    EXPECT_EQ(woke, true);
+    EXPECT_EQ(cpu->read_reg(0), 1);
+    EXPECT_EQ(cpu->cycles(), 1000000001ULL);
+    delete cpu;
+}
+
+TEST(wfi, stops_at_end_of_run) {
+    Emulator32bit *cpu = create_wfi_program();
+    cpu->schedule_event(1000, []() {});
+
+    cpu->run(10);
+    EXPECT_EQ(cpu->is_waiting(), true);
+    EXPECT_EQ(cpu->cycles(), 10);
+    EXPECT_EQ(cpu->read_reg(0), 0);
+
+    cpu->run(0);
+    EXPECT_EQ(cpu->read_reg(0), 1);
+    delete cpu;
+}
+
+TEST(wfi, bounded_run_with_nothing_scheduled) {
+    Emulator32bit *cpu = create_wfi_program();
+
+    cpu->run(10);
+    EXPECT_EQ(cpu->is_waiting(), true) << "returns instead of waiting for an event that never comes";
+    EXPECT_EQ(cpu->cycles(), 10);
+    EXPECT_EQ(cpu->read_reg(0), 0);
+    delete cpu;
+}
+
+TEST(wfi, sleeps_until_posted_event) {
+    Emulator32bit *cpu = create_wfi_program();
+    bool woke = false;
+    cpu->attach_event_source();
+    std::thread device([&]() {
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        cpu->post_event([&]() { woke = true; });
+    });
+
+    std::clock_t cpu_start = std::clock();
+    cpu->run(0);
+    double cpu_ms = 1000.0 * (std::clock() - cpu_start) / CLOCKS_PER_SEC;
+    device.join();
+    cpu->detach_event_source();
+
+    EXPECT_EQ(woke, true);
+    EXPECT_EQ(cpu->read_reg(0), 1);
+    EXPECT_LT(cpu_ms, 25.0) << "the emulator thread should block, not spin";
+    delete cpu;
+}
+
+TEST(wfi, stops_with_nothing_to_wake_it) {
+    Emulator32bit *cpu = create_wfi_program();
+
+    cpu->run(0);
+    EXPECT_EQ(cpu->is_waiting(), true) << "stops instead of sleeping forever";
+    EXPECT_EQ(cpu->read_reg(0), 0);
+    delete cpu;
+}
@@ -116,6 +116,42 @@ class FileReader
         bool m_closed;
 };
 
+/**
+ * Maps a file into memory. Nothing is read until a page is touched and the host shares the pages
+ * between everything mapping the same file.
+ *
+ * READ_ONLY maps the whole file read only. PRIVATE and SHARED map a fixed size, zero filled past
+ * the end of the file. Writes to a PRIVATE mapping are never seen by the file, writes to a SHARED
+ * mapping go through to the file, which is grown to the mapped size. On Windows a PRIVATE mapping
+ * is read into zeroed memory up front, since a file view can not be followed by zero pages.
+ */
+class MappedFile
+{
+    public:
+        enum class Mode
+        {
+            READ_ONLY, PRIVATE, SHARED,
+        };
+
+        MappedFile(const File& file);
+        MappedFile(const File& file, size_t size, Mode mode);
+        ~MappedFile();
+
+        MappedFile(const MappedFile&) = delete;
+        MappedFile& operator=(const MappedFile&) = delete;
+
+        const unsigned char* data() const;
+        unsigned char* data();
+        size_t size() const;
+        size_t file_size() const;
+        void sync(size_t offset, size_t length);
+    private:
+        unsigned char* m_data = nullptr;
+        size_t m_size = 0;
+        size_t m_file_size = 0;
+        Mode m_mode = Mode::READ_ONLY;
+};
+
 class ByteReader
 {
     public:
@@ -3,6 +3,18 @@
 
 #include <fstream>
 
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#define NOGDI
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
 std::string trim_dir_path(const std::string& str)
 {
     std::vector<std::string> segments;
@@ -360,7 +372,7 @@ char* FileWriter::last_bytes_written(unsigned int num_bytes)
 {
     char* bytes = new char[num_bytes];
 
-    for (size_t i = std::max(0ULL, num_bytes - m_bytes_written.size()); i < num_bytes; i++) {
+    for (size_t i = std::max((size_t) 0, num_bytes - m_bytes_written.size()); i < num_bytes; i++) {
         bytes[i] = m_bytes_written[m_bytes_written.size() - num_bytes + i];
     }
 
@@ -574,3 +586,292 @@ void FileReader::close()
         m_closed = true;
     }
 }
+
+#ifdef _WIN32
+/**
+ * Maps the file into memory
+ *
+ * @param file the file to map
+ */
+MappedFile::MappedFile(const File& file)
+{
+    HANDLE handle = CreateFileA(file.get_path().c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+                                OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (handle == INVALID_HANDLE_VALUE) {
+        ERROR("MappedFile::MappedFile() - Could not open file: %s", file.get_path().c_str());
+        return;
+    }
+
+    LARGE_INTEGER file_size;
+    if (GetFileSizeEx(handle, &file_size) && file_size.QuadPart > 0) {
+        m_size = file_size.QuadPart;
+        m_file_size = m_size;
+        HANDLE mapping = CreateFileMappingA(handle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        void* view = mapping ? MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0) : nullptr;
+        if (!view) {
+            m_size = 0;
+            ERROR("MappedFile::MappedFile() - Could not map file: %s", file.get_path().c_str());
+        } else {
+            m_data = (unsigned char*) view;
+        }
+
+        /* the view keeps the mapping object alive */
+        if (mapping) {
+            CloseHandle(mapping);
+        }
+    }
+    CloseHandle(handle);
+}
+
+/**
+ * Maps the first size bytes of a file, zero filled past the end of the file
+ *
+ * @param file the file to map
+ * @param size the number of bytes to map
+ * @param mode PRIVATE keeps writes in memory, SHARED writes them through to the file
+ */
+MappedFile::MappedFile(const File& file, size_t size, Mode mode) :
+    m_mode(mode)
+{
+    if (mode == Mode::READ_ONLY) {
+        ERROR("MappedFile::MappedFile() - A sized mapping must be writable: %s", file.get_path().c_str());
+        return;
+    }
+
+    HANDLE handle = CreateFileA(file.get_path().c_str(),
+                                mode == Mode::SHARED ? GENERIC_READ | GENERIC_WRITE : GENERIC_READ,
+                                FILE_SHARE_READ | FILE_SHARE_WRITE, nullptr,
+                                mode == Mode::SHARED ? OPEN_ALWAYS : OPEN_EXISTING,
+                                FILE_ATTRIBUTE_NORMAL, nullptr);
+    LARGE_INTEGER file_size;
+    if (handle == INVALID_HANDLE_VALUE || !GetFileSizeEx(handle, &file_size)) {
+        if (handle != INVALID_HANDLE_VALUE) {
+            CloseHandle(handle);
+        }
+        ERROR("MappedFile::MappedFile() - Could not open file: %s", file.get_path().c_str());
+        return;
+    }
+    m_file_size = file_size.QuadPart;
+
+    if (size == 0) {
+        CloseHandle(handle);
+        return;
+    }
+
+    void* view = nullptr;
+    if (mode == Mode::SHARED) {
+        /* a mapping larger than the file grows the file to cover it */
+        HANDLE mapping = CreateFileMappingA(handle, nullptr, PAGE_READWRITE,
+                                            (DWORD) ((unsigned long long) size >> 32), (DWORD) size, nullptr);
+        if (mapping) {
+            view = MapViewOfFile(mapping, FILE_MAP_WRITE, 0, 0, size);
+            CloseHandle(mapping);
+        }
+    } else {
+        /*
+            A file view can not be followed by zero pages, so private mappings read the file into
+            zeroed memory instead of mapping it.
+        */
+        view = VirtualAlloc(nullptr, size, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE);
+        size_t file_bytes = m_file_size < size ? m_file_size : size;
+        size_t read = 0;
+        while (view && read < file_bytes) {
+            DWORD chunk = file_bytes - read < 0x40000000 ? (DWORD) (file_bytes - read) : 0x40000000;
+            DWORD nread = 0;
+            if (!ReadFile(handle, (unsigned char*) view + read, chunk, &nread, nullptr) || nread == 0) {
+                VirtualFree(view, 0, MEM_RELEASE);
+                view = nullptr;
+            }
+            read += nread;
+        }
+    }
+    CloseHandle(handle);
+
+    if (!view) {
+        ERROR("MappedFile::MappedFile() - Could not map file: %s", file.get_path().c_str());
+        return;
+    }
+    m_data = (unsigned char*) view;
+    m_size = size;
+}
+
+/**
+ * Unmaps the file
+ */
+MappedFile::~MappedFile()
+{
+    if (!m_data) {
+        return;
+    }
+
+    if (m_mode == Mode::PRIVATE) {
+        VirtualFree(m_data, 0, MEM_RELEASE);
+    } else {
+        UnmapViewOfFile(m_data);
+    }
+}
+#else
+/**
+ * Maps the file into memory
+ *
+ * @param file the file to map
+ */
+MappedFile::MappedFile(const File& file)
+{
+    int fd = open(file.get_path().c_str(), O_RDONLY);
+    if (fd < 0) {
+        ERROR("MappedFile::MappedFile() - Could not open file: %s", file.get_path().c_str());
+        return;
+    }
+
+    struct stat file_stat;
+    if (fstat(fd, &file_stat) == 0 && file_stat.st_size > 0) {
+        m_size = file_stat.st_size;
+        m_file_size = m_size;
+        void* mapping = mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (mapping == MAP_FAILED) {
+            m_size = 0;
+            ERROR("MappedFile::MappedFile() - Could not map file: %s", file.get_path().c_str());
+        } else {
+            m_data = (unsigned char*) mapping;
+        }
+    }
+
+    /* the mapping stays valid after the descriptor is closed */
+    ::close(fd);
+}
+
+/**
+ * Maps the first size bytes of a file, zero filled past the end of the file
+ *
+ * @param file the file to map
+ * @param size the number of bytes to map
+ * @param mode PRIVATE keeps writes in memory, SHARED writes them through to the file
+ */
+MappedFile::MappedFile(const File& file, size_t size, Mode mode) :
+    m_mode(mode)
+{
+    if (mode == Mode::READ_ONLY) {
+        ERROR("MappedFile::MappedFile() - A sized mapping must be writable: %s", file.get_path().c_str());
+        return;
+    }
+
+    int fd = open(file.get_path().c_str(), mode == Mode::SHARED ? O_RDWR | O_CREAT : O_RDONLY, 0644);
+    struct stat file_stat;
+    if (fd < 0 || fstat(fd, &file_stat) != 0) {
+        if (fd >= 0) {
+            ::close(fd);
+        }
+        ERROR("MappedFile::MappedFile() - Could not open file: %s", file.get_path().c_str());
+        return;
+    }
+    m_file_size = file_stat.st_size;
+
+    if (size == 0) {
+        ::close(fd);
+        return;
+    }
+
+    void* mapping = MAP_FAILED;
+    if (mode == Mode::SHARED) {
+        /* pages past the end of the file can not be shared, so the file grows to cover them */
+        if (m_file_size >= size || ftruncate(fd, size) == 0) {
+            mapping = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        }
+    } else {
+        /* zero pages past the end of the file, with the file mapped over the start of them */
+        mapping = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        size_t file_bytes = m_file_size < size ? m_file_size : size;
+        if (mapping != MAP_FAILED && file_bytes > 0 &&
+                mmap(mapping, file_bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_FIXED, fd, 0) == MAP_FAILED) {
+            munmap(mapping, size);
+            mapping = MAP_FAILED;
+        }
+    }
+    ::close(fd);
+
+    if (mapping == MAP_FAILED) {
+        ERROR("MappedFile::MappedFile() - Could not map file: %s", file.get_path().c_str());
+        return;
+    }
+    m_data = (unsigned char*) mapping;
+    m_size = size;
+}
+
+/**
+ * Unmaps the file
+ */
+MappedFile::~MappedFile()
+{
+    if (m_data) {
+        munmap(m_data, m_size);
+    }
+}
+#endif
+
+/**
+ * Returns the mapped bytes of the file
+ *
+ * @return the first byte of the file, nullptr if the file is empty
+ */
+const unsigned char* MappedFile::data() const
+{
+    return m_data;
+}
+
+/**
+ * Returns the mapped bytes of the file
+ *
+ * @return the first byte of the mapping, writable unless the mapping is READ_ONLY
+ */
+unsigned char* MappedFile::data()
+{
+    return m_data;
+}
+
+/**
+ * Returns the size of the mapped file
+ *
+ * @return the size in bytes
+ */
+size_t MappedFile::size() const
+{
+    return m_size;
+}
+
+/**
+ * Returns the size of the file when it was mapped
+ *
+ * @return the size in bytes
+ */
+size_t MappedFile::file_size() const
+{
+    return m_file_size;
+}
+
+/**
+ * Flushes writes to part of a SHARED mapping to the file. Does nothing for other mappings
+ *
+ * @param offset the first byte to flush
+ * @param length the number of bytes to flush
+ */
+void MappedFile::sync(size_t offset, size_t length)
+{
+    if (m_mode != Mode::SHARED || !m_data || offset >= m_size) {
+        return;
+    }
+
+    size_t end = offset + length < m_size ? offset + length : m_size;
+#ifdef _WIN32
+    if (!FlushViewOfFile(m_data + offset, end - offset)) {
+        ERROR("MappedFile::sync() - Could not write back mapped bytes %zu to %zu", offset, end);
+    }
+#else
+    /* msync needs a page aligned start */
+    size_t page_size = sysconf(_SC_PAGESIZE);
+    size_t start = offset - offset % page_size;
+    if (msync(m_data + start, end - start, MS_SYNC) != 0) {
+        ERROR("MappedFile::sync() - Could not write back mapped bytes %zu to %zu", offset, end);
+    }
+#endif
+}